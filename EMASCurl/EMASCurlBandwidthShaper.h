@@ -0,0 +1,41 @@
+//
+//  EMASCurlBandwidthShaper.h
+//  EMASCurl
+//
+//  Created by xuyecan on 2026/10/18.
+//
+
+#import <Foundation/Foundation.h>
+#import <curl/curl.h>
+#import "EMASCurlConfiguration.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ * 按优先级分配带宽：以最近聚合吞吐的衰减峰值估计链路容量，有前台传输时给后台传输设置
+ * CURLOPT_MAX_RECV_SPEED_LARGE/CURLOPT_MAX_SEND_SPEED_LARGE，只让它们使用前台用量与预留之外的剩余容量；
+ * 没有前台传输时解除限速。传输开始、结束及每次采样后重新分配。
+ * 所有方法只应在网络线程调用。
+ */
+@interface EMASCurlBandwidthShaper : NSObject
+
+// 关闭后解除所有限速，默认开启
+@property (nonatomic, assign) BOOL enabled;
+
+// 估计的下行/上行链路容量，单位字节每秒，尚无样本时为0
+@property (nonatomic, assign, readonly) int64_t estimatedRecvCapacity;
+
+@property (nonatomic, assign, readonly) int64_t estimatedSendCapacity;
+
+// 句柄加入multi后登记，复制句柄带来的限速会被清除
+- (void)addTransfer:(CURL *)easyHandle priority:(EMASCurlRequestPriority)priority;
+
+// 句柄结束、cleanup之前移除
+- (void)removeTransfer:(CURL *)easyHandle;
+
+// 事件循环每轮调用，按固定间隔采样吞吐并重新分配
+- (void)tick;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,226 @@
+//
+//  EMASCurlBandwidthShaper.m
+//  EMASCurl
+//
+//  Created by xuyecan on 2026/10/18.
+//
+
+#import "EMASCurlBandwidthShaper.h"
+#import "EMASCurlLogger.h"
+#include <math.h>
+#include <time.h>
+
+// 吞吐采样间隔
+static const uint64_t kEMASShaperSampleIntervalNs = 250 * NSEC_PER_MSEC;
+
+// 容量估计取带衰减的峰值，经过该秒数没有更高的样本时衰减一半
+static const double kEMASShaperCapacityHalfLife = 10.0;
+
+// 有前台传输时在其当前用量之上预留的容量比例，供前台突发使用
+static const double kEMASShaperForegroundHeadroom = 0.25;
+
+// 前台占满链路时，所有后台传输合计仍可使用的容量比例
+static const double kEMASShaperBackgroundMinimumShare = 0.1;
+
+// 单个后台传输的最低速率，避免长时间饿死而超时
+static const int64_t kEMASShaperMinimumRate = 16 * 1024;
+
+@interface EMASCurlShapedTransfer : NSObject
+
+@property (nonatomic, assign) CURL *easy;
+@property (nonatomic, assign) EMASCurlRequestPriority priority;
+@property (nonatomic, assign) curl_off_t lastRecvBytes;
+@property (nonatomic, assign) curl_off_t lastSendBytes;
+// 当前设置的限速，0表示不限
+@property (nonatomic, assign) int64_t recvLimit;
+@property (nonatomic, assign) int64_t sendLimit;
+
+@end
+
+@implementation EMASCurlShapedTransfer
+@end
+
+@interface EMASCurlBandwidthShaper ()
+
+@property (nonatomic, strong) NSMutableDictionary<NSNumber *, EMASCurlShapedTransfer *> *transfers;
+@property (nonatomic, assign) uint64_t lastSampleTime;
+// 已结束的传输在最后一个采样周期内的字节数
+@property (nonatomic, assign) int64_t finishedRecvBytes;
+@property (nonatomic, assign) int64_t finishedSendBytes;
+@property (nonatomic, assign) double recvCapacity;
+@property (nonatomic, assign) double sendCapacity;
+// 前台传输的平滑吞吐
+@property (nonatomic, assign) double foregroundRecvRate;
+@property (nonatomic, assign) double foregroundSendRate;
+
+@end
+
+@implementation EMASCurlBandwidthShaper
+
+- (instancetype)init {
+    self = [super init];
+    if (self) {
+        _enabled = YES;
+        _transfers = [NSMutableDictionary dictionary];
+    }
+    return self;
+}
+
+- (int64_t)estimatedRecvCapacity {
+    return (int64_t)self.recvCapacity;
+}
+
+- (int64_t)estimatedSendCapacity {
+    return (int64_t)self.sendCapacity;
+}
+
+- (void)setEnabled:(BOOL)enabled {
+    _enabled = enabled;
+    [self rebalance];
+}
+
+- (void)addTransfer:(CURL *)easyHandle priority:(EMASCurlRequestPriority)priority {
+    if (self.transfers.count == 0) {
+        // 空闲期间不计入采样周期
+        self.lastSampleTime = clock_gettime_nsec_np(CLOCK_UPTIME_RAW);
+        self.finishedRecvBytes = 0;
+        self.finishedSendBytes = 0;
+    }
+
+    EMASCurlShapedTransfer *transfer = [EMASCurlShapedTransfer new];
+    transfer.easy = easyHandle;
+    transfer.priority = priority;
+    // curl_easy_duphandle会带上原句柄的限速，从不限速开始
+    curl_easy_setopt(easyHandle, CURLOPT_MAX_RECV_SPEED_LARGE, (curl_off_t)0);
+    curl_easy_setopt(easyHandle, CURLOPT_MAX_SEND_SPEED_LARGE, (curl_off_t)0);
+    self.transfers[@((uintptr_t)easyHandle)] = transfer;
+    [self rebalance];
+}
+
+- (void)removeTransfer:(CURL *)easyHandle {
+    NSNumber *key = @((uintptr_t)easyHandle);
+    EMASCurlShapedTransfer *transfer = self.transfers[key];
+    if (!transfer) {
+        return;
+    }
+    curl_off_t recvBytes = 0, sendBytes = 0;
+    curl_easy_getinfo(easyHandle, CURLINFO_SIZE_DOWNLOAD_T, &recvBytes);
+    curl_easy_getinfo(easyHandle, CURLINFO_SIZE_UPLOAD_T, &sendBytes);
+    self.finishedRecvBytes += MAX(recvBytes - transfer.lastRecvBytes, 0);
+    self.finishedSendBytes += MAX(sendBytes - transfer.lastSendBytes, 0);
+
+    [self.transfers removeObjectForKey:key];
+    [self rebalance];
+}
+
+- (void)tick {
+    if (self.transfers.count == 0) {
+        return;
+    }
+    uint64_t now = clock_gettime_nsec_np(CLOCK_UPTIME_RAW);
+    if (now - self.lastSampleTime < kEMASShaperSampleIntervalNs) {
+        return;
+    }
+    double elapsed = (double)(now - self.lastSampleTime) / NSEC_PER_SEC;
+    self.lastSampleTime = now;
+
+    int64_t recvBytes = self.finishedRecvBytes;
+    int64_t sendBytes = self.finishedSendBytes;
+    int64_t foregroundRecvBytes = 0, foregroundSendBytes = 0;
+    self.finishedRecvBytes = 0;
+    self.finishedSendBytes = 0;
+    BOOL recvLimited = NO, sendLimited = NO;
+    for (EMASCurlShapedTransfer *transfer in self.transfers.objectEnumerator) {
+        curl_off_t currentRecv = 0, currentSend = 0;
+        curl_easy_getinfo(transfer.easy, CURLINFO_SIZE_DOWNLOAD_T, &currentRecv);
+        curl_easy_getinfo(transfer.easy, CURLINFO_SIZE_UPLOAD_T, &currentSend);
+        int64_t recvDelta = MAX(currentRecv - transfer.lastRecvBytes, 0);
+        int64_t sendDelta = MAX(currentSend - transfer.lastSendBytes, 0);
+        transfer.lastRecvBytes = currentRecv;
+        transfer.lastSendBytes = currentSend;
+        recvBytes += recvDelta;
+        sendBytes += sendDelta;
+        if (transfer.priority != EMASCurlRequestPriorityBackground) {
+            foregroundRecvBytes += recvDelta;
+            foregroundSendBytes += sendDelta;
+        }
+
+        // 速率达到限速的95%视为被限速卡住
+        if (transfer.recvLimit > 0 && recvDelta >= 0.95 * transfer.recvLimit * elapsed) {
+            recvLimited = YES;
+        }
+        if (transfer.sendLimit > 0 && sendDelta >= 0.95 * transfer.sendLimit * elapsed) {
+            sendLimited = YES;
+        }
+    }
+
+    // 后台传输跑满限速时聚合吞吐低于真实容量，保持估计值不衰减；链路变差时后台速率达不到限速，估计值随之回落
+    double decay = exp2(-elapsed / kEMASShaperCapacityHalfLife);
+    self.recvCapacity = MAX(recvBytes / elapsed, self.recvCapacity * (recvLimited ? 1.0 : decay));
+    self.sendCapacity = MAX(sendBytes / elapsed, self.sendCapacity * (sendLimited ? 1.0 : decay));
+    self.foregroundRecvRate = (self.foregroundRecvRate + foregroundRecvBytes / elapsed) / 2;
+    self.foregroundSendRate = (self.foregroundSendRate + foregroundSendBytes / elapsed) / 2;
+    [self rebalance];
+}
+
+- (void)rebalance {
+    NSUInteger foregroundCount = 0, backgroundCount = 0;
+    for (EMASCurlShapedTransfer *transfer in self.transfers.objectEnumerator) {
+        if (transfer.priority == EMASCurlRequestPriorityBackground) {
+            backgroundCount++;
+        } else {
+            foregroundCount++;
+        }
+    }
+    if (foregroundCount == 0) {
+        self.foregroundRecvRate = 0;
+        self.foregroundSendRate = 0;
+    }
+    if (backgroundCount == 0) {
+        return;
+    }
+
+    // 只有与前台传输并存时才限速，后台传输之间不互相限制
+    BOOL shaping = self.enabled && foregroundCount > 0;
+    int64_t recvLimit = shaping ? [self limitForCapacity:self.recvCapacity
+                                          foregroundRate:self.foregroundRecvRate
+                                           transferCount:backgroundCount] : 0;
+    int64_t sendLimit = shaping ? [self limitForCapacity:self.sendCapacity
+                                          foregroundRate:self.foregroundSendRate
+                                           transferCount:backgroundCount] : 0;
+
+    // libcurl每次检查速率时读取限速选项，运行中的传输从下一次读写起生效
+    BOOL changed = NO;
+    for (EMASCurlShapedTransfer *transfer in self.transfers.objectEnumerator) {
+        if (transfer.priority != EMASCurlRequestPriorityBackground) {
+            continue;
+        }
+        if (transfer.recvLimit != recvLimit) {
+            transfer.recvLimit = recvLimit;
+            curl_easy_setopt(transfer.easy, CURLOPT_MAX_RECV_SPEED_LARGE, (curl_off_t)recvLimit);
+            changed = YES;
+        }
+        if (transfer.sendLimit != sendLimit) {
+            transfer.sendLimit = sendLimit;
+            curl_easy_setopt(transfer.easy, CURLOPT_MAX_SEND_SPEED_LARGE, (curl_off_t)sendLimit);
+            changed = YES;
+        }
+    }
+    if (changed) {
+        EMAS_LOG_DEBUG(@"EC-Manager", @"Bandwidth shaping: %lu foreground, %lu background, limit recv %lld B/s send %lld B/s",
+                       (unsigned long)foregroundCount, (unsigned long)backgroundCount, recvLimit, sendLimit);
+    }
+}
+
+// 后台传输平分前台用量与预留之外的剩余容量，前台占满时仍保留最低份额
+- (int64_t)limitForCapacity:(double)capacity foregroundRate:(double)foregroundRate transferCount:(NSUInteger)transferCount {
+    if (capacity <= 0) {
+        // 尚无样本，先不限速，首个采样周期的聚合吞吐即作为容量估计
+        return 0;
+    }
+    double spare = capacity * (1 - kEMASShaperForegroundHeadroom) - foregroundRate;
+    double budget = MAX(spare, capacity * kEMASShaperBackgroundMinimumShare);
+    return MAX((int64_t)(budget / transferCount), kEMASShaperMinimumRate);
+}
+
+@end
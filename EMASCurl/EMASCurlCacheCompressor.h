@@ -0,0 +1,72 @@
+//
+//  EMASCurlCacheCompressor.h
+//  EMASCurl
+//
+//  Created by xuyecan on 2026/10/18.
+//
+
+#import <Foundation/Foundation.h>
+#import "EMASCurlConfiguration.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ * 缓存响应体的压缩与解压，基于系统Compression框架
+ */
+@interface EMASCurlCacheCompressor : NSObject
+
+/**
+ * 按Content-Type在配置表中做最长前缀匹配，返回应使用的压缩算法
+ */
++ (EMASCurlCacheCompressionAlgorithm)algorithmForContentType:(nullable NSString *)contentType
+                                                     inTable:(nullable NSDictionary<NSString *, NSNumber *> *)table;
+
+/**
+ * 算法在缓存userInfo中的持久化名称；使用名称而非枚举值，避免枚举调整后无法识别旧条目
+ */
++ (nullable NSString *)nameForAlgorithm:(EMASCurlCacheCompressionAlgorithm)algorithm;
+
++ (EMASCurlCacheCompressionAlgorithm)algorithmForName:(nullable NSString *)name;
+
+/**
+ * 压缩数据，压缩后不小于原数据时返回nil
+ */
++ (nullable NSData *)compressData:(NSData *)data algorithm:(EMASCurlCacheCompressionAlgorithm)algorithm;
+
+/**
+ * 流式解压，每产出最多chunkSize字节就回调一次
+ *
+ * @return 数据完整解压返回YES；数据损坏或被截断返回NO，此前已回调的数据不完整
+ */
++ (BOOL)decompressData:(NSData *)data
+             algorithm:(EMASCurlCacheCompressionAlgorithm)algorithm
+             chunkSize:(NSUInteger)chunkSize
+            usingBlock:(void (^)(NSData *chunk))block;
+
+@end
+
+/**
+ * 增量解压器，每次调用产出一块数据，由调用方决定拉取节奏
+ */
+@interface EMASCurlCacheDecoder : NSObject
+
+// 数据已完整解压
+@property (nonatomic, assign, readonly) BOOL finished;
+// 数据损坏或被截断
+@property (nonatomic, assign, readonly) BOOL failed;
+
+/**
+ * 算法不支持或初始化失败时返回nil
+ */
+- (nullable instancetype)initWithData:(NSData *)data
+                            algorithm:(EMASCurlCacheCompressionAlgorithm)algorithm
+                            chunkSize:(NSUInteger)chunkSize;
+
+/**
+ * 返回下一块最多chunkSize字节的解压数据；全部产出或出错后返回nil，由finished/failed区分
+ */
+- (nullable NSData *)nextChunk;
+
+@end
+
+NS_ASSUME_NONNULL_END
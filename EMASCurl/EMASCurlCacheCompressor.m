@@ -0,0 +1,194 @@
+//
+//  EMASCurlCacheCompressor.m
+//  EMASCurl
+//
+//  Created by xuyecan on 2026/10/18.
+//
+
+#import "EMASCurlCacheCompressor.h"
+#import <compression.h>
+
+static BOOL EMASCompressionAlgorithmValue(EMASCurlCacheCompressionAlgorithm algorithm, compression_algorithm *outValue) {
+    switch (algorithm) {
+        case EMASCurlCacheCompressionLZ4:
+            *outValue = COMPRESSION_LZ4;
+            return YES;
+        case EMASCurlCacheCompressionLZFSE:
+            *outValue = COMPRESSION_LZFSE;
+            return YES;
+        case EMASCurlCacheCompressionZlib:
+            *outValue = COMPRESSION_ZLIB;
+            return YES;
+        default:
+            return NO;
+    }
+}
+
+@implementation EMASCurlCacheCompressor
+
++ (EMASCurlCacheCompressionAlgorithm)algorithmForContentType:(nullable NSString *)contentType
+                                                     inTable:(nullable NSDictionary<NSString *, NSNumber *> *)table {
+    if (contentType.length == 0 || table.count == 0) {
+        return EMASCurlCacheCompressionNone;
+    }
+
+    // 去掉charset等参数，只比较媒体类型
+    NSString *mediaType = [[contentType componentsSeparatedByString:@";"] firstObject];
+    mediaType = [[mediaType stringByTrimmingCharactersInSet:[NSCharacterSet whitespaceCharacterSet]] lowercaseString];
+
+    NSString *matchedKey = nil;
+    for (NSString *key in table) {
+        if (![key isKindOfClass:[NSString class]] || key.length == 0) {
+            continue;
+        }
+        if ([mediaType hasPrefix:key.lowercaseString] && key.length > matchedKey.length) {
+            matchedKey = key;
+        }
+    }
+
+    id value = matchedKey ? table[matchedKey] : nil;
+    return [value isKindOfClass:[NSNumber class]] ? [value integerValue] : EMASCurlCacheCompressionNone;
+}
+
++ (nullable NSString *)nameForAlgorithm:(EMASCurlCacheCompressionAlgorithm)algorithm {
+    switch (algorithm) {
+        case EMASCurlCacheCompressionLZ4:
+            return @"lz4";
+        case EMASCurlCacheCompressionLZFSE:
+            return @"lzfse";
+        case EMASCurlCacheCompressionZlib:
+            return @"zlib";
+        default:
+            return nil;
+    }
+}
+
++ (EMASCurlCacheCompressionAlgorithm)algorithmForName:(nullable NSString *)name {
+    if ([name isEqualToString:@"lz4"]) {
+        return EMASCurlCacheCompressionLZ4;
+    }
+    if ([name isEqualToString:@"lzfse"]) {
+        return EMASCurlCacheCompressionLZFSE;
+    }
+    if ([name isEqualToString:@"zlib"]) {
+        return EMASCurlCacheCompressionZlib;
+    }
+    return EMASCurlCacheCompressionNone;
+}
+
++ (nullable NSData *)compressData:(NSData *)data algorithm:(EMASCurlCacheCompressionAlgorithm)algorithm {
+    compression_algorithm value;
+    if (data.length == 0 || !EMASCompressionAlgorithmValue(algorithm, &value)) {
+        return nil;
+    }
+
+    // 目标缓冲区与原数据等长：放不下时encode返回0，说明压缩没有收益
+    size_t capacity = data.length;
+    uint8_t *buffer = malloc(capacity);
+    if (!buffer) {
+        return nil;
+    }
+    size_t written = compression_encode_buffer(buffer, capacity, data.bytes, data.length, NULL, value);
+    if (written == 0) {
+        free(buffer);
+        return nil;
+    }
+
+    uint8_t *shrunk = realloc(buffer, written);
+    if (shrunk) {
+        buffer = shrunk;
+    }
+    return [NSData dataWithBytesNoCopy:buffer length:written freeWhenDone:YES];
+}
+
++ (BOOL)decompressData:(NSData *)data
+             algorithm:(EMASCurlCacheCompressionAlgorithm)algorithm
+             chunkSize:(NSUInteger)chunkSize
+            usingBlock:(void (^)(NSData *chunk))block {
+    EMASCurlCacheDecoder *decoder = [[EMASCurlCacheDecoder alloc] initWithData:data algorithm:algorithm chunkSize:chunkSize];
+    if (!decoder) {
+        return NO;
+    }
+
+    NSData *chunk = nil;
+    while ((chunk = [decoder nextChunk])) {
+        block(chunk);
+    }
+    return decoder.finished;
+}
+
+@end
+
+@implementation EMASCurlCacheDecoder {
+    NSData *_data;
+    compression_stream _stream;
+    uint8_t *_buffer;
+    size_t _bufferSize;
+}
+
+- (nullable instancetype)initWithData:(NSData *)data
+                            algorithm:(EMASCurlCacheCompressionAlgorithm)algorithm
+                            chunkSize:(NSUInteger)chunkSize {
+    compression_algorithm value;
+    if (!EMASCompressionAlgorithmValue(algorithm, &value)) {
+        return nil;
+    }
+
+    self = [super init];
+    if (self) {
+        if (compression_stream_init(&_stream, COMPRESSION_STREAM_DECODE, value) != COMPRESSION_STATUS_OK) {
+            return nil;
+        }
+        _bufferSize = MAX(chunkSize, (NSUInteger)4096);
+        _buffer = malloc(_bufferSize);
+        if (!_buffer) {
+            compression_stream_destroy(&_stream);
+            return nil;
+        }
+
+        // 持有源数据，保证解压期间src_ptr有效
+        _data = data;
+        _stream.src_ptr = data.bytes;
+        _stream.src_size = data.length;
+    }
+    return self;
+}
+
+- (void)dealloc {
+    if (_buffer) {
+        free(_buffer);
+        compression_stream_destroy(&_stream);
+    }
+}
+
+- (nullable NSData *)nextChunk {
+    if (_finished || _failed) {
+        return nil;
+    }
+
+    _stream.dst_ptr = _buffer;
+    _stream.dst_size = _bufferSize;
+    compression_status status = compression_stream_process(&_stream, COMPRESSION_STREAM_FINALIZE);
+    if (status == COMPRESSION_STATUS_ERROR) {
+        _failed = YES;
+        return nil;
+    }
+
+    size_t produced = _bufferSize - _stream.dst_size;
+    if (status == COMPRESSION_STATUS_END) {
+        _finished = YES;
+    } else if (produced < _bufferSize && _stream.src_size == 0) {
+        // 输出缓冲区未写满却没有结束，说明输入已耗尽，数据被截断
+        _failed = YES;
+    }
+
+    if (produced == 0) {
+        if (!_finished) {
+            _failed = YES;
+        }
+        return nil;
+    }
+    return [NSData dataWithBytes:_buffer length:produced];
+}
+
+@end
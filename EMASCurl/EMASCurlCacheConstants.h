@@ -26,6 +26,10 @@
 #define EMASHTTPHeaderLastModified @"Last-Modified"
 #define EMASHTTPHeaderAge @"Age"
 #define EMASHTTPHeaderVary @"Vary"
+#define EMASHTTPHeaderRange @"Range"
+#define EMASHTTPHeaderContentRange @"Content-Range"
+#define EMASHTTPHeaderIfRange @"If-Range"
+#define EMASHTTPHeaderContentEncoding @"Content-Encoding"
 
 #define EMASCacheControlNoCache @"no-cache"
 #define EMASCacheControlNoStore @"no-store"
@@ -42,5 +46,14 @@
 #define EMASUserInfoKeyOriginalStatusCode @"EMASUserInfoKeyOriginalStatusCode"
 #define EMASUserInfoKeyVaryHeader @"EMASUserInfoKeyVaryHeader"
 #define EMASUserInfoKeyVaryValues @"EMASUserInfoKeyVaryValues"
+// 稀疏缓存条目：已缓存区间列表 [[offset, length], ...] 与资源总长度
+#define EMASUserInfoKeySparseRanges @"EMASUserInfoKeySparseRanges"
+#define EMASUserInfoKeySparseTotalLength @"EMASUserInfoKeySparseTotalLength"
+// 压缩存储的响应体：压缩算法名称与解压后长度
+#define EMASUserInfoKeyBodyCompression @"EMASUserInfoKeyBodyCompression"
+#define EMASUserInfoKeyBodyOriginalLength @"EMASUserInfoKeyBodyOriginalLength"
+// 存放在独立文件中的响应体：文件名与文件长度（即存储长度，可能是压缩后的）
+#define EMASUserInfoKeyBodyFile @"EMASUserInfoKeyBodyFile"
+#define EMASUserInfoKeyBodyStoredLength @"EMASUserInfoKeyBodyStoredLength"
 
 #endif /* EMASCurlCacheConstants_h */
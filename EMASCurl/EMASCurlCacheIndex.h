@@ -0,0 +1,92 @@
+//
+//  EMASCurlCacheIndex.h
+//  EMASCurl
+//
+//  Created by xuyecan on 2026/10/18.
+//
+
+#import <Foundation/Foundation.h>
+#import "EMASCurlConfiguration.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ * 一次缓存写入适用的淘汰策略与配额，由请求所用的配置生成
+ */
+@interface EMASCurlCacheQuotaPolicy : NSObject
+
+// 配额分区，同一分区的条目共享partitionByteQuota，通常对应一个配置ID
+@property (nonatomic, copy, readonly) NSString *partition;
+@property (nonatomic, assign, readonly) EMASCurlCacheEvictionPolicy evictionPolicy;
+@property (nonatomic, assign, readonly) NSUInteger partitionByteQuota;
+@property (nonatomic, assign, readonly) NSUInteger hostByteQuota;
+@property (nonatomic, copy, readonly, nullable) NSDictionary<NSString *, NSNumber *> *hostByteQuotaOverrides;
+
+/**
+ * 从配置生成，配置未启用淘汰策略时返回nil
+ */
++ (nullable instancetype)policyWithConfiguration:(EMASCurlConfiguration *)configuration partition:(NSString *)partition;
+
+- (instancetype)initWithPartition:(NSString *)partition
+                   evictionPolicy:(EMASCurlCacheEvictionPolicy)evictionPolicy
+               partitionByteQuota:(NSUInteger)partitionByteQuota
+                    hostByteQuota:(NSUInteger)hostByteQuota
+           hostByteQuotaOverrides:(nullable NSDictionary<NSString *, NSNumber *> *)hostByteQuotaOverrides;
+
+/**
+ * host适用的字节上限，0表示不限制
+ */
+- (NSUInteger)byteQuotaForHost:(NSString *)host;
+
+@end
+
+/**
+ * 记录经由EMASCurl写入NSURLCache的条目，并按策略与配额决定淘汰哪些条目。
+ * NSURLCache自身的淘汰对我们不透明，这里在其之上主动移除条目，使各host、各配置的占用保持在配额内。
+ * 条目以缓存键URL字符串标识。非线程安全，由EMASCurlResponseCache在其串行队列中调用。
+ */
+@interface EMASCurlCacheIndex : NSObject
+
+/**
+ * 从writeToFile:写入的文件恢复条目、访问顺序与GDSF膨胀值，频率草图按各条目的访问次数重建。
+ * 文件不存在或格式不符时返回空索引；命中与淘汰统计不持久化
+ */
++ (instancetype)indexWithContentsOfFile:(NSString *)path;
+
+// 以JSON原子写入文件
+- (BOOL)writeToFile:(NSString *)path;
+
+/**
+ * 记录一次缓存查询。已记录的条目会刷新访问时间与频率
+ */
+- (void)recordLookupForKey:(NSString *)key hit:(BOOL)hit;
+
+/**
+ * 记录一次写入，返回为满足配额需要淘汰的key。
+ * 返回值可能包含刚写入的key，表示该条目未获准入或自身超过配额。
+ */
+- (NSArray<NSString *> *)recordStoreForKey:(NSString *)key
+                                      host:(NSString *)host
+                                     bytes:(NSUInteger)bytes
+                               quotaPolicy:(EMASCurlCacheQuotaPolicy *)quotaPolicy;
+
+/**
+ * 条目已不在缓存中（被主动移除或被NSURLCache淘汰）
+ */
+- (void)removeKey:(NSString *)key;
+
+/**
+ * 缓存已被清空，停止跟踪所有条目；命中与淘汰统计保留
+ */
+- (void)removeAllKeys;
+
+- (BOOL)containsKey:(NSString *)key;
+
+// 当前跟踪的所有条目
+- (NSArray<NSString *> *)allKeys;
+
+- (EMASCurlCacheStatistics *)statistics;
+
+@end
+
+NS_ASSUME_NONNULL_END
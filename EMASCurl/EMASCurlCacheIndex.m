@@ -0,0 +1,535 @@
+//
+//  EMASCurlCacheIndex.m
+//  EMASCurl
+//
+//  Created by xuyecan on 2026/10/18.
+//
+
+#import "EMASCurlCacheIndex.h"
+#import "EMASCurlLogger.h"
+
+NSString * const EMASCurlCacheEvictionReasonHostQuota = @"hostQuota";
+NSString * const EMASCurlCacheEvictionReasonConfigurationQuota = @"configurationQuota";
+NSString * const EMASCurlCacheEvictionReasonAdmissionRejected = @"admissionRejected";
+
+// 频率草图每行计数器个数（2的幂），4行共占用16KB
+static const NSUInteger kEMASSketchWidth = 4096;
+static const NSUInteger kEMASSketchDepth = 4;
+// 计数器为4位饱和计数
+static const uint8_t kEMASSketchMaxCount = 15;
+
+// W-TinyLFU的LRU窗口占配额的比例
+static const NSUInteger kEMASTinyLFUWindowPercent = 1;
+
+// GDSF优先级中频率/体积项的缩放，使KB级体积的条目优先级落在便于比较的量级
+static const double kEMASGDSFCostScale = 1024.0;
+
+// 持久化文件格式版本，不一致时丢弃旧文件
+static const NSInteger kEMASCacheIndexFileVersion = 1;
+
+#pragma mark - EMASCurlCacheQuotaPolicy
+
+@implementation EMASCurlCacheQuotaPolicy
+
++ (nullable instancetype)policyWithConfiguration:(EMASCurlConfiguration *)configuration partition:(NSString *)partition {
+    if (configuration.cacheEvictionPolicy == EMASCurlCacheEvictionPolicyNone) {
+        return nil;
+    }
+    return [[self alloc] initWithPartition:partition
+                            evictionPolicy:configuration.cacheEvictionPolicy
+                        partitionByteQuota:configuration.cacheByteQuota
+                             hostByteQuota:configuration.cacheHostByteQuota
+                    hostByteQuotaOverrides:configuration.cacheHostByteQuotaOverrides];
+}
+
+- (instancetype)initWithPartition:(NSString *)partition
+                   evictionPolicy:(EMASCurlCacheEvictionPolicy)evictionPolicy
+               partitionByteQuota:(NSUInteger)partitionByteQuota
+                    hostByteQuota:(NSUInteger)hostByteQuota
+           hostByteQuotaOverrides:(nullable NSDictionary<NSString *, NSNumber *> *)hostByteQuotaOverrides {
+    self = [super init];
+    if (self) {
+        _partition = [partition copy];
+        _evictionPolicy = evictionPolicy;
+        _partitionByteQuota = partitionByteQuota;
+        _hostByteQuota = hostByteQuota;
+        _hostByteQuotaOverrides = [hostByteQuotaOverrides copy];
+    }
+    return self;
+}
+
+- (NSUInteger)byteQuotaForHost:(NSString *)host {
+    NSNumber *override = self.hostByteQuotaOverrides[host.lowercaseString];
+    if ([override isKindOfClass:[NSNumber class]]) {
+        return override.unsignedIntegerValue;
+    }
+    return self.hostByteQuota;
+}
+
+@end
+
+#pragma mark - EMASCurlFrequencySketch
+
+// Count-Min草图，估计key的近期访问频率；计数总量达到阈值时全部减半，使频率随时间衰减
+@interface EMASCurlFrequencySketch : NSObject
+
+- (void)increment:(NSString *)key;
+
+- (NSUInteger)frequency:(NSString *)key;
+
+@end
+
+@implementation EMASCurlFrequencySketch {
+    uint8_t _table[kEMASSketchDepth * kEMASSketchWidth];
+    NSUInteger _additions;
+}
+
+static uint64_t EMASSketchHash(NSString *key) {
+    // FNV-1a，NSString的hash对长URL只取部分字符，区分度不足
+    uint64_t hash = 14695981039346656037ULL;
+    const char *bytes = key.UTF8String;
+    if (!bytes) {
+        return hash;
+    }
+    for (; *bytes; bytes++) {
+        hash ^= (uint8_t)*bytes;
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+static inline NSUInteger EMASSketchIndex(uint64_t hash, NSUInteger row) {
+    uint64_t h1 = hash;
+    uint64_t h2 = (hash >> 32) | 1;
+    return row * kEMASSketchWidth + (NSUInteger)((h1 + row * h2) & (kEMASSketchWidth - 1));
+}
+
+- (void)increment:(NSString *)key {
+    uint64_t hash = EMASSketchHash(key);
+    for (NSUInteger row = 0; row < kEMASSketchDepth; row++) {
+        NSUInteger index = EMASSketchIndex(hash, row);
+        if (_table[index] < kEMASSketchMaxCount) {
+            _table[index]++;
+        }
+    }
+
+    _additions++;
+    if (_additions >= 10 * kEMASSketchWidth) {
+        for (NSUInteger i = 0; i < kEMASSketchDepth * kEMASSketchWidth; i++) {
+            _table[i] >>= 1;
+        }
+        _additions /= 2;
+    }
+}
+
+- (NSUInteger)frequency:(NSString *)key {
+    uint64_t hash = EMASSketchHash(key);
+    NSUInteger frequency = kEMASSketchMaxCount;
+    for (NSUInteger row = 0; row < kEMASSketchDepth; row++) {
+        frequency = MIN(frequency, (NSUInteger)_table[EMASSketchIndex(hash, row)]);
+    }
+    return frequency;
+}
+
+@end
+
+#pragma mark - EMASCurlCacheIndexEntry
+
+@interface EMASCurlCacheIndexEntry : NSObject
+
+@property (nonatomic, copy) NSString *key;
+@property (nonatomic, copy) NSString *host;
+@property (nonatomic, copy) NSString *partition;
+@property (nonatomic, assign) NSUInteger bytes;
+@property (nonatomic, assign) uint64_t lastAccessTick;
+@property (nonatomic, assign) NSUInteger frequency;
+// GDSF优先级 H = L + frequency * cost / size
+@property (nonatomic, assign) double priority;
+// W-TinyLFU：仍在LRU窗口中
+@property (nonatomic, assign) BOOL inWindow;
+// W-TinyLFU：已离开窗口，等待与主区淘汰候选比较
+@property (nonatomic, assign) BOOL pendingAdmission;
+
+@end
+
+@implementation EMASCurlCacheIndexEntry
+@end
+
+#pragma mark - EMASCurlCachePartition
+
+@interface EMASCurlCachePartition : NSObject
+
+@property (nonatomic, strong) NSMutableDictionary<NSString *, EMASCurlCacheIndexEntry *> *entries;
+@property (nonatomic, strong) NSMutableDictionary<NSString *, NSNumber *> *bytesByHost;
+@property (nonatomic, assign) NSUInteger totalBytes;
+@property (nonatomic, assign) NSUInteger windowBytes;
+// GDSF膨胀值L：最近一次淘汰条目的优先级，使长期未访问的旧条目逐渐失去优势
+@property (nonatomic, assign) double inflation;
+
+@end
+
+@implementation EMASCurlCachePartition
+
+- (instancetype)init {
+    self = [super init];
+    if (self) {
+        _entries = [NSMutableDictionary dictionary];
+        _bytesByHost = [NSMutableDictionary dictionary];
+    }
+    return self;
+}
+
+- (NSUInteger)bytesForHost:(NSString *)host {
+    return [self.bytesByHost[host] unsignedIntegerValue];
+}
+
+- (void)addEntry:(EMASCurlCacheIndexEntry *)entry {
+    self.entries[entry.key] = entry;
+    self.totalBytes += entry.bytes;
+    self.bytesByHost[entry.host] = @([self bytesForHost:entry.host] + entry.bytes);
+    if (entry.inWindow) {
+        self.windowBytes += entry.bytes;
+    }
+}
+
+- (void)removeEntry:(EMASCurlCacheIndexEntry *)entry {
+    [self.entries removeObjectForKey:entry.key];
+    self.totalBytes -= MIN(self.totalBytes, entry.bytes);
+    NSUInteger hostBytes = [self bytesForHost:entry.host];
+    if (hostBytes > entry.bytes) {
+        self.bytesByHost[entry.host] = @(hostBytes - entry.bytes);
+    } else {
+        [self.bytesByHost removeObjectForKey:entry.host];
+    }
+    if (entry.inWindow) {
+        self.windowBytes -= MIN(self.windowBytes, entry.bytes);
+    }
+}
+
+@end
+
+#pragma mark - EMASCurlCacheIndex
+
+@interface EMASCurlCacheIndex ()
+
+@property (nonatomic, strong) NSMutableDictionary<NSString *, EMASCurlCachePartition *> *partitions;
+@property (nonatomic, strong) NSMutableDictionary<NSString *, EMASCurlCacheIndexEntry *> *entriesByKey;
+@property (nonatomic, strong) EMASCurlFrequencySketch *sketch;
+@property (nonatomic, assign) uint64_t tick;
+@property (nonatomic, assign) NSUInteger hitCount;
+@property (nonatomic, assign) NSUInteger missCount;
+@property (nonatomic, strong) NSMutableDictionary<NSString *, NSNumber *> *evictionCounts;
+
+@end
+
+@implementation EMASCurlCacheIndex
+
+- (instancetype)init {
+    self = [super init];
+    if (self) {
+        _partitions = [NSMutableDictionary dictionary];
+        _entriesByKey = [NSMutableDictionary dictionary];
+        _sketch = [EMASCurlFrequencySketch new];
+        _evictionCounts = [NSMutableDictionary dictionary];
+    }
+    return self;
+}
+
++ (instancetype)indexWithContentsOfFile:(NSString *)path {
+    EMASCurlCacheIndex *index = [EMASCurlCacheIndex new];
+
+    NSData *data = [NSData dataWithContentsOfFile:path];
+    NSDictionary *json = data ? [NSJSONSerialization JSONObjectWithData:data options:0 error:nil] : nil;
+    if (![json isKindOfClass:[NSDictionary class]] || [json[@"version"] integerValue] != kEMASCacheIndexFileVersion) {
+        return index;
+    }
+
+    index.tick = [json[@"tick"] unsignedLongLongValue];
+    NSDictionary *inflations = json[@"inflations"];
+    NSArray *entries = json[@"entries"];
+    if (![inflations isKindOfClass:[NSDictionary class]] || ![entries isKindOfClass:[NSArray class]]) {
+        return index;
+    }
+
+    for (NSDictionary *item in entries) {
+        if (![item isKindOfClass:[NSDictionary class]]) {
+            continue;
+        }
+        NSString *key = item[@"key"];
+        NSString *host = item[@"host"];
+        NSString *partitionName = item[@"partition"];
+        if (![key isKindOfClass:[NSString class]] || ![host isKindOfClass:[NSString class]] ||
+            ![partitionName isKindOfClass:[NSString class]] || index.entriesByKey[key]) {
+            continue;
+        }
+
+        EMASCurlCachePartition *partition = index.partitions[partitionName];
+        if (!partition) {
+            partition = [EMASCurlCachePartition new];
+            id inflation = inflations[partitionName];
+            partition.inflation = [inflation isKindOfClass:[NSNumber class]] ? [inflation doubleValue] : 0;
+            index.partitions[partitionName] = partition;
+        }
+
+        EMASCurlCacheIndexEntry *entry = [EMASCurlCacheIndexEntry new];
+        entry.key = key;
+        entry.host = host;
+        entry.partition = partitionName;
+        entry.bytes = [item[@"bytes"] unsignedIntegerValue];
+        entry.lastAccessTick = [item[@"lastAccessTick"] unsignedLongLongValue];
+        entry.frequency = [item[@"frequency"] unsignedIntegerValue];
+        entry.priority = [item[@"priority"] doubleValue];
+        entry.inWindow = [item[@"inWindow"] boolValue];
+        entry.pendingAdmission = [item[@"pendingAdmission"] boolValue];
+        [partition addEntry:entry];
+        index.entriesByKey[key] = entry;
+        index.tick = MAX(index.tick, entry.lastAccessTick);
+
+        // 频率草图不持久化，按条目的访问次数重建，使上次运行的热条目仍能通过准入比较
+        for (NSUInteger i = 0; i < MIN(entry.frequency, (NSUInteger)kEMASSketchMaxCount); i++) {
+            [index.sketch increment:key];
+        }
+    }
+    return index;
+}
+
+- (BOOL)writeToFile:(NSString *)path {
+    NSMutableDictionary<NSString *, NSNumber *> *inflations = [NSMutableDictionary dictionary];
+    [self.partitions enumerateKeysAndObjectsUsingBlock:^(NSString *name, EMASCurlCachePartition *partition, BOOL *stop) {
+        inflations[name] = @(partition.inflation);
+    }];
+    NSMutableArray<NSDictionary *> *entries = [NSMutableArray arrayWithCapacity:self.entriesByKey.count];
+    for (EMASCurlCacheIndexEntry *entry in self.entriesByKey.objectEnumerator) {
+        [entries addObject:@{@"key": entry.key,
+                             @"host": entry.host,
+                             @"partition": entry.partition,
+                             @"bytes": @(entry.bytes),
+                             @"lastAccessTick": @(entry.lastAccessTick),
+                             @"frequency": @(entry.frequency),
+                             @"priority": @(entry.priority),
+                             @"inWindow": @(entry.inWindow),
+                             @"pendingAdmission": @(entry.pendingAdmission)}];
+    }
+    NSDictionary *json = @{@"version": @(kEMASCacheIndexFileVersion),
+                           @"tick": @(self.tick),
+                           @"inflations": inflations,
+                           @"entries": entries};
+
+    NSError *error = nil;
+    NSData *data = [NSJSONSerialization dataWithJSONObject:json options:0 error:&error];
+    if (!data || ![data writeToFile:path options:NSDataWritingAtomic error:&error]) {
+        EMAS_LOG_ERROR(@"EC-Cache", @"Failed to persist cache index: %@", error.localizedDescription);
+        return NO;
+    }
+    return YES;
+}
+
+- (void)recordLookupForKey:(NSString *)key hit:(BOOL)hit {
+    if (hit) {
+        self.hitCount += 1;
+    } else {
+        self.missCount += 1;
+    }
+    // 未命中同样计入频率，W-TinyLFU需要知道被反复请求但尚未缓存的key
+    [self.sketch increment:key];
+
+    EMASCurlCacheIndexEntry *entry = self.entriesByKey[key];
+    if (!entry) {
+        return;
+    }
+    entry.lastAccessTick = ++self.tick;
+    entry.frequency += 1;
+    EMASCurlCachePartition *partition = self.partitions[entry.partition];
+    entry.priority = partition.inflation + entry.frequency * kEMASGDSFCostScale / (double)MAX(entry.bytes, (NSUInteger)1);
+}
+
+- (NSArray<NSString *> *)recordStoreForKey:(NSString *)key
+                                      host:(NSString *)host
+                                     bytes:(NSUInteger)bytes
+                               quotaPolicy:(EMASCurlCacheQuotaPolicy *)quotaPolicy {
+    host = host.lowercaseString ?: @"";
+    NSUInteger previousFrequency = 0;
+    EMASCurlCacheIndexEntry *existing = self.entriesByKey[key];
+    if (existing) {
+        previousFrequency = existing.frequency;
+        [self removeKey:key];
+    }
+
+    EMASCurlCachePartition *partition = self.partitions[quotaPolicy.partition];
+    if (!partition) {
+        partition = [EMASCurlCachePartition new];
+        self.partitions[quotaPolicy.partition] = partition;
+    }
+
+    EMASCurlCacheIndexEntry *entry = [EMASCurlCacheIndexEntry new];
+    entry.key = key;
+    entry.host = host;
+    entry.partition = quotaPolicy.partition;
+    entry.bytes = bytes;
+    entry.lastAccessTick = ++self.tick;
+    entry.frequency = previousFrequency + 1;
+    entry.priority = partition.inflation + entry.frequency * kEMASGDSFCostScale / (double)MAX(bytes, (NSUInteger)1);
+    entry.inWindow = quotaPolicy.evictionPolicy == EMASCurlCacheEvictionPolicyTinyLFU;
+    [partition addEntry:entry];
+    self.entriesByKey[key] = entry;
+    [self.sketch increment:key];
+
+    NSMutableArray<NSString *> *evictedKeys = [NSMutableArray array];
+    NSUInteger hostQuota = [quotaPolicy byteQuotaForHost:host];
+    NSUInteger partitionQuota = quotaPolicy.partitionByteQuota;
+    if (hostQuota == 0 && partitionQuota == 0) {
+        return evictedKeys;
+    }
+
+    if (quotaPolicy.evictionPolicy == EMASCurlCacheEvictionPolicyTinyLFU) {
+        [self shrinkWindowOfPartition:partition capacity:(partitionQuota ?: hostQuota) * kEMASTinyLFUWindowPercent / 100];
+    }
+
+    while (hostQuota > 0 && [partition bytesForHost:host] > hostQuota) {
+        NSString *reason = EMASCurlCacheEvictionReasonHostQuota;
+        EMASCurlCacheIndexEntry *victim = [self victimInPartition:partition host:host policy:quotaPolicy.evictionPolicy reason:&reason];
+        if (!victim) {
+            break;
+        }
+        [self evictEntry:victim fromPartition:partition reason:reason];
+        [evictedKeys addObject:victim.key];
+    }
+
+    while (partitionQuota > 0 && partition.totalBytes > partitionQuota) {
+        NSString *reason = EMASCurlCacheEvictionReasonConfigurationQuota;
+        EMASCurlCacheIndexEntry *victim = [self victimInPartition:partition host:nil policy:quotaPolicy.evictionPolicy reason:&reason];
+        if (!victim) {
+            break;
+        }
+        [self evictEntry:victim fromPartition:partition reason:reason];
+        [evictedKeys addObject:victim.key];
+    }
+
+    // 没有因配额而被比较淘汰的待准入条目直接进入主区
+    for (EMASCurlCacheIndexEntry *candidate in partition.entries.objectEnumerator) {
+        candidate.pendingAdmission = NO;
+    }
+    return evictedKeys;
+}
+
+- (void)removeKey:(NSString *)key {
+    EMASCurlCacheIndexEntry *entry = self.entriesByKey[key];
+    if (!entry) {
+        return;
+    }
+    [self.partitions[entry.partition] removeEntry:entry];
+    [self.entriesByKey removeObjectForKey:key];
+}
+
+- (void)removeAllKeys {
+    for (NSString *key in self.entriesByKey.allKeys) {
+        [self removeKey:key];
+    }
+}
+
+- (BOOL)containsKey:(NSString *)key {
+    return self.entriesByKey[key] != nil;
+}
+
+- (NSArray<NSString *> *)allKeys {
+    return self.entriesByKey.allKeys;
+}
+
+- (EMASCurlCacheStatistics *)statistics {
+    EMASCurlCacheStatistics *statistics = [EMASCurlCacheStatistics new];
+    statistics.hitCount = self.hitCount;
+    statistics.missCount = self.missCount;
+    statistics.evictionCountsByReason = [self.evictionCounts copy];
+
+    NSMutableDictionary<NSString *, NSNumber *> *bytesByHost = [NSMutableDictionary dictionary];
+    for (EMASCurlCachePartition *partition in self.partitions.allValues) {
+        [partition.bytesByHost enumerateKeysAndObjectsUsingBlock:^(NSString *host, NSNumber *bytes, BOOL *stop) {
+            bytesByHost[host] = @([bytesByHost[host] unsignedIntegerValue] + bytes.unsignedIntegerValue);
+        }];
+    }
+    statistics.bytesByHost = bytesByHost;
+    return statistics;
+}
+
+#pragma mark - 淘汰
+
+- (void)evictEntry:(EMASCurlCacheIndexEntry *)entry fromPartition:(EMASCurlCachePartition *)partition reason:(NSString *)reason {
+    partition.inflation = MAX(partition.inflation, entry.priority);
+    [partition removeEntry:entry];
+    [self.entriesByKey removeObjectForKey:entry.key];
+    self.evictionCounts[reason] = @([self.evictionCounts[reason] unsignedIntegerValue] + 1);
+}
+
+// 窗口超出容量时，最久未访问的窗口条目离开窗口，成为待准入条目
+- (void)shrinkWindowOfPartition:(EMASCurlCachePartition *)partition capacity:(NSUInteger)capacity {
+    while (partition.windowBytes > capacity) {
+        EMASCurlCacheIndexEntry *oldest = nil;
+        for (EMASCurlCacheIndexEntry *entry in partition.entries.objectEnumerator) {
+            if (entry.inWindow && (!oldest || entry.lastAccessTick < oldest.lastAccessTick)) {
+                oldest = entry;
+            }
+        }
+        if (!oldest) {
+            break;
+        }
+        oldest.inWindow = NO;
+        oldest.pendingAdmission = YES;
+        partition.windowBytes -= MIN(partition.windowBytes, oldest.bytes);
+    }
+}
+
+// 在分区（或分区内的指定host）中按策略选出淘汰对象；条目数量在应用缓存规模下有限，这里直接线性扫描
+- (nullable EMASCurlCacheIndexEntry *)victimInPartition:(EMASCurlCachePartition *)partition
+                                                   host:(nullable NSString *)host
+                                                 policy:(EMASCurlCacheEvictionPolicy)policy
+                                                 reason:(NSString * __autoreleasing *)reason {
+    EMASCurlCacheIndexEntry *lruEntry = nil;
+    EMASCurlCacheIndexEntry *lowestPriorityEntry = nil;
+    EMASCurlCacheIndexEntry *oldestCandidate = nil;
+    EMASCurlCacheIndexEntry *oldestMain = nil;
+    EMASCurlCacheIndexEntry *oldestWindow = nil;
+
+    for (EMASCurlCacheIndexEntry *entry in partition.entries.objectEnumerator) {
+        if (host && ![entry.host isEqualToString:host]) {
+            continue;
+        }
+        if (!lruEntry || entry.lastAccessTick < lruEntry.lastAccessTick) {
+            lruEntry = entry;
+        }
+        if (!lowestPriorityEntry || entry.priority < lowestPriorityEntry.priority ||
+            (entry.priority == lowestPriorityEntry.priority && entry.lastAccessTick < lowestPriorityEntry.lastAccessTick)) {
+            lowestPriorityEntry = entry;
+        }
+        if (entry.pendingAdmission) {
+            if (!oldestCandidate || entry.lastAccessTick < oldestCandidate.lastAccessTick) {
+                oldestCandidate = entry;
+            }
+        } else if (entry.inWindow) {
+            if (!oldestWindow || entry.lastAccessTick < oldestWindow.lastAccessTick) {
+                oldestWindow = entry;
+            }
+        } else if (!oldestMain || entry.lastAccessTick < oldestMain.lastAccessTick) {
+            oldestMain = entry;
+        }
+    }
+
+    switch (policy) {
+        case EMASCurlCacheEvictionPolicyGDSF:
+            return lowestPriorityEntry;
+        case EMASCurlCacheEvictionPolicyTinyLFU:
+            if (oldestCandidate && oldestMain) {
+                // 准入过滤：离开窗口的条目只有比主区淘汰候选更常被访问时才能替换它
+                if ([self.sketch frequency:oldestCandidate.key] > [self.sketch frequency:oldestMain.key]) {
+                    oldestCandidate.pendingAdmission = NO;
+                    return oldestMain;
+                }
+                *reason = EMASCurlCacheEvictionReasonAdmissionRejected;
+                return oldestCandidate;
+            }
+            return oldestCandidate ?: oldestMain ?: oldestWindow;
+        default:
+            return lruEntry;
+    }
+}
+
+@end
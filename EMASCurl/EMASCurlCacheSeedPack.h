@@ -0,0 +1,44 @@
+//
+//  EMASCurlCacheSeedPack.h
+//  EMASCurl
+//
+//  Created by xuyecan on 2026/10/18.
+//
+
+#import <Foundation/Foundation.h>
+#import "EMASCurlConfiguration.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ * 预置缓存包：随应用分发的只读缓存条目集合，作为响应缓存的下层。
+ * 打开时只映射文件并校验文件头与索引范围，不复制任何数据；条目在首次查找时才校验（元数据解析、URL比对与响应体CRC32）。
+ * 非线程安全，由EMASCurlResponseCache在其串行队列中使用。
+ *
+ * 文件格式（小端）：
+ *   文件头32字节：magic "EMSEEDPK" | version u32 | entryCount u32 | indexOffset u64 | reserved u64
+ *   条目数据：每个条目的元数据JSON（url/status/headers/stored）与响应体依次存放
+ *   索引entryCount×40字节，按urlHash升序：urlHash u64 | metaOffset u64 | bodyOffset u64 |
+ *       metaLength u32 | bodyLength u32 | bodyCRC32 u32 | reserved u32
+ *   urlHash为URL字符串UTF-8编码的64位FNV-1a。
+ */
+@interface EMASCurlCacheSeedPack : NSObject
+
+@property (nonatomic, copy, readonly) NSString *path;
+@property (nonatomic, assign, readonly) NSUInteger entryCount;
+
+// 文件不存在或文件头/索引无效时返回nil
++ (nullable instancetype)packWithContentsOfFile:(NSString *)path;
+
+// 查找请求URL对应的条目，不存在或未通过校验时返回nil。响应体直接引用文件映射
+- (nullable NSCachedURLResponse *)cachedResponseForRequest:(NSURLRequest *)request;
+
+// 丢弃已校验条目的元数据缓存，返回释放的估计字节数；这些条目下次查找时重新校验
+- (NSUInteger)purgeValidatedMetadata;
+
+// 将条目打包写入文件，写入失败或条目无效时返回NO
++ (BOOL)writePackWithEntries:(NSArray<EMASCurlCacheSeedEntry *> *)entries toPath:(NSString *)path;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,406 @@
+//
+//  EMASCurlCacheSeedPack.m
+//  EMASCurl
+//
+//  Created by xuyecan on 2026/10/18.
+//
+
+#import "EMASCurlCacheSeedPack.h"
+#import "NSCachedURLResponse+EMASCurl.h"
+#import "EMASCurlLogger.h"
+#import <libkern/OSByteOrder.h>
+#import <zlib.h>
+
+static const char kEMASSeedPackMagic[8] = {'E', 'M', 'S', 'E', 'E', 'D', 'P', 'K'};
+static const uint32_t kEMASSeedPackVersion = 1;
+static const NSUInteger kEMASSeedPackHeaderSize = 32;
+static const NSUInteger kEMASSeedPackIndexEntrySize = 40;
+
+// 元数据JSON的键
+static NSString * const kEMASSeedMetaURL = @"url";
+static NSString * const kEMASSeedMetaStatus = @"status";
+static NSString * const kEMASSeedMetaHeaders = @"headers";
+static NSString * const kEMASSeedMetaStored = @"stored";
+
+typedef NS_ENUM(uint8_t, EMASSeedEntryState) {
+    EMASSeedEntryUnchecked = 0,
+    EMASSeedEntryValid,
+    EMASSeedEntryInvalid,
+};
+
+typedef struct {
+    uint64_t urlHash;
+    uint64_t metaOffset;
+    uint64_t bodyOffset;
+    uint32_t metaLength;
+    uint32_t bodyLength;
+    uint32_t bodyCRC32;
+} EMASSeedIndexEntry;
+
+static uint64_t EMASSeedURLHash(const char *url) {
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    for (const uint8_t *p = (const uint8_t *)url; *p; p++) {
+        hash ^= *p;
+        hash *= 0x100000001b3ULL;
+    }
+    return hash;
+}
+
+static uint64_t EMASReadLE64(const uint8_t *p) {
+    uint64_t value;
+    memcpy(&value, p, sizeof(value));
+    return OSSwapLittleToHostInt64(value);
+}
+
+static uint32_t EMASReadLE32(const uint8_t *p) {
+    uint32_t value;
+    memcpy(&value, p, sizeof(value));
+    return OSSwapLittleToHostInt32(value);
+}
+
+static void EMASAppendLE64(NSMutableData *data, uint64_t value) {
+    uint64_t le = OSSwapHostToLittleInt64(value);
+    [data appendBytes:&le length:sizeof(le)];
+}
+
+static void EMASAppendLE32(NSMutableData *data, uint32_t value) {
+    uint32_t le = OSSwapHostToLittleInt32(value);
+    [data appendBytes:&le length:sizeof(le)];
+}
+
+static int EMASCompareSeedIndexEntries(const void *a, const void *b) {
+    uint64_t ha = ((const EMASSeedIndexEntry *)a)->urlHash;
+    uint64_t hb = ((const EMASSeedIndexEntry *)b)->urlHash;
+    return ha < hb ? -1 : (ha > hb ? 1 : 0);
+}
+
+// 响应体已是解码后的原始数据，与传输相关的头不再适用
+static NSDictionary<NSString *, NSString *> *EMASSeedStorableHeaders(NSDictionary *headers, NSUInteger bodyLength) {
+    static NSSet<NSString *> *droppedHeaders;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        droppedHeaders = [NSSet setWithObjects:@"content-encoding", @"transfer-encoding", @"connection", @"content-length", nil];
+    });
+
+    NSMutableDictionary<NSString *, NSString *> *result = [NSMutableDictionary dictionary];
+    for (id key in headers) {
+        id value = headers[key];
+        if (![key isKindOfClass:[NSString class]] || ![value isKindOfClass:[NSString class]]) {
+            continue;
+        }
+        if ([droppedHeaders containsObject:[key lowercaseString]]) {
+            continue;
+        }
+        result[key] = value;
+    }
+    result[@"Content-Length"] = [NSString stringWithFormat:@"%lu", (unsigned long)bodyLength];
+    return result;
+}
+
+@implementation EMASCurlCacheSeedEntry
+
+- (instancetype)init {
+    if (self = [super init]) {
+        _statusCode = 200;
+        _body = [NSData data];
+    }
+    return self;
+}
+
++ (instancetype)entryWithURL:(NSURL *)URL
+                headerFields:(NSDictionary<NSString *, NSString *> *)headerFields
+                        body:(NSData *)body {
+    EMASCurlCacheSeedEntry *entry = [EMASCurlCacheSeedEntry new];
+    entry.URL = URL;
+    entry.headerFields = headerFields;
+    entry.body = body ?: [NSData data];
+    return entry;
+}
+
+@end
+
+@interface EMASCurlCacheSeedPack () {
+    // 每个条目的校验状态，按索引位置存放
+    uint8_t *_states;
+}
+
+@property (nonatomic, copy, readwrite) NSString *path;
+@property (nonatomic, assign, readwrite) NSUInteger entryCount;
+@property (nonatomic, strong) NSData *mappedData;
+@property (nonatomic, assign) uint64_t indexOffset;
+// 已通过校验的条目元数据，键为索引位置
+@property (nonatomic, strong) NSMutableDictionary<NSNumber *, NSDictionary *> *validatedMetadata;
+
+@end
+
+@implementation EMASCurlCacheSeedPack
+
++ (nullable instancetype)packWithContentsOfFile:(NSString *)path {
+    if (path.length == 0) {
+        return nil;
+    }
+
+    NSError *error = nil;
+    NSData *mappedData = [NSData dataWithContentsOfFile:path options:NSDataReadingMappedAlways error:&error];
+    if (!mappedData) {
+        EMAS_LOG_ERROR(@"EC-Cache", @"Failed to map cache seed pack %@: %@", path, error.localizedDescription);
+        return nil;
+    }
+
+    const uint8_t *bytes = mappedData.bytes;
+    if (mappedData.length < kEMASSeedPackHeaderSize ||
+        memcmp(bytes, kEMASSeedPackMagic, sizeof(kEMASSeedPackMagic)) != 0 ||
+        EMASReadLE32(bytes + 8) != kEMASSeedPackVersion) {
+        EMAS_LOG_ERROR(@"EC-Cache", @"Invalid cache seed pack header: %@", path);
+        return nil;
+    }
+
+    uint32_t entryCount = EMASReadLE32(bytes + 12);
+    uint64_t indexOffset = EMASReadLE64(bytes + 16);
+    uint64_t indexLength = (uint64_t)entryCount * kEMASSeedPackIndexEntrySize;
+    if (indexOffset < kEMASSeedPackHeaderSize ||
+        indexOffset > mappedData.length ||
+        indexLength > mappedData.length - indexOffset) {
+        EMAS_LOG_ERROR(@"EC-Cache", @"Cache seed pack index out of bounds: %@", path);
+        return nil;
+    }
+
+    EMASCurlCacheSeedPack *pack = [EMASCurlCacheSeedPack new];
+    pack.path = path;
+    pack.entryCount = entryCount;
+    pack.mappedData = mappedData;
+    pack.indexOffset = indexOffset;
+    pack.validatedMetadata = [NSMutableDictionary dictionary];
+    pack->_states = entryCount > 0 ? calloc(entryCount, sizeof(uint8_t)) : NULL;
+    if (entryCount > 0 && !pack->_states) {
+        return nil;
+    }
+    EMAS_LOG_INFO(@"EC-Cache", @"Opened cache seed pack %@ with %u entries", path.lastPathComponent, entryCount);
+    return pack;
+}
+
+- (void)dealloc {
+    free(_states);
+}
+
+- (EMASSeedIndexEntry)indexEntryAtPosition:(NSUInteger)position {
+    const uint8_t *p = (const uint8_t *)self.mappedData.bytes + self.indexOffset + position * kEMASSeedPackIndexEntrySize;
+    EMASSeedIndexEntry entry;
+    entry.urlHash = EMASReadLE64(p);
+    entry.metaOffset = EMASReadLE64(p + 8);
+    entry.bodyOffset = EMASReadLE64(p + 16);
+    entry.metaLength = EMASReadLE32(p + 24);
+    entry.bodyLength = EMASReadLE32(p + 28);
+    entry.bodyCRC32 = EMASReadLE32(p + 32);
+    return entry;
+}
+
+- (uint64_t)hashAtPosition:(NSUInteger)position {
+    return EMASReadLE64((const uint8_t *)self.mappedData.bytes + self.indexOffset + position * kEMASSeedPackIndexEntrySize);
+}
+
+- (nullable NSCachedURLResponse *)cachedResponseForRequest:(NSURLRequest *)request {
+    NSString *url = request.URL.absoluteString;
+    const char *urlString = url.UTF8String;
+    if (!urlString || self.entryCount == 0) {
+        return nil;
+    }
+
+    // 二分查找第一个urlHash不小于目标的位置，相同hash的条目相邻
+    uint64_t hash = EMASSeedURLHash(urlString);
+    NSUInteger low = 0;
+    NSUInteger high = self.entryCount;
+    while (low < high) {
+        NSUInteger mid = low + (high - low) / 2;
+        if ([self hashAtPosition:mid] < hash) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+
+    for (NSUInteger position = low; position < self.entryCount && [self hashAtPosition:position] == hash; position++) {
+        NSDictionary *metadata = [self validatedMetadataAtPosition:position];
+        if (metadata && [metadata[kEMASSeedMetaURL] isEqualToString:url]) {
+            return [self cachedResponseAtPosition:position metadata:metadata request:request];
+        }
+    }
+    return nil;
+}
+
+// 首次访问时校验条目，结果按位置记录，之后不再重复校验
+- (nullable NSDictionary *)validatedMetadataAtPosition:(NSUInteger)position {
+    switch (_states[position]) {
+        case EMASSeedEntryValid:
+            return self.validatedMetadata[@(position)];
+        case EMASSeedEntryInvalid:
+            return nil;
+        default:
+            break;
+    }
+
+    NSDictionary *metadata = [self metadataByValidatingEntryAtPosition:position];
+    if (metadata) {
+        _states[position] = EMASSeedEntryValid;
+        self.validatedMetadata[@(position)] = metadata;
+    } else {
+        _states[position] = EMASSeedEntryInvalid;
+        EMAS_LOG_ERROR(@"EC-Cache", @"Cache seed pack %@ entry %lu failed validation",
+                       self.path.lastPathComponent, (unsigned long)position);
+    }
+    return metadata;
+}
+
+- (NSUInteger)purgeValidatedMetadata {
+    // 以元数据JSON的长度估算解析后字典占用的内存；校验失败的条目不占内存，状态保留
+    NSUInteger releasedBytes = 0;
+    for (NSNumber *position in self.validatedMetadata) {
+        NSUInteger index = position.unsignedIntegerValue;
+        releasedBytes += [self indexEntryAtPosition:index].metaLength;
+        _states[index] = EMASSeedEntryUnchecked;
+    }
+    [self.validatedMetadata removeAllObjects];
+    return releasedBytes;
+}
+
+- (nullable NSDictionary *)metadataByValidatingEntryAtPosition:(NSUInteger)position {
+    EMASSeedIndexEntry entry = [self indexEntryAtPosition:position];
+    uint64_t length = self.mappedData.length;
+    if (entry.metaOffset > length || entry.metaLength > length - entry.metaOffset ||
+        entry.bodyOffset > length || entry.bodyLength > length - entry.bodyOffset) {
+        return nil;
+    }
+
+    const uint8_t *bytes = self.mappedData.bytes;
+    NSData *metaData = [NSData dataWithBytesNoCopy:(void *)(bytes + entry.metaOffset) length:entry.metaLength freeWhenDone:NO];
+    id metadata = [NSJSONSerialization JSONObjectWithData:metaData options:0 error:nil];
+    if (![metadata isKindOfClass:[NSDictionary class]] ||
+        ![metadata[kEMASSeedMetaURL] isKindOfClass:[NSString class]] ||
+        ![metadata[kEMASSeedMetaStatus] isKindOfClass:[NSNumber class]] ||
+        ![metadata[kEMASSeedMetaHeaders] isKindOfClass:[NSDictionary class]]) {
+        return nil;
+    }
+    for (id value in [metadata[kEMASSeedMetaHeaders] allValues]) {
+        if (![value isKindOfClass:[NSString class]]) {
+            return nil;
+        }
+    }
+
+    uLong crc = crc32(0L, Z_NULL, 0);
+    crc = crc32(crc, bytes + entry.bodyOffset, (uInt)entry.bodyLength);
+    if ((uint32_t)crc != entry.bodyCRC32) {
+        return nil;
+    }
+    return metadata;
+}
+
+- (nullable NSCachedURLResponse *)cachedResponseAtPosition:(NSUInteger)position
+                                                  metadata:(NSDictionary *)metadata
+                                                   request:(NSURLRequest *)request {
+    EMASSeedIndexEntry entry = [self indexEntryAtPosition:position];
+
+    // 响应体直接引用映射区域，数据块持有映射对象，保证其在使用期间有效
+    NSData *body = [NSData data];
+    if (entry.bodyLength > 0) {
+        NSData *mappedData = self.mappedData;
+        const uint8_t *bodyBytes = (const uint8_t *)mappedData.bytes + entry.bodyOffset;
+        body = [[NSData alloc] initWithBytesNoCopy:(void *)bodyBytes length:entry.bodyLength deallocator:^(void *bytes, NSUInteger length) {
+            (void)mappedData;
+        }];
+    }
+
+    NSHTTPURLResponse *response = [[NSHTTPURLResponse alloc] initWithURL:request.URL
+                                                              statusCode:[metadata[kEMASSeedMetaStatus] integerValue]
+                                                             HTTPVersion:@"HTTP/1.1"
+                                                            headerFields:metadata[kEMASSeedMetaHeaders]];
+    NSCachedURLResponse *cachedResponse = [NSCachedURLResponse emas_cachedResponseWithHTTPURLResponse:response
+                                                                                                 data:body
+                                                                                           requestURL:request.URL
+                                                                                          httpVersion:@"HTTP/1.1"
+                                                                                      originalRequest:request];
+    if (!cachedResponse) {
+        return nil;
+    }
+
+    // 新鲜度从打包时间起算
+    NSNumber *stored = metadata[kEMASSeedMetaStored];
+    if (![stored isKindOfClass:[NSNumber class]]) {
+        return cachedResponse;
+    }
+    NSMutableDictionary *userInfo = [cachedResponse.userInfo mutableCopy];
+    userInfo[EMASUserInfoKeyStorageTimestamp] = stored;
+    return [[NSCachedURLResponse alloc] initWithResponse:cachedResponse.response
+                                                    data:cachedResponse.data
+                                                userInfo:userInfo
+                                           storagePolicy:cachedResponse.storagePolicy];
+}
+
++ (BOOL)writePackWithEntries:(NSArray<EMASCurlCacheSeedEntry *> *)entries toPath:(NSString *)path {
+    if (path.length == 0 || entries.count > UINT32_MAX) {
+        return NO;
+    }
+
+    NSMutableData *file = [NSMutableData dataWithLength:kEMASSeedPackHeaderSize];
+    NSMutableData *indexEntries = [NSMutableData dataWithLength:entries.count * sizeof(EMASSeedIndexEntry)];
+    EMASSeedIndexEntry *index = indexEntries.mutableBytes;
+    NSNumber *stored = @([[NSDate date] timeIntervalSince1970]);
+
+    for (NSUInteger i = 0; i < entries.count; i++) {
+        EMASCurlCacheSeedEntry *entry = entries[i];
+        NSString *url = entry.URL.absoluteString;
+        NSData *body = entry.body ?: [NSData data];
+        if (url.length == 0 || body.length > UINT32_MAX) {
+            EMAS_LOG_ERROR(@"EC-Cache", @"Invalid cache seed entry at %lu", (unsigned long)i);
+            return NO;
+        }
+
+        NSDictionary *metadata = @{
+            kEMASSeedMetaURL: url,
+            kEMASSeedMetaStatus: @(entry.statusCode),
+            kEMASSeedMetaHeaders: EMASSeedStorableHeaders(entry.headerFields, body.length),
+            kEMASSeedMetaStored: stored,
+        };
+        NSData *metaData = [NSJSONSerialization dataWithJSONObject:metadata options:0 error:nil];
+        if (!metaData || metaData.length > UINT32_MAX) {
+            return NO;
+        }
+
+        index[i].urlHash = EMASSeedURLHash(url.UTF8String);
+        index[i].metaOffset = file.length;
+        index[i].metaLength = (uint32_t)metaData.length;
+        [file appendData:metaData];
+        index[i].bodyOffset = file.length;
+        index[i].bodyLength = (uint32_t)body.length;
+        uLong crc = crc32(0L, Z_NULL, 0);
+        index[i].bodyCRC32 = (uint32_t)crc32(crc, body.bytes, (uInt)body.length);
+        [file appendData:body];
+    }
+
+    qsort(index, entries.count, sizeof(EMASSeedIndexEntry), EMASCompareSeedIndexEntries);
+    uint64_t indexOffset = file.length;
+    for (NSUInteger i = 0; i < entries.count; i++) {
+        EMASAppendLE64(file, index[i].urlHash);
+        EMASAppendLE64(file, index[i].metaOffset);
+        EMASAppendLE64(file, index[i].bodyOffset);
+        EMASAppendLE32(file, index[i].metaLength);
+        EMASAppendLE32(file, index[i].bodyLength);
+        EMASAppendLE32(file, index[i].bodyCRC32);
+        EMASAppendLE32(file, 0);
+    }
+
+    NSMutableData *header = [NSMutableData dataWithBytes:kEMASSeedPackMagic length:sizeof(kEMASSeedPackMagic)];
+    EMASAppendLE32(header, kEMASSeedPackVersion);
+    EMASAppendLE32(header, (uint32_t)entries.count);
+    EMASAppendLE64(header, indexOffset);
+    EMASAppendLE64(header, 0);
+    [file replaceBytesInRange:NSMakeRange(0, kEMASSeedPackHeaderSize) withBytes:header.bytes];
+
+    NSError *error = nil;
+    if (![file writeToFile:path options:NSDataWritingAtomic error:&error]) {
+        EMAS_LOG_ERROR(@"EC-Cache", @"Failed to write cache seed pack %@: %@", path, error.localizedDescription);
+        return NO;
+    }
+    return YES;
+}
+
+@end
@@ -38,6 +38,18 @@ typedef void(^EMASCurlUploadProgressUpdateBlock)(NSURLRequest * _Nonnull request
                                          int64_t totalBytesExpectedToSend);
 
 
+/// 下载进度回调，字节数为交付给调用方的响应体字节数（已解压）
+///
+/// param @request 发起请求使用的请求实例
+/// param @bytesReceived: 自上次回调以来接收的字节数
+/// param @totalBytesReceived: 已接收的总字节数
+/// param @totalBytesExpectedToReceive: 总字节数，未知或响应经过压缩时为-1
+typedef void(^EMASCurlDownloadProgressUpdateBlock)(NSURLRequest * _Nonnull request,
+                                           int64_t bytesReceived,
+                                           int64_t totalBytesReceived,
+                                           int64_t totalBytesExpectedToReceive);
+
+
 /// 网络请求性能指标回调
 ///
 /// param @request 发起请求使用的请求实例
@@ -84,8 +96,12 @@ typedef void(^EMASCurlMetricsObserverBlock)(NSURLRequest * _Nonnull request,
 @property (nonatomic, assign) BOOL reusedConnection;
 @property (nonatomic, assign) NSInteger requestHeaderBytesSent;
 @property (nonatomic, assign) NSInteger requestBodyBytesSent;
+// 压缩前的请求体字节数，未压缩时等于requestBodyBytesSent
+@property (nonatomic, assign) NSInteger requestBodyBytesBeforeEncoding;
 @property (nonatomic, assign) NSInteger responseHeaderBytesReceived;
 @property (nonatomic, assign) NSInteger responseBodyBytesReceived;
+// 断点续传时复用的已下载字节数，不计入responseBodyBytesReceived
+@property (nonatomic, assign) NSInteger resumedResponseBodyBytes;
 @property (nonatomic, copy, nullable) NSString *localAddress;
 @property (nonatomic, assign) NSInteger localPort;
 @property (nonatomic, copy, nullable) NSString *remoteAddress;
@@ -101,6 +117,186 @@ typedef void(^EMASCurlMetricsObserverBlock)(NSURLRequest * _Nonnull request,
 @end
 
 
+/// 缓存响应体压缩统计（进程内累计值）
+@interface EMASCurlCacheCompressionStatistics : NSObject
+
+// 以压缩形式写入缓存的条目数
+@property (nonatomic, assign) NSUInteger compressedEntryCount;
+// 命中压缩规则但压缩无收益、按原样存储的条目数
+@property (nonatomic, assign) NSUInteger incompressibleEntryCount;
+// 压缩前的字节数
+@property (nonatomic, assign) unsigned long long originalBytes;
+// 压缩后实际写入缓存的字节数
+@property (nonatomic, assign) unsigned long long compressedBytes;
+// 压缩比（originalBytes / compressedBytes），无数据时为0
+@property (nonatomic, assign, readonly) double compressionRatio;
+// 命中时解压的条目数
+@property (nonatomic, assign) NSUInteger decodedEntryCount;
+// 命中时解压累计消耗的线程CPU时间，单位秒
+@property (nonatomic, assign) NSTimeInterval decodeCPUTime;
+
+@end
+
+
+/// 缓存淘汰原因
+// 单个host的占用超过cacheHostByteQuota
+FOUNDATION_EXPORT NSString * const EMASCurlCacheEvictionReasonHostQuota;
+// 同一配置的占用超过cacheByteQuota
+FOUNDATION_EXPORT NSString * const EMASCurlCacheEvictionReasonConfigurationQuota;
+// W-TinyLFU准入失败：新条目的访问频率不高于被比较的淘汰候选
+FOUNDATION_EXPORT NSString * const EMASCurlCacheEvictionReasonAdmissionRejected;
+
+/// 响应缓存统计（进程内累计值）
+@interface EMASCurlCacheStatistics : NSObject
+
+// 可缓存请求直接由缓存应答的次数
+@property (nonatomic, assign) NSUInteger hitCount;
+// 可缓存请求需要访问网络的次数（包括条件请求校验）
+@property (nonatomic, assign) NSUInteger missCount;
+// 命中率，无请求时为0
+@property (nonatomic, assign, readonly) double hitRatio;
+// 按原因统计的淘汰次数，键为EMASCurlCacheEvictionReason*
+@property (nonatomic, copy) NSDictionary<NSString *, NSNumber *> *evictionCountsByReason;
+// 各host当前由淘汰策略管理的缓存字节数
+@property (nonatomic, copy) NSDictionary<NSString *, NSNumber *> *bytesByHost;
+
+@end
+
+
+/// 按host与协议聚合的分布指标
+typedef NS_ENUM(NSInteger, EMASCurlHistogramMetric) {
+    EMASCurlHistogramMetricNameLookup = 0,  // 域名解析耗时，只统计新建连接的请求
+    EMASCurlHistogramMetricConnect,         // 建连耗时（不含域名解析），只统计新建连接的请求
+    EMASCurlHistogramMetricSecureConnection,// TLS握手耗时，只统计新建的HTTPS连接
+    EMASCurlHistogramMetricTimeToFirstByte, // 从请求开始到收到响应首字节
+    EMASCurlHistogramMetricTotal,           // 请求总耗时
+    EMASCurlHistogramMetricRequestBodyBytes,// 发送的请求体字节数
+    EMASCurlHistogramMetricResponseBodyBytes// 接收的响应体字节数
+};
+
+/// 一个指标的分布摘要。耗时单位为秒，字节数单位为字节；
+/// 取值按对数分桶近似，min/max/分位数的相对误差不超过1/16
+@interface EMASCurlHistogramSummary : NSObject
+
+@property (nonatomic, assign) NSUInteger count;
+@property (nonatomic, assign) double min;
+@property (nonatomic, assign) double max;
+@property (nonatomic, assign) double mean;
+@property (nonatomic, assign) double p50;
+@property (nonatomic, assign) double p90;
+@property (nonatomic, assign) double p99;
+
+@end
+
+/// 单个host与协议的分布快照
+@interface EMASCurlHostLatencySnapshot : NSObject
+
+@property (nonatomic, copy) NSString *host;
+// http/1.0、http/1.1、http/2或http/3，与EMASCurlTransactionMetrics.networkProtocolName一致
+@property (nonatomic, copy) NSString *protocolName;
+// 键为EMASCurlHistogramMetric，没有样本的指标不出现
+@property (nonatomic, copy) NSDictionary<NSNumber *, EMASCurlHistogramSummary *> *summaries;
+
+- (nullable EMASCurlHistogramSummary *)summaryForMetric:(EMASCurlHistogramMetric)metric;
+
+@end
+
+/// 网络质量分级，由建连RTT、下载吞吐与失败率的滑动平均得出
+typedef NS_ENUM(NSInteger, EMASCurlNetworkQuality) {
+    EMASCurlNetworkQualityUnknown = 0,      // 当前网络上的样本不足
+    EMASCurlNetworkQualityPoor,             // 如拥塞的3G、弱信号：RTT≥1s、吞吐≤20KB/s或失败率≥30%
+    EMASCurlNetworkQualityModerate,         // RTT≥300ms、吞吐≤150KB/s或失败率≥10%
+    EMASCurlNetworkQualityGood,             // RTT≥100ms或吞吐≤1.5MB/s
+    EMASCurlNetworkQualityExcellent         // 其余，如光纤Wi-Fi
+};
+
+/// 当前网络的质量估计
+@interface EMASCurlNetworkQualityEstimate : NSObject
+
+// 当前网络：wifi、cellular-2g/3g/4g/5g、cellular、none；各网络分别估计，切换网络不会沿用之前的样本
+@property (nonatomic, copy) NSString *network;
+@property (nonatomic, assign) EMASCurlNetworkQuality quality;
+// 新建连接的TCP/QUIC握手耗时的滑动平均，单位秒；没有样本时为0
+@property (nonatomic, assign) NSTimeInterval rtt;
+// 响应体下载速率的滑动平均，单位字节/秒；只统计较大的响应，没有样本时为0
+@property (nonatomic, assign) double throughput;
+// 网络错误（建连失败、超时、连接中断等）所占比例的滑动平均，取消与证书错误不计入
+@property (nonatomic, assign) double failureRate;
+@property (nonatomic, assign) NSUInteger sampleCount;
+
+@end
+
+/// 连接缓存中一条连接的快照
+@interface EMASCurlConnectionInfo : NSObject
+
+// 连接上第一个请求的host
+@property (nonatomic, copy) NSString *host;
+@property (nonatomic, copy) NSString *remoteAddress;
+@property (nonatomic, assign) NSInteger remotePort;
+@property (nonatomic, assign) NSInteger localPort;
+// http/1.0、http/1.1、http/2或http/3；连接上还没有请求完成时为nil
+@property (nonatomic, copy, nullable) NSString *protocolName;
+// 连接建立至今的时长，单位秒
+@property (nonatomic, assign) NSTimeInterval age;
+// 距上一个请求结束的时长，单位秒；有进行中的请求时为0
+@property (nonatomic, assign) NSTimeInterval idleTime;
+// 进行中的请求数，HTTP/2与HTTP/3下即并发流数
+@property (nonatomic, assign) NSUInteger activeStreams;
+// 连接上承载过的请求数（含进行中的）减1
+@property (nonatomic, assign) NSUInteger reuseCount;
+// 已结束请求累计发送、接收的字节数，含头部
+@property (nonatomic, assign) int64_t bytesSent;
+@property (nonatomic, assign) int64_t bytesReceived;
+
+@end
+
+
+/// 预置缓存包中的一个条目，用于+[EMASCurlProtocol writeCacheSeedPackWithEntries:toPath:]
+@interface EMASCurlCacheSeedEntry : NSObject
+
+@property (nonatomic, copy) NSURL *URL;
+// 默认200
+@property (nonatomic, assign) NSInteger statusCode;
+// 响应头，决定条目的新鲜度与校验方式（Cache-Control/ETag等），新鲜度从打包时间起算
+@property (nonatomic, copy, nullable) NSDictionary<NSString *, NSString *> *headerFields;
+// 未经Content-Encoding编码的响应体
+@property (nonatomic, copy) NSData *body;
+
++ (instancetype)entryWithURL:(NSURL *)URL
+                headerFields:(nullable NSDictionary<NSString *, NSString *> *)headerFields
+                        body:(NSData *)body;
+
+@end
+
+
+// 内存压力级别
+typedef NS_ENUM(NSInteger, EMASCurlMemoryPressureLevel) {
+    EMASCurlMemoryPressureNormal = 0,   // 压力解除，恢复缩减的缓存容量
+    EMASCurlMemoryPressureWarning,      // 缩减内存缓存，释放传输中的缓存缓冲
+    EMASCurlMemoryPressureCritical      // 清空内存缓存，释放缓冲，且压力解除前新请求不再缓冲响应体
+};
+
+/// 内存压力事件中释放内存的组件
+// 响应缓存自身的内存结构（预置缓存包已解析的元数据），不包括应用共享的NSURLCache
+FOUNDATION_EXPORT NSString * const EMASCurlMemoryComponentResponseCache;
+// 传输中为写入缓存而缓冲的响应体
+FOUNDATION_EXPORT NSString * const EMASCurlMemoryComponentTransferBuffers;
+
+/// 一次内存压力事件的处理结果
+@interface EMASCurlMemoryPressureEvent : NSObject
+
+@property (nonatomic, assign) EMASCurlMemoryPressureLevel level;
+// 本次事件释放的总字节数
+@property (nonatomic, assign) NSUInteger releasedBytes;
+// 按组件统计的释放字节数，键为EMASCurlMemoryComponent*
+@property (nonatomic, copy) NSDictionary<NSString *, NSNumber *> *releasedBytesByComponent;
+@property (nonatomic, strong) NSDate *date;
+
+@end
+
+typedef void(^EMASCurlMemoryPressureObserverBlock)(EMASCurlMemoryPressureEvent * _Nonnull event);
+
+
 /// 综合性能指标回调（等价于URLSessionTaskTransactionMetrics）
 typedef void(^EMASCurlTransactionMetricsObserverBlock)(NSURLRequest * _Nonnull request,
                                                       BOOL success,
@@ -116,6 +312,38 @@ typedef NS_ENUM(NSInteger, HTTPVersion) {
 };
 
 
+// 缓存响应体的落盘压缩算法，基于系统Compression框架
+typedef NS_ENUM(NSInteger, EMASCurlCacheCompressionAlgorithm) {
+    EMASCurlCacheCompressionNone = 0,   // 不压缩
+    EMASCurlCacheCompressionLZ4,        // 压缩与解压最快，压缩率最低
+    EMASCurlCacheCompressionLZFSE,      // 压缩率接近zlib，解压更快
+    EMASCurlCacheCompressionZlib        // 压缩率最高，解压开销最大
+};
+
+
+// 请求体压缩编码
+typedef NS_ENUM(NSInteger, EMASCurlRequestBodyEncoding) {
+    EMASCurlRequestBodyEncodingNone = 0,    // 不压缩
+    EMASCurlRequestBodyEncodingGzip         // gzip压缩，发送Content-Encoding: gzip
+};
+
+
+// 请求的带宽优先级
+typedef NS_ENUM(NSInteger, EMASCurlRequestPriority) {
+    EMASCurlRequestPriorityDefault = 0,     // 前台请求，不限速
+    EMASCurlRequestPriorityBackground       // 预取、日志上报等批量传输，与前台请求并存时限速，只使用剩余带宽
+};
+
+
+// 响应缓存的淘汰策略
+typedef NS_ENUM(NSInteger, EMASCurlCacheEvictionPolicy) {
+    EMASCurlCacheEvictionPolicyNone = 0,    // 不做额外淘汰，完全交由NSURLCache管理
+    EMASCurlCacheEvictionPolicyLRU,         // 淘汰最久未访问的条目
+    EMASCurlCacheEvictionPolicyTinyLFU,     // W-TinyLFU：新条目先进入LRU窗口，离开窗口时按访问频率决定是否替换主区条目
+    EMASCurlCacheEvictionPolicyGDSF         // GreedyDual-Size-Frequency：优先淘汰访问少且体积大的条目
+};
+
+
 /**
  * EMASCurl配置对象，封装所有网络设置
  * 每个NSURLSession可以拥有自己的配置实例
@@ -239,6 +467,96 @@ typedef NS_ENUM(NSInteger, HTTPVersion) {
  */
 @property (nonatomic, assign) NSUInteger maximumCacheableBodyBytes;
 
+/**
+ * 按Content-Type为缓存响应体选择落盘压缩算法，使相同的缓存容量能容纳更多响应。
+ * 键为小写的媒体类型或其前缀（如 @"application/json"、@"text/"），按最长前缀匹配；
+ * 值为EMASCurlCacheCompressionAlgorithm。
+ * 未匹配、体积过小或压缩无收益的响应按原样存储；命中时流式解压后交付给客户端。
+ * 默认值: nil (不压缩)
+ */
+@property (nonatomic, copy, nullable) NSDictionary<NSString *, NSNumber *> *cacheCompressionAlgorithms;
+
+/**
+ * 缓存淘汰策略。NSURLCache的淘汰对调用方不透明，启用后EMASCurl会记录本进程写入的条目，
+ * 并在超过下列配额时按策略主动移除条目。
+ * 默认值: EMASCurlCacheEvictionPolicyNone (不启用，下列配额不生效)
+ */
+@property (nonatomic, assign) EMASCurlCacheEvictionPolicy cacheEvictionPolicy;
+
+/**
+ * 使用此配置写入缓存的总字节上限，0表示不限制
+ * 默认值: 0
+ */
+@property (nonatomic, assign) NSUInteger cacheByteQuota;
+
+/**
+ * 单个host写入缓存的字节上限，避免某个host的大资源挤掉其他host的小响应，0表示不限制
+ * 默认值: 0
+ */
+@property (nonatomic, assign) NSUInteger cacheHostByteQuota;
+
+/**
+ * 按host单独指定的字节上限（键为小写host，值为字节数），优先于cacheHostByteQuota
+ * 默认值: nil
+ */
+@property (nonatomic, copy, nullable) NSDictionary<NSString *, NSNumber *> *cacheHostByteQuotaOverrides;
+
+
+#pragma mark - 请求体压缩
+
+/**
+ * 按host为请求体启用压缩（键为小写host，值为EMASCurlRequestBodyEncoding），
+ * 单个请求可通过+[EMASCurlProtocol setRequestBodyEncoding:forRequest:]覆盖。
+ * 压缩后以chunked方式发送，已带Content-Encoding或已知长度小于1KB的请求体不压缩；
+ * 服务端对压缩的请求体返回415后，本进程内发往该host的请求不再压缩
+ * 默认值: nil
+ */
+@property (nonatomic, copy, nullable) NSDictionary<NSString *, NSNumber *> *requestBodyEncodingByHost;
+
+#pragma mark - 进度回调
+
+/**
+ * 上传/下载进度回调的最小间隔（秒），期间的进度合并为一次回调，传输完成时总会回调最终进度
+ * 设为0且progressReportByteDelta为0时，每次读写都会回调
+ * 默认值: 0.1秒
+ */
+@property (nonatomic, assign) NSTimeInterval progressReportInterval;
+
+/**
+ * 自上次回调累计传输超过该字节数时立即回调，不受progressReportInterval限制，0表示不启用
+ * 默认值: 0
+ */
+@property (nonatomic, assign) NSUInteger progressReportByteDelta;
+
+/**
+ * 进度回调执行的队列，同一请求的回调按序执行
+ * 默认值: nil (内部串行队列)；使用内部队列时进度回调保证先于请求完成回调到达
+ */
+@property (nonatomic, strong, nullable) dispatch_queue_t progressCallbackQueue;
+
+#pragma mark - 网络质量自适应
+
+/**
+ * 按当前网络质量估计（+[EMASCurlProtocol currentNetworkQuality]）调整连接超时：
+ * 取建连RTT的8倍，不小于1秒、不大于connectTimeoutInterval的4倍；样本不足时使用connectTimeoutInterval。
+ * 请求级别的连接超时设置优先
+ * 默认值: NO
+ */
+@property (nonatomic, assign) BOOL adaptiveConnectTimeoutEnabled;
+
+/**
+ * 按网络质量限制同一host同时进行的请求数：Poor为2，Moderate为6，Good为16，Excellent与样本不足时不限制。
+ * 超出的请求在EMASCurl内部排队，前面的请求结束后按序发出
+ * 默认值: NO
+ */
+@property (nonatomic, assign) BOOL adaptiveHostConcurrencyEnabled;
+
+/**
+ * 网络质量为Poor时推迟后台优先级（EMASCurlRequestPriorityBackground）的请求：
+ * 有前台请求进行中时不发出，且同时最多一个后台请求，避免预取挤占前台请求
+ * 默认值: NO
+ */
+@property (nonatomic, assign) BOOL adaptivePrefetchGatingEnabled;
 
 #pragma mark - 性能监控
 
@@ -8,9 +8,14 @@
 #import "EMASCurlConfiguration.h"
 #import "EMASCurlResponseCache.h"
 #import "EMASCurlLogger.h"
+#import "EMASCurlRequestMatcher.h"
+#import <os/lock.h>
 
 @interface EMASCurlConfiguration () {
     dispatch_queue_t _propertyQueue;
+    // 由域名黑白名单与路径黑名单编译的匹配器，名单变化时置空
+    EMASCurlRequestMatcher *_requestMatcher;
+    os_unfair_lock _requestMatcherLock;
 }
 @end
 
@@ -22,6 +27,7 @@
     self = [super init];
     if (self) {
         _propertyQueue = dispatch_queue_create("com.emas.curl.config", DISPATCH_QUEUE_CONCURRENT);
+        _requestMatcherLock = OS_UNFAIR_LOCK_INIT;
         [self setupDefaults];
     }
     return self;
@@ -55,6 +61,24 @@
     // 缓存设置
     _cacheEnabled = YES; // Will be set to shared instance when needed
     _maximumCacheableBodyBytes = 5 * 1024 * 1024; // 5 MiB 默认阈值，防止大响应占用过多内存
+    _cacheCompressionAlgorithms = nil;
+    _cacheEvictionPolicy = EMASCurlCacheEvictionPolicyNone;
+    _cacheByteQuota = 0;
+    _cacheHostByteQuota = 0;
+    _cacheHostByteQuotaOverrides = nil;
+
+    // 请求体压缩
+    _requestBodyEncodingByHost = nil;
+
+    // 进度回调
+    _progressReportInterval = 0.1;
+    _progressReportByteDelta = 0;
+    _progressCallbackQueue = nil;
+
+    // 网络质量自适应
+    _adaptiveConnectTimeoutEnabled = NO;
+    _adaptiveHostConcurrencyEnabled = NO;
+    _adaptivePrefetchGatingEnabled = NO;
 
     // 性能监控
     _transactionMetricsObserver = nil;
@@ -67,6 +91,32 @@
     return config;
 }
 
+#pragma mark - 拦截名单
+
+- (void)setDomainWhiteList:(NSArray<NSString *> *)domainWhiteList {
+    NSArray<NSString *> *list = [domainWhiteList copy];
+    os_unfair_lock_lock(&_requestMatcherLock);
+    _domainWhiteList = list;
+    _requestMatcher = nil;
+    os_unfair_lock_unlock(&_requestMatcherLock);
+}
+
+- (void)setDomainBlackList:(NSArray<NSString *> *)domainBlackList {
+    NSArray<NSString *> *list = [domainBlackList copy];
+    os_unfair_lock_lock(&_requestMatcherLock);
+    _domainBlackList = list;
+    _requestMatcher = nil;
+    os_unfair_lock_unlock(&_requestMatcherLock);
+}
+
+- (void)setUrlPathBlackList:(NSArray<NSString *> *)urlPathBlackList {
+    NSArray<NSString *> *list = [urlPathBlackList copy];
+    os_unfair_lock_lock(&_requestMatcherLock);
+    _urlPathBlackList = list;
+    _requestMatcher = nil;
+    os_unfair_lock_unlock(&_requestMatcherLock);
+}
+
 #pragma mark - NSCopying协议
 
 - (id)copyWithZone:(NSZone *)zone {
@@ -93,8 +143,23 @@
 
     copy.cacheEnabled = self.cacheEnabled;
     copy.maximumCacheableBodyBytes = self.maximumCacheableBodyBytes;
+    copy.cacheCompressionAlgorithms = [self.cacheCompressionAlgorithms copy];
+    copy.cacheEvictionPolicy = self.cacheEvictionPolicy;
+    copy.cacheByteQuota = self.cacheByteQuota;
+    copy.cacheHostByteQuota = self.cacheHostByteQuota;
+    copy.cacheHostByteQuotaOverrides = [self.cacheHostByteQuotaOverrides copy];
     // 缓存全局管理，不属于配置
 
+    copy.requestBodyEncodingByHost = [self.requestBodyEncodingByHost copy];
+
+    copy.progressReportInterval = self.progressReportInterval;
+    copy.progressReportByteDelta = self.progressReportByteDelta;
+    copy.progressCallbackQueue = self.progressCallbackQueue;
+
+    copy.adaptiveConnectTimeoutEnabled = self.adaptiveConnectTimeoutEnabled;
+    copy.adaptiveHostConcurrencyEnabled = self.adaptiveHostConcurrencyEnabled;
+    copy.adaptivePrefetchGatingEnabled = self.adaptivePrefetchGatingEnabled;
+
     copy.transactionMetricsObserver = [self.transactionMetricsObserver copy];
 
     return copy;
@@ -137,6 +202,24 @@
 
     if (self.cacheEnabled != configuration.cacheEnabled) return NO;
     if (self.maximumCacheableBodyBytes != configuration.maximumCacheableBodyBytes) return NO;
+    if ((self.cacheCompressionAlgorithms || configuration.cacheCompressionAlgorithms) &&
+        ![self.cacheCompressionAlgorithms isEqualToDictionary:configuration.cacheCompressionAlgorithms]) return NO;
+    if (self.cacheEvictionPolicy != configuration.cacheEvictionPolicy) return NO;
+    if (self.cacheByteQuota != configuration.cacheByteQuota) return NO;
+    if (self.cacheHostByteQuota != configuration.cacheHostByteQuota) return NO;
+    if ((self.cacheHostByteQuotaOverrides || configuration.cacheHostByteQuotaOverrides) &&
+        ![self.cacheHostByteQuotaOverrides isEqualToDictionary:configuration.cacheHostByteQuotaOverrides]) return NO;
+
+    if ((self.requestBodyEncodingByHost || configuration.requestBodyEncodingByHost) &&
+        ![self.requestBodyEncodingByHost isEqualToDictionary:configuration.requestBodyEncodingByHost]) return NO;
+
+    if (self.progressReportInterval != configuration.progressReportInterval) return NO;
+    if (self.progressReportByteDelta != configuration.progressReportByteDelta) return NO;
+    if (self.progressCallbackQueue != configuration.progressCallbackQueue) return NO;
+
+    if (self.adaptiveConnectTimeoutEnabled != configuration.adaptiveConnectTimeoutEnabled) return NO;
+    if (self.adaptiveHostConcurrencyEnabled != configuration.adaptiveHostConcurrencyEnabled) return NO;
+    if (self.adaptivePrefetchGatingEnabled != configuration.adaptivePrefetchGatingEnabled) return NO;
 
     // 注意：不比较block (transactionMetricsObserver)
 
@@ -166,6 +249,14 @@
     hash ^= [self.urlPathBlackList hash];
     hash ^= self.cacheEnabled ? 32 : 0;
     hash ^= self.maximumCacheableBodyBytes;
+    hash ^= [self.cacheCompressionAlgorithms hash];
+    hash ^= self.cacheEvictionPolicy << 8;
+    hash ^= self.cacheByteQuota;
+    hash ^= self.cacheHostByteQuota;
+    hash ^= [self.cacheHostByteQuotaOverrides hash];
+    hash ^= self.adaptiveConnectTimeoutEnabled ? 64 : 0;
+    hash ^= self.adaptiveHostConcurrencyEnabled ? 128 : 0;
+    hash ^= self.adaptivePrefetchGatingEnabled ? 256 : 0;
     return hash;
 }
 
@@ -183,3 +274,20 @@
 }
 
 @end
+
+@implementation EMASCurlConfiguration (EMASRequestMatcher)
+
+- (EMASCurlRequestMatcher *)requestMatcher {
+    os_unfair_lock_lock(&_requestMatcherLock);
+    EMASCurlRequestMatcher *matcher = _requestMatcher;
+    if (!matcher) {
+        matcher = [[EMASCurlRequestMatcher alloc] initWithDomainBlackList:_domainBlackList
+                                                          domainWhiteList:_domainWhiteList
+                                                         urlPathBlackList:_urlPathBlackList];
+        _requestMatcher = matcher;
+    }
+    os_unfair_lock_unlock(&_requestMatcherLock);
+    return matcher;
+}
+
+@end
@@ -0,0 +1,35 @@
+//
+//  EMASCurlConnectionPool.h
+//  EMASCurl
+//
+//  Created by xuyecan on 2026/10/18.
+//
+
+#import <Foundation/Foundation.h>
+#import <curl/curl.h>
+#import "EMASCurlConfiguration.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+@class EMASCurlMetricsData;
+@class EMASCurlPooledTransfer;
+
+/**
+ * 跟踪libcurl连接缓存中的连接。libcurl没有枚举连接缓存的接口，这里用opensocket/closesocket回调
+ * 记录连接的建立与关闭，用prereq回调按远端地址与本地端口把每个请求关联到所用的连接。
+ * 所有方法与回调都在网络线程上执行，不加锁。
+ */
+@interface EMASCurlConnectionPool : NSObject
+
+// 在句柄加入multi前调用，设置跟踪所需的回调；返回值须在传输期间持有，结束时交给transferDidFinish:metrics:
+- (EMASCurlPooledTransfer *)attachToEasyHandle:(CURL *)easyHandle;
+
+// 传输结束，计入字节数与协议，连接的进行中请求数减1
+- (void)transferDidFinish:(nullable EMASCurlPooledTransfer *)transfer metrics:(nullable EMASCurlMetricsData *)metrics;
+
+// 当前仍打开、且至少承载过一个请求的连接，按建立时间排序
+- (NSArray<EMASCurlConnectionInfo *> *)snapshot;
+
+@end
+
+NS_ASSUME_NONNULL_END
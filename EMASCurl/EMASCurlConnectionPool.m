@@ -0,0 +1,244 @@
+//
+//  EMASCurlConnectionPool.m
+//  EMASCurl
+//
+//  Created by xuyecan on 2026/10/18.
+//
+
+#import "EMASCurlConnectionPool.h"
+#import "EMASCurlManager.h"
+#import "EMASCurlTraceRecorder.h"
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+@implementation EMASCurlConnectionInfo
+@end
+
+static NSString *EMASConnectionPoolProtocolName(long httpVersion) {
+    switch (httpVersion) {
+        case CURL_HTTP_VERSION_1_0:
+            return @"http/1.0";
+        case CURL_HTTP_VERSION_2_0:
+            return @"http/2";
+        case CURL_HTTP_VERSION_3:
+            return @"http/3";
+        default:
+            return @"http/1.1";
+    }
+}
+
+// 与libcurl的CURLINFO_PRIMARY_IP格式一致，便于在prereq回调中比对
+static NSString *EMASConnectionPoolAddressString(const struct sockaddr *address, NSInteger *port) {
+    char buffer[INET6_ADDRSTRLEN] = {0};
+    if (address->sa_family == AF_INET) {
+        const struct sockaddr_in *in4 = (const struct sockaddr_in *)address;
+        inet_ntop(AF_INET, &in4->sin_addr, buffer, sizeof(buffer));
+        *port = ntohs(in4->sin_port);
+    } else if (address->sa_family == AF_INET6) {
+        const struct sockaddr_in6 *in6 = (const struct sockaddr_in6 *)address;
+        inet_ntop(AF_INET6, &in6->sin6_addr, buffer, sizeof(buffer));
+        *port = ntohs(in6->sin6_port);
+    } else {
+        *port = 0;
+    }
+    return @(buffer);
+}
+
+@interface EMASCurlPooledConnection : NSObject
+
+@property (nonatomic, assign) curl_socket_t socket;
+@property (nonatomic, copy) NSString *remoteAddress;
+@property (nonatomic, assign) NSInteger remotePort;
+// 0表示尚未取到，连接建立后才有本地端口
+@property (nonatomic, assign) NSInteger localPort;
+@property (nonatomic, copy, nullable) NSString *host;
+@property (nonatomic, copy, nullable) NSString *protocolName;
+@property (nonatomic, assign) uint64_t createdNs;
+@property (nonatomic, assign) uint64_t lastActiveNs;
+@property (nonatomic, assign) NSUInteger activeStreams;
+@property (nonatomic, assign) NSUInteger transferCount;
+@property (nonatomic, assign) int64_t bytesSent;
+@property (nonatomic, assign) int64_t bytesReceived;
+
+@end
+
+@implementation EMASCurlPooledConnection
+@end
+
+@interface EMASCurlPooledTransfer : NSObject
+
+// 连接池随manager常驻，不会先于传输释放
+@property (nonatomic, unsafe_unretained) EMASCurlConnectionPool *pool;
+@property (nonatomic, assign) CURL *easy;
+// 当前请求所用的连接；重定向换连接时更新
+@property (nonatomic, strong, nullable) EMASCurlPooledConnection *connection;
+
+@end
+
+@implementation EMASCurlPooledTransfer
+@end
+
+@interface EMASCurlConnectionPool ()
+
+- (void)socketDidOpen:(curl_socket_t)socket address:(const struct sockaddr *)address;
+- (void)socketWillClose:(curl_socket_t)socket;
+- (void)transfer:(EMASCurlPooledTransfer *)transfer didStartWithRemoteAddress:(const char *)remoteAddress localPort:(int)localPort;
+
+@end
+
+static curl_socket_t EMASConnectionPoolOpenSocket(void *clientp, curlsocktype purpose, struct curl_sockaddr *address) {
+    curl_socket_t socketFd = socket(address->family, address->socktype, address->protocol);
+    if (socketFd != CURL_SOCKET_BAD && purpose == CURLSOCKTYPE_IPCXN) {
+        [(__bridge EMASCurlConnectionPool *)clientp socketDidOpen:socketFd address:&address->addr];
+    }
+    return socketFd;
+}
+
+static int EMASConnectionPoolCloseSocket(void *clientp, curl_socket_t item) {
+    [(__bridge EMASCurlConnectionPool *)clientp socketWillClose:item];
+    return close(item);
+}
+
+static int EMASConnectionPoolPrereq(void *clientp, char *conn_primary_ip, char *conn_local_ip, int conn_primary_port, int conn_local_port) {
+    EMASCurlPooledTransfer *transfer = (__bridge EMASCurlPooledTransfer *)clientp;
+    [transfer.pool transfer:transfer didStartWithRemoteAddress:conn_primary_ip localPort:conn_local_port];
+    return CURL_PREREQFUNC_OK;
+}
+
+@implementation EMASCurlConnectionPool {
+    NSMutableDictionary<NSNumber *, EMASCurlPooledConnection *> *_connectionsBySocket;
+}
+
+- (instancetype)init {
+    self = [super init];
+    if (self) {
+        _connectionsBySocket = [NSMutableDictionary dictionary];
+    }
+    return self;
+}
+
+- (EMASCurlPooledTransfer *)attachToEasyHandle:(CURL *)easyHandle {
+    EMASCurlPooledTransfer *transfer = [[EMASCurlPooledTransfer alloc] init];
+    transfer.pool = self;
+    transfer.easy = easyHandle;
+
+    curl_easy_setopt(easyHandle, CURLOPT_OPENSOCKETFUNCTION, EMASConnectionPoolOpenSocket);
+    curl_easy_setopt(easyHandle, CURLOPT_OPENSOCKETDATA, (__bridge void *)self);
+    curl_easy_setopt(easyHandle, CURLOPT_CLOSESOCKETFUNCTION, EMASConnectionPoolCloseSocket);
+    curl_easy_setopt(easyHandle, CURLOPT_CLOSESOCKETDATA, (__bridge void *)self);
+    curl_easy_setopt(easyHandle, CURLOPT_PREREQFUNCTION, EMASConnectionPoolPrereq);
+    curl_easy_setopt(easyHandle, CURLOPT_PREREQDATA, (__bridge void *)transfer);
+    return transfer;
+}
+
+- (void)socketDidOpen:(curl_socket_t)socket address:(const struct sockaddr *)address {
+    EMASCurlPooledConnection *connection = [[EMASCurlPooledConnection alloc] init];
+    NSInteger remotePort = 0;
+    connection.socket = socket;
+    connection.remoteAddress = EMASConnectionPoolAddressString(address, &remotePort);
+    connection.remotePort = remotePort;
+    connection.createdNs = EMASCurlTraceNow();
+    connection.lastActiveNs = connection.createdNs;
+    _connectionsBySocket[@(socket)] = connection;
+}
+
+- (void)socketWillClose:(curl_socket_t)socket {
+    [_connectionsBySocket removeObjectForKey:@(socket)];
+}
+
+- (void)transfer:(EMASCurlPooledTransfer *)transfer didStartWithRemoteAddress:(const char *)remoteAddress localPort:(int)localPort {
+    NSString *address = remoteAddress ? @(remoteAddress) : @"";
+    EMASCurlPooledConnection *matched = nil;
+    for (EMASCurlPooledConnection *connection in _connectionsBySocket.objectEnumerator) {
+        if (connection.localPort == 0) {
+            struct sockaddr_storage local;
+            socklen_t length = sizeof(local);
+            if (getsockname(connection.socket, (struct sockaddr *)&local, &length) == 0) {
+                NSInteger port = 0;
+                EMASConnectionPoolAddressString((struct sockaddr *)&local, &port);
+                connection.localPort = port;
+            }
+        }
+        if (connection.localPort == localPort && [connection.remoteAddress isEqualToString:address]) {
+            matched = connection;
+            break;
+        }
+    }
+
+    uint64_t now = EMASCurlTraceNow();
+    // 重定向时同一传输会再次发起请求，先从上一个连接上解绑
+    EMASCurlPooledConnection *previous = transfer.connection;
+    if (previous && previous.activeStreams > 0) {
+        previous.activeStreams--;
+        previous.lastActiveNs = now;
+    }
+
+    transfer.connection = matched;
+    if (!matched) {
+        return;
+    }
+    matched.activeStreams++;
+    matched.transferCount++;
+    matched.lastActiveNs = now;
+    if (!matched.host) {
+        char *url = NULL;
+        curl_easy_getinfo(transfer.easy, CURLINFO_EFFECTIVE_URL, &url);
+        matched.host = url ? [NSURL URLWithString:@(url)].host : nil;
+    }
+}
+
+- (void)transferDidFinish:(EMASCurlPooledTransfer *)transfer metrics:(EMASCurlMetricsData *)metrics {
+    EMASCurlPooledConnection *connection = transfer.connection;
+    transfer.connection = nil;
+    if (!connection) {
+        return;
+    }
+
+    if (connection.activeStreams > 0) {
+        connection.activeStreams--;
+    }
+    connection.lastActiveNs = EMASCurlTraceNow();
+    if (metrics) {
+        connection.bytesSent += metrics.requestSize + metrics.uploadBytes;
+        connection.bytesReceived += metrics.headerSize + metrics.downloadBytes;
+        if (metrics.httpVersion > 0) {
+            connection.protocolName = EMASConnectionPoolProtocolName(metrics.httpVersion);
+        }
+    }
+}
+
+- (NSArray<EMASCurlConnectionInfo *> *)snapshot {
+    uint64_t now = EMASCurlTraceNow();
+    NSMutableArray<EMASCurlPooledConnection *> *connections = [NSMutableArray array];
+    for (EMASCurlPooledConnection *connection in _connectionsBySocket.objectEnumerator) {
+        // 竞速失败或尚未发出请求的socket不算连接池中的连接
+        if (connection.transferCount > 0) {
+            [connections addObject:connection];
+        }
+    }
+    [connections sortUsingComparator:^NSComparisonResult(EMASCurlPooledConnection *a, EMASCurlPooledConnection *b) {
+        return a.createdNs < b.createdNs ? NSOrderedAscending : (a.createdNs > b.createdNs ? NSOrderedDescending : NSOrderedSame);
+    }];
+
+    NSMutableArray<EMASCurlConnectionInfo *> *snapshot = [NSMutableArray arrayWithCapacity:connections.count];
+    for (EMASCurlPooledConnection *connection in connections) {
+        EMASCurlConnectionInfo *info = [[EMASCurlConnectionInfo alloc] init];
+        info.host = connection.host ?: @"";
+        info.remoteAddress = connection.remoteAddress;
+        info.remotePort = connection.remotePort;
+        info.localPort = connection.localPort;
+        info.protocolName = connection.protocolName;
+        info.age = (now - connection.createdNs) / (double)NSEC_PER_SEC;
+        info.idleTime = connection.activeStreams > 0 ? 0 : (now - connection.lastActiveNs) / (double)NSEC_PER_SEC;
+        info.activeStreams = connection.activeStreams;
+        info.reuseCount = connection.transferCount - 1;
+        info.bytesSent = connection.bytesSent;
+        info.bytesReceived = connection.bytesReceived;
+        [snapshot addObject:info];
+    }
+    return snapshot;
+}
+
+@end
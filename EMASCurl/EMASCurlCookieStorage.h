@@ -9,6 +9,11 @@
 
 NS_ASSUME_NONNULL_BEGIN
 
+/**
+ * 内存中的cookie索引，按cookie domain分桶、按路径段组织为前缀树，每个节点预先拼接好Cookie头片段。
+ * 读写只操作内存索引；写入批量异步同步到NSHTTPCookieStorage，网络线程不会等待持久化。
+ * NSHTTPCookieStorage被外部修改时，索引会异步重建。
+ */
 @interface EMASCurlCookieStorage : NSObject
 
 + (instancetype)sharedStorage;
@@ -21,7 +26,12 @@ NS_ASSUME_NONNULL_BEGIN
 /**
  * 获取指定 URL 的 cookie 字符串
  */
-- (NSString *)cookieStringForURL:(NSURL *)url;
+- (nullable NSString *)cookieStringForURL:(NSURL *)url;
+
+/**
+ * 同步写入尚未落盘的cookie
+ */
+- (void)flushPendingCookies;
 
 @end
 
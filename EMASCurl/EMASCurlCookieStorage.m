@@ -6,6 +6,161 @@
 //
 
 #import "EMASCurlCookieStorage.h"
+#import "EMASCurlLogger.h"
+#import <os/lock.h>
+
+// 写入NSHTTPCookieStorage的合并窗口
+static const double kEMASCookiePersistDelaySec = 0.3;
+// NSHTTPCookieStorage变更后与索引比对的合并窗口
+static const double kEMASCookieReloadDelaySec = 0.1;
+
+// 路径前缀树节点，对应cookie path按"/"切分后的一段
+@interface EMASCookiePathNode : NSObject
+@property (nonatomic, strong) NSMutableDictionary<NSString *, EMASCookiePathNode *> *children;
+@property (nonatomic, strong) NSMutableArray<NSHTTPCookie *> *cookies;
+// 预先拼接好的"name=value; ..."片段，分别包含与不包含Secure cookie
+@property (nonatomic, copy, nullable) NSString *headerFragment;
+@property (nonatomic, copy, nullable) NSString *insecureHeaderFragment;
+// 最早过期时间，到期后读取时清理
+@property (nonatomic, assign) NSTimeInterval earliestExpiry;
+@end
+
+@implementation EMASCookiePathNode
+
+- (instancetype)init {
+    self = [super init];
+    if (self) {
+        _children = [NSMutableDictionary new];
+        _cookies = [NSMutableArray new];
+        _earliestExpiry = DBL_MAX;
+    }
+    return self;
+}
+
+- (void)rebuildFragments {
+    NSMutableString *all = nil;
+    NSMutableString *insecure = nil;
+    NSTimeInterval earliestExpiry = DBL_MAX;
+    for (NSHTTPCookie *cookie in self.cookies) {
+        NSString *pair = [NSString stringWithFormat:@"%@=%@", cookie.name, cookie.value];
+        if (!all) {
+            all = [pair mutableCopy];
+        } else {
+            [all appendFormat:@"; %@", pair];
+        }
+        if (!cookie.isSecure) {
+            if (!insecure) {
+                insecure = [pair mutableCopy];
+            } else {
+                [insecure appendFormat:@"; %@", pair];
+            }
+        }
+        if (cookie.expiresDate) {
+            earliestExpiry = MIN(earliestExpiry, cookie.expiresDate.timeIntervalSinceReferenceDate);
+        }
+    }
+    self.headerFragment = all;
+    self.insecureHeaderFragment = insecure;
+    self.earliestExpiry = earliestExpiry;
+}
+
+- (void)purgeExpiredCookiesAtTime:(NSTimeInterval)now {
+    if (now < self.earliestExpiry) {
+        return;
+    }
+    NSIndexSet *expired = [self.cookies indexesOfObjectsPassingTest:^BOOL(NSHTTPCookie *cookie, NSUInteger idx, BOOL *stop) {
+        return cookie.expiresDate && cookie.expiresDate.timeIntervalSinceReferenceDate <= now;
+    }];
+    [self.cookies removeObjectsAtIndexes:expired];
+    [self rebuildFragments];
+}
+
+@end
+
+// 同一cookie domain下的cookie，host-only与Domain属性写入的分开存放
+@interface EMASCookieDomainBucket : NSObject
+@property (nonatomic, strong) EMASCookiePathNode *hostOnlyRoot;
+@property (nonatomic, strong) EMASCookiePathNode *domainRoot;
+@end
+
+@implementation EMASCookieDomainBucket
+
+- (instancetype)init {
+    self = [super init];
+    if (self) {
+        _hostOnlyRoot = [EMASCookiePathNode new];
+        _domainRoot = [EMASCookiePathNode new];
+    }
+    return self;
+}
+
+@end
+
+// 待写入NSHTTPCookieStorage的一批cookie
+@interface EMASPendingCookieWrite : NSObject
+@property (nonatomic, copy) NSArray<NSHTTPCookie *> *cookies;
+@property (nonatomic, strong) NSURL *url;
+@end
+
+@implementation EMASPendingCookieWrite
+@end
+
+// "/a/b/"切分为"a"、"b"，根路径没有分段
+static NSArray<NSString *> *EMASCookiePathSegments(NSString *path) {
+    NSMutableArray<NSString *> *segments = [NSMutableArray new];
+    for (NSString *segment in [path componentsSeparatedByString:@"/"]) {
+        if (segment.length > 0 || segments.count > 0) {
+            [segments addObject:segment];
+        }
+    }
+    if (segments.count > 0 && segments.lastObject.length == 0) {
+        [segments removeLastObject];
+    }
+    return segments;
+}
+
+// 比对索引与NSHTTPCookieStorage时的cookie标识，domain与path按索引的方式归一化
+static NSString *EMASCookieIdentity(NSHTTPCookie *cookie) {
+    NSString *path = [EMASCookiePathSegments(cookie.path.length > 0 ? cookie.path : @"/") componentsJoinedByString:@"/"];
+    return [NSString stringWithFormat:@"%@\n%@\n%@", cookie.domain.lowercaseString, path, cookie.name];
+}
+
+static NSString *EMASCookieContent(NSHTTPCookie *cookie) {
+    return [NSString stringWithFormat:@"%@\n%d", cookie.value, cookie.isSecure];
+}
+
+static BOOL EMASCookieIsExpired(NSHTTPCookie *cookie, NSTimeInterval now) {
+    return cookie.expiresDate && cookie.expiresDate.timeIntervalSinceReferenceDate <= now;
+}
+
+// NSHTTPCookieStorage在properties中以"Created"记录创建时间（NSNumber或NSDate）
+static double EMASCookieCreationTime(NSHTTPCookie *cookie) {
+    id created = cookie.properties[@"Created"];
+    if ([created isKindOfClass:[NSNumber class]]) {
+        return [created doubleValue];
+    }
+    if ([created isKindOfClass:[NSDate class]]) {
+        return [created timeIntervalSinceReferenceDate];
+    }
+    return 0;
+}
+
+@interface EMASCurlCookieStorage () {
+    os_unfair_lock _lock;
+}
+
+// 以cookie domain（小写、去掉前导"."）为键，以下可变状态均由_lock保护
+@property (nonatomic, strong) NSMutableDictionary<NSString *, EMASCookieDomainBucket *> *domains;
+@property (nonatomic, strong) NSMutableArray<EMASPendingCookieWrite *> *pendingWrites;
+@property (nonatomic, assign) BOOL persistScheduled;
+@property (nonatomic, assign) BOOL reloadScheduled;
+// 已执行的索引重建次数
+@property (nonatomic, assign) NSUInteger reloadCount;
+
+@property (nonatomic, strong) dispatch_queue_t persistQueue;
+@property (nonatomic, strong) NSHTTPCookieStorage *backingStorage;
+
+@end
 
 @implementation EMASCurlCookieStorage
 
@@ -20,29 +175,311 @@
 
 - (instancetype)init {
     self = [super init];
+    if (self) {
+        _lock = OS_UNFAIR_LOCK_INIT;
+        _pendingWrites = [NSMutableArray new];
+        _persistQueue = dispatch_queue_create("com.alicloud.emascurl.cookiePersistQueue", DISPATCH_QUEUE_SERIAL);
+        _backingStorage = [NSHTTPCookieStorage sharedHTTPCookieStorage];
+        _domains = [self indexWithCookies:_backingStorage.cookies];
+
+        // App或WebView直接修改NSHTTPCookieStorage时重建内存索引；本jar自身写入引起的通知经比对后忽略
+        [[NSNotificationCenter defaultCenter] addObserver:self
+                                                 selector:@selector(backingStorageDidChange:)
+                                                     name:NSHTTPCookieManagerCookiesChangedNotification
+                                                   object:_backingStorage];
+    }
     return self;
 }
 
+- (void)dealloc {
+    [[NSNotificationCenter defaultCenter] removeObserver:self];
+}
+
 #pragma mark - Public Methods
 
 - (void)setCookieWithString:(NSString *)cookieString forURL:(NSURL *)url {
     if (!cookieString.length || !url) {
         return;
     }
+    if (self.backingStorage.cookieAcceptPolicy == NSHTTPCookieAcceptPolicyNever) {
+        return;
+    }
 
-    // 解析 Set-Cookie 字符串并设置到 NSHTTPCookieStorage
+    // 解析只涉及字符串处理，在调用线程完成；落盘交给persistQueue批量进行
     NSArray<NSHTTPCookie *> *cookies = [NSHTTPCookie cookiesWithResponseHeaderFields:@{@"Set-Cookie": cookieString} forURL:url];
-    [[NSHTTPCookieStorage sharedHTTPCookieStorage] setCookies:cookies forURL:url mainDocumentURL:nil];
+    if (cookies.count == 0) {
+        return;
+    }
+
+    EMASPendingCookieWrite *write = [EMASPendingCookieWrite new];
+    write.cookies = cookies;
+    write.url = url;
+
+    BOOL shouldSchedule = NO;
+    os_unfair_lock_lock(&_lock);
+    for (NSHTTPCookie *cookie in cookies) {
+        [self applyCookie:cookie toIndex:self.domains];
+    }
+    [self.pendingWrites addObject:write];
+    if (!self.persistScheduled) {
+        self.persistScheduled = YES;
+        shouldSchedule = YES;
+    }
+    os_unfair_lock_unlock(&_lock);
+
+    if (shouldSchedule) {
+        dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t)(kEMASCookiePersistDelaySec * NSEC_PER_SEC)), self.persistQueue, ^{
+            [self persistPendingWrites];
+        });
+    }
 }
 
 - (NSString *)cookieStringForURL:(NSURL *)url {
-    if (!url) {
+    NSString *host = url.host.lowercaseString;
+    if (host.length == 0) {
         return nil;
     }
 
-    NSArray<NSHTTPCookie *> *cookies = [[NSHTTPCookieStorage sharedHTTPCookieStorage] cookiesForURL:url];
-    NSDictionary *headers = [NSHTTPCookie requestHeaderFieldsWithCookies:cookies];
-    return headers[@"Cookie"];
+    NSString *path = url.path.length > 0 ? url.path : @"/";
+    NSArray<NSString *> *segments = EMASCookiePathSegments(path);
+    BOOL secure = [url.scheme caseInsensitiveCompare:@"https"] == NSOrderedSame;
+    NSTimeInterval now = [NSDate timeIntervalSinceReferenceDate];
+
+    // 按路径深度分组，路径更长的cookie排在前面
+    NSMutableArray<NSMutableArray<NSString *> *> *fragmentsByDepth = [NSMutableArray new];
+    for (NSUInteger i = 0; i <= segments.count; i++) {
+        [fragmentsByDepth addObject:[NSMutableArray new]];
+    }
+
+    os_unfair_lock_lock(&_lock);
+    // 依次查找host本身及其上级域名，host-only的cookie只在host本身生效
+    NSString *domain = host;
+    BOOL isHost = YES;
+    while (domain.length > 0) {
+        EMASCookieDomainBucket *bucket = self.domains[domain];
+        if (bucket) {
+            if (isHost) {
+                [self collectFragmentsFromRoot:bucket.hostOnlyRoot segments:segments secure:secure now:now into:fragmentsByDepth];
+            }
+            [self collectFragmentsFromRoot:bucket.domainRoot segments:segments secure:secure now:now into:fragmentsByDepth];
+        }
+        NSRange dot = [domain rangeOfString:@"."];
+        domain = dot.location == NSNotFound ? nil : [domain substringFromIndex:dot.location + 1];
+        isHost = NO;
+    }
+    os_unfair_lock_unlock(&_lock);
+
+    NSMutableString *header = nil;
+    for (NSArray<NSString *> *fragments in fragmentsByDepth.reverseObjectEnumerator) {
+        for (NSString *fragment in fragments) {
+            if (!header) {
+                header = [fragment mutableCopy];
+            } else {
+                [header appendFormat:@"; %@", fragment];
+            }
+        }
+    }
+    return header;
+}
+
+- (void)flushPendingCookies {
+    dispatch_sync(self.persistQueue, ^{
+        [self persistPendingWrites];
+    });
+}
+
+#pragma mark - Index
+
+- (void)collectFragmentsFromRoot:(EMASCookiePathNode *)root
+                        segments:(NSArray<NSString *> *)segments
+                          secure:(BOOL)secure
+                             now:(NSTimeInterval)now
+                            into:(NSMutableArray<NSMutableArray<NSString *> *> *)fragmentsByDepth {
+    EMASCookiePathNode *node = root;
+    NSUInteger depth = 0;
+    while (node) {
+        if (node.cookies.count > 0) {
+            [node purgeExpiredCookiesAtTime:now];
+            NSString *fragment = secure ? node.headerFragment : node.insecureHeaderFragment;
+            if (fragment) {
+                [fragmentsByDepth[depth] addObject:fragment];
+            }
+        }
+        if (depth == segments.count) {
+            break;
+        }
+        node = node.children[segments[depth]];
+        depth++;
+    }
+}
+
+// 调用方需持有_lock或独占index
+- (void)applyCookie:(NSHTTPCookie *)cookie toIndex:(NSMutableDictionary<NSString *, EMASCookieDomainBucket *> *)index {
+    NSString *domain = cookie.domain.lowercaseString;
+    BOOL hostOnly = ![domain hasPrefix:@"."];
+    if (!hostOnly) {
+        domain = [domain substringFromIndex:1];
+    }
+    if (domain.length == 0) {
+        return;
+    }
+
+    EMASCookieDomainBucket *bucket = index[domain];
+    if (!bucket) {
+        bucket = [EMASCookieDomainBucket new];
+        index[domain] = bucket;
+    }
+
+    EMASCookiePathNode *node = hostOnly ? bucket.hostOnlyRoot : bucket.domainRoot;
+    for (NSString *segment in EMASCookiePathSegments(cookie.path.length > 0 ? cookie.path : @"/")) {
+        EMASCookiePathNode *child = node.children[segment];
+        if (!child) {
+            child = [EMASCookiePathNode new];
+            node.children[segment] = child;
+        }
+        node = child;
+    }
+
+    // 同名cookie替换原有值并保持原有顺序；已过期的cookie视为删除
+    NSUInteger existing = [node.cookies indexOfObjectPassingTest:^BOOL(NSHTTPCookie *candidate, NSUInteger idx, BOOL *stop) {
+        return [candidate.name isEqualToString:cookie.name];
+    }];
+    BOOL expired = cookie.expiresDate && cookie.expiresDate.timeIntervalSinceNow <= 0;
+    if (existing != NSNotFound) {
+        if (expired) {
+            [node.cookies removeObjectAtIndex:existing];
+        } else {
+            node.cookies[existing] = cookie;
+        }
+    } else if (!expired) {
+        [node.cookies addObject:cookie];
+    }
+    [node rebuildFragments];
+}
+
+- (NSMutableDictionary<NSString *, EMASCookieDomainBucket *> *)indexWithCookies:(NSArray<NSHTTPCookie *> *)cookies {
+    NSMutableDictionary<NSString *, EMASCookieDomainBucket *> *index = [NSMutableDictionary new];
+    // 按创建时间重放，同一路径下先创建的cookie排在前面
+    NSArray<NSHTTPCookie *> *sorted = [cookies sortedArrayUsingComparator:^NSComparisonResult(NSHTTPCookie *a, NSHTTPCookie *b) {
+        double aCreated = EMASCookieCreationTime(a);
+        double bCreated = EMASCookieCreationTime(b);
+        return aCreated < bCreated ? NSOrderedAscending : (aCreated > bCreated ? NSOrderedDescending : NSOrderedSame);
+    }];
+    for (NSHTTPCookie *cookie in sorted) {
+        [self applyCookie:cookie toIndex:index];
+    }
+    return index;
+}
+
+#pragma mark - Persistence
+
+// 在persistQueue上执行
+- (void)persistPendingWrites {
+    os_unfair_lock_lock(&_lock);
+    NSArray<EMASPendingCookieWrite *> *writes = [self.pendingWrites copy];
+    [self.pendingWrites removeAllObjects];
+    self.persistScheduled = NO;
+    os_unfair_lock_unlock(&_lock);
+
+    for (EMASPendingCookieWrite *write in writes) {
+        [self.backingStorage setCookies:write.cookies forURL:write.url mainDocumentURL:nil];
+    }
+
+    if (writes.count > 0) {
+        EMAS_LOG_DEBUG(@"EC-Cookie", @"Persisted %lu cookie batches", (unsigned long)writes.count);
+    }
+}
+
+// 通知不携带变更内容，也不保证在写入线程上同步发出，无法据此判断来源；合并后统一与索引比对
+- (void)backingStorageDidChange:(NSNotification *)notification {
+    os_unfair_lock_lock(&_lock);
+    BOOL shouldSchedule = !self.reloadScheduled;
+    self.reloadScheduled = YES;
+    os_unfair_lock_unlock(&_lock);
+
+    if (shouldSchedule) {
+        dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t)(kEMASCookieReloadDelaySec * NSEC_PER_SEC)), self.persistQueue, ^{
+            [self syncWithBackingStorage];
+        });
+    }
+}
+
+// 在persistQueue上执行：先落盘已有写入，再与NSHTTPCookieStorage比对。
+// 只有本jar自身写入时二者一致，无需重建；其他写入方的修改（包括与自身写入同时发生的）都会使二者不一致
+- (void)syncWithBackingStorage {
+    os_unfair_lock_lock(&_lock);
+    self.reloadScheduled = NO;
+    os_unfair_lock_unlock(&_lock);
+
+    [self persistPendingWrites];
+    NSArray<NSHTTPCookie *> *cookies = self.backingStorage.cookies;
+
+    NSTimeInterval now = [NSDate timeIntervalSinceReferenceDate];
+    NSMutableDictionary<NSString *, NSString *> *expected = [NSMutableDictionary dictionaryWithCapacity:cookies.count];
+    for (NSHTTPCookie *cookie in cookies) {
+        if (!EMASCookieIsExpired(cookie, now)) {
+            expected[EMASCookieIdentity(cookie)] = EMASCookieContent(cookie);
+        }
+    }
+
+    os_unfair_lock_lock(&_lock);
+    // 比对期间新到的写入已进入索引但尚未落盘，叠加到期望内容上
+    for (EMASPendingCookieWrite *write in self.pendingWrites) {
+        for (NSHTTPCookie *cookie in write.cookies) {
+            expected[EMASCookieIdentity(cookie)] = EMASCookieIsExpired(cookie, now) ? nil : EMASCookieContent(cookie);
+        }
+    }
+    BOOL upToDate = [self indexMatchesCookies:expected now:now];
+    os_unfair_lock_unlock(&_lock);
+
+    if (!upToDate) {
+        [self reloadWithCookies:cookies];
+    }
+}
+
+// 调用方需持有_lock；expected以EMASCookieIdentity为键、EMASCookieContent为值
+- (BOOL)indexMatchesCookies:(NSDictionary<NSString *, NSString *> *)expected now:(NSTimeInterval)now {
+    NSUInteger count = 0;
+    BOOL matches = YES;
+    NSMutableArray<EMASCookiePathNode *> *nodes = [NSMutableArray new];
+    for (EMASCookieDomainBucket *bucket in self.domains.objectEnumerator) {
+        [nodes addObject:bucket.hostOnlyRoot];
+        [nodes addObject:bucket.domainRoot];
+    }
+    while (matches && nodes.count > 0) {
+        EMASCookiePathNode *node = nodes.lastObject;
+        [nodes removeLastObject];
+        for (NSHTTPCookie *cookie in node.cookies) {
+            if (EMASCookieIsExpired(cookie, now)) {
+                continue;
+            }
+            if (![expected[EMASCookieIdentity(cookie)] isEqualToString:EMASCookieContent(cookie)]) {
+                matches = NO;
+                break;
+            }
+            count++;
+        }
+        [nodes addObjectsFromArray:node.children.allValues];
+    }
+    return matches && count == expected.count;
+}
+
+// 在persistQueue上执行：以NSHTTPCookieStorage为准重建索引，重建期间新到的写入在替换前重新应用，不会丢失
+- (void)reloadWithCookies:(NSArray<NSHTTPCookie *> *)cookies {
+    os_unfair_lock_lock(&_lock);
+    self.reloadCount++;
+    os_unfair_lock_unlock(&_lock);
+
+    NSMutableDictionary<NSString *, EMASCookieDomainBucket *> *index = [self indexWithCookies:cookies];
+
+    os_unfair_lock_lock(&_lock);
+    for (EMASPendingCookieWrite *write in self.pendingWrites) {
+        for (NSHTTPCookie *cookie in write.cookies) {
+            [self applyCookie:cookie toIndex:index];
+        }
+    }
+    self.domains = index;
+    os_unfair_lock_unlock(&_lock);
 }
 
 @end
@@ -0,0 +1,53 @@
+//
+//  EMASCurlDownloadResumeRecord.h
+//  EMASCurl
+//
+//  Created by xuyecan on 2026/10/18.
+//
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ * 可续传下载的进度记录：与目标文件同目录的隐藏文件，记录URL、校验器、总长度和已落盘的字节区间。
+ * 未完成的数据保存在同目录的partial文件中，下载失败、取消或进程退出后保留，下次同一URL下载到同一目标时据此续传。
+ * 同一目标文件同时只应有一个可续传下载。
+ */
+@interface EMASCurlDownloadResumeRecord : NSObject
+
+/**
+ * 读取目标文件对应的记录；记录不存在、URL不一致或partial文件缺失时返回不含已下载区间的新记录
+ */
++ (instancetype)recordForDestinationURL:(NSURL *)destinationURL URLString:(NSString *)URLString;
+
+- (instancetype)init NS_UNAVAILABLE;
+
+@property (nonatomic, strong, readonly) NSURL *destinationURL;
+
+@property (nonatomic, copy, readonly) NSString *URLString;
+
+// 强ETag或Last-Modified，续传时作为If-Range的值
+@property (nonatomic, copy, nullable) NSString *validator;
+
+// 资源完整长度，未知时为-1
+@property (nonatomic, assign) int64_t totalLength;
+
+// 已写入partial文件的字节区间
+@property (nonatomic, copy) NSIndexSet *receivedRanges;
+
+// 保存未完成数据的partial文件路径
+@property (nonatomic, copy, readonly) NSString *partialFilePath;
+
+// 从0开始连续已下载的字节数，续传从这里开始；不超过partial文件的实际长度
+@property (nonatomic, assign, readonly) int64_t resumableLength;
+
+// 原子写入记录文件
+- (BOOL)persistWithError:(NSError **)error;
+
+// 删除记录文件，partial文件由调用方处理
+- (void)remove;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,112 @@
+//
+//  EMASCurlDownloadResumeRecord.m
+//  EMASCurl
+//
+//  Created by xuyecan on 2026/10/18.
+//
+
+#import "EMASCurlDownloadResumeRecord.h"
+#import "EMASCurlLogger.h"
+#include <sys/stat.h>
+#include <unistd.h>
+
+static NSInteger const kEMASResumeRecordVersion = 1;
+
+@interface EMASCurlDownloadResumeRecord ()
+
+@property (nonatomic, strong, readwrite) NSURL *destinationURL;
+@property (nonatomic, copy, readwrite) NSString *URLString;
+@property (nonatomic, copy, readwrite) NSString *partialFilePath;
+@property (nonatomic, copy) NSString *recordFilePath;
+
+@end
+
+@implementation EMASCurlDownloadResumeRecord
+
+- (instancetype)initWithDestinationURL:(NSURL *)destinationURL URLString:(NSString *)URLString {
+    self = [super init];
+    if (self) {
+        _destinationURL = destinationURL;
+        _URLString = [URLString copy];
+        _totalLength = -1;
+        _receivedRanges = [NSIndexSet indexSet];
+        NSString *directory = destinationURL.path.stringByDeletingLastPathComponent;
+        NSString *name = destinationURL.lastPathComponent;
+        _partialFilePath = [directory stringByAppendingPathComponent:[NSString stringWithFormat:@".%@.emascurl-partial", name]];
+        _recordFilePath = [directory stringByAppendingPathComponent:[NSString stringWithFormat:@".%@.emascurl-resume", name]];
+    }
+    return self;
+}
+
++ (instancetype)recordForDestinationURL:(NSURL *)destinationURL URLString:(NSString *)URLString {
+    EMASCurlDownloadResumeRecord *record = [[EMASCurlDownloadResumeRecord alloc] initWithDestinationURL:destinationURL URLString:URLString];
+
+    NSData *data = [NSData dataWithContentsOfFile:record.recordFilePath];
+    NSDictionary *json = data ? [NSJSONSerialization JSONObjectWithData:data options:0 error:nil] : nil;
+    if (![json isKindOfClass:[NSDictionary class]] ||
+        [json[@"version"] integerValue] != kEMASResumeRecordVersion ||
+        ![json[@"url"] isEqual:URLString] ||
+        ![[NSFileManager defaultManager] fileExistsAtPath:record.partialFilePath]) {
+        return record;
+    }
+
+    NSString *validator = json[@"validator"];
+    record.validator = [validator isKindOfClass:[NSString class]] ? validator : nil;
+    record.totalLength = [json[@"totalLength"] longLongValue];
+
+    NSMutableIndexSet *ranges = [NSMutableIndexSet indexSet];
+    NSArray *rangeList = json[@"ranges"];
+    if ([rangeList isKindOfClass:[NSArray class]]) {
+        for (NSArray *pair in rangeList) {
+            if ([pair isKindOfClass:[NSArray class]] && pair.count == 2) {
+                [ranges addIndexesInRange:NSMakeRange([pair[0] unsignedIntegerValue], [pair[1] unsignedIntegerValue])];
+            }
+        }
+    }
+    record.receivedRanges = ranges;
+    return record;
+}
+
+- (int64_t)resumableLength {
+    if (self.receivedRanges.count == 0 || self.receivedRanges.firstIndex != 0) {
+        return 0;
+    }
+    __block int64_t length = 0;
+    [self.receivedRanges enumerateRangesUsingBlock:^(NSRange range, BOOL *stop) {
+        length = (int64_t)NSMaxRange(range);
+        *stop = YES;
+    }];
+
+    // 记录可能领先于实际落盘的数据（如设备掉电），以文件长度为准
+    struct stat st;
+    if (stat(self.partialFilePath.fileSystemRepresentation, &st) != 0) {
+        return 0;
+    }
+    return MIN(length, (int64_t)st.st_size);
+}
+
+- (BOOL)persistWithError:(NSError **)error {
+    NSMutableArray<NSArray<NSNumber *> *> *ranges = [NSMutableArray array];
+    [self.receivedRanges enumerateRangesUsingBlock:^(NSRange range, BOOL *stop) {
+        [ranges addObject:@[@(range.location), @(range.length)]];
+    }];
+    NSMutableDictionary *json = [NSMutableDictionary dictionary];
+    json[@"version"] = @(kEMASResumeRecordVersion);
+    json[@"url"] = self.URLString;
+    json[@"validator"] = self.validator;
+    json[@"totalLength"] = @(self.totalLength);
+    json[@"ranges"] = ranges;
+
+    NSData *data = [NSJSONSerialization dataWithJSONObject:json options:0 error:error];
+    if (!data || ![data writeToFile:self.recordFilePath options:NSDataWritingAtomic error:error]) {
+        EMAS_LOG_ERROR(@"EC-Download", @"Failed to persist resume record for %@", self.destinationURL.path);
+        return NO;
+    }
+    return YES;
+}
+
+- (void)remove {
+    unlink(self.recordFilePath.fileSystemRepresentation);
+}
+
+@end
@@ -0,0 +1,73 @@
+//
+//  EMASCurlFileDownloadSink.h
+//  EMASCurl
+//
+//  Created by xuyecan on 2026/10/18.
+//
+
+#import <Foundation/Foundation.h>
+
+@class EMASCurlDownloadResumeRecord;
+
+NS_ASSUME_NONNULL_BEGIN
+
+// appendBytes:length:的返回值，非负值表示接收的字节数
+typedef NS_ENUM(NSInteger, EMASCurlFileSinkAppendStatus) {
+    EMASCurlFileSinkAppendWouldBlock = -1,  // 待写入数据积压，调用方应暂停传输，积压消化后触发drainedHandler
+    EMASCurlFileSinkAppendFailed = -2       // 写文件出错
+};
+
+/**
+ * 把响应体直接写入目标文件：网络线程只把数据拷入1MiB的写缓冲，写满后交给I/O队列写入。
+ * 数据先写入同目录下的临时文件，成功完成后原子替换目标文件，失败或取消时删除临时文件。
+ * 顺序写入使用appendBytes:length:，分段下载使用checkWritable与writeData:atOffset:按偏移写入，两者不混用。
+ * 写入与finish只应在网络线程调用。
+ */
+@interface EMASCurlFileDownloadSink : NSObject
+
+/**
+ * @param expectedLength 完整文件的长度，用于预分配磁盘空间并在完成时校验已写满，未知时传-1
+ */
+- (nullable instancetype)initWithDestinationURL:(NSURL *)destinationURL
+                                 expectedLength:(int64_t)expectedLength
+                                          error:(NSError **)error;
+
+/**
+ * 可续传的写入：数据写入resumeRecord的partial文件，从其resumableLength处继续顺序写入，
+ * 写入过程中定期落盘并更新记录；失败或取消时保留partial文件与记录，成功替换目标文件后删除记录
+ */
+- (nullable instancetype)initWithDestinationURL:(NSURL *)destinationURL
+                                 expectedLength:(int64_t)expectedLength
+                                   resumeRecord:(nullable EMASCurlDownloadResumeRecord *)resumeRecord
+                                          error:(NSError **)error NS_DESIGNATED_INITIALIZER;
+
+- (instancetype)init NS_UNAVAILABLE;
+
+// 返回WouldBlock后积压降到阈值以下时调用一次，在I/O队列上执行
+@property (nonatomic, copy, nullable) dispatch_block_t drainedHandler;
+
+@property (nonatomic, strong, readonly) NSURL *destinationURL;
+
+// 已写入文件的字节数
+@property (nonatomic, assign, readonly) int64_t bytesWritten;
+
+- (NSInteger)appendBytes:(const void *)bytes length:(size_t)length;
+
+/**
+ * 分段写入前检查积压：可以写入时返回0，否则返回EMASCurlFileSinkAppendStatus。
+ * 返回WouldBlock后积压消化时触发drainedHandler
+ */
+- (NSInteger)checkWritable;
+
+// 分段写入：把一段数据排入I/O队列写到文件的offset处，调用方负责先调用checkWritable
+- (void)writeData:(NSData *)data atOffset:(int64_t)offset;
+
+/**
+ * 写完剩余数据并关闭文件，success为YES时校验数据完整后替换目标文件，否则删除临时文件（可续传时保留）。
+ * completion在I/O队列上执行，error为写文件、校验或替换失败的原因
+ */
+- (void)finishWithSuccess:(BOOL)success completion:(void (^)(NSError * _Nullable error))completion;
+
+@end
+
+NS_ASSUME_NONNULL_END
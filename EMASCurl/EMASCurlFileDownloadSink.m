@@ -0,0 +1,319 @@
+//
+//  EMASCurlFileDownloadSink.m
+//  EMASCurl
+//
+//  Created by xuyecan on 2026/10/18.
+//
+
+#import "EMASCurlFileDownloadSink.h"
+#import "EMASCurlDownloadResumeRecord.h"
+#import "EMASCurlLogger.h"
+#import <os/lock.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+
+// 写缓冲大小，攒满后一次写入，减少系统调用
+static const NSUInteger kEMASFileSinkChunkBytes = 1024 * 1024;
+
+// I/O队列上待写入的数据超过该值时暂停传输，降到一半以下时恢复
+static const NSUInteger kEMASFileSinkMaxPendingBytes = 8 * 1024 * 1024;
+
+// 超过该大小的下载不经过统一缓冲区缓存（F_NOCACHE），避免大文件挤占页缓存
+static const int64_t kEMASFileSinkNoCacheThreshold = 16 * 1024 * 1024;
+
+// 可续传下载每写入该字节数落盘一次并更新续传记录
+static const int64_t kEMASFileSinkPersistIntervalBytes = 8 * 1024 * 1024;
+
+@interface EMASCurlFileDownloadSink () {
+    int _fd;
+    os_unfair_lock _lock;
+    // 以下由_lock保护
+    NSUInteger _pendingBytes;
+    BOOL _producerWaiting;
+    int _writeErrno;
+}
+
+@property (nonatomic, strong, readwrite) NSURL *destinationURL;
+@property (nonatomic, copy) NSString *temporaryPath;
+@property (nonatomic, strong) dispatch_queue_t ioQueue;
+@property (nonatomic, assign) int64_t expectedLength;
+@property (nonatomic, strong) EMASCurlDownloadResumeRecord *resumeRecord;
+// 只在网络线程访问
+@property (nonatomic, strong) NSMutableData *chunk;
+@property (nonatomic, assign) int64_t appendOffset;
+@property (nonatomic, assign) BOOL finished;
+// 只在I/O队列访问
+@property (nonatomic, assign, readwrite) int64_t bytesWritten;
+@property (nonatomic, assign) int64_t fileLength;
+@property (nonatomic, strong) NSMutableIndexSet *writtenRanges;
+@property (nonatomic, assign) int64_t bytesSincePersist;
+
+@end
+
+@implementation EMASCurlFileDownloadSink
+
++ (NSError *)errorWithErrno:(int)code path:(NSString *)path {
+    return [NSError errorWithDomain:NSPOSIXErrorDomain
+                               code:code
+                           userInfo:@{NSFilePathErrorKey: path ?: @"",
+                                      NSLocalizedDescriptionKey: [NSString stringWithUTF8String:strerror(code)]}];
+}
+
+- (instancetype)initWithDestinationURL:(NSURL *)destinationURL expectedLength:(int64_t)expectedLength error:(NSError **)error {
+    return [self initWithDestinationURL:destinationURL expectedLength:expectedLength resumeRecord:nil error:error];
+}
+
+- (instancetype)initWithDestinationURL:(NSURL *)destinationURL
+                        expectedLength:(int64_t)expectedLength
+                          resumeRecord:(EMASCurlDownloadResumeRecord *)resumeRecord
+                                 error:(NSError **)error {
+    self = [super init];
+    if (self) {
+        _lock = OS_UNFAIR_LOCK_INIT;
+        _destinationURL = destinationURL;
+        _expectedLength = expectedLength;
+        _resumeRecord = resumeRecord;
+        _writtenRanges = [NSMutableIndexSet indexSet];
+
+        int flags = O_WRONLY | O_CREAT | O_TRUNC;
+        if (resumeRecord) {
+            _temporaryPath = resumeRecord.partialFilePath;
+            _appendOffset = resumeRecord.resumableLength;
+            if (_appendOffset > 0) {
+                // 续传时保留已下载的前缀，之后的数据会被覆盖
+                flags &= ~O_TRUNC;
+                _fileLength = _appendOffset;
+                [_writtenRanges addIndexesInRange:NSMakeRange(0, (NSUInteger)_appendOffset)];
+            }
+        } else {
+            NSString *directory = destinationURL.path.stringByDeletingLastPathComponent;
+            _temporaryPath = [directory stringByAppendingPathComponent:
+                              [NSString stringWithFormat:@".%@.%@.emascurl", destinationURL.lastPathComponent, [NSUUID UUID].UUIDString]];
+        }
+
+        _fd = open(_temporaryPath.fileSystemRepresentation, flags, 0644);
+        if (_fd < 0) {
+            if (error) {
+                *error = [EMASCurlFileDownloadSink errorWithErrno:errno path:_temporaryPath];
+            }
+            EMAS_LOG_ERROR(@"EC-Download", @"Failed to create download file %@: %s", _temporaryPath, strerror(errno));
+            return nil;
+        }
+
+        if (expectedLength > _appendOffset) {
+            // 预分配连续空间，失败时退回非连续分配，均失败也不影响写入
+            fstore_t store = {F_ALLOCATECONTIG | F_ALLOCATEALL, F_PEOFPOSMODE, 0, expectedLength - _appendOffset, 0};
+            if (fcntl(_fd, F_PREALLOCATE, &store) == -1) {
+                store.fst_flags = F_ALLOCATEALL;
+                fcntl(_fd, F_PREALLOCATE, &store);
+            }
+        }
+        if (expectedLength < 0 || expectedLength >= kEMASFileSinkNoCacheThreshold) {
+            // 顺序写入后不会再读，绕过页缓存
+            fcntl(_fd, F_NOCACHE, 1);
+        }
+
+        dispatch_queue_attr_t attr = dispatch_queue_attr_make_with_qos_class(DISPATCH_QUEUE_SERIAL, QOS_CLASS_UTILITY, 0);
+        _ioQueue = dispatch_queue_create("com.alicloud.emascurl.downloadSink", attr);
+        _chunk = [NSMutableData dataWithCapacity:kEMASFileSinkChunkBytes];
+    }
+    return self;
+}
+
+- (void)dealloc {
+    if (_fd >= 0) {
+        close(_fd);
+        // 可续传的partial文件与最近一次落盘的记录保持一致，留待续传
+        if (!_resumeRecord) {
+            unlink(_temporaryPath.fileSystemRepresentation);
+        }
+    }
+}
+
+#pragma mark - 网络线程
+
+- (NSInteger)checkWritable {
+    os_unfair_lock_lock(&_lock);
+    NSInteger status = 0;
+    if (_writeErrno != 0) {
+        status = EMASCurlFileSinkAppendFailed;
+    } else if (_pendingBytes >= kEMASFileSinkMaxPendingBytes) {
+        _producerWaiting = YES;
+        status = EMASCurlFileSinkAppendWouldBlock;
+    }
+    os_unfair_lock_unlock(&_lock);
+    return status;
+}
+
+- (NSInteger)appendBytes:(const void *)bytes length:(size_t)length {
+    NSInteger status = [self checkWritable];
+    if (status < 0) {
+        return status;
+    }
+
+    [self.chunk appendBytes:bytes length:length];
+    if (self.chunk.length >= kEMASFileSinkChunkBytes) {
+        [self submitChunk];
+    }
+    return (NSInteger)length;
+}
+
+- (void)submitChunk {
+    NSData *chunk = self.chunk;
+    if (chunk.length == 0) {
+        return;
+    }
+    self.chunk = [NSMutableData dataWithCapacity:kEMASFileSinkChunkBytes];
+    [self writeData:chunk atOffset:self.appendOffset];
+    self.appendOffset += (int64_t)chunk.length;
+}
+
+- (void)writeData:(NSData *)data atOffset:(int64_t)offset {
+    if (data.length == 0) {
+        return;
+    }
+    os_unfair_lock_lock(&_lock);
+    _pendingBytes += data.length;
+    os_unfair_lock_unlock(&_lock);
+
+    dispatch_async(self.ioQueue, ^{
+        [self writeChunk:data atOffset:offset];
+    });
+}
+
+- (void)finishWithSuccess:(BOOL)success completion:(void (^)(NSError * _Nullable))completion {
+    if (self.finished) {
+        return;
+    }
+    self.finished = YES;
+    // 可续传时已收到的数据也要写入，下次从更靠后的位置续传
+    if (success || self.resumeRecord) {
+        [self submitChunk];
+    }
+    self.chunk = nil;
+
+    dispatch_async(self.ioQueue, ^{
+        NSError *error = [self closeAndMoveIntoPlace:success];
+        if (completion) {
+            completion(error);
+        }
+    });
+}
+
+#pragma mark - I/O队列
+
+- (void)writeChunk:(NSData *)chunk atOffset:(int64_t)offset {
+    os_unfair_lock_lock(&_lock);
+    BOOL failed = _writeErrno != 0;
+    os_unfair_lock_unlock(&_lock);
+
+    int writeErrno = 0;
+    if (!failed) {
+        const uint8_t *bytes = chunk.bytes;
+        size_t remaining = chunk.length;
+        while (remaining > 0) {
+            ssize_t written = pwrite(_fd, bytes, remaining, offset);
+            if (written < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                writeErrno = errno;
+                break;
+            }
+            [self.writtenRanges addIndexesInRange:NSMakeRange((NSUInteger)offset, (NSUInteger)written)];
+            bytes += written;
+            offset += written;
+            remaining -= (size_t)written;
+            self.bytesWritten += written;
+            self.bytesSincePersist += written;
+        }
+        self.fileLength = MAX(self.fileLength, offset);
+        if (self.resumeRecord && self.bytesSincePersist >= kEMASFileSinkPersistIntervalBytes) {
+            [self persistResumeRecord];
+        }
+    }
+
+    os_unfair_lock_lock(&_lock);
+    _pendingBytes -= chunk.length;
+    if (writeErrno != 0) {
+        _writeErrno = writeErrno;
+    }
+    // 出错时同样唤醒，让网络线程尽快拿到失败结果
+    BOOL resume = _producerWaiting && (_pendingBytes <= kEMASFileSinkMaxPendingBytes / 2 || _writeErrno != 0);
+    if (resume) {
+        _producerWaiting = NO;
+    }
+    os_unfair_lock_unlock(&_lock);
+
+    if (writeErrno != 0) {
+        EMAS_LOG_ERROR(@"EC-Download", @"Failed to write download file %@: %s", self.temporaryPath, strerror(writeErrno));
+    }
+    if (resume && self.drainedHandler) {
+        self.drainedHandler();
+    }
+}
+
+// 先让数据落盘再更新记录，记录描述的区间不会超前于文件内容
+- (void)persistResumeRecord {
+    fsync(_fd);
+    self.resumeRecord.receivedRanges = self.writtenRanges;
+    [self.resumeRecord persistWithError:nil];
+    self.bytesSincePersist = 0;
+}
+
+- (NSError *)closeAndMoveIntoPlace:(BOOL)success {
+    os_unfair_lock_lock(&_lock);
+    int writeErrno = _writeErrno;
+    os_unfair_lock_unlock(&_lock);
+
+    // 各段拼接后必须无空洞地覆盖完整长度
+    NSError *verifyError = nil;
+    if (success && writeErrno == 0 && self.expectedLength > 0 &&
+        (self.fileLength != self.expectedLength ||
+         ![self.writtenRanges containsIndexesInRange:NSMakeRange(0, (NSUInteger)self.expectedLength)])) {
+        EMAS_LOG_ERROR(@"EC-Download", @"Download file %@ is incomplete: %lld of %lld bytes", self.temporaryPath,
+                       (long long)self.writtenRanges.count, self.expectedLength);
+        verifyError = [NSError errorWithDomain:NSURLErrorDomain
+                                          code:NSURLErrorCannotDecodeRawData
+                                      userInfo:@{NSLocalizedDescriptionKey: @"Downloaded file is incomplete"}];
+    }
+
+    // 预分配可能超出实际长度，按写到的最远位置截断
+    if (success && writeErrno == 0 && !verifyError && ftruncate(_fd, self.fileLength) != 0) {
+        writeErrno = errno;
+    }
+
+    const char *temporaryPath = self.temporaryPath.fileSystemRepresentation;
+    if (!success && writeErrno == 0 && self.resumeRecord) {
+        // 失败或取消时保留已下载的数据，下次续传
+        [self persistResumeRecord];
+        close(_fd);
+        _fd = -1;
+        EMAS_LOG_INFO(@"EC-Download", @"Kept %lld bytes of %@ for resuming", self.resumeRecord.resumableLength, self.destinationURL.lastPathComponent);
+        return nil;
+    }
+    close(_fd);
+    _fd = -1;
+
+    if (!success || writeErrno != 0 || verifyError) {
+        unlink(temporaryPath);
+        [self.resumeRecord remove];
+        if (verifyError) {
+            return verifyError;
+        }
+        return writeErrno != 0 ? [EMASCurlFileDownloadSink errorWithErrno:writeErrno path:self.temporaryPath] : nil;
+    }
+
+    // rename在同一目录内原子地替换已存在的目标文件
+    if (rename(temporaryPath, self.destinationURL.path.fileSystemRepresentation) != 0) {
+        int renameErrno = errno;
+        unlink(temporaryPath);
+        EMAS_LOG_ERROR(@"EC-Download", @"Failed to move download file to %@: %s", self.destinationURL.path, strerror(renameErrno));
+        return [EMASCurlFileDownloadSink errorWithErrno:renameErrno path:self.destinationURL.path];
+    }
+    [self.resumeRecord remove];
+    return nil;
+}
+
+@end
@@ -0,0 +1,108 @@
+//
+//  EMASCurlHeaderParser.h
+//  EMASCurl
+//
+//  Created by xuyecan on 2026/10/18.
+//
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ * 常见响应头，通过完美哈希识别（大小写不敏感）
+ */
+typedef NS_ENUM(int8_t, EMASKnownHeader) {
+    EMASKnownHeaderNone = -1,
+    EMASKnownHeaderContentType = 0,
+    EMASKnownHeaderContentLength,
+    EMASKnownHeaderContentEncoding,
+    EMASKnownHeaderContentRange,
+    EMASKnownHeaderContentDisposition,
+    EMASKnownHeaderContentLanguage,
+    EMASKnownHeaderCacheControl,
+    EMASKnownHeaderETag,
+    EMASKnownHeaderLastModified,
+    EMASKnownHeaderExpires,
+    EMASKnownHeaderDate,
+    EMASKnownHeaderAge,
+    EMASKnownHeaderVary,
+    EMASKnownHeaderLocation,
+    EMASKnownHeaderSetCookie,
+    EMASKnownHeaderAcceptRanges,
+    EMASKnownHeaderServer,
+    EMASKnownHeaderConnection,
+    EMASKnownHeaderTransferEncoding,
+    EMASKnownHeaderPragma,
+    EMASKnownHeaderKeepAlive,
+    EMASKnownHeaderAccessControlAllowOrigin,
+    EMASKnownHeaderStrictTransportSecurity,
+    EMASKnownHeaderXContentTypeOptions,
+    EMASKnownHeaderAltSvc,
+    EMASKnownHeaderVia,
+    EMASKnownHeaderXFrameOptions,
+    EMASKnownHeaderWwwAuthenticate,
+    EMASKnownHeaderRetryAfter,
+    EMASKnownHeaderXCache,
+    EMASKnownHeaderCount
+};
+
+// 单行头部的解析结果
+typedef NS_ENUM(NSInteger, EMASHeaderLineType) {
+    EMASHeaderLineIgnored = 0,  // 无法识别的行（没有冒号等）
+    EMASHeaderLineStatus,       // 状态行，标识新的头部开始，解析器已重置
+    EMASHeaderLineField,        // 头部字段
+    EMASHeaderLineEnd           // 空行，标识当前头部结束
+};
+
+typedef struct {
+    uint32_t nameOffset;
+    uint32_t nameLength;
+    uint32_t valueOffset;
+    uint32_t valueLength;
+    EMASKnownHeader known;
+} EMASHeaderField;
+
+/**
+ * 直接在libcurl缓冲区上解析响应头的C解析器。
+ * 头部名与值复制到解析器的内存区中，区域在重置后复用，逐行解析不产生任何分配；
+ * 只在头部结束时一次性创建Foundation对象。非线程安全，只在网络线程使用。
+ */
+typedef struct EMASHeaderParser EMASHeaderParser;
+
+EMASHeaderParser * _Nullable EMASHeaderParserCreate(void);
+void EMASHeaderParserDestroy(EMASHeaderParser * _Nullable parser);
+
+// 清空已解析的内容，保留已分配的内存
+void EMASHeaderParserReset(EMASHeaderParser *parser);
+
+// 解析一行（可包含结尾的CRLF），状态行会先重置解析器
+EMASHeaderLineType EMASHeaderParserFeedLine(EMASHeaderParser *parser, const char *buffer, size_t length);
+
+// 识别常见头部名，未识别时返回EMASKnownHeaderNone
+EMASKnownHeader EMASKnownHeaderLookup(const char *name, size_t length);
+
+NSInteger EMASHeaderParserStatusCode(const EMASHeaderParser *parser);
+NSString * _Nullable EMASHeaderParserCopyHTTPVersion(const EMASHeaderParser *parser);
+NSString *EMASHeaderParserCopyReasonPhrase(const EMASHeaderParser *parser);
+
+size_t EMASHeaderParserFieldCount(const EMASHeaderParser *parser);
+const EMASHeaderField *EMASHeaderParserFieldAtIndex(const EMASHeaderParser *parser, size_t index);
+NSString * _Nullable EMASHeaderParserCopyFieldValue(const EMASHeaderParser *parser, const EMASHeaderField *field);
+
+// 第一个该名称的字段，不存在时返回NULL
+const EMASHeaderField * _Nullable EMASHeaderParserFindKnown(const EMASHeaderParser *parser, EMASKnownHeader known);
+
+// 该头部的任一字段是否包含token（大小写不敏感的子串匹配），不创建对象
+BOOL EMASHeaderParserKnownHeaderContains(const EMASHeaderParser *parser, EMASKnownHeader known, const char *token);
+
+// 将头部值按十进制整数解析，不存在或无法解析时返回-1
+long long EMASHeaderParserKnownHeaderInteger(const EMASHeaderParser *parser, EMASKnownHeader known);
+
+/**
+ * 构建头部字典。同名（大小写敏感）字段以", "合并，与逐行拼接的结果一致；
+ * 常见头部名复用常量字符串，不重复创建。
+ */
+NSMutableDictionary<NSString *, NSString *> *EMASHeaderParserCopyHeaderDictionary(const EMASHeaderParser *parser);
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,367 @@
+//
+//  EMASCurlHeaderParser.m
+//  EMASCurl
+//
+//  Created by xuyecan on 2026/10/18.
+//
+
+#import "EMASCurlHeaderParser.h"
+
+// 初始容量可容纳常见的HTTP/2 API响应头，超出时按倍数扩容，扩容后的内存在重置后继续复用
+static const size_t kEMASHeaderArenaInitialCapacity = 4096;
+static const size_t kEMASHeaderFieldsInitialCapacity = 48;
+
+struct EMASHeaderParser {
+    char *arena;
+    size_t arenaLength;
+    size_t arenaCapacity;
+    EMASHeaderField *fields;
+    size_t fieldCount;
+    size_t fieldCapacity;
+    NSInteger statusCode;
+    uint32_t versionOffset;
+    uint32_t versionLength;
+    uint32_t reasonOffset;
+    uint32_t reasonLength;
+};
+
+typedef struct {
+    const char *lowercaseName;
+    const char *canonicalCName;
+    size_t length;
+    __unsafe_unretained NSString *canonicalName;
+    __unsafe_unretained NSString *lowercaseKey;
+} EMASKnownHeaderInfo;
+
+static const EMASKnownHeaderInfo kEMASKnownHeaders[EMASKnownHeaderCount] = {
+    {"content-type", "Content-Type", 12, @"Content-Type", @"content-type"},
+    {"content-length", "Content-Length", 14, @"Content-Length", @"content-length"},
+    {"content-encoding", "Content-Encoding", 16, @"Content-Encoding", @"content-encoding"},
+    {"content-range", "Content-Range", 13, @"Content-Range", @"content-range"},
+    {"content-disposition", "Content-Disposition", 19, @"Content-Disposition", @"content-disposition"},
+    {"content-language", "Content-Language", 16, @"Content-Language", @"content-language"},
+    {"cache-control", "Cache-Control", 13, @"Cache-Control", @"cache-control"},
+    {"etag", "ETag", 4, @"ETag", @"etag"},
+    {"last-modified", "Last-Modified", 13, @"Last-Modified", @"last-modified"},
+    {"expires", "Expires", 7, @"Expires", @"expires"},
+    {"date", "Date", 4, @"Date", @"date"},
+    {"age", "Age", 3, @"Age", @"age"},
+    {"vary", "Vary", 4, @"Vary", @"vary"},
+    {"location", "Location", 8, @"Location", @"location"},
+    {"set-cookie", "Set-Cookie", 10, @"Set-Cookie", @"set-cookie"},
+    {"accept-ranges", "Accept-Ranges", 13, @"Accept-Ranges", @"accept-ranges"},
+    {"server", "Server", 6, @"Server", @"server"},
+    {"connection", "Connection", 10, @"Connection", @"connection"},
+    {"transfer-encoding", "Transfer-Encoding", 17, @"Transfer-Encoding", @"transfer-encoding"},
+    {"pragma", "Pragma", 6, @"Pragma", @"pragma"},
+    {"keep-alive", "Keep-Alive", 10, @"Keep-Alive", @"keep-alive"},
+    {"access-control-allow-origin", "Access-Control-Allow-Origin", 27, @"Access-Control-Allow-Origin", @"access-control-allow-origin"},
+    {"strict-transport-security", "Strict-Transport-Security", 25, @"Strict-Transport-Security", @"strict-transport-security"},
+    {"x-content-type-options", "X-Content-Type-Options", 22, @"X-Content-Type-Options", @"x-content-type-options"},
+    {"alt-svc", "Alt-Svc", 7, @"Alt-Svc", @"alt-svc"},
+    {"via", "Via", 3, @"Via", @"via"},
+    {"x-frame-options", "X-Frame-Options", 15, @"X-Frame-Options", @"x-frame-options"},
+    {"www-authenticate", "WWW-Authenticate", 16, @"WWW-Authenticate", @"www-authenticate"},
+    {"retry-after", "Retry-After", 11, @"Retry-After", @"retry-after"},
+    {"x-cache", "X-Cache", 7, @"X-Cache", @"x-cache"},
+};
+
+// 完美哈希：(长度 + 首字符 + 末字符*3 + 中间字符*20) & 63，对上表中的名称无冲突；
+// 槽位到EMASKnownHeader的映射，-1表示空槽
+static const int8_t kEMASKnownHeaderSlots[64] = {
+    -1, -1, 29, -1, -1, -1, -1, 16, -1, -1, -1, 15, 2, 12, 13, -1,
+    25, 8, 5, -1, -1, 24, -1, 28, 14, -1, 27, 23, -1, -1, -1, 11,
+    -1, -1, -1, -1, 26, 19, -1, 10, -1, -1, -1, -1, -1, 1, 0, 3,
+    6, -1, 7, 17, 4, -1, 21, 22, 20, 9, -1, -1, -1, -1, 18, -1,
+};
+
+static inline uint8_t EMASLowercaseASCII(uint8_t c) {
+    return (c >= 'A' && c <= 'Z') ? (uint8_t)(c + ('a' - 'A')) : c;
+}
+
+static inline BOOL EMASIsOptionalWhitespace(char c) {
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+EMASKnownHeader EMASKnownHeaderLookup(const char *name, size_t length) {
+    if (length < 3 || length > 27) {
+        return EMASKnownHeaderNone;
+    }
+    const uint8_t *p = (const uint8_t *)name;
+    size_t hash = length + EMASLowercaseASCII(p[0]) + EMASLowercaseASCII(p[length - 1]) * 3 + EMASLowercaseASCII(p[length / 2]) * 20;
+    int8_t known = kEMASKnownHeaderSlots[hash & 63];
+    if (known < 0 || kEMASKnownHeaders[known].length != length) {
+        return EMASKnownHeaderNone;
+    }
+    const char *candidate = kEMASKnownHeaders[known].lowercaseName;
+    for (size_t i = 0; i < length; i++) {
+        if (EMASLowercaseASCII(p[i]) != (uint8_t)candidate[i]) {
+            return EMASKnownHeaderNone;
+        }
+    }
+    return (EMASKnownHeader)known;
+}
+
+EMASHeaderParser *EMASHeaderParserCreate(void) {
+    EMASHeaderParser *parser = calloc(1, sizeof(EMASHeaderParser));
+    if (!parser) {
+        return NULL;
+    }
+    parser->arena = malloc(kEMASHeaderArenaInitialCapacity);
+    parser->fields = malloc(kEMASHeaderFieldsInitialCapacity * sizeof(EMASHeaderField));
+    if (!parser->arena || !parser->fields) {
+        EMASHeaderParserDestroy(parser);
+        return NULL;
+    }
+    parser->arenaCapacity = kEMASHeaderArenaInitialCapacity;
+    parser->fieldCapacity = kEMASHeaderFieldsInitialCapacity;
+    return parser;
+}
+
+void EMASHeaderParserDestroy(EMASHeaderParser *parser) {
+    if (!parser) {
+        return;
+    }
+    free(parser->arena);
+    free(parser->fields);
+    free(parser);
+}
+
+void EMASHeaderParserReset(EMASHeaderParser *parser) {
+    parser->arenaLength = 0;
+    parser->fieldCount = 0;
+    parser->statusCode = 0;
+    parser->versionOffset = parser->versionLength = 0;
+    parser->reasonOffset = parser->reasonLength = 0;
+}
+
+// 复制到内存区并返回偏移，扩容失败返回NO
+static BOOL EMASHeaderArenaAppend(EMASHeaderParser *parser, const char *bytes, size_t length, uint32_t *offset) {
+    if (parser->arenaLength + length > parser->arenaCapacity) {
+        size_t capacity = parser->arenaCapacity;
+        while (capacity < parser->arenaLength + length) {
+            capacity *= 2;
+        }
+        if (capacity > UINT32_MAX) {
+            return NO;
+        }
+        char *arena = realloc(parser->arena, capacity);
+        if (!arena) {
+            return NO;
+        }
+        parser->arena = arena;
+        parser->arenaCapacity = capacity;
+    }
+    memcpy(parser->arena + parser->arenaLength, bytes, length);
+    *offset = (uint32_t)parser->arenaLength;
+    parser->arenaLength += length;
+    return YES;
+}
+
+static EMASHeaderLineType EMASHeaderParseStatusLine(EMASHeaderParser *parser, const char *line, size_t length) {
+    EMASHeaderParserReset(parser);
+
+    size_t pos = 0;
+    while (pos < length && line[pos] != ' ') {
+        pos++;
+    }
+    if (!EMASHeaderArenaAppend(parser, line, pos, &parser->versionOffset)) {
+        return EMASHeaderLineIgnored;
+    }
+    parser->versionLength = (uint32_t)pos;
+
+    while (pos < length && line[pos] == ' ') {
+        pos++;
+    }
+    NSInteger statusCode = 0;
+    while (pos < length && line[pos] >= '0' && line[pos] <= '9' && statusCode < 1000) {
+        statusCode = statusCode * 10 + (line[pos] - '0');
+        pos++;
+    }
+    parser->statusCode = statusCode;
+
+    while (pos < length && line[pos] == ' ') {
+        pos++;
+    }
+    if (!EMASHeaderArenaAppend(parser, line + pos, length - pos, &parser->reasonOffset)) {
+        return EMASHeaderLineIgnored;
+    }
+    parser->reasonLength = (uint32_t)(length - pos);
+    return EMASHeaderLineStatus;
+}
+
+EMASHeaderLineType EMASHeaderParserFeedLine(EMASHeaderParser *parser, const char *buffer, size_t length) {
+    // 去掉首尾空白与CRLF
+    while (length > 0 && EMASIsOptionalWhitespace(buffer[length - 1])) {
+        length--;
+    }
+    while (length > 0 && EMASIsOptionalWhitespace(buffer[0])) {
+        buffer++;
+        length--;
+    }
+    if (length == 0) {
+        return EMASHeaderLineEnd;
+    }
+    if (length >= 5 && memcmp(buffer, "HTTP/", 5) == 0) {
+        return EMASHeaderParseStatusLine(parser, buffer, length);
+    }
+
+    const char *colon = memchr(buffer, ':', length);
+    if (!colon || colon == buffer) {
+        return EMASHeaderLineIgnored;
+    }
+    size_t nameLength = (size_t)(colon - buffer);
+    while (nameLength > 0 && EMASIsOptionalWhitespace(buffer[nameLength - 1])) {
+        nameLength--;
+    }
+    const char *value = colon + 1;
+    size_t valueLength = length - (size_t)(value - buffer);
+    while (valueLength > 0 && EMASIsOptionalWhitespace(value[0])) {
+        value++;
+        valueLength--;
+    }
+    if (nameLength == 0) {
+        return EMASHeaderLineIgnored;
+    }
+
+    if (parser->fieldCount == parser->fieldCapacity) {
+        EMASHeaderField *fields = realloc(parser->fields, parser->fieldCapacity * 2 * sizeof(EMASHeaderField));
+        if (!fields) {
+            return EMASHeaderLineIgnored;
+        }
+        parser->fields = fields;
+        parser->fieldCapacity *= 2;
+    }
+
+    EMASHeaderField field;
+    if (!EMASHeaderArenaAppend(parser, buffer, nameLength, &field.nameOffset) ||
+        !EMASHeaderArenaAppend(parser, value, valueLength, &field.valueOffset)) {
+        return EMASHeaderLineIgnored;
+    }
+    field.nameLength = (uint32_t)nameLength;
+    field.valueLength = (uint32_t)valueLength;
+    field.known = EMASKnownHeaderLookup(buffer, nameLength);
+    parser->fields[parser->fieldCount++] = field;
+    return EMASHeaderLineField;
+}
+
+NSInteger EMASHeaderParserStatusCode(const EMASHeaderParser *parser) {
+    return parser->statusCode;
+}
+
+// 头部按RFC应为ASCII，个别服务端会发送Latin-1字节
+static NSString *EMASHeaderCopyString(const char *bytes, size_t length) {
+    NSString *string = [[NSString alloc] initWithBytes:bytes length:length encoding:NSUTF8StringEncoding];
+    if (!string) {
+        string = [[NSString alloc] initWithBytes:bytes length:length encoding:NSISOLatin1StringEncoding];
+    }
+    return string;
+}
+
+NSString *EMASHeaderParserCopyHTTPVersion(const EMASHeaderParser *parser) {
+    if (parser->versionLength == 0) {
+        return nil;
+    }
+    return EMASHeaderCopyString(parser->arena + parser->versionOffset, parser->versionLength);
+}
+
+NSString *EMASHeaderParserCopyReasonPhrase(const EMASHeaderParser *parser) {
+    if (parser->reasonLength == 0) {
+        return @"";
+    }
+    return EMASHeaderCopyString(parser->arena + parser->reasonOffset, parser->reasonLength) ?: @"";
+}
+
+size_t EMASHeaderParserFieldCount(const EMASHeaderParser *parser) {
+    return parser->fieldCount;
+}
+
+const EMASHeaderField *EMASHeaderParserFieldAtIndex(const EMASHeaderParser *parser, size_t index) {
+    return &parser->fields[index];
+}
+
+NSString *EMASHeaderParserCopyFieldValue(const EMASHeaderParser *parser, const EMASHeaderField *field) {
+    return EMASHeaderCopyString(parser->arena + field->valueOffset, field->valueLength);
+}
+
+const EMASHeaderField *EMASHeaderParserFindKnown(const EMASHeaderParser *parser, EMASKnownHeader known) {
+    for (size_t i = 0; i < parser->fieldCount; i++) {
+        if (parser->fields[i].known == known) {
+            return &parser->fields[i];
+        }
+    }
+    return NULL;
+}
+
+BOOL EMASHeaderParserKnownHeaderContains(const EMASHeaderParser *parser, EMASKnownHeader known, const char *token) {
+    size_t tokenLength = strlen(token);
+    if (tokenLength == 0) {
+        return NO;
+    }
+    for (size_t i = 0; i < parser->fieldCount; i++) {
+        const EMASHeaderField *field = &parser->fields[i];
+        if (field->known != known || field->valueLength < tokenLength) {
+            continue;
+        }
+        const uint8_t *value = (const uint8_t *)parser->arena + field->valueOffset;
+        for (size_t start = 0; start + tokenLength <= field->valueLength; start++) {
+            size_t matched = 0;
+            while (matched < tokenLength && EMASLowercaseASCII(value[start + matched]) == EMASLowercaseASCII((uint8_t)token[matched])) {
+                matched++;
+            }
+            if (matched == tokenLength) {
+                return YES;
+            }
+        }
+    }
+    return NO;
+}
+
+long long EMASHeaderParserKnownHeaderInteger(const EMASHeaderParser *parser, EMASKnownHeader known) {
+    const EMASHeaderField *field = EMASHeaderParserFindKnown(parser, known);
+    if (!field || field->valueLength == 0) {
+        return -1;
+    }
+    const char *value = parser->arena + field->valueOffset;
+    long long result = 0;
+    for (uint32_t i = 0; i < field->valueLength; i++) {
+        if (value[i] < '0' || value[i] > '9') {
+            return -1;
+        }
+        if (result > (LLONG_MAX - 9) / 10) {
+            return -1;
+        }
+        result = result * 10 + (value[i] - '0');
+    }
+    return result;
+}
+
+static NSString *EMASHeaderCopyName(const EMASHeaderParser *parser, const EMASHeaderField *field) {
+    const char *name = parser->arena + field->nameOffset;
+    if (field->known != EMASKnownHeaderNone) {
+        const EMASKnownHeaderInfo *info = &kEMASKnownHeaders[field->known];
+        // 名称已确认与表项大小写无关地相等，只需判断是否恰好为两种常见写法之一
+        if (memcmp(name, info->lowercaseName, field->nameLength) == 0) {
+            return info->lowercaseKey;
+        }
+        if (memcmp(name, info->canonicalCName, field->nameLength) == 0) {
+            return info->canonicalName;
+        }
+    }
+    return EMASHeaderCopyString(name, field->nameLength);
+}
+
+NSMutableDictionary<NSString *, NSString *> *EMASHeaderParserCopyHeaderDictionary(const EMASHeaderParser *parser) {
+    NSMutableDictionary<NSString *, NSString *> *headers = [NSMutableDictionary dictionaryWithCapacity:parser->fieldCount];
+    for (size_t i = 0; i < parser->fieldCount; i++) {
+        const EMASHeaderField *field = &parser->fields[i];
+        NSString *name = EMASHeaderCopyName(parser, field);
+        NSString *value = EMASHeaderParserCopyFieldValue(parser, field);
+        if (!name || !value) {
+            continue;
+        }
+        NSString *existingValue = headers[name];
+        headers[name] = existingValue ? [NSString stringWithFormat:@"%@, %@", existingValue, value] : value;
+    }
+    return headers;
+}
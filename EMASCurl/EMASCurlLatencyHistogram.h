@@ -0,0 +1,46 @@
+//
+//  EMASCurlLatencyHistogram.h
+//  EMASCurl
+//
+//  Created by xuyecan on 2026/10/18.
+//
+
+#import <Foundation/Foundation.h>
+#import "EMASCurlConfiguration.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+@class EMASCurlMetricsData;
+
+/**
+ * 按host与协议聚合的耗时、字节数直方图。
+ * 每个指标按2的幂分段、段内8个线性子桶（HDR风格），记录只对桶计数做原子加，不加锁；
+ * host与协议的组合首次出现时以CAS插入固定容量的开放寻址表，表满后计入host为"*"的汇总项。
+ * 记录与取快照可在任意线程并发调用。
+ */
+@interface EMASCurlLatencyHistograms : NSObject
+
++ (instancetype)sharedInstance;
+
+/**
+ * 记录一次传输的指标，未收到响应（httpVersion为0）或没有host的传输忽略
+ */
+- (void)recordMetrics:(EMASCurlMetricsData *)metrics;
+
+/**
+ * 记录单个样本，耗时指标的单位为微秒，字节数指标的单位为字节
+ */
+- (void)recordValue:(uint64_t)value
+          forMetric:(EMASCurlHistogramMetric)metric
+               host:(NSString *)host
+       protocolName:(NSString *)protocolName;
+
+/**
+ * 取各host与协议的快照，没有样本的组合不出现；reset为YES时逐桶原子交换为0，
+ * 并发记录的样本要么计入本次快照，要么留给下一次
+ */
+- (NSArray<EMASCurlHostLatencySnapshot *> *)snapshotsResetting:(BOOL)reset;
+
+@end
+
+NS_ASSUME_NONNULL_END
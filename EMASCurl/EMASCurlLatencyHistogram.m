@@ -0,0 +1,327 @@
+//
+//  EMASCurlLatencyHistogram.m
+//  EMASCurl
+//
+//  Created by xuyecan on 2026/10/18.
+//
+
+#import "EMASCurlLatencyHistogram.h"
+#import "EMASCurlManager.h"
+#import <curl/curl.h>
+#import <stdatomic.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define EMAS_HISTOGRAM_METRIC_COUNT (EMASCurlHistogramMetricResponseBodyBytes + 1)
+
+// 每段的线性子桶数为2^EMAS_HISTOGRAM_SUB_BUCKET_BITS，桶宽与桶下界之比不超过1/8
+#define EMAS_HISTOGRAM_SUB_BUCKET_BITS 3
+#define EMAS_HISTOGRAM_SUB_BUCKET_COUNT (1 << EMAS_HISTOGRAM_SUB_BUCKET_BITS)
+
+// 超过2^40（约12天的微秒数、1TiB）的样本计入最后一个桶
+#define EMAS_HISTOGRAM_MAX_MAGNITUDE 39
+#define EMAS_HISTOGRAM_BUCKET_COUNT ((EMAS_HISTOGRAM_MAX_MAGNITUDE - EMAS_HISTOGRAM_SUB_BUCKET_BITS + 2) * EMAS_HISTOGRAM_SUB_BUCKET_COUNT)
+
+// 开放寻址表容量，须为2的幂
+#define EMAS_HISTOGRAM_SLOT_COUNT 64
+
+typedef struct {
+    _Atomic uint64_t buckets[EMAS_HISTOGRAM_BUCKET_COUNT];
+    _Atomic uint64_t sum;
+} EMASHistogram;
+
+typedef struct {
+    uint64_t hash;
+    char *host;
+    char *protocolName;
+    EMASHistogram histograms[EMAS_HISTOGRAM_METRIC_COUNT];
+} EMASHistogramEntry;
+
+typedef struct {
+    // 条目插入后不再移除，reset只清零计数
+    _Atomic(EMASHistogramEntry *) slots[EMAS_HISTOGRAM_SLOT_COUNT];
+    EMASHistogramEntry *overflow;
+} EMASHistogramTable;
+
+static inline NSUInteger EMASHistogramBucketIndex(uint64_t value) {
+    if (value < EMAS_HISTOGRAM_SUB_BUCKET_COUNT) {
+        return (NSUInteger)value;
+    }
+    unsigned magnitude = 63 - __builtin_clzll(value);
+    if (magnitude > EMAS_HISTOGRAM_MAX_MAGNITUDE) {
+        return EMAS_HISTOGRAM_BUCKET_COUNT - 1;
+    }
+    unsigned shift = magnitude - EMAS_HISTOGRAM_SUB_BUCKET_BITS;
+    uint64_t subBucket = (value >> shift) & (EMAS_HISTOGRAM_SUB_BUCKET_COUNT - 1);
+    return (NSUInteger)((shift + 1) * EMAS_HISTOGRAM_SUB_BUCKET_COUNT + subBucket);
+}
+
+// 桶的中点作为该桶样本的代表值
+static double EMASHistogramBucketValue(NSUInteger index) {
+    if (index < EMAS_HISTOGRAM_SUB_BUCKET_COUNT) {
+        return (double)index;
+    }
+    unsigned shift = (unsigned)(index / EMAS_HISTOGRAM_SUB_BUCKET_COUNT) - 1;
+    uint64_t lower = (EMAS_HISTOGRAM_SUB_BUCKET_COUNT + index % EMAS_HISTOGRAM_SUB_BUCKET_COUNT) << shift;
+    uint64_t width = (uint64_t)1 << shift;
+    return (double)lower + (double)(width - 1) / 2.0;
+}
+
+static uint64_t EMASHistogramHash(const char *host, const char *protocolName) {
+    // FNV-1a
+    uint64_t hash = 14695981039346656037ULL;
+    for (const char *p = host; *p; p++) {
+        hash = (hash ^ (uint8_t)*p) * 1099511628211ULL;
+    }
+    hash = (hash ^ '|') * 1099511628211ULL;
+    for (const char *p = protocolName; *p; p++) {
+        hash = (hash ^ (uint8_t)*p) * 1099511628211ULL;
+    }
+    return hash;
+}
+
+static EMASHistogramEntry *EMASHistogramEntryCreate(uint64_t hash, const char *host, const char *protocolName) {
+    EMASHistogramEntry *entry = calloc(1, sizeof(EMASHistogramEntry));
+    entry->hash = hash;
+    entry->host = strdup(host);
+    entry->protocolName = strdup(protocolName);
+    return entry;
+}
+
+static void EMASHistogramEntryFree(EMASHistogramEntry *entry) {
+    if (!entry) {
+        return;
+    }
+    free(entry->host);
+    free(entry->protocolName);
+    free(entry);
+}
+
+static EMASHistogramEntry *EMASHistogramTableLookup(EMASHistogramTable *table, const char *host, const char *protocolName) {
+    uint64_t hash = EMASHistogramHash(host, protocolName);
+    EMASHistogramEntry *candidate = NULL;
+    EMASHistogramEntry *found = table->overflow;
+
+    for (NSUInteger probe = 0; probe < EMAS_HISTOGRAM_SLOT_COUNT; probe++) {
+        NSUInteger index = (NSUInteger)(hash + probe) & (EMAS_HISTOGRAM_SLOT_COUNT - 1);
+        EMASHistogramEntry *entry = atomic_load_explicit(&table->slots[index], memory_order_acquire);
+        if (!entry) {
+            if (!candidate) {
+                candidate = EMASHistogramEntryCreate(hash, host, protocolName);
+            }
+            // 失败时expected带回并发插入的条目，继续与它比较
+            EMASHistogramEntry *expected = NULL;
+            if (atomic_compare_exchange_strong_explicit(&table->slots[index], &expected, candidate,
+                                                        memory_order_acq_rel, memory_order_acquire)) {
+                return candidate;
+            }
+            entry = expected;
+        }
+        if (entry->hash == hash && strcmp(entry->host, host) == 0 && strcmp(entry->protocolName, protocolName) == 0) {
+            found = entry;
+            break;
+        }
+    }
+
+    EMASHistogramEntryFree(candidate);
+    return found;
+}
+
+static NSString *EMASHistogramProtocolName(long httpVersion) {
+    switch (httpVersion) {
+        case CURL_HTTP_VERSION_1_0:
+            return @"http/1.0";
+        case CURL_HTTP_VERSION_2_0:
+            return @"http/2";
+        case CURL_HTTP_VERSION_3:
+            return @"http/3";
+        default:
+            return @"http/1.1";
+    }
+}
+
+static inline uint64_t EMASHistogramMicroseconds(double seconds) {
+    return seconds > 0 ? (uint64_t)llround(seconds * 1e6) : 0;
+}
+
+static BOOL EMASHistogramMetricIsDuration(EMASCurlHistogramMetric metric) {
+    return metric != EMASCurlHistogramMetricRequestBodyBytes && metric != EMASCurlHistogramMetricResponseBodyBytes;
+}
+
+@implementation EMASCurlHistogramSummary
+@end
+
+@implementation EMASCurlHostLatencySnapshot
+
+- (nullable EMASCurlHistogramSummary *)summaryForMetric:(EMASCurlHistogramMetric)metric {
+    return self.summaries[@(metric)];
+}
+
+@end
+
+@implementation EMASCurlLatencyHistograms {
+    EMASHistogramTable *_table;
+}
+
++ (instancetype)sharedInstance {
+    static EMASCurlLatencyHistograms *instance = nil;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        instance = [[EMASCurlLatencyHistograms alloc] init];
+    });
+    return instance;
+}
+
+- (instancetype)init {
+    self = [super init];
+    if (self) {
+        _table = calloc(1, sizeof(EMASHistogramTable));
+        _table->overflow = EMASHistogramEntryCreate(0, "*", "*");
+    }
+    return self;
+}
+
+- (void)dealloc {
+    for (NSUInteger i = 0; i < EMAS_HISTOGRAM_SLOT_COUNT; i++) {
+        EMASHistogramEntryFree(atomic_load_explicit(&_table->slots[i], memory_order_acquire));
+    }
+    EMASHistogramEntryFree(_table->overflow);
+    free(_table);
+}
+
+- (void)recordMetrics:(EMASCurlMetricsData *)metrics {
+    if (metrics.httpVersion == 0 || !metrics.effectiveURL) {
+        return;
+    }
+    NSString *host = [NSURL URLWithString:metrics.effectiveURL].host.lowercaseString;
+    if (host.length == 0) {
+        return;
+    }
+    EMASHistogramEntry *entry = EMASHistogramTableLookup(_table, host.UTF8String,
+                                                         EMASHistogramProtocolName(metrics.httpVersion).UTF8String);
+
+    // 复用连接的请求没有解析、建连与握手阶段，计入会把分布拉向0
+    if (metrics.numConnects > 0) {
+        [self recordValue:EMASHistogramMicroseconds(metrics.nameLookupTime)
+              inHistogram:&entry->histograms[EMASCurlHistogramMetricNameLookup]];
+        if (metrics.connectTime > 0) {
+            [self recordValue:EMASHistogramMicroseconds(metrics.connectTime - metrics.nameLookupTime)
+                  inHistogram:&entry->histograms[EMASCurlHistogramMetricConnect]];
+        }
+        if (metrics.appConnectTime > 0) {
+            [self recordValue:EMASHistogramMicroseconds(metrics.appConnectTime - metrics.connectTime)
+                  inHistogram:&entry->histograms[EMASCurlHistogramMetricSecureConnection]];
+        }
+    }
+    if (metrics.startTransferTime > 0) {
+        [self recordValue:EMASHistogramMicroseconds(metrics.startTransferTime)
+              inHistogram:&entry->histograms[EMASCurlHistogramMetricTimeToFirstByte]];
+    }
+    [self recordValue:EMASHistogramMicroseconds(metrics.totalTime)
+          inHistogram:&entry->histograms[EMASCurlHistogramMetricTotal]];
+    [self recordValue:(uint64_t)MAX(metrics.uploadBytes, 0)
+          inHistogram:&entry->histograms[EMASCurlHistogramMetricRequestBodyBytes]];
+    [self recordValue:(uint64_t)MAX(metrics.downloadBytes, 0)
+          inHistogram:&entry->histograms[EMASCurlHistogramMetricResponseBodyBytes]];
+}
+
+- (void)recordValue:(uint64_t)value
+          forMetric:(EMASCurlHistogramMetric)metric
+               host:(NSString *)host
+       protocolName:(NSString *)protocolName {
+    if (metric < 0 || metric >= EMAS_HISTOGRAM_METRIC_COUNT) {
+        return;
+    }
+    EMASHistogramEntry *entry = EMASHistogramTableLookup(_table, host.UTF8String, protocolName.UTF8String);
+    [self recordValue:value inHistogram:&entry->histograms[metric]];
+}
+
+- (void)recordValue:(uint64_t)value inHistogram:(EMASHistogram *)histogram {
+    atomic_fetch_add_explicit(&histogram->buckets[EMASHistogramBucketIndex(value)], 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&histogram->sum, value, memory_order_relaxed);
+}
+
+- (NSArray<EMASCurlHostLatencySnapshot *> *)snapshotsResetting:(BOOL)reset {
+    NSMutableArray<EMASCurlHostLatencySnapshot *> *snapshots = [NSMutableArray array];
+    for (NSUInteger i = 0; i <= EMAS_HISTOGRAM_SLOT_COUNT; i++) {
+        EMASHistogramEntry *entry = i < EMAS_HISTOGRAM_SLOT_COUNT
+            ? atomic_load_explicit(&_table->slots[i], memory_order_acquire)
+            : _table->overflow;
+        if (!entry) {
+            continue;
+        }
+        NSMutableDictionary<NSNumber *, EMASCurlHistogramSummary *> *summaries = [NSMutableDictionary dictionary];
+        for (NSInteger metric = 0; metric < EMAS_HISTOGRAM_METRIC_COUNT; metric++) {
+            EMASCurlHistogramSummary *summary = [self summaryOfHistogram:&entry->histograms[metric]
+                                                                   reset:reset
+                                                                   scale:EMASHistogramMetricIsDuration(metric) ? 1e-6 : 1];
+            if (summary) {
+                summaries[@(metric)] = summary;
+            }
+        }
+        if (summaries.count == 0) {
+            continue;
+        }
+        EMASCurlHostLatencySnapshot *snapshot = [EMASCurlHostLatencySnapshot new];
+        snapshot.host = @(entry->host);
+        snapshot.protocolName = @(entry->protocolName);
+        snapshot.summaries = summaries;
+        [snapshots addObject:snapshot];
+    }
+    return snapshots;
+}
+
+- (nullable EMASCurlHistogramSummary *)summaryOfHistogram:(EMASHistogram *)histogram reset:(BOOL)reset scale:(double)scale {
+    uint64_t counts[EMAS_HISTOGRAM_BUCKET_COUNT];
+    uint64_t total = 0;
+    for (NSUInteger i = 0; i < EMAS_HISTOGRAM_BUCKET_COUNT; i++) {
+        counts[i] = reset
+            ? atomic_exchange_explicit(&histogram->buckets[i], 0, memory_order_relaxed)
+            : atomic_load_explicit(&histogram->buckets[i], memory_order_relaxed);
+        total += counts[i];
+    }
+    // sum与桶计数不是同一时刻读取，并发记录时均值可能有一个样本的偏差，计数本身不会丢失
+    uint64_t sum = reset
+        ? atomic_exchange_explicit(&histogram->sum, 0, memory_order_relaxed)
+        : atomic_load_explicit(&histogram->sum, memory_order_relaxed);
+    if (total == 0) {
+        return nil;
+    }
+
+    EMASCurlHistogramSummary *summary = [EMASCurlHistogramSummary new];
+    summary.count = (NSUInteger)total;
+    summary.mean = (double)sum / (double)total * scale;
+
+    // 分位数取累计计数首次达到ceil(p * total)的桶
+    const double percentiles[] = {0.5, 0.9, 0.99};
+    double values[3] = {0};
+    uint64_t ranks[3];
+    for (int p = 0; p < 3; p++) {
+        ranks[p] = MAX((uint64_t)ceil(percentiles[p] * (double)total), 1);
+    }
+    uint64_t cumulative = 0;
+    int nextPercentile = 0;
+    BOOL foundMin = NO;
+    for (NSUInteger i = 0; i < EMAS_HISTOGRAM_BUCKET_COUNT; i++) {
+        if (counts[i] == 0) {
+            continue;
+        }
+        double value = EMASHistogramBucketValue(i) * scale;
+        if (!foundMin) {
+            summary.min = value;
+            foundMin = YES;
+        }
+        summary.max = value;
+        cumulative += counts[i];
+        while (nextPercentile < 3 && cumulative >= ranks[nextPercentile]) {
+            values[nextPercentile++] = value;
+        }
+    }
+    summary.p50 = values[0];
+    summary.p90 = values[1];
+    summary.p99 = values[2];
+    return summary;
+}
+
+@end
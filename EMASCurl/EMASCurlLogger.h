@@ -30,6 +30,14 @@ NS_ASSUME_NONNULL_BEGIN
 // 获取当前日志处理器
 + (nullable EMASCurlLogHandlerBlock)currentLogHandler;
 
+// 设置滚动日志文件目录，nil表示不写文件；当前文件超过maxFileSize字节后滚动，最多保留maxFileCount个文件
++ (void)setLogFileDirectory:(nullable NSString *)directory
+                maxFileSize:(unsigned long long)maxFileSize
+               maxFileCount:(NSUInteger)maxFileCount;
+
+// 在当前线程同步输出所有已记录的日志，不能在日志处理器中调用
++ (void)flush;
+
 @end
 
 // 便捷的日志记录宏 - 使用全局函数避免宏参数问题
@@ -43,6 +51,8 @@ NS_ASSUME_NONNULL_BEGIN
     EMASCurlLog(EMASCurlLogLevelDebug, component, format, ##__VA_ARGS__)
 
 // 内部使用的函数声明，供宏调用
+// 调用线程只把级别、组件、格式串和参数写入本线程的环形缓冲区，格式化与输出在后台线程完成；
+// %@参数被持有到输出时，除字符串外的可变对象按输出时的内容格式化
 void EMASCurlLog(EMASCurlLogLevel level, NSString *component, NSString *format, ...);
 
 NS_ASSUME_NONNULL_END
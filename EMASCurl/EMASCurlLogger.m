@@ -6,14 +6,557 @@
 //
 
 #import "EMASCurlLogger.h"
+#import <pthread.h>
+#import <stdatomic.h>
+#include <ctype.h>
+#include <fcntl.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+// 记录定长，参数按类型原样保存，格式化推迟到后台线程
+#define EMAS_LOG_RECORD_SIZE 256
+#define EMAS_LOG_MAX_ARGS 12
+// 每个线程一个环形缓冲区，容量须为2的幂
+#define EMAS_LOG_RING_CAPACITY 128
+// 参数无法按类型保存（*宽度、位置参数、过长的%s等）时，在调用线程格式化后只保存结果
+#define EMAS_LOG_PREFORMATTED 0xFF
+// %s参数为NULL
+#define EMAS_LOG_NULL_STRING UINT64_MAX
+
+// 有日志时消费线程攒批的间隔，以及空闲时的最长休眠
+static const int64_t kEMASLogBatchIntervalNs = 5 * NSEC_PER_MSEC;
+static const int64_t kEMASLogIdleIntervalNs = 100 * NSEC_PER_MSEC;
+
+static NSString * const kEMASLogFileBaseName = @"emascurl";
+
+typedef NS_ENUM(uint8_t, EMASLogArgType) {
+    EMASLogArgInt32 = 1,
+    EMASLogArgInt64,
+    EMASLogArgDouble,
+    EMASLogArgCString,
+    EMASLogArgObject,
+    EMASLogArgPointer,
+};
+
+typedef struct {
+    uint64_t timestampNs;
+    // 以下两个对象指针均持有一次引用，消费后释放
+    void *component;
+    // argCount为EMAS_LOG_PREFORMATTED时是格式化好的消息
+    void *format;
+    uint8_t level;
+    uint8_t argCount;
+    uint8_t argTypes[EMAS_LOG_MAX_ARGS];
+    uint16_t stringBytes;
+    // %s参数保存为strings中的偏移
+    uint64_t args[EMAS_LOG_MAX_ARGS];
+    char strings[EMAS_LOG_RECORD_SIZE - 40 - 8 * EMAS_LOG_MAX_ARGS];
+} EMASLogRecord;
+
+_Static_assert(sizeof(EMASLogRecord) == EMAS_LOG_RECORD_SIZE, "EMASLogRecord must be fixed size");
+
+// 单生产者单消费者：所属线程写tail，消费者写head
+typedef struct EMASLogRing {
+    _Atomic uint64_t head;
+    _Alignas(64) _Atomic uint64_t tail;
+    // 线程退出后置为false，缓冲区留给新线程复用，未消费的记录照常输出
+    _Atomic bool owned;
+    // 只由持有s_drainLock的消费者读写
+    uint64_t drainLimit;
+    struct EMASLogRing *next;
+    EMASLogRecord records[EMAS_LOG_RING_CAPACITY];
+} EMASLogRing;
+
+// 级别检查在调用线程上，放在C全局变量中避免消息发送
+static _Atomic NSInteger s_logLevel = EMASCurlLogLevelError;
+
+// 缓冲区链表只在表头插入、从不删除
+static _Atomic(EMASLogRing *) s_rings = NULL;
+static pthread_key_t s_ringKey;
+static _Atomic uint64_t s_droppedCount = 0;
+static _Atomic bool s_consumerSleeping = false;
+static dispatch_semaphore_t s_consumerSemaphore;
+
+// 消费者互斥：后台线程与flush不会同时读取同一缓冲区；文件输出的状态也由它保护
+static pthread_mutex_t s_drainLock = PTHREAD_MUTEX_INITIALIZER;
+
+// 单调时钟与墙上时间的对应关系，启动时取一次
+static uint64_t s_anchorMonotonicNs;
+static NSTimeInterval s_anchorTimeIntervalSince1970;
+
+// 滚动文件输出，均受s_drainLock保护
+static NSString *s_logFileDirectory;
+static unsigned long long s_logFileMaxSize;
+static NSUInteger s_logFileMaxCount;
+static int s_logFileDescriptor = -1;
+static unsigned long long s_logFileSize;
 
 @interface EMASCurlLogger ()
 
-@property (atomic, assign) EMASCurlLogLevel currentLogLevel;
 @property (atomic, copy, nullable) EMASCurlLogHandlerBlock logHandler;
 
++ (NSString *)stringForLogLevel:(EMASCurlLogLevel)level;
+
 @end
 
+#pragma mark - 格式说明符解析
+
+typedef struct {
+    // 转换字符，如d、f、@
+    char conversion;
+    // l/ll/q/z/t/j的个数，非0时整数按64位读取
+    int longness;
+    BOOL longDouble;
+    // *宽度/精度或位置参数，无法按类型保存
+    BOOL unsupported;
+    // 转换字符之后的位置
+    const char *end;
+} EMASLogSpecifier;
+
+// p指向'%'之后
+static EMASLogSpecifier EMASLogParseSpecifier(const char *p) {
+    EMASLogSpecifier spec = {0};
+    while (*p && strchr("-+ #0'", *p)) {
+        p++;
+    }
+    while (isdigit((unsigned char)*p)) {
+        p++;
+    }
+    if (*p == '$' || *p == '*') {
+        spec.unsupported = YES;
+    }
+    if (*p == '.') {
+        p++;
+        if (*p == '*') {
+            spec.unsupported = YES;
+        }
+        while (isdigit((unsigned char)*p)) {
+            p++;
+        }
+    }
+    while (*p && strchr("hlqztjL", *p)) {
+        if (*p == 'L') {
+            spec.longDouble = YES;
+        } else if (*p != 'h') {
+            spec.longness++;
+        }
+        p++;
+    }
+    spec.conversion = *p;
+    spec.end = *p ? p + 1 : p;
+    return spec;
+}
+
+static void EMASLogReleaseArguments(EMASLogRecord *record) {
+    if (record->argCount == EMAS_LOG_PREFORMATTED) {
+        return;
+    }
+    for (uint8_t i = 0; i < record->argCount; i++) {
+        if (record->argTypes[i] == EMASLogArgObject && record->args[i]) {
+            CFRelease((CFTypeRef)(uintptr_t)record->args[i]);
+        }
+    }
+    record->argCount = 0;
+}
+
+// 按格式串读取参数写入记录；返回NO时已保存的对象参数由调用方释放
+static BOOL EMASLogEncodeArguments(EMASLogRecord *record, const char *fmt, va_list args) {
+    record->argCount = 0;
+    record->stringBytes = 0;
+    const char *p = fmt;
+    while ((p = strchr(p, '%'))) {
+        p++;
+        if (*p == '%') {
+            p++;
+            continue;
+        }
+        EMASLogSpecifier spec = EMASLogParseSpecifier(p);
+        if (spec.unsupported || record->argCount == EMAS_LOG_MAX_ARGS) {
+            return NO;
+        }
+
+        uint8_t index = record->argCount;
+        uint64_t value = 0;
+        EMASLogArgType type;
+        switch (spec.conversion) {
+            case 'd': case 'i': case 'o': case 'u': case 'x': case 'X':
+                if (spec.longness > 0) {
+                    value = (uint64_t)va_arg(args, long long);
+                    type = EMASLogArgInt64;
+                } else {
+                    value = (uint32_t)va_arg(args, int);
+                    type = EMASLogArgInt32;
+                }
+                break;
+            case 'c': case 'C':
+                if (spec.longness > 0) {
+                    return NO;
+                }
+                value = (uint32_t)va_arg(args, int);
+                type = EMASLogArgInt32;
+                break;
+            case 'f': case 'F': case 'e': case 'E': case 'g': case 'G': case 'a': case 'A': {
+                if (spec.longDouble) {
+                    return NO;
+                }
+                double number = va_arg(args, double);
+                memcpy(&value, &number, sizeof(value));
+                type = EMASLogArgDouble;
+                break;
+            }
+            case 's': {
+                if (spec.longness > 0) {
+                    return NO;
+                }
+                const char *string = va_arg(args, const char *);
+                if (!string) {
+                    value = EMAS_LOG_NULL_STRING;
+                } else {
+                    size_t length = strlen(string) + 1;
+                    if (length > sizeof(record->strings) - record->stringBytes) {
+                        return NO;
+                    }
+                    memcpy(record->strings + record->stringBytes, string, length);
+                    value = record->stringBytes;
+                    record->stringBytes += length;
+                }
+                type = EMASLogArgCString;
+                break;
+            }
+            case '@': {
+                id object = va_arg(args, id);
+                // 字符串可能是可变的，copy保留当前内容；不可变字符串的copy只是retain
+                if ([object isKindOfClass:[NSString class]]) {
+                    object = [object copy];
+                }
+                value = (uint64_t)(uintptr_t)(__bridge_retained void *)object;
+                type = EMASLogArgObject;
+                break;
+            }
+            case 'p':
+                value = (uint64_t)(uintptr_t)va_arg(args, void *);
+                type = EMASLogArgPointer;
+                break;
+            default:
+                return NO;
+        }
+        record->args[index] = value;
+        record->argTypes[index] = type;
+        record->argCount = index + 1;
+        p = spec.end;
+    }
+    return YES;
+}
+
+static NSString *EMASLogFormatArgument(const EMASLogRecord *record, uint8_t index, NSString *spec) {
+    uint64_t value = record->args[index];
+    switch ((EMASLogArgType)record->argTypes[index]) {
+        case EMASLogArgInt32:
+            return [NSString stringWithFormat:spec, (int)(uint32_t)value];
+        case EMASLogArgInt64:
+            return [NSString stringWithFormat:spec, (long long)value];
+        case EMASLogArgDouble: {
+            double number;
+            memcpy(&number, &value, sizeof(number));
+            return [NSString stringWithFormat:spec, number];
+        }
+        case EMASLogArgCString: {
+            const char *string = value == EMAS_LOG_NULL_STRING ? NULL : record->strings + value;
+            return [NSString stringWithFormat:spec, string];
+        }
+        case EMASLogArgObject:
+            return [NSString stringWithFormat:spec, (__bridge id)(void *)(uintptr_t)value];
+        case EMASLogArgPointer:
+            return [NSString stringWithFormat:spec, (void *)(uintptr_t)value];
+    }
+    return @"";
+}
+
+static void EMASLogAppendBytes(NSMutableString *message, const char *bytes, size_t length) {
+    if (length == 0) {
+        return;
+    }
+    NSString *segment = [[NSString alloc] initWithBytes:bytes length:length encoding:NSUTF8StringEncoding];
+    if (segment) {
+        [message appendString:segment];
+    }
+}
+
+// 按格式串逐个说明符格式化，每个说明符单独调用一次stringWithFormat:
+static NSString *EMASLogFormatRecord(const EMASLogRecord *record) {
+    NSString *format = (__bridge NSString *)record->format;
+    if (record->argCount == EMAS_LOG_PREFORMATTED) {
+        return format;
+    }
+
+    const char *fmt = format.UTF8String;
+    NSMutableString *message = [NSMutableString string];
+    const char *literal = fmt;
+    const char *p = fmt;
+    uint8_t index = 0;
+    while ((p = strchr(p, '%'))) {
+        if (p[1] == '%') {
+            // 保留一个%
+            EMASLogAppendBytes(message, literal, p + 1 - literal);
+            p += 2;
+            literal = p;
+            continue;
+        }
+        EMASLogAppendBytes(message, literal, p - literal);
+        EMASLogSpecifier spec = EMASLogParseSpecifier(p + 1);
+        if (index < record->argCount) {
+            NSString *specString = [[NSString alloc] initWithBytes:p length:spec.end - p encoding:NSUTF8StringEncoding];
+            [message appendString:EMASLogFormatArgument(record, index++, specString)];
+        }
+        p = spec.end;
+        literal = p;
+    }
+    EMASLogAppendBytes(message, literal, strlen(literal));
+    return message;
+}
+
+#pragma mark - 滚动文件输出
+
+static NSString *EMASLogFilePath(NSUInteger index) {
+    NSString *name = index == 0
+        ? [kEMASLogFileBaseName stringByAppendingString:@".log"]
+        : [NSString stringWithFormat:@"%@.%lu.log", kEMASLogFileBaseName, (unsigned long)index];
+    return [s_logFileDirectory stringByAppendingPathComponent:name];
+}
+
+static void EMASLogCloseFile(void) {
+    if (s_logFileDescriptor >= 0) {
+        close(s_logFileDescriptor);
+        s_logFileDescriptor = -1;
+    }
+}
+
+static BOOL EMASLogOpenFile(void) {
+    s_logFileDescriptor = open(EMASLogFilePath(0).fileSystemRepresentation, O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+    if (s_logFileDescriptor < 0) {
+        return NO;
+    }
+    struct stat st;
+    s_logFileSize = fstat(s_logFileDescriptor, &st) == 0 ? (unsigned long long)st.st_size : 0;
+    return YES;
+}
+
+// 当前文件写满后依次后移：emascurl.log -> emascurl.1.log -> ...，超出个数的最旧文件删除
+static void EMASLogRotateFile(void) {
+    EMASLogCloseFile();
+    unlink(EMASLogFilePath(s_logFileMaxCount - 1).fileSystemRepresentation);
+    for (NSUInteger index = s_logFileMaxCount - 1; index > 0; index--) {
+        rename(EMASLogFilePath(index - 1).fileSystemRepresentation, EMASLogFilePath(index).fileSystemRepresentation);
+    }
+    EMASLogOpenFile();
+}
+
+static void EMASLogWriteToFile(NSString *line) {
+    NSData *data = [[line stringByAppendingString:@"\n"] dataUsingEncoding:NSUTF8StringEncoding];
+    if (s_logFileDescriptor < 0 && !EMASLogOpenFile()) {
+        return;
+    }
+    if (s_logFileSize > 0 && s_logFileSize + data.length > s_logFileMaxSize) {
+        EMASLogRotateFile();
+        if (s_logFileDescriptor < 0) {
+            return;
+        }
+    }
+    ssize_t written = write(s_logFileDescriptor, data.bytes, data.length);
+    if (written > 0) {
+        s_logFileSize += (unsigned long long)written;
+    }
+}
+
+#pragma mark - 消费
+
+static NSDateFormatter *EMASLogTimestampFormatter(void) {
+    // 只在持有s_drainLock时使用
+    static NSDateFormatter *formatter;
+    if (!formatter) {
+        formatter = [[NSDateFormatter alloc] init];
+        formatter.dateFormat = @"yyyy-MM-dd HH:mm:ss.SSS";
+    }
+    return formatter;
+}
+
+static void EMASLogDeliver(EMASCurlLogLevel level, NSString *component, NSString *message, uint64_t timestampNs) {
+    EMASCurlLogHandlerBlock handler = [EMASCurlLogger currentLogHandler];
+    if (handler) {
+        handler(level, component, message);
+    }
+    if (!handler || s_logFileDirectory) {
+        NSTimeInterval time = s_anchorTimeIntervalSince1970 + (double)(int64_t)(timestampNs - s_anchorMonotonicNs) / NSEC_PER_SEC;
+        NSString *timestamp = [EMASLogTimestampFormatter() stringFromDate:[NSDate dateWithTimeIntervalSince1970:time]];
+        NSString *line = [NSString stringWithFormat:@"[%@] [%@] [%@] %@",
+                          timestamp, [EMASCurlLogger stringForLogLevel:level], component, message];
+        if (s_logFileDirectory) {
+            EMASLogWriteToFile(line);
+        } else {
+            NSLog(@"%@", line);
+        }
+    }
+}
+
+// 按时间先后合并各线程的记录并输出；只处理开始时已写入的记录，处理器中再打的日志留到下一轮
+static NSUInteger EMASLogDrain(void) {
+    pthread_mutex_lock(&s_drainLock);
+    EMASLogRing *rings = atomic_load_explicit(&s_rings, memory_order_acquire);
+    for (EMASLogRing *ring = rings; ring; ring = ring->next) {
+        ring->drainLimit = atomic_load_explicit(&ring->tail, memory_order_acquire);
+    }
+
+    NSUInteger delivered = 0;
+    for (;;) {
+        EMASLogRing *earliest = NULL;
+        uint64_t earliestTimestamp = UINT64_MAX;
+        for (EMASLogRing *ring = rings; ring; ring = ring->next) {
+            uint64_t head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+            if (head < ring->drainLimit) {
+                uint64_t timestamp = ring->records[head & (EMAS_LOG_RING_CAPACITY - 1)].timestampNs;
+                if (timestamp < earliestTimestamp) {
+                    earliest = ring;
+                    earliestTimestamp = timestamp;
+                }
+            }
+        }
+        if (!earliest) {
+            break;
+        }
+
+        uint64_t head = atomic_load_explicit(&earliest->head, memory_order_relaxed);
+        EMASLogRecord *record = &earliest->records[head & (EMAS_LOG_RING_CAPACITY - 1)];
+        @autoreleasepool {
+            NSString *component = (__bridge_transfer NSString *)record->component;
+            NSString *message = EMASLogFormatRecord(record);
+            EMASLogReleaseArguments(record);
+            CFRelease(record->format);
+            EMASLogDeliver((EMASCurlLogLevel)record->level, component, message, record->timestampNs);
+        }
+        atomic_store_explicit(&earliest->head, head + 1, memory_order_release);
+        delivered++;
+    }
+
+    uint64_t dropped = atomic_exchange_explicit(&s_droppedCount, 0, memory_order_relaxed);
+    if (dropped > 0) {
+        @autoreleasepool {
+            NSString *message = [NSString stringWithFormat:@"Dropped %llu log records because the buffer was full", dropped];
+            EMASLogDeliver(EMASCurlLogLevelError, @"EC-Logger", message, clock_gettime_nsec_np(CLOCK_UPTIME_RAW));
+        }
+    }
+    pthread_mutex_unlock(&s_drainLock);
+    return delivered;
+}
+
+static void *EMASLogConsumerMain(void *context) {
+    pthread_setname_np("com.alibaba.emascurl.logger");
+    for (;;) {
+        if (EMASLogDrain() > 0) {
+            // 刚有日志时攒一小段再处理，缓冲区过半时生产者会提前唤醒
+            dispatch_semaphore_wait(s_consumerSemaphore, dispatch_time(DISPATCH_TIME_NOW, kEMASLogBatchIntervalNs));
+            continue;
+        }
+        atomic_store_explicit(&s_consumerSleeping, true, memory_order_relaxed);
+        dispatch_semaphore_wait(s_consumerSemaphore, dispatch_time(DISPATCH_TIME_NOW, kEMASLogIdleIntervalNs));
+        atomic_store_explicit(&s_consumerSleeping, false, memory_order_relaxed);
+    }
+    return NULL;
+}
+
+static void EMASLogRingRelease(void *ring) {
+    atomic_store_explicit(&((EMASLogRing *)ring)->owned, false, memory_order_release);
+}
+
+static void EMASLogSetupOnce(void) {
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        s_anchorMonotonicNs = clock_gettime_nsec_np(CLOCK_UPTIME_RAW);
+        s_anchorTimeIntervalSince1970 = CFAbsoluteTimeGetCurrent() + kCFAbsoluteTimeIntervalSince1970;
+        pthread_key_create(&s_ringKey, EMASLogRingRelease);
+        s_consumerSemaphore = dispatch_semaphore_create(0);
+
+        pthread_attr_t attr;
+        pthread_attr_init(&attr);
+        pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+        pthread_attr_set_qos_class_np(&attr, QOS_CLASS_UTILITY, 0);
+        pthread_t thread;
+        pthread_create(&thread, &attr, EMASLogConsumerMain, NULL);
+        pthread_attr_destroy(&attr);
+    });
+}
+
+#pragma mark - 生产
+
+static EMASLogRing *EMASLogCurrentRing(void) {
+    EMASLogRing *ring = pthread_getspecific(s_ringKey);
+    if (ring) {
+        return ring;
+    }
+    // 优先复用已退出线程留下的缓冲区
+    for (ring = atomic_load_explicit(&s_rings, memory_order_acquire); ring; ring = ring->next) {
+        bool expected = false;
+        if (atomic_compare_exchange_strong_explicit(&ring->owned, &expected, true, memory_order_acquire, memory_order_relaxed)) {
+            break;
+        }
+    }
+    if (!ring) {
+        ring = calloc(1, sizeof(EMASLogRing));
+        if (!ring) {
+            return NULL;
+        }
+        atomic_init(&ring->owned, true);
+        EMASLogRing *head = atomic_load_explicit(&s_rings, memory_order_relaxed);
+        do {
+            ring->next = head;
+        } while (!atomic_compare_exchange_weak_explicit(&s_rings, &head, ring, memory_order_release, memory_order_relaxed));
+    }
+    pthread_setspecific(s_ringKey, ring);
+    return ring;
+}
+
+static void EMASLogEnqueue(EMASLogRing *ring, EMASCurlLogLevel level, NSString *component, NSString *format, va_list args) {
+    uint64_t tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+    uint64_t used = tail - atomic_load_explicit(&ring->head, memory_order_acquire);
+    if (used >= EMAS_LOG_RING_CAPACITY) {
+        atomic_fetch_add_explicit(&s_droppedCount, 1, memory_order_relaxed);
+        return;
+    }
+
+    EMASLogRecord *record = &ring->records[tail & (EMAS_LOG_RING_CAPACITY - 1)];
+    record->timestampNs = clock_gettime_nsec_np(CLOCK_UPTIME_RAW);
+    record->level = (uint8_t)level;
+
+    // 常量格式串通常可直接取到C字符串，不产生拷贝
+    const char *fmt = CFStringGetCStringPtr((__bridge CFStringRef)format, kCFStringEncodingUTF8);
+    if (!fmt) {
+        fmt = format.UTF8String;
+    }
+    va_list encodingArgs;
+    va_copy(encodingArgs, args);
+    BOOL encoded = fmt && EMASLogEncodeArguments(record, fmt, encodingArgs);
+    va_end(encodingArgs);
+
+    if (encoded) {
+        record->format = (__bridge_retained void *)format;
+    } else {
+        EMASLogReleaseArguments(record);
+        NSString *message = [[NSString alloc] initWithFormat:format arguments:args];
+        record->format = (__bridge_retained void *)message;
+        record->argCount = EMAS_LOG_PREFORMATTED;
+    }
+    record->component = (__bridge_retained void *)component;
+    atomic_store_explicit(&ring->tail, tail + 1, memory_order_release);
+
+    // 消费者休眠中或缓冲区过半时唤醒
+    if (used + 1 == EMAS_LOG_RING_CAPACITY / 2 ||
+        (atomic_load_explicit(&s_consumerSleeping, memory_order_relaxed) &&
+         atomic_exchange_explicit(&s_consumerSleeping, false, memory_order_relaxed))) {
+        dispatch_semaphore_signal(s_consumerSemaphore);
+    }
+}
+
 @implementation EMASCurlLogger
 
 + (instancetype)sharedLogger {
@@ -25,21 +568,12 @@
     return instance;
 }
 
-- (instancetype)init {
-    self = [super init];
-    if (self) {
-        // 默认日志级别设为ERROR，生产环境较为安全
-        _currentLogLevel = EMASCurlLogLevelError;
-    }
-    return self;
-}
-
 + (void)setLogLevel:(EMASCurlLogLevel)level {
-    [EMASCurlLogger sharedLogger].currentLogLevel = level;
+    atomic_store_explicit(&s_logLevel, level, memory_order_relaxed);
 }
 
 + (EMASCurlLogLevel)currentLogLevel {
-    return [EMASCurlLogger sharedLogger].currentLogLevel;
+    return (EMASCurlLogLevel)atomic_load_explicit(&s_logLevel, memory_order_relaxed);
 }
 
 + (void)setLogHandler:(nullable EMASCurlLogHandlerBlock)handler {
@@ -50,6 +584,25 @@
     return [EMASCurlLogger sharedLogger].logHandler;
 }
 
++ (void)setLogFileDirectory:(nullable NSString *)directory
+                maxFileSize:(unsigned long long)maxFileSize
+               maxFileCount:(NSUInteger)maxFileCount {
+    if (directory) {
+        [[NSFileManager defaultManager] createDirectoryAtPath:directory withIntermediateDirectories:YES attributes:nil error:nil];
+    }
+    pthread_mutex_lock(&s_drainLock);
+    EMASLogCloseFile();
+    s_logFileDirectory = [directory copy];
+    s_logFileMaxSize = maxFileSize > 0 ? maxFileSize : 1024 * 1024;
+    s_logFileMaxCount = MAX(maxFileCount, (NSUInteger)1);
+    pthread_mutex_unlock(&s_drainLock);
+}
+
++ (void)flush {
+    EMASLogSetupOnce();
+    EMASLogDrain();
+}
+
 + (NSString *)stringForLogLevel:(EMASCurlLogLevel)level {
     switch (level) {
         case EMASCurlLogLevelOff:
@@ -67,52 +620,21 @@
 
 @end
 
-// 全局函数实现，供宏调用
+// 全局函数实现，供宏调用：调用线程只写入二进制记录，格式化与输出在后台线程
 void EMASCurlLog(EMASCurlLogLevel level, NSString *component, NSString *format, ...) {
     // 检查是否需要记录此级别的日志
-    if (level > [EMASCurlLogger currentLogLevel]) {
+    if (level > atomic_load_explicit(&s_logLevel, memory_order_relaxed) || !format) {
         return;
     }
 
-    // 获取格式化的消息
+    EMASLogSetupOnce();
     va_list args;
     va_start(args, format);
-    NSString *message = [[NSString alloc] initWithFormat:format arguments:args];
-    va_end(args);
-
-    // 检查是否有自定义日志处理器
-    EMASCurlLogHandlerBlock handler = [EMASCurlLogger currentLogHandler];
-    if (handler) {
-        // 使用自定义处理器
-        handler(level, component, message);
+    EMASLogRing *ring = EMASLogCurrentRing();
+    if (ring) {
+        EMASLogEnqueue(ring, level, component ?: @"", format, args);
     } else {
-        // 默认使用 NSLog 输出（向后兼容）
-        // 生成时间戳
-        NSDateFormatter *formatter = [[NSDateFormatter alloc] init];
-        formatter.dateFormat = @"yyyy-MM-dd HH:mm:ss.SSS";
-        NSString *timestamp = [formatter stringFromDate:[NSDate date]];
-
-        // 获取日志级别字符串
-        NSString *levelString;
-        switch (level) {
-            case EMASCurlLogLevelOff:
-                levelString = @"OFF";
-                break;
-            case EMASCurlLogLevelError:
-                levelString = @"ERROR";
-                break;
-            case EMASCurlLogLevelInfo:
-                levelString = @"INFO";
-                break;
-            case EMASCurlLogLevelDebug:
-                levelString = @"DEBUG";
-                break;
-            default:
-                levelString = @"UNKNOWN";
-                break;
-        }
-
-        // 输出格式化的日志消息
-        NSLog(@"[%@] [%@] [%@] %@", timestamp, levelString, component, message);
+        atomic_fetch_add_explicit(&s_droppedCount, 1, memory_order_relaxed);
     }
+    va_end(args);
 }
@@ -7,18 +7,37 @@
 
 #import <Foundation/Foundation.h>
 #import <curl/curl.h>
+#import "EMASCurlConfiguration.h"
 
 NS_ASSUME_NONNULL_BEGIN
 
+@class EMASCurlNetworkQualityEstimator;
+
+// libcurl各阶段时间，均为从加入multi起算的累计值，单位微秒
+typedef struct {
+    // 加入multi的单调时刻（CLOCK_UPTIME_RAW，纳秒），各阶段以此为起点
+    uint64_t transferStartNs;
+    curl_off_t queue;
+    curl_off_t nameLookup;
+    curl_off_t connect;
+    curl_off_t appConnect;
+    curl_off_t preTransfer;
+    curl_off_t postTransfer;
+    curl_off_t startTransfer;
+    curl_off_t total;
+} EMASCurlPhaseTimings;
+
 @interface EMASCurlMetricsData : NSObject
 
-// 时间指标 (秒)
-@property (nonatomic, assign) double nameLookupTime;
-@property (nonatomic, assign) double connectTime;
-@property (nonatomic, assign) double appConnectTime;
-@property (nonatomic, assign) double preTransferTime;
-@property (nonatomic, assign) double startTransferTime;
-@property (nonatomic, assign) double totalTime;
+@property (nonatomic, assign) EMASCurlPhaseTimings timings;
+
+// 时间指标 (秒)，由timings换算
+@property (nonatomic, assign, readonly) double nameLookupTime;
+@property (nonatomic, assign, readonly) double connectTime;
+@property (nonatomic, assign, readonly) double appConnectTime;
+@property (nonatomic, assign, readonly) double preTransferTime;
+@property (nonatomic, assign, readonly) double startTransferTime;
+@property (nonatomic, assign, readonly) double totalTime;
 
 // 连接信息
 @property (nonatomic, assign) long httpVersion;
@@ -41,19 +60,59 @@ NS_ASSUME_NONNULL_BEGIN
 
 @end
 
+// 按网络质量推迟加入multi的条件，对应EMASCurlConfiguration中的自适应开关
+typedef NS_OPTIONS(NSUInteger, EMASCurlAdaptiveAdmission) {
+    EMASCurlAdaptiveAdmissionNone = 0,
+    EMASCurlAdaptiveAdmissionHostConcurrency = 1 << 0,  // 同一host的请求数达到上限时排队
+    EMASCurlAdaptiveAdmissionPrefetchGating = 1 << 1    // 网络差时后台请求等前台请求结束
+};
+
 @interface EMASCurlManager : NSObject
 
 + (instancetype)sharedInstance;
 
 - (void)enqueueNewEasyHandle:(CURL *)easyHandle completion:(void (^)(BOOL succeeded, NSError * _Nullable error, EMASCurlMetricsData * _Nullable metrics))completion;
 
+// priority决定带宽整形时的限速分配
+- (void)enqueueNewEasyHandle:(CURL *)easyHandle
+                    priority:(EMASCurlRequestPriority)priority
+                  completion:(void (^)(BOOL succeeded, NSError * _Nullable error, EMASCurlMetricsData * _Nullable metrics))completion;
+
+// admission不为None时，请求可能在加入multi前排队，直到网络质量估计允许。
+// 排队期间cancellationCheck返回YES时以NSURLErrorCancelled结束，超过timeout（0表示不限）时以NSURLErrorTimedOut结束
+- (void)enqueueNewEasyHandle:(CURL *)easyHandle
+                    priority:(EMASCurlRequestPriority)priority
+                        host:(nullable NSString *)host
+           adaptiveAdmission:(EMASCurlAdaptiveAdmission)admission
+                     timeout:(NSTimeInterval)timeout
+           cancellationCheck:(nullable BOOL (^)(void))cancellationCheck
+                  completion:(void (^)(BOOL succeeded, NSError * _Nullable error, EMASCurlMetricsData * _Nullable metrics))completion;
+
 /// 唤醒 multi 事件循环，常用于取消请求后尽快进入回调
 - (void)wakeup;
 
+// 在网络线程中执行block，用于访问只在网络线程读写的传输状态
+- (void)performBlockOnNetworkThread:(dispatch_block_t)block;
+
+// 在网络线程上收集连接缓存快照，completion也在网络线程上调用
+- (void)connectionPoolSnapshotWithCompletion:(void (^)(NSArray<EMASCurlConnectionInfo *> *connections))completion;
+
+// 同步获取连接缓存快照，等待网络线程收集；在网络线程上调用时直接收集
+- (NSArray<EMASCurlConnectionInfo *> *)connectionPoolSnapshot;
+
+// 恢复因read/write回调返回PAUSE而暂停的传输，句柄已结束时忽略；可在任意线程调用
+- (void)resumeEasyHandle:(CURL *)easyHandle;
+
 /// 设置单连接最大并发流数
 /// @param maxStreams 最大并发流数，默认 32
 - (void)setMaxConcurrentStreamsPerConnection:(NSInteger)maxStreams;
 
+// 替换自适应准入与样本记录所用的网络质量估计，nil恢复为共享实例；用于测试
+- (void)setNetworkQualityEstimator:(nullable EMASCurlNetworkQualityEstimator *)estimator;
+
+/// 设置是否按优先级整形带宽，默认开启
+- (void)setBandwidthShapingEnabled:(BOOL)enabled;
+
 @end
 
 NS_ASSUME_NONNULL_END
@@ -7,6 +7,11 @@
 
 #import "EMASCurlManager.h"
 #import "EMASCurlLogger.h"
+#import "EMASCurlBandwidthShaper.h"
+#import "EMASCurlLatencyHistogram.h"
+#import "EMASCurlTraceRecorder.h"
+#import "EMASCurlConnectionPool.h"
+#import "EMASCurlNetworkQualityEstimator.h"
 #import <pthread.h>
 
 #pragma mark - Share Handle Locking
@@ -39,6 +44,31 @@ static void shareUnlockCallback(CURL *handle, curl_lock_data data, void *userptr
 #pragma mark - EMASCurlMetricsData
 
 @implementation EMASCurlMetricsData
+
+- (double)nameLookupTime {
+    return _timings.nameLookup / (double)USEC_PER_SEC;
+}
+
+- (double)connectTime {
+    return _timings.connect / (double)USEC_PER_SEC;
+}
+
+- (double)appConnectTime {
+    return _timings.appConnect / (double)USEC_PER_SEC;
+}
+
+- (double)preTransferTime {
+    return _timings.preTransfer / (double)USEC_PER_SEC;
+}
+
+- (double)startTransferTime {
+    return _timings.startTransfer / (double)USEC_PER_SEC;
+}
+
+- (double)totalTime {
+    return _timings.total / (double)USEC_PER_SEC;
+}
+
 @end
 
 static NSString * const EMASCurlErrorCodeKey = @"EMASCurlErrorCodeKey";
@@ -82,7 +112,21 @@ static NSInteger convertCurlCodeToNSURLErrorCode(CURLcode curlCode) {
 @interface EMASCurlRequest : NSObject
 
 @property (nonatomic, assign) CURL *easy;
+@property (nonatomic, assign) EMASCurlRequestPriority priority;
 @property (nonatomic, copy) void (^ _Nullable completion)(BOOL, NSError *, EMASCurlMetricsData *);
+// 开启追踪时记录的入队时刻，0表示不追踪
+@property (nonatomic, assign) uint64_t traceEnqueueNs;
+// 加入multi的单调时刻，libcurl各阶段时间以此为起点
+@property (nonatomic, assign) uint64_t addedNs;
+// 连接池跟踪所用的回调数据，须在传输期间持有
+@property (nonatomic, strong, nullable) EMASCurlPooledTransfer *pooledTransfer;
+@property (nonatomic, copy, nullable) NSString *host;
+@property (nonatomic, assign) EMASCurlAdaptiveAdmission adaptiveAdmission;
+// 推迟期间的截止时刻（单调时钟，纳秒），0表示不限
+@property (nonatomic, assign) uint64_t deadlineNs;
+@property (nonatomic, copy, nullable) BOOL (^cancellationCheck)(void);
+// 曾因写盘或上传数据积压而暂停，期间的耗时不反映链路速率
+@property (nonatomic, assign) BOOL paused;
 
 @end
 
@@ -96,6 +140,18 @@ static NSInteger convertCurlCodeToNSURLErrorCode(CURLcode curlCode) {
     NSCondition *_condition;
     NSMutableDictionary<NSNumber *, EMASCurlRequest *> *_requestsByHandle;
     NSMutableArray<EMASCurlRequest *> *_pendingAddQueue;
+    NSMutableArray<dispatch_block_t> *_pendingBlocks;
+    // 只在网络线程访问
+    EMASCurlBandwidthShaper *_bandwidthShaper;
+    EMASCurlConnectionPool *_connectionPool;
+    // 因自适应准入而推迟的请求，按入队顺序
+    NSMutableArray<EMASCurlRequest *> *_deferredRequests;
+    NSCountedSet<NSString *> *_activeTransfersByHost;
+    NSUInteger _foregroundTransferCount;
+    NSUInteger _backgroundTransferCount;
+    // 推迟的请求中最早的截止时刻，0表示没有；网络线程据此缩短等待
+    uint64_t _nextDeferredDeadlineNs;
+    EMASCurlNetworkQualityEstimator *_qualityEstimator;
 }
 
 @end
@@ -149,6 +205,12 @@ static NSInteger convertCurlCodeToNSURLErrorCode(CURLcode curlCode) {
 
         _requestsByHandle = [NSMutableDictionary dictionary];
         _pendingAddQueue = [NSMutableArray array];
+        _pendingBlocks = [NSMutableArray array];
+        _bandwidthShaper = [[EMASCurlBandwidthShaper alloc] init];
+        _connectionPool = [[EMASCurlConnectionPool alloc] init];
+        _deferredRequests = [NSMutableArray array];
+        _activeTransfersByHost = [NSCountedSet set];
+        _qualityEstimator = [EMASCurlNetworkQualityEstimator sharedInstance];
 
         _condition = [[NSCondition alloc] init];
         _networkThread = [[NSThread alloc] initWithTarget:self selector:@selector(networkThreadEntry) object:nil];
@@ -161,11 +223,44 @@ static NSInteger convertCurlCodeToNSURLErrorCode(CURLcode curlCode) {
 }
 
 - (void)enqueueNewEasyHandle:(CURL *)easyHandle completion:(void (^)(BOOL, NSError *, EMASCurlMetricsData *))completion {
+    [self enqueueNewEasyHandle:easyHandle priority:EMASCurlRequestPriorityDefault completion:completion];
+}
+
+- (void)enqueueNewEasyHandle:(CURL *)easyHandle
+                    priority:(EMASCurlRequestPriority)priority
+                  completion:(void (^)(BOOL, NSError *, EMASCurlMetricsData *))completion {
+    [self enqueueNewEasyHandle:easyHandle
+                      priority:priority
+                          host:nil
+             adaptiveAdmission:EMASCurlAdaptiveAdmissionNone
+                       timeout:0
+             cancellationCheck:nil
+                    completion:completion];
+}
+
+- (void)enqueueNewEasyHandle:(CURL *)easyHandle
+                    priority:(EMASCurlRequestPriority)priority
+                        host:(NSString *)host
+           adaptiveAdmission:(EMASCurlAdaptiveAdmission)admission
+                     timeout:(NSTimeInterval)timeout
+           cancellationCheck:(BOOL (^)(void))cancellationCheck
+                  completion:(void (^)(BOOL, NSError *, EMASCurlMetricsData *))completion {
     curl_easy_setopt(easyHandle, CURLOPT_SHARE, _shareHandle);
 
     EMASCurlRequest *request = [[EMASCurlRequest alloc] init];
     request.easy = easyHandle;
+    request.priority = priority;
+    request.host = host.lowercaseString;
+    request.adaptiveAdmission = admission;
     request.completion = completion;
+    if (admission != EMASCurlAdaptiveAdmissionNone) {
+        // 只有可能被推迟的请求需要；加入multi后由libcurl的超时与progress回调处理
+        request.deadlineNs = timeout > 0 ? EMASCurlTraceNow() + (uint64_t)(timeout * NSEC_PER_SEC) : 0;
+        request.cancellationCheck = cancellationCheck;
+    }
+    if (EMASCurlTraceIsEnabled()) {
+        request.traceEnqueueNs = EMASCurlTraceNow();
+    }
 
     [_condition lock];
     [_pendingAddQueue addObject:request];
@@ -186,7 +281,7 @@ static NSInteger convertCurlCodeToNSURLErrorCode(CURLcode curlCode) {
     while (YES) {
         @autoreleasepool {
             // 单轮循环创建独立的 autorelease 池，避免常驻线程的自动释放对象累积
-            if (_requestsByHandle.count == 0 && _pendingAddQueue.count == 0) {
+            if (_requestsByHandle.count == 0 && _pendingAddQueue.count == 0 && _pendingBlocks.count == 0 && _deferredRequests.count == 0) {
                 EMAS_LOG_DEBUG(@"EC-Manager", @"No pending requests, waiting for new work");
                 // 为避免"高QoS线程等待低QoS线程"导致的优先级反转告警，这里在进入阻塞等待前临时降低QoS；
                 // 被唤醒后立刻恢复到较高QoS以尽快处理请求。
@@ -197,7 +292,16 @@ static NSInteger convertCurlCodeToNSURLErrorCode(CURLcode curlCode) {
 
             [self drainPendingAddQueueLocked];
 
+            [self runPendingBlocksLocked];
+
+            NSUInteger runningCount = _requestsByHandle.count;
             [self processCurlMessages];
+            // 有传输结束时立即重新检查推迟的请求，不必等下一轮poll
+            if (_deferredRequests.count > 0 && _requestsByHandle.count < runningCount) {
+                [self drainPendingAddQueueLocked];
+            }
+
+            [_bandwidthShaper tick];
 
             if (_requestsByHandle.count > 0) {
                 long timeoutMs = -1;
@@ -215,6 +319,12 @@ static NSInteger convertCurlCodeToNSURLErrorCode(CURLcode curlCode) {
                 } else {
                     waitMs = (int)MIN(timeoutMs, 1000);
                 }
+                // 推迟的请求到期时须及时醒来结束它
+                if (_nextDeferredDeadlineNs > 0) {
+                    uint64_t now = EMASCurlTraceNow();
+                    uint64_t untilDeadlineMs = _nextDeferredDeadlineNs > now ? (_nextDeferredDeadlineNs - now + NSEC_PER_MSEC - 1) / NSEC_PER_MSEC : 0;
+                    waitMs = (int)MIN((uint64_t)waitMs, untilDeadlineMs);
+                }
 
                 [_condition unlock];
 
@@ -234,34 +344,197 @@ static NSInteger convertCurlCodeToNSURLErrorCode(CURLcode curlCode) {
 }
 
 - (void)drainPendingAddQueueLocked {
+    // 先按入队顺序重新检查推迟的请求，再处理新入队的请求
+    _nextDeferredDeadlineNs = 0;
+    if (_deferredRequests.count > 0) {
+        NSArray<EMASCurlRequest *> *deferred = [_deferredRequests copy];
+        [_deferredRequests removeAllObjects];
+        for (EMASCurlRequest *request in deferred) {
+            [self admitRequest:request];
+        }
+    }
 
     while (_pendingAddQueue.count > 0) {
         EMASCurlRequest *request = _pendingAddQueue.firstObject;
         [_pendingAddQueue removeObjectAtIndex:0];
+        [self admitRequest:request];
+    }
+}
 
-        CURLMcode addResult = curl_multi_add_handle(_multiHandle, request.easy);
-        if (addResult != CURLM_OK) {
-            EMAS_LOG_ERROR(@"EC-Manager", @"Failed to add easy handle: %s", curl_multi_strerror(addResult));
+// 推迟的请求尚未加入multi，libcurl的超时与progress回调都不会生效，这里结束已取消或已到期的请求
+- (BOOL)finishDeferredRequestIfNeeded:(EMASCurlRequest *)request {
+    NSInteger errorCode = 0;
+    if (request.cancellationCheck && request.cancellationCheck()) {
+        errorCode = NSURLErrorCancelled;
+    } else if (request.deadlineNs > 0 && EMASCurlTraceNow() >= request.deadlineNs) {
+        errorCode = NSURLErrorTimedOut;
+    } else {
+        return NO;
+    }
 
-            NSError *error = [NSError errorWithDomain:@"EMASCurlManager"
-                                                 code:addResult
-                                             userInfo:@{NSLocalizedDescriptionKey: @(curl_multi_strerror(addResult))}];
+    char *urlp = NULL;
+    curl_easy_getinfo(request.easy, CURLINFO_EFFECTIVE_URL, &urlp);
+    NSString *url = urlp ? @(urlp) : @"unknown URL";
+    EMAS_LOG_INFO(@"EC-Manager", @"Deferred request %@ for URL: %@", errorCode == NSURLErrorCancelled ? @"cancelled" : @"timed out", url);
+
+    NSError *error = [NSError errorWithDomain:NSURLErrorDomain
+                                         code:errorCode
+                                     userInfo:@{NSURLErrorFailingURLStringErrorKey: url}];
+    curl_easy_cleanup(request.easy);
+
+    void (^completion)(BOOL, NSError *, EMASCurlMetricsData *) = request.completion;
+    if (completion) {
+        dispatch_async(dispatch_get_global_queue(QOS_CLASS_DEFAULT, 0), ^{
+            completion(NO, error, nil);
+        });
+    }
+    return YES;
+}
 
-            curl_easy_cleanup(request.easy);
+- (BOOL)shouldDeferRequest:(EMASCurlRequest *)request {
+    EMASCurlAdaptiveAdmission admission = request.adaptiveAdmission;
+    if (admission == EMASCurlAdaptiveAdmissionNone) {
+        return NO;
+    }
+    EMASCurlNetworkQualityEstimator *estimator = _qualityEstimator;
 
-            void (^completion)(BOOL, NSError *, EMASCurlMetricsData *) = request.completion;
-            if (completion) {
-                dispatch_async(dispatch_get_global_queue(QOS_CLASS_DEFAULT, 0), ^{
-                    completion(NO, error, nil);
-                });
-            }
-            continue;
+    if ((admission & EMASCurlAdaptiveAdmissionPrefetchGating) &&
+        request.priority == EMASCurlRequestPriorityBackground &&
+        (_foregroundTransferCount > 0 || _backgroundTransferCount > 0) &&
+        [estimator shouldDeferBackgroundTransfers]) {
+        return YES;
+    }
+
+    if ((admission & EMASCurlAdaptiveAdmissionHostConcurrency) && request.host) {
+        NSUInteger limit = [estimator maxConcurrentTransfersPerHost];
+        if (limit > 0 && [_activeTransfersByHost countForObject:request.host] >= limit) {
+            return YES;
         }
+    }
+    return NO;
+}
+
+- (void)admitRequest:(EMASCurlRequest *)request {
+    if ([self shouldDeferRequest:request]) {
+        if ([self finishDeferredRequestIfNeeded:request]) {
+            return;
+        }
+        [_deferredRequests addObject:request];
+        if (request.deadlineNs > 0 && (_nextDeferredDeadlineNs == 0 || request.deadlineNs < _nextDeferredDeadlineNs)) {
+            _nextDeferredDeadlineNs = request.deadlineNs;
+        }
+        return;
+    }
 
-        NSNumber *easyKey = @((uintptr_t)request.easy);
-        _requestsByHandle[easyKey] = request;
-        EMAS_LOG_DEBUG(@"EC-Manager", @"Easy handle added to multi handle successfully (total running: %lu)", (unsigned long)_requestsByHandle.count);
+    request.pooledTransfer = [_connectionPool attachToEasyHandle:request.easy];
+    CURLMcode addResult = curl_multi_add_handle(_multiHandle, request.easy);
+    if (addResult != CURLM_OK) {
+        EMAS_LOG_ERROR(@"EC-Manager", @"Failed to add easy handle: %s", curl_multi_strerror(addResult));
+
+        NSError *error = [NSError errorWithDomain:@"EMASCurlManager"
+                                             code:addResult
+                                         userInfo:@{NSLocalizedDescriptionKey: @(curl_multi_strerror(addResult))}];
+
+        curl_easy_cleanup(request.easy);
+
+        void (^completion)(BOOL, NSError *, EMASCurlMetricsData *) = request.completion;
+        if (completion) {
+            dispatch_async(dispatch_get_global_queue(QOS_CLASS_DEFAULT, 0), ^{
+                completion(NO, error, nil);
+            });
+        }
+        return;
     }
+
+    NSNumber *easyKey = @((uintptr_t)request.easy);
+    _requestsByHandle[easyKey] = request;
+    request.addedNs = EMASCurlTraceNow();
+    [_bandwidthShaper addTransfer:request.easy priority:request.priority];
+    [self trackAdmittedRequest:request added:YES];
+    EMAS_LOG_DEBUG(@"EC-Manager", @"Easy handle added to multi handle successfully (total running: %lu)", (unsigned long)_requestsByHandle.count);
+}
+
+// 维护自适应准入所需的计数，只在网络线程调用
+- (void)trackAdmittedRequest:(EMASCurlRequest *)request added:(BOOL)added {
+    if (!request) {
+        return;
+    }
+    if (request.priority == EMASCurlRequestPriorityBackground) {
+        _backgroundTransferCount = added ? _backgroundTransferCount + 1 : _backgroundTransferCount - 1;
+    } else {
+        _foregroundTransferCount = added ? _foregroundTransferCount + 1 : _foregroundTransferCount - 1;
+    }
+    if (request.host) {
+        if (added) {
+            [_activeTransfersByHost addObject:request.host];
+        } else {
+            [_activeTransfersByHost removeObject:request.host];
+        }
+    }
+}
+
+- (void)performBlockOnNetworkThread:(dispatch_block_t)block {
+    if (!block) {
+        return;
+    }
+
+    [_condition lock];
+    [_pendingBlocks addObject:[block copy]];
+    [_condition signal];
+    [_condition unlock];
+
+    curl_multi_wakeup(_multiHandle);
+}
+
+- (void)connectionPoolSnapshotWithCompletion:(void (^)(NSArray<EMASCurlConnectionInfo *> *))completion {
+    if (!completion) {
+        return;
+    }
+    [self performBlockOnNetworkThread:^{
+        completion([self->_connectionPool snapshot]);
+    }];
+}
+
+- (NSArray<EMASCurlConnectionInfo *> *)connectionPoolSnapshot {
+    if ([NSThread currentThread] == _networkThread) {
+        return [_connectionPool snapshot];
+    }
+
+    __block NSArray<EMASCurlConnectionInfo *> *snapshot = nil;
+    dispatch_semaphore_t semaphore = dispatch_semaphore_create(0);
+    [self connectionPoolSnapshotWithCompletion:^(NSArray<EMASCurlConnectionInfo *> *connections) {
+        snapshot = connections;
+        dispatch_semaphore_signal(semaphore);
+    }];
+    dispatch_semaphore_wait(semaphore, DISPATCH_TIME_FOREVER);
+    return snapshot;
+}
+
+- (void)resumeEasyHandle:(CURL *)easyHandle {
+    [self performBlockOnNetworkThread:^{
+        // 在网络线程上执行，_requestsByHandle只在该线程修改
+        EMASCurlRequest *request = self->_requestsByHandle[@((uintptr_t)easyHandle)];
+        if (request) {
+            // 暂停由回调返回PAUSE触发，恢复一定经过这里
+            request.paused = YES;
+            curl_easy_pause(easyHandle, CURLPAUSE_CONT);
+        }
+    }];
+}
+
+- (void)runPendingBlocksLocked {
+    if (_pendingBlocks.count == 0) {
+        return;
+    }
+    NSArray<dispatch_block_t> *blocks = [_pendingBlocks copy];
+    [_pendingBlocks removeAllObjects];
+
+    // 执行期间释放锁，block内可以再次入队请求或block
+    [_condition unlock];
+    for (dispatch_block_t block in blocks) {
+        block();
+    }
+    [_condition lock];
 }
 
 - (void)processCurlMessages {
@@ -317,7 +590,16 @@ static NSInteger convertCurlCodeToNSURLErrorCode(CURLcode curlCode) {
                 }
             }
 
-            EMASCurlMetricsData *metrics = [self extractMetricsForEasyHandle:easy];
+            EMASCurlMetricsData *metrics = [self extractMetricsForEasyHandle:easy addedNs:request.addedNs];
+            if (request.traceEnqueueNs) {
+                [self recordTracePhasesForRequest:request timings:metrics.timings];
+            }
+            [_bandwidthShaper removeTransfer:easy];
+            [_connectionPool transferDidFinish:request.pooledTransfer metrics:metrics];
+            [self trackAdmittedRequest:request added:NO];
+            // 后台传输可能被带宽整形限速，暂停过的传输含有等待时间，二者的吞吐都不代表链路能力
+            BOOL sampleThroughput = request.priority != EMASCurlRequestPriorityBackground && !request.paused;
+            [_qualityEstimator recordMetrics:metrics result:msg->data.result sampleThroughput:sampleThroughput];
 
             curl_multi_remove_handle(_multiHandle, easy);
             // easy 句柄必须在从 multi 中移除后再 cleanup，避免并发销毁
@@ -334,23 +616,26 @@ static NSInteger convertCurlCodeToNSURLErrorCode(CURLcode curlCode) {
     }
 }
 
-- (EMASCurlMetricsData *)extractMetricsForEasyHandle:(CURL *)easy {
+- (EMASCurlMetricsData *)extractMetricsForEasyHandle:(CURL *)easy addedNs:(uint64_t)addedNs {
     // cleanup 前必须调用，避免访问已释放的 easy 句柄
     EMASCurlMetricsData *metrics = [[EMASCurlMetricsData alloc] init];
 
-    double nameLookupTime = 0, connectTime = 0, appConnectTime = 0;
-    double preTransferTime = 0, startTransferTime = 0, totalTime = 0;
+    // 取整数微秒，避免double在长耗时下的精度损失
+    EMASCurlPhaseTimings timings = {0};
+    timings.transferStartNs = addedNs;
     long httpVersion = 0, primaryPort = 0, localPort = 0;
     long numConnects = 0, requestSize = 0, headerSize = 0, usedProxy = 0;
     curl_off_t uploadBytes = 0, downloadBytes = 0;
     char *primaryIP = NULL, *localIP = NULL;
 
-    curl_easy_getinfo(easy, CURLINFO_NAMELOOKUP_TIME, &nameLookupTime);
-    curl_easy_getinfo(easy, CURLINFO_CONNECT_TIME, &connectTime);
-    curl_easy_getinfo(easy, CURLINFO_APPCONNECT_TIME, &appConnectTime);
-    curl_easy_getinfo(easy, CURLINFO_PRETRANSFER_TIME, &preTransferTime);
-    curl_easy_getinfo(easy, CURLINFO_STARTTRANSFER_TIME, &startTransferTime);
-    curl_easy_getinfo(easy, CURLINFO_TOTAL_TIME, &totalTime);
+    curl_easy_getinfo(easy, CURLINFO_QUEUE_TIME_T, &timings.queue);
+    curl_easy_getinfo(easy, CURLINFO_NAMELOOKUP_TIME_T, &timings.nameLookup);
+    curl_easy_getinfo(easy, CURLINFO_CONNECT_TIME_T, &timings.connect);
+    curl_easy_getinfo(easy, CURLINFO_APPCONNECT_TIME_T, &timings.appConnect);
+    curl_easy_getinfo(easy, CURLINFO_PRETRANSFER_TIME_T, &timings.preTransfer);
+    curl_easy_getinfo(easy, CURLINFO_POSTTRANSFER_TIME_T, &timings.postTransfer);
+    curl_easy_getinfo(easy, CURLINFO_STARTTRANSFER_TIME_T, &timings.startTransfer);
+    curl_easy_getinfo(easy, CURLINFO_TOTAL_TIME_T, &timings.total);
     curl_easy_getinfo(easy, CURLINFO_HTTP_VERSION, &httpVersion);
     curl_easy_getinfo(easy, CURLINFO_PRIMARY_IP, &primaryIP);
     curl_easy_getinfo(easy, CURLINFO_PRIMARY_PORT, &primaryPort);
@@ -369,12 +654,7 @@ static NSInteger convertCurlCodeToNSURLErrorCode(CURLcode curlCode) {
     curl_easy_getinfo(easy, CURLINFO_REDIRECT_COUNT, &redirectCount);
     curl_easy_getinfo(easy, CURLINFO_EFFECTIVE_URL, &effectiveURLStr);
 
-    metrics.nameLookupTime = nameLookupTime;
-    metrics.connectTime = connectTime;
-    metrics.appConnectTime = appConnectTime;
-    metrics.preTransferTime = preTransferTime;
-    metrics.startTransferTime = startTransferTime;
-    metrics.totalTime = totalTime;
+    metrics.timings = timings;
     metrics.httpVersion = httpVersion;
     metrics.primaryIP = primaryIP ? [NSString stringWithUTF8String:primaryIP] : nil;
     metrics.primaryPort = primaryPort;
@@ -389,9 +669,44 @@ static NSInteger convertCurlCodeToNSURLErrorCode(CURLcode curlCode) {
     metrics.redirectCount = redirectCount;
     metrics.effectiveURL = effectiveURLStr ? @(effectiveURLStr) : nil;
 
+    [[EMASCurlLatencyHistograms sharedInstance] recordMetrics:metrics];
+
     return metrics;
 }
 
+// libcurl的各阶段时间是从传输开始的累计值，以加入multi的时刻为基准还原各阶段起止
+- (void)recordTracePhasesForRequest:(EMASCurlRequest *)request timings:(EMASCurlPhaseTimings)timings {
+    char *privateData = NULL;
+    curl_easy_getinfo(request.easy, CURLINFO_PRIVATE, &privateData);
+    // 分段下载的分段复制自主请求句柄，与主请求在同一条轨道；未设置追踪ID的传输单独占一条轨道
+    uint64_t requestId = privateData ? (uint64_t)(uintptr_t)privateData : EMASCurlTraceNextRequestId();
+
+    // 单位为微秒；复用连接时解析、建连阶段为0，跳过不记录
+    uint64_t base = timings.transferStartNs;
+    uint64_t (^at)(curl_off_t) = ^uint64_t(curl_off_t us) {
+        return base + (uint64_t)MAX(us, 0) * NSEC_PER_USEC;
+    };
+    EMASCurlTraceRecordSpan(requestId, EMASCurlTracePhaseQueue, request.traceEnqueueNs, at(timings.queue), NULL);
+    if (timings.nameLookup > timings.queue) {
+        EMASCurlTraceRecordSpan(requestId, EMASCurlTracePhaseNameLookup, at(timings.queue), at(timings.nameLookup), NULL);
+    }
+    if (timings.connect > timings.nameLookup) {
+        EMASCurlTraceRecordSpan(requestId, EMASCurlTracePhaseConnect, at(timings.nameLookup), at(timings.connect), NULL);
+    }
+    if (timings.appConnect > timings.connect) {
+        EMASCurlTraceRecordSpan(requestId, EMASCurlTracePhaseSecureConnection, at(timings.connect), at(timings.appConnect), NULL);
+    }
+    if (timings.preTransfer > 0 && timings.postTransfer >= timings.preTransfer) {
+        EMASCurlTraceRecordSpan(requestId, EMASCurlTracePhaseRequestSend, at(timings.preTransfer), at(timings.postTransfer), NULL);
+    }
+    if (timings.startTransfer > timings.postTransfer) {
+        EMASCurlTraceRecordSpan(requestId, EMASCurlTracePhaseTimeToFirstByte, at(timings.postTransfer), at(timings.startTransfer), NULL);
+    }
+    if (timings.startTransfer > 0 && timings.total >= timings.startTransfer) {
+        EMASCurlTraceRecordSpan(requestId, EMASCurlTracePhaseBodyDownload, at(timings.startTransfer), at(timings.total), NULL);
+    }
+}
+
 - (void)wakeup {
     // 唤醒等待，促使尽快进入 perform/回调。无需持锁即可安全调用。
     if (_multiHandle) {
@@ -411,4 +726,18 @@ static NSInteger convertCurlCodeToNSURLErrorCode(CURLcode curlCode) {
     EMAS_LOG_INFO(@"EC-Manager", @"Set max concurrent streams per connection to %ld", (long)maxStreams);
 }
 
+- (void)setNetworkQualityEstimator:(EMASCurlNetworkQualityEstimator *)estimator {
+    EMASCurlNetworkQualityEstimator *resolved = estimator ?: [EMASCurlNetworkQualityEstimator sharedInstance];
+    [self performBlockOnNetworkThread:^{
+        self->_qualityEstimator = resolved;
+    }];
+}
+
+- (void)setBandwidthShapingEnabled:(BOOL)enabled {
+    [self performBlockOnNetworkThread:^{
+        self->_bandwidthShaper.enabled = enabled;
+    }];
+    EMAS_LOG_INFO(@"EC-Manager", @"Bandwidth shaping %@", enabled ? @"enabled" : @"disabled");
+}
+
 @end
@@ -0,0 +1,42 @@
+//
+//  EMASCurlMemoryPressureManager.h
+//  EMASCurl
+//
+//  Created by xuyecan on 2026/10/18.
+//
+
+#import <Foundation/Foundation.h>
+#import "EMASCurlConfiguration.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ * 组件的内存释放回调。处理完成后（可在任意线程）调用completion报告释放的字节数，且只能调用一次。
+ * 压力解除（EMASCurlMemoryPressureNormal）时同样会回调，供组件恢复缩减的容量，此时报告0即可。
+ */
+typedef void (^EMASCurlMemoryReleaseHandler)(EMASCurlMemoryPressureLevel level, void (^completion)(NSUInteger releasedBytes));
+
+/**
+ * 监听系统内存压力，分发给各组件释放内存，并汇总每次事件释放的字节数
+ */
+@interface EMASCurlMemoryPressureManager : NSObject
+
++ (instancetype)sharedManager;
+
+// 最近一次事件的级别
+@property (atomic, assign, readonly) EMASCurlMemoryPressureLevel currentLevel;
+
+// 每次警告/严重级别事件处理完成后回调，在内部串行队列执行
+@property (atomic, copy, nullable) EMASCurlMemoryPressureObserverBlock observer;
+
+- (void)registerReleaseHandler:(EMASCurlMemoryReleaseHandler)handler forComponent:(NSString *)component;
+
+/**
+ * 模拟一次内存压力事件，与系统事件走同一处理流程。
+ * 用于测试，以及没有内存压力dispatch source的平台。
+ */
+- (void)simulateMemoryPressure:(EMASCurlMemoryPressureLevel)level;
+
+@end
+
+NS_ASSUME_NONNULL_END
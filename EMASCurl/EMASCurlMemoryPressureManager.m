@@ -0,0 +1,148 @@
+//
+//  EMASCurlMemoryPressureManager.m
+//  EMASCurl
+//
+//  Created by xuyecan on 2026/10/18.
+//
+
+#import "EMASCurlMemoryPressureManager.h"
+#import "EMASCurlLogger.h"
+
+NSString * const EMASCurlMemoryComponentResponseCache = @"responseCache";
+NSString * const EMASCurlMemoryComponentTransferBuffers = @"transferBuffers";
+
+@implementation EMASCurlMemoryPressureEvent
+@end
+
+@interface EMASCurlMemoryPressureManager ()
+
+@property (atomic, assign, readwrite) EMASCurlMemoryPressureLevel currentLevel;
+@property (nonatomic, strong) dispatch_queue_t pressureQueue;
+// 只在pressureQueue中访问
+@property (nonatomic, strong) NSMutableDictionary<NSString *, EMASCurlMemoryReleaseHandler> *handlers;
+@property (nonatomic, strong, nullable) dispatch_source_t pressureSource;
+
+@end
+
+@implementation EMASCurlMemoryPressureManager
+
++ (instancetype)sharedManager {
+    static EMASCurlMemoryPressureManager *manager;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        manager = [[EMASCurlMemoryPressureManager alloc] initPrivate];
+    });
+    return manager;
+}
+
+- (instancetype)initPrivate {
+    self = [super init];
+    if (self) {
+        _currentLevel = EMASCurlMemoryPressureNormal;
+        _pressureQueue = dispatch_queue_create("com.alicloud.emascurl.memoryPressureQueue", DISPATCH_QUEUE_SERIAL);
+        _handlers = [NSMutableDictionary dictionary];
+        [self startPressureObservation];
+    }
+    return self;
+}
+
+- (void)startPressureObservation {
+#ifdef DISPATCH_SOURCE_TYPE_MEMORYPRESSURE
+    dispatch_source_t source = dispatch_source_create(DISPATCH_SOURCE_TYPE_MEMORYPRESSURE,
+                                                      0,
+                                                      DISPATCH_MEMORYPRESSURE_NORMAL | DISPATCH_MEMORYPRESSURE_WARN | DISPATCH_MEMORYPRESSURE_CRITICAL,
+                                                      self.pressureQueue);
+    if (!source) {
+        EMAS_LOG_ERROR(@"EC-Memory", @"Failed to create memory pressure source");
+        return;
+    }
+
+    __weak typeof(self) weakSelf = self;
+    dispatch_source_set_event_handler(source, ^{
+        __strong typeof(weakSelf) strongSelf = weakSelf;
+        if (!strongSelf) {
+            return;
+        }
+        unsigned long flags = dispatch_source_get_data(source);
+        EMASCurlMemoryPressureLevel level = EMASCurlMemoryPressureNormal;
+        if (flags & DISPATCH_MEMORYPRESSURE_CRITICAL) {
+            level = EMASCurlMemoryPressureCritical;
+        } else if (flags & DISPATCH_MEMORYPRESSURE_WARN) {
+            level = EMASCurlMemoryPressureWarning;
+        }
+        [strongSelf handleMemoryPressure:level];
+    });
+    dispatch_resume(source);
+    self.pressureSource = source;
+#else
+    EMAS_LOG_INFO(@"EC-Memory", @"Memory pressure source unavailable, relying on simulateMemoryPressure:");
+#endif
+}
+
+- (void)registerReleaseHandler:(EMASCurlMemoryReleaseHandler)handler forComponent:(NSString *)component {
+    if (!handler || component.length == 0) {
+        return;
+    }
+    EMASCurlMemoryReleaseHandler handlerCopy = [handler copy];
+    dispatch_async(self.pressureQueue, ^{
+        self.handlers[component] = handlerCopy;
+    });
+}
+
+- (void)simulateMemoryPressure:(EMASCurlMemoryPressureLevel)level {
+    dispatch_async(self.pressureQueue, ^{
+        [self handleMemoryPressure:level];
+    });
+}
+
+// 在pressureQueue中执行：分发给各组件，全部完成后汇总上报
+- (void)handleMemoryPressure:(EMASCurlMemoryPressureLevel)level {
+    self.currentLevel = level;
+    EMAS_LOG_INFO(@"EC-Memory", @"Memory pressure level changed to %ld", (long)level);
+
+    dispatch_group_t group = dispatch_group_create();
+    NSMutableDictionary<NSString *, NSNumber *> *releasedBytesByComponent = [NSMutableDictionary dictionary];
+
+    [self.handlers enumerateKeysAndObjectsUsingBlock:^(NSString *component, EMASCurlMemoryReleaseHandler handler, BOOL *stop) {
+        dispatch_group_enter(group);
+        __block BOOL completed = NO;
+        handler(level, ^(NSUInteger releasedBytes) {
+            @synchronized (releasedBytesByComponent) {
+                if (completed) {
+                    return;
+                }
+                completed = YES;
+                releasedBytesByComponent[component] = @(releasedBytes);
+            }
+            dispatch_group_leave(group);
+        });
+    }];
+
+    if (level == EMASCurlMemoryPressureNormal) {
+        return;
+    }
+
+    dispatch_group_notify(group, self.pressureQueue, ^{
+        EMASCurlMemoryPressureEvent *event = [EMASCurlMemoryPressureEvent new];
+        event.level = level;
+        event.date = [NSDate date];
+        @synchronized (releasedBytesByComponent) {
+            event.releasedBytesByComponent = [releasedBytesByComponent copy];
+        }
+        NSUInteger total = 0;
+        for (NSNumber *bytes in event.releasedBytesByComponent.allValues) {
+            total += bytes.unsignedIntegerValue;
+        }
+        event.releasedBytes = total;
+
+        EMAS_LOG_INFO(@"EC-Memory", @"Memory pressure level %ld released %lu bytes: %@",
+                      (long)level, (unsigned long)total, event.releasedBytesByComponent);
+
+        EMASCurlMemoryPressureObserverBlock observer = self.observer;
+        if (observer) {
+            observer(event);
+        }
+    });
+}
+
+@end
@@ -0,0 +1,48 @@
+//
+//  EMASCurlNetworkQualityEstimator.h
+//  EMASCurl
+//
+//  Created by xuyecan on 2026/10/18.
+//
+
+#import <Foundation/Foundation.h>
+#import <curl/curl.h>
+#import "EMASCurlConfiguration.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+@class EMASCurlMetricsData;
+
+/**
+ * 网络质量估计。对每个结束的传输取新建连接的握手耗时作为RTT样本、较大响应体的下载速率作为吞吐样本、
+ * 是否因网络错误失败作为失败率样本，按当前网络（Wi-Fi、各代蜂窝）分别做指数滑动平均，并据此分级。
+ * 当前网络由SCNetworkReachability与CoreTelephony得出，切换后使用新网络自己的估计；
+ * 一个网络上超过5分钟没有新样本时，旧估计作废。
+ * 所有方法可在任意线程调用。
+ */
+@interface EMASCurlNetworkQualityEstimator : NSObject
+
++ (instancetype)sharedInstance;
+
+// 记录一次结束的传输，result为libcurl的结果码
+- (void)recordMetrics:(EMASCurlMetricsData *)metrics result:(CURLcode)result;
+
+// sampleThroughput为NO时只取RTT与失败率样本，用于被限速或暂停过的传输
+- (void)recordMetrics:(EMASCurlMetricsData *)metrics result:(CURLcode)result sampleThroughput:(BOOL)sampleThroughput;
+
+- (EMASCurlNetworkQualityEstimate *)currentEstimate;
+
+- (EMASCurlNetworkQuality)currentQuality;
+
+// 自适应连接超时：RTT的8倍，限制在[1秒, baseTimeout的4倍]；没有RTT样本时返回baseTimeout
+- (NSTimeInterval)connectTimeoutForBaseTimeout:(NSTimeInterval)baseTimeout;
+
+// 同一host同时进行的请求数上限，0表示不限制
+- (NSUInteger)maxConcurrentTransfersPerHost;
+
+// 是否应推迟后台优先级的请求
+- (BOOL)shouldDeferBackgroundTransfers;
+
+@end
+
+NS_ASSUME_NONNULL_END
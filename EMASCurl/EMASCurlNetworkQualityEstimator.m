@@ -0,0 +1,388 @@
+//
+//  EMASCurlNetworkQualityEstimator.m
+//  EMASCurl
+//
+//  Created by xuyecan on 2026/10/18.
+//
+
+#import "EMASCurlNetworkQualityEstimator.h"
+#import "EMASCurlManager.h"
+#import "EMASCurlLogger.h"
+#import "EMASCurlTraceRecorder.h"
+#import <CoreTelephony/CTTelephonyNetworkInfo.h>
+#import <SystemConfiguration/SystemConfiguration.h>
+#import <netinet/in.h>
+#import <os/lock.h>
+
+// 每个样本的权重，约等于最近8个样本的平均
+static const double kEMASNetworkQualityEWMAWeight = 0.2;
+// 超过该时长没有新样本时丢弃旧估计
+static const uint64_t kEMASNetworkQualityStaleNs = 300 * NSEC_PER_SEC;
+// 较小的响应体受慢启动影响，不能反映吞吐
+static const long long kEMASNetworkQualityMinThroughputBytes = 32 * 1024;
+static const NSUInteger kEMASNetworkQualityMinSamples = 2;
+static const NSUInteger kEMASNetworkQualityMinOutcomeSamples = 5;
+
+static const double kEMASConnectTimeoutRTTMultiplier = 8;
+static const NSTimeInterval kEMASConnectTimeoutFloor = 1.0;
+static const double kEMASConnectTimeoutCeilingMultiplier = 4;
+
+static const void *kEMASNetworkQualityQueueKey = &kEMASNetworkQualityQueueKey;
+
+@implementation EMASCurlNetworkQualityEstimate
+@end
+
+// 单个网络上的滑动平均
+@interface EMASNetworkQualityStats : NSObject
+
+@property (nonatomic, assign) double rtt;
+@property (nonatomic, assign) NSUInteger rttSamples;
+@property (nonatomic, assign) double throughput;
+@property (nonatomic, assign) NSUInteger throughputSamples;
+@property (nonatomic, assign) double failureRate;
+@property (nonatomic, assign) NSUInteger outcomeSamples;
+@property (nonatomic, assign) uint64_t lastSampleNs;
+@property (nonatomic, assign) EMASCurlNetworkQuality quality;
+
+@end
+
+@implementation EMASNetworkQualityStats
+@end
+
+static double EMASNetworkQualityEWMA(double average, NSUInteger samples, double value) {
+    return samples == 0 ? value : average + kEMASNetworkQualityEWMAWeight * (value - average);
+}
+
+static EMASCurlNetworkQuality EMASNetworkQualityClassify(EMASNetworkQualityStats *stats) {
+    BOOL hasRTT = stats.rttSamples >= kEMASNetworkQualityMinSamples;
+    BOOL hasThroughput = stats.throughputSamples >= kEMASNetworkQualityMinSamples;
+    BOOL hasOutcomes = stats.outcomeSamples >= kEMASNetworkQualityMinOutcomeSamples;
+
+    if ((hasRTT && stats.rtt >= 1.0) ||
+        (hasThroughput && stats.throughput <= 20 * 1024) ||
+        (hasOutcomes && stats.failureRate >= 0.3)) {
+        return EMASCurlNetworkQualityPoor;
+    }
+    if ((hasRTT && stats.rtt >= 0.3) ||
+        (hasThroughput && stats.throughput <= 150 * 1024) ||
+        (hasOutcomes && stats.failureRate >= 0.1)) {
+        return EMASCurlNetworkQualityModerate;
+    }
+    // 只有失败率样本时无法判断网络快慢
+    if (!hasRTT && !hasThroughput) {
+        return EMASCurlNetworkQualityUnknown;
+    }
+    if ((hasRTT && stats.rtt >= 0.1) ||
+        (hasThroughput && stats.throughput <= 1.5 * 1024 * 1024)) {
+        return EMASCurlNetworkQualityGood;
+    }
+    return EMASCurlNetworkQualityExcellent;
+}
+
+static NSString *EMASNetworkQualityName(EMASCurlNetworkQuality quality) {
+    switch (quality) {
+        case EMASCurlNetworkQualityPoor:
+            return @"poor";
+        case EMASCurlNetworkQualityModerate:
+            return @"moderate";
+        case EMASCurlNetworkQualityGood:
+            return @"good";
+        case EMASCurlNetworkQualityExcellent:
+            return @"excellent";
+        default:
+            return @"unknown";
+    }
+}
+
+// 只有反映网络状况的错误计入失败率；取消、证书校验失败、写回调出错等与网络无关
+static BOOL EMASNetworkQualityIsNetworkFailure(CURLcode result) {
+    switch (result) {
+        case CURLE_COULDNT_RESOLVE_HOST:
+        case CURLE_COULDNT_CONNECT:
+        case CURLE_OPERATION_TIMEDOUT:
+        case CURLE_SSL_CONNECT_ERROR:
+        case CURLE_GOT_NOTHING:
+        case CURLE_SEND_ERROR:
+        case CURLE_RECV_ERROR:
+        case CURLE_PARTIAL_FILE:
+        case CURLE_HTTP2:
+        case CURLE_HTTP2_STREAM:
+        case CURLE_HTTP3:
+        case CURLE_QUIC_CONNECT_ERROR:
+            return YES;
+        default:
+            return NO;
+    }
+}
+
+static NSString *EMASNetworkQualityCellularName(NSString *radio) {
+    static NSDictionary<NSString *, NSString *> *generations;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        NSMutableDictionary<NSString *, NSString *> *map = [@{
+            CTRadioAccessTechnologyGPRS: @"cellular-2g",
+            CTRadioAccessTechnologyEdge: @"cellular-2g",
+            CTRadioAccessTechnologyCDMA1x: @"cellular-2g",
+            CTRadioAccessTechnologyWCDMA: @"cellular-3g",
+            CTRadioAccessTechnologyHSDPA: @"cellular-3g",
+            CTRadioAccessTechnologyHSUPA: @"cellular-3g",
+            CTRadioAccessTechnologyCDMAEVDORev0: @"cellular-3g",
+            CTRadioAccessTechnologyCDMAEVDORevA: @"cellular-3g",
+            CTRadioAccessTechnologyCDMAEVDORevB: @"cellular-3g",
+            CTRadioAccessTechnologyeHRPD: @"cellular-3g",
+            CTRadioAccessTechnologyLTE: @"cellular-4g",
+        } mutableCopy];
+        if (@available(iOS 14.1, *)) {
+            map[CTRadioAccessTechnologyNRNSA] = @"cellular-5g";
+            map[CTRadioAccessTechnologyNR] = @"cellular-5g";
+        }
+        generations = [map copy];
+    });
+    return (radio ? generations[radio] : nil) ?: @"cellular";
+}
+
+@interface EMASCurlNetworkQualityEstimator ()
+
+- (void)updateNetworkWithFlags:(SCNetworkReachabilityFlags)flags;
+
+@end
+
+static void EMASNetworkQualityReachabilityCallback(SCNetworkReachabilityRef target, SCNetworkReachabilityFlags flags, void *info) {
+    [(__bridge EMASCurlNetworkQualityEstimator *)info updateNetworkWithFlags:flags];
+}
+
+@implementation EMASCurlNetworkQualityEstimator {
+    os_unfair_lock _lock;
+    // 以下两项由_lock保护
+    NSString *_network;
+    NSMutableDictionary<NSString *, EMASNetworkQualityStats *> *_statsByNetwork;
+
+    SCNetworkReachabilityRef _reachability;
+    // reachability与无线制式变化的回调都在此队列上执行
+    dispatch_queue_t _queue;
+    SCNetworkReachabilityFlags _reachabilityFlags;
+    CTTelephonyNetworkInfo *_telephonyInfo;
+    id _radioObserver;
+}
+
++ (instancetype)sharedInstance {
+    static EMASCurlNetworkQualityEstimator *estimator;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        estimator = [[EMASCurlNetworkQualityEstimator alloc] init];
+    });
+    return estimator;
+}
+
+- (instancetype)init {
+    self = [super init];
+    if (self) {
+        _lock = OS_UNFAIR_LOCK_INIT;
+        _network = @"unknown";
+        _statsByNetwork = [NSMutableDictionary dictionary];
+        _queue = dispatch_queue_create("com.alicloud.emascurl.networkQuality", DISPATCH_QUEUE_SERIAL);
+        dispatch_queue_set_specific(_queue, kEMASNetworkQualityQueueKey, (__bridge void *)self, NULL);
+        _telephonyInfo = [[CTTelephonyNetworkInfo alloc] init];
+
+        struct sockaddr_in zeroAddress = {0};
+        zeroAddress.sin_len = sizeof(zeroAddress);
+        zeroAddress.sin_family = AF_INET;
+        _reachability = SCNetworkReachabilityCreateWithAddress(kCFAllocatorDefault, (const struct sockaddr *)&zeroAddress);
+        if (_reachability) {
+            // 地址形式的reachability只查本地路由，同步取初始状态不会阻塞
+            SCNetworkReachabilityFlags flags = 0;
+            if (SCNetworkReachabilityGetFlags(_reachability, &flags)) {
+                [self updateNetworkWithFlags:flags];
+            }
+            SCNetworkReachabilityContext context = {0, (__bridge void *)self, NULL, NULL, NULL};
+            SCNetworkReachabilitySetCallback(_reachability, EMASNetworkQualityReachabilityCallback, &context);
+            SCNetworkReachabilitySetDispatchQueue(_reachability, _queue);
+        }
+
+        __weak typeof(self) weakSelf = self;
+        NSOperationQueue *observerQueue = [[NSOperationQueue alloc] init];
+        observerQueue.underlyingQueue = _queue;
+        _radioObserver = [[NSNotificationCenter defaultCenter] addObserverForName:CTRadioAccessTechnologyDidChangeNotification
+                                                                           object:nil
+                                                                            queue:observerQueue
+                                                                       usingBlock:^(NSNotification *note) {
+            __strong typeof(weakSelf) strongSelf = weakSelf;
+            if (strongSelf) {
+                [strongSelf updateNetworkWithFlags:strongSelf->_reachabilityFlags];
+            }
+        }];
+    }
+    return self;
+}
+
+- (void)dealloc {
+    [[NSNotificationCenter defaultCenter] removeObserver:_radioObserver];
+    if (_reachability) {
+        SCNetworkReachabilitySetDispatchQueue(_reachability, NULL);
+        SCNetworkReachabilitySetCallback(_reachability, NULL, NULL);
+        // 等待已派发的回调执行完，之后不会再访问self；在回调队列上释放时已无其他回调在执行
+        if (dispatch_get_specific(kEMASNetworkQualityQueueKey) != (__bridge void *)self) {
+            dispatch_sync(_queue, ^{});
+        }
+        CFRelease(_reachability);
+    }
+}
+
+- (NSString *)currentRadioAccessTechnology {
+    if (@available(iOS 13.0, *)) {
+        NSString *service = _telephonyInfo.dataServiceIdentifier;
+        return service ? _telephonyInfo.serviceCurrentRadioAccessTechnology[service] : nil;
+    } else if (@available(iOS 12.0, *)) {
+        return _telephonyInfo.serviceCurrentRadioAccessTechnology.allValues.firstObject;
+    } else {
+        return _telephonyInfo.currentRadioAccessTechnology;
+    }
+}
+
+- (void)updateNetworkWithFlags:(SCNetworkReachabilityFlags)flags {
+    _reachabilityFlags = flags;
+
+    NSString *network = nil;
+    BOOL reachable = (flags & kSCNetworkReachabilityFlagsReachable) &&
+                     !(flags & kSCNetworkReachabilityFlagsConnectionRequired);
+    if (!reachable) {
+        network = @"none";
+    } else if (flags & kSCNetworkReachabilityFlagsIsWWAN) {
+        network = EMASNetworkQualityCellularName([self currentRadioAccessTechnology]);
+    } else {
+        network = @"wifi";
+    }
+
+    os_unfair_lock_lock(&_lock);
+    NSString *previous = _network;
+    _network = network;
+    os_unfair_lock_unlock(&_lock);
+
+    if (![previous isEqualToString:network]) {
+        EMAS_LOG_INFO(@"EC-NetworkQuality", @"Network changed: %@ -> %@", previous, network);
+    }
+}
+
+- (void)recordMetrics:(EMASCurlMetricsData *)metrics result:(CURLcode)result {
+    [self recordMetrics:metrics result:result sampleThroughput:YES];
+}
+
+- (void)recordMetrics:(EMASCurlMetricsData *)metrics result:(CURLcode)result sampleThroughput:(BOOL)sampleThroughput {
+    EMASCurlPhaseTimings timings = metrics.timings;
+
+    // 新建连接的TCP握手（QUIC为握手完成）约为一个RTT；经过代理时测到的是到代理的RTT，不计入
+    double rtt = -1;
+    if (result == CURLE_OK && metrics.numConnects > 0 && !metrics.usedProxy && timings.connect > timings.nameLookup) {
+        rtt = (timings.connect - timings.nameLookup) / (double)USEC_PER_SEC;
+    }
+
+    double throughput = -1;
+    curl_off_t downloadUs = timings.total - timings.startTransfer;
+    if (sampleThroughput && result == CURLE_OK && metrics.downloadBytes >= kEMASNetworkQualityMinThroughputBytes && downloadUs > 0) {
+        throughput = metrics.downloadBytes / (downloadUs / (double)USEC_PER_SEC);
+    }
+
+    double outcome = -1;
+    if (result == CURLE_OK) {
+        outcome = 0;
+    } else if (EMASNetworkQualityIsNetworkFailure(result)) {
+        outcome = 1;
+    }
+
+    if (rtt < 0 && throughput < 0 && outcome < 0) {
+        return;
+    }
+
+    uint64_t now = EMASCurlTraceNow();
+    os_unfair_lock_lock(&_lock);
+    NSString *network = _network;
+    EMASNetworkQualityStats *stats = _statsByNetwork[network];
+    if (!stats || now - stats.lastSampleNs > kEMASNetworkQualityStaleNs) {
+        stats = [[EMASNetworkQualityStats alloc] init];
+        _statsByNetwork[network] = stats;
+    }
+    stats.lastSampleNs = now;
+    if (rtt >= 0) {
+        stats.rtt = EMASNetworkQualityEWMA(stats.rtt, stats.rttSamples++, rtt);
+    }
+    if (throughput >= 0) {
+        stats.throughput = EMASNetworkQualityEWMA(stats.throughput, stats.throughputSamples++, throughput);
+    }
+    if (outcome >= 0) {
+        stats.failureRate = EMASNetworkQualityEWMA(stats.failureRate, stats.outcomeSamples++, outcome);
+    }
+    EMASCurlNetworkQuality previousQuality = stats.quality;
+    EMASCurlNetworkQuality quality = EMASNetworkQualityClassify(stats);
+    stats.quality = quality;
+    double averageRTT = stats.rtt, averageThroughput = stats.throughput, failureRate = stats.failureRate;
+    os_unfair_lock_unlock(&_lock);
+
+    if (quality != previousQuality) {
+        EMAS_LOG_INFO(@"EC-NetworkQuality", @"Network quality on %@ changed: %@ -> %@ (rtt=%.0fms throughput=%.0fKB/s failureRate=%.2f)",
+                      network, EMASNetworkQualityName(previousQuality), EMASNetworkQualityName(quality),
+                      averageRTT * 1000, averageThroughput / 1024, failureRate);
+    }
+}
+
+// 调用方须持有_lock；当前网络没有样本或估计已过期时返回nil
+- (EMASNetworkQualityStats *)currentStatsLocked {
+    EMASNetworkQualityStats *stats = _statsByNetwork[_network];
+    if (!stats || EMASCurlTraceNow() - stats.lastSampleNs > kEMASNetworkQualityStaleNs) {
+        return nil;
+    }
+    return stats;
+}
+
+- (EMASCurlNetworkQualityEstimate *)currentEstimate {
+    EMASCurlNetworkQualityEstimate *estimate = [[EMASCurlNetworkQualityEstimate alloc] init];
+    os_unfair_lock_lock(&_lock);
+    EMASNetworkQualityStats *stats = [self currentStatsLocked];
+    estimate.network = _network;
+    estimate.quality = stats.quality;
+    estimate.rtt = stats.rtt;
+    estimate.throughput = stats.throughput;
+    estimate.failureRate = stats.failureRate;
+    estimate.sampleCount = MAX(MAX(stats.rttSamples, stats.throughputSamples), stats.outcomeSamples);
+    os_unfair_lock_unlock(&_lock);
+    return estimate;
+}
+
+- (EMASCurlNetworkQuality)currentQuality {
+    os_unfair_lock_lock(&_lock);
+    EMASCurlNetworkQuality quality = [self currentStatsLocked].quality;
+    os_unfair_lock_unlock(&_lock);
+    return quality;
+}
+
+- (NSTimeInterval)connectTimeoutForBaseTimeout:(NSTimeInterval)baseTimeout {
+    os_unfair_lock_lock(&_lock);
+    EMASNetworkQualityStats *stats = [self currentStatsLocked];
+    BOOL hasRTT = stats.rttSamples >= kEMASNetworkQualityMinSamples;
+    double rtt = stats.rtt;
+    os_unfair_lock_unlock(&_lock);
+
+    if (!hasRTT || baseTimeout <= 0) {
+        return baseTimeout;
+    }
+    NSTimeInterval ceiling = MAX(baseTimeout * kEMASConnectTimeoutCeilingMultiplier, kEMASConnectTimeoutFloor);
+    return MIN(MAX(rtt * kEMASConnectTimeoutRTTMultiplier, kEMASConnectTimeoutFloor), ceiling);
+}
+
+- (NSUInteger)maxConcurrentTransfersPerHost {
+    switch ([self currentQuality]) {
+        case EMASCurlNetworkQualityPoor:
+            return 2;
+        case EMASCurlNetworkQualityModerate:
+            return 6;
+        case EMASCurlNetworkQualityGood:
+            return 16;
+        default:
+            return 0;
+    }
+}
+
+- (BOOL)shouldDeferBackgroundTransfers {
+    return [self currentQuality] == EMASCurlNetworkQualityPoor;
+}
+
+@end
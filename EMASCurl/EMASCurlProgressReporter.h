@@ -0,0 +1,52 @@
+//
+//  EMASCurlProgressReporter.h
+//  EMASCurl
+//
+//  Created by xuyecan on 2026/10/18.
+//
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+// 与EMASCurlUploadProgressUpdateBlock/EMASCurlDownloadProgressUpdateBlock签名一致
+typedef void(^EMASCurlProgressHandler)(NSURLRequest *request,
+                                       int64_t bytesTransferred,
+                                       int64_t totalBytesTransferred,
+                                       int64_t totalBytesExpected);
+
+/**
+ * 合并传输进度并在回调队列上交付，网络线程只做计数与节流判断。
+ * 距上次交付超过interval或累计超过byteDelta时交付一次，传输完成时总会交付最终进度。
+ * report/flush只应在网络线程调用。
+ */
+@interface EMASCurlProgressReporter : NSObject
+
+/**
+ * @param interval 两次交付的最小间隔，单位秒，0表示不按时间节流
+ * @param byteDelta 累计达到该字节数时立即交付，0表示不按字节数触发
+ * @param queue 回调队列，nil时使用内部串行队列
+ */
+- (instancetype)initWithRequest:(NSURLRequest *)request
+                        handler:(EMASCurlProgressHandler)handler
+                       interval:(NSTimeInterval)interval
+                      byteDelta:(int64_t)byteDelta
+                          queue:(nullable dispatch_queue_t)queue NS_DESIGNATED_INITIALIZER;
+
+- (instancetype)init NS_UNAVAILABLE;
+
+// 记录新传输的字节，按节流规则决定是否交付
+- (void)reportBytes:(int64_t)bytes totalBytes:(int64_t)totalBytes expectedBytes:(int64_t)expectedBytes;
+
+// 交付尚未交付的进度
+- (void)flush;
+
+/**
+ * 使用内部队列时把block排在已提交的回调之后异步执行，保证进度先于完成回调到达调用方，调用线程不会被阻塞。
+ * 自定义队列可能被调用方挂起，此时立即执行block
+ */
+- (void)performAfterDelivered:(dispatch_block_t)block;
+
+@end
+
+NS_ASSUME_NONNULL_END
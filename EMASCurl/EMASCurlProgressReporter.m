@@ -0,0 +1,99 @@
+//
+//  EMASCurlProgressReporter.m
+//  EMASCurl
+//
+//  Created by xuyecan on 2026/10/18.
+//
+
+#import "EMASCurlProgressReporter.h"
+#import <time.h>
+
+@interface EMASCurlProgressReporter ()
+
+@property (nonatomic, strong) NSURLRequest *request;
+@property (nonatomic, copy) EMASCurlProgressHandler handler;
+@property (nonatomic, assign) uint64_t intervalNanoseconds;
+@property (nonatomic, assign) int64_t byteDelta;
+@property (nonatomic, strong) dispatch_queue_t deliveryQueue;
+@property (nonatomic, assign) BOOL usesInternalQueue;
+
+// 以下只在网络线程访问
+@property (nonatomic, assign) int64_t pendingBytes;
+@property (nonatomic, assign) int64_t totalBytes;
+@property (nonatomic, assign) int64_t expectedBytes;
+@property (nonatomic, assign) uint64_t lastDeliveryTime;
+
+@end
+
+@implementation EMASCurlProgressReporter
+
+- (instancetype)initWithRequest:(NSURLRequest *)request
+                        handler:(EMASCurlProgressHandler)handler
+                       interval:(NSTimeInterval)interval
+                      byteDelta:(int64_t)byteDelta
+                          queue:(dispatch_queue_t)queue {
+    self = [super init];
+    if (self) {
+        _request = request;
+        _handler = [handler copy];
+        _intervalNanoseconds = interval > 0 ? (uint64_t)(interval * NSEC_PER_SEC) : 0;
+        _byteDelta = MAX(byteDelta, 0);
+        _usesInternalQueue = (queue == nil);
+        // 每个请求一个串行队列，保证同一请求的进度按序交付；内部队列直接以全局并发队列为目标，
+        // 一个请求的回调执行缓慢不会拖住其他请求
+        _deliveryQueue = dispatch_queue_create_with_target("com.alicloud.emascurl.progress.request", DISPATCH_QUEUE_SERIAL,
+                                                           queue ?: dispatch_get_global_queue(QOS_CLASS_UTILITY, 0));
+    }
+    return self;
+}
+
+- (void)reportBytes:(int64_t)bytes totalBytes:(int64_t)totalBytes expectedBytes:(int64_t)expectedBytes {
+    if (bytes <= 0) {
+        return;
+    }
+    self.pendingBytes += bytes;
+    self.totalBytes = totalBytes;
+    self.expectedBytes = expectedBytes;
+
+    BOOL completed = expectedBytes > 0 && totalBytes >= expectedBytes;
+    BOOL byteDeltaReached = self.byteDelta > 0 && self.pendingBytes >= self.byteDelta;
+    BOOL throttled = self.intervalNanoseconds > 0 || self.byteDelta > 0;
+
+    uint64_t now = clock_gettime_nsec_np(CLOCK_UPTIME_RAW);
+    BOOL intervalElapsed = self.intervalNanoseconds > 0 && now - self.lastDeliveryTime >= self.intervalNanoseconds;
+
+    if (!throttled || completed || byteDeltaReached || intervalElapsed) {
+        self.lastDeliveryTime = now;
+        [self deliverPending];
+    }
+}
+
+- (void)flush {
+    if (self.pendingBytes > 0) {
+        self.lastDeliveryTime = clock_gettime_nsec_np(CLOCK_UPTIME_RAW);
+        [self deliverPending];
+    }
+}
+
+- (void)deliverPending {
+    int64_t bytes = self.pendingBytes;
+    int64_t totalBytes = self.totalBytes;
+    int64_t expectedBytes = self.expectedBytes;
+    self.pendingBytes = 0;
+
+    NSURLRequest *request = self.request;
+    EMASCurlProgressHandler handler = self.handler;
+    dispatch_async(self.deliveryQueue, ^{
+        handler(request, bytes, totalBytes, expectedBytes);
+    });
+}
+
+- (void)performAfterDelivered:(dispatch_block_t)block {
+    if (self.usesInternalQueue) {
+        dispatch_async(self.deliveryQueue, block);
+    } else {
+        block();
+    }
+}
+
+@end
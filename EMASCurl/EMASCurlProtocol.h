@@ -67,8 +67,18 @@ typedef void(^EMASCurlLogHandlerBlock)(EMASCurlLogLevel level, NSString * _Nonnu
 // 设置自定义日志处理器（可选）
 // 如果不设置，日志将输出到控制台（NSLog）
 // 传入 nil 可恢复默认行为
+// 日志在后台线程格式化并回调处理器，不在产生日志的线程上
 + (void)setLogHandler:(nullable EMASCurlLogHandlerBlock)handler;
 
+// 将日志写入目录下的滚动文件（emascurl.log、emascurl.1.log...），设置后不再输出到控制台
+// maxFileSize为单个文件的字节上限，maxFileCount为保留的文件个数；传入 nil 停止写文件
++ (void)setLogFileDirectory:(nullable NSString *)directory
+                maxFileSize:(unsigned long long)maxFileSize
+               maxFileCount:(NSUInteger)maxFileCount;
+
+// 同步输出所有已记录但尚未输出的日志，如在应用退出或上报日志文件前调用
++ (void)flushLogs;
+
 #pragma mark - 其他配置方法
 
 // 设置DNS解析器
@@ -90,9 +100,45 @@ typedef void(^EMASCurlLogHandlerBlock)(EMASCurlLogLevel level, NSString * _Nonnu
 // 获取单个请求的拦截设置，未设置时返回YES（默认拦截）
 + (BOOL)isRequestInterceptEnabledForRequest:(nonnull NSURLRequest *)request;
 
+// 把成功响应（2xx）的响应体直接写入指定文件，不再经过URLProtocol:didLoadData:交付
+// 文件写完后原子替换目标文件，再回调完成；完成回调中的data为空，可配合下载进度回调获知进度
+// 该请求不读写响应缓存，非2xx响应的响应体照常交付
++ (void)setDownloadDestinationFileURL:(nonnull NSURL *)fileURL forRequest:(nonnull NSMutableURLRequest *)request;
+
+// 下载到文件时把大文件拆成最多segmentCount段并发下载，需同时设置setDownloadDestinationFileURL:forRequest:
+// 仅对GET请求生效：首个响应为200、支持bytes范围请求、带ETag或Last-Modified且长度足够时才分段，否则按单连接下载
+// 各段通过If-Range校验属于同一版本，服务端不支持范围请求或资源已变化时自动退回单连接下载
++ (void)setDownloadSegmentCount:(NSUInteger)segmentCount forRequest:(nonnull NSMutableURLRequest *)request;
+
+// 下载到文件时支持断点续传，需同时设置setDownloadDestinationFileURL:forRequest:，仅对未指定Range的GET请求生效
+// 失败、取消或进程退出后已下载的数据保留在目标文件同目录的隐藏文件中，再次以同一URL下载到同一目标时带Range与If-Range续传
+// 资源已变化（If-Range不匹配）或响应缺少强ETag/Last-Modified、长度未知时从头下载；同一目标文件同时只应有一个可续传下载
++ (void)setDownloadResumable:(BOOL)resumable forRequest:(nonnull NSMutableURLRequest *)request;
+
+// 设置请求的带宽优先级，默认EMASCurlRequestPriorityDefault
+// 预取、日志上报等批量传输可设为EMASCurlRequestPriorityBackground，与前台请求并存时按估计的剩余带宽限速，前台请求结束后恢复全速
++ (void)setRequestPriority:(EMASCurlRequestPriority)priority forRequest:(nonnull NSMutableURLRequest *)request;
+
+// 设置单个请求的请求体压缩方式，优先于配置中的requestBodyEncodingByHost
+// 压缩在上传时流式进行，Content-Length改为chunked发送
++ (void)setRequestBodyEncoding:(EMASCurlRequestBodyEncoding)encoding forRequest:(nonnull NSMutableURLRequest *)request;
+
 // 设置上传进度回调
+// 回调按配置的progressReportInterval合并，在progressCallbackQueue上执行，不占用网络线程
 + (void)setUploadProgressUpdateBlockForRequest:(nonnull NSMutableURLRequest *)request uploadProgressUpdateBlock:(nonnull EMASCurlUploadProgressUpdateBlock)uploadProgressUpdateBlock;
 
+// 设置下载进度回调，合并与执行队列规则同上传进度回调
+// 命中缓存直接应答的请求不回调
++ (void)setDownloadProgressUpdateBlockForRequest:(nonnull NSMutableURLRequest *)request downloadProgressUpdateBlock:(nonnull EMASCurlDownloadProgressUpdateBlock)downloadProgressUpdateBlock;
+
+// 以内存数据作为请求体，libcurl直接发送该缓冲区，不再经过HTTPBodyStream逐段复制
+// 同时设置request.HTTPBody，请求未被拦截时由系统正常发送
++ (void)setUploadBodyData:(nonnull NSData *)data forRequest:(nonnull NSMutableURLRequest *)request;
+
+// 以本地文件作为请求体，传输时从文件逐段读取，不额外占用与文件等大的堆内存；Content-Length取发送时的文件大小
+// 同时设置request.HTTPBodyStream和Content-Length，请求未被拦截时由系统正常发送
++ (void)setUploadBodyFileURL:(nonnull NSURL *)fileURL forRequest:(nonnull NSMutableURLRequest *)request;
+
 /// 设置全局综合性能指标观察回调（推荐使用）
 /// 提供等价于URLSessionTaskTransactionMetrics的完整性能指标
 /// @param transactionMetricsObserverBlock 综合性能指标回调，传入nil清除回调
@@ -101,6 +147,36 @@ typedef void(^EMASCurlLogHandlerBlock)(EMASCurlLogLevel level, NSString * _Nonnu
 /// 获取当前全局综合性能指标观察回调
 + (nullable EMASCurlTransactionMetricsObserverBlock)globalTransactionMetricsObserverBlock;
 
+/// 获取缓存响应体压缩统计（进程内累计值），用于评估压缩比与命中时的解压CPU开销
+/// 压缩规则通过`EMASCurlConfiguration.cacheCompressionAlgorithms`配置
++ (nonnull EMASCurlCacheCompressionStatistics *)cacheCompressionStatistics;
+
+/// 获取缓存命中率、按原因的淘汰次数与各host占用（进程内累计值）
+/// 淘汰策略与配额通过`EMASCurlConfiguration.cacheEvictionPolicy`等属性配置
++ (nonnull EMASCurlCacheStatistics *)cacheStatistics;
+
+/// 清空响应缓存：NSURLCache中的条目、独立存放的大响应体文件与淘汰索引。
+/// 直接调用`[NSURLCache removeAllCachedResponses]`不会删除大响应体文件，应改用本方法
++ (void)removeAllCachedResponses;
+
+/// 获取各host、协议的请求耗时与字节数分布（进程内累计值），包括分位数p50/p90/p99
+/// 记录只做原子累加，取快照不阻塞网络线程；reset为YES时取快照的同时清零，每个样本只会计入一次快照
++ (nonnull NSArray<EMASCurlHostLatencySnapshot *> *)hostLatencySnapshotsResetting:(BOOL)reset;
+
+/// 添加随应用分发的预置缓存包（由create_cache_seed_pack.py或writeCacheSeedPackWithEntries:toPath:生成），
+/// 用于首次启动时命中静态配置与资源请求。预置包是只读的下层缓存：NSURLCache未命中时查找，后添加的包优先；
+/// 打开时只做内存映射，不复制数据，条目在首次查找时才校验。条目过期后若有ETag/Last-Modified，
+/// 会以条件请求校验，304时写入NSURLCache
+/// @return 文件不存在或格式无效时返回NO
++ (BOOL)addCacheSeedPackAtPath:(nonnull NSString *)path;
+
+/// 将条目打包为预置缓存包文件。条目新鲜度从打包时间起算
++ (BOOL)writeCacheSeedPackWithEntries:(nonnull NSArray<EMASCurlCacheSeedEntry *> *)entries toPath:(nonnull NSString *)path;
+
+/// 设置内存压力事件观察回调。收到系统内存警告/严重压力时，EMASCurl会缩减内存缓存并释放传输中为缓存缓冲的响应体，
+/// 处理完成后回调本次事件各组件释放的字节数。回调在内部串行队列执行
++ (void)setMemoryPressureObserverBlock:(nullable EMASCurlMemoryPressureObserverBlock)memoryPressureObserverBlock;
+
 /// 为指定请求设置性能指标观察回调（已废弃，请使用全局回调）
 /// @param request 请求对象
 /// @param metricsObserverBlock 性能指标回调
@@ -172,6 +248,34 @@ typedef void(^EMASCurlLogHandlerBlock)(EMASCurlLogLevel level, NSString * _Nonnu
 // 较低的值会促使建立更多连接，减少单连接上的流排队等待
 + (void)setMaxConcurrentStreamsPerConnection:(NSInteger)maxStreams;
 
+// 获取连接缓存中各连接的快照：host、地址、协议、存活与空闲时长、进行中的流数、复用次数与字节数
+// 在网络线程上收集，调用方会等待网络线程处理完当前一轮事件
++ (nonnull NSArray<EMASCurlConnectionInfo *> *)connectionPoolSnapshot;
+
+#pragma mark - 网络质量
+
+// 获取当前网络的质量估计（建连RTT、下载吞吐、失败率的滑动平均及分级），可在任意线程调用
+// 据此自适应的连接超时、host并发与预取推迟通过EMASCurlConfiguration的adaptive*开关开启
++ (nonnull EMASCurlNetworkQualityEstimate *)currentNetworkQuality;
+
+#pragma mark - 带宽整形
+
+// 设置是否按请求优先级整形带宽，默认启用；关闭后后台优先级的请求不再限速
++ (void)setBandwidthShapingEnabled:(BOOL)enabled;
+
+#pragma mark - 请求阶段追踪
+
+// 设置是否记录请求各阶段的起止时间，默认关闭；关闭时每个请求只多一次分支判断
+// 阶段包括缓存查询、排队、DNS、建连、TLS、发送请求、等待首字节、接收响应体和回调交付，
+// 写入固定容量（8192个事件）的环形缓冲区，写满后覆盖最旧的事件
++ (void)setRequestTracingEnabled:(BOOL)enabled;
+
+// 以Chrome Trace Event格式（JSON）导出已记录的事件，每个请求一条轨道，可在Perfetto或chrome://tracing中打开
++ (nonnull NSData *)exportRequestTraceJSON;
+
+// 丢弃已记录的事件
++ (void)clearRequestTrace;
+
 #pragma mark - 全局拦截开关
 
 // 设置是否启用请求拦截，默认启用
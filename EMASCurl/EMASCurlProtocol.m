@@ -9,11 +9,27 @@
 #import "EMASCurlManager.h"
 #import "EMASCurlCookieStorage.h"
 #import "EMASCurlResponseCache.h"
+#import "EMASCurlCacheSeedPack.h"
+#import "EMASCurlSparseCacheEntry.h"
+#import "EMASCurlCacheCompressor.h"
+#import "EMASCurlCacheIndex.h"
+#import "EMASCurlMemoryPressureManager.h"
+#import "EMASCurlHeaderParser.h"
+#import "EMASCurlRequestMatcher.h"
+#import "EMASCurlUploadBodyPump.h"
 #import "NSCachedURLResponse+EMASCurl.h"
 #import "EMASCurlLogger.h"
 #import "EMASCurlConfiguration.h"
 #import "EMASCurlConfigurationManager.h"
 #import "EMASCurlProxySetting.h"
+#import "EMASCurlProgressReporter.h"
+#import "EMASCurlRequestBodyEncoder.h"
+#import "EMASCurlFileDownloadSink.h"
+#import "EMASCurlSegmentedDownload.h"
+#import "EMASCurlDownloadResumeRecord.h"
+#import "EMASCurlLatencyHistogram.h"
+#import "EMASCurlTraceRecorder.h"
+#import "EMASCurlNetworkQualityEstimator.h"
 #import <curl/curl.h>
 #import <CoreTelephony/CTTelephonyNetworkInfo.h>
 #import <NetworkExtension/NetworkExtension.h>
@@ -29,12 +45,20 @@
 #define HTTP_METHOD_CONNECT @"CONNECT"
 
 static NSString * _Nonnull const kEMASCurlUploadProgressUpdateBlockKey = @"kEMASCurlUploadProgressUpdateBlockKey";
+static NSString * _Nonnull const kEMASCurlDownloadProgressUpdateBlockKey = @"kEMASCurlDownloadProgressUpdateBlockKey";
 static NSString * _Nonnull const kEMASCurlMetricsObserverBlockKey = @"kEMASCurlMetricsObserverBlockKey";
 
 static NSString * _Nonnull const kEMASCurlConnectTimeoutIntervalKey = @"kEMASCurlConnectTimeoutIntervalKey";
 // 内部 APM 监控去重依赖该标记，谨慎修改！
 static NSString * _Nonnull const kEMASCurlHandledKey = @"kEMASCurlHandledKey";
 static NSString * _Nonnull const kEMASCurlRequestInterceptEnabledKey = @"kEMASCurlRequestInterceptEnabledKey";
+static NSString * _Nonnull const kEMASCurlUploadBodyDataKey = @"kEMASCurlUploadBodyDataKey";
+static NSString * _Nonnull const kEMASCurlUploadBodyFilePathKey = @"kEMASCurlUploadBodyFilePathKey";
+static NSString * _Nonnull const kEMASCurlRequestBodyEncodingKey = @"kEMASCurlRequestBodyEncodingKey";
+static NSString * _Nonnull const kEMASCurlDownloadDestinationPathKey = @"kEMASCurlDownloadDestinationPathKey";
+static NSString * _Nonnull const kEMASCurlDownloadSegmentCountKey = @"kEMASCurlDownloadSegmentCountKey";
+static NSString * _Nonnull const kEMASCurlDownloadResumableKey = @"kEMASCurlDownloadResumableKey";
+static NSString * _Nonnull const kEMASCurlRequestPriorityKey = @"kEMASCurlRequestPriorityKey";
 
 // Multi-instance configuration support
 static NSString * _Nonnull const kEMASCurlConfigurationIDKey = @"kEMASCurlConfigurationIDKey";
@@ -42,6 +66,12 @@ static NSString * _Nonnull const kEMASCurlConfigurationHeaderKey = @"X-EMASCurl-
 
 static const long kEMASCurlMaxConnectionIdleAgeSeconds = 30L;
 
+// 每个上传预读的请求体上限
+static const NSUInteger kEMASUploadBodyPumpCapacity = 256 * 1024;
+
+// 已知长度小于该值的请求体不压缩，压缩收益抵不过gzip头尾开销
+static const int64_t kEMASRequestBodyEncodingMinimumBytes = 1024;
+
 // RFC 7234 可能可缓存的状态码（实际可缓存性由 emas_cachedResponseWithHTTPURLResponse 决定）
 static BOOL isPotentiallyCacheableStatusCode(NSInteger statusCode) {
     switch (statusCode) {
@@ -62,46 +92,201 @@ static BOOL isPotentiallyCacheableStatusCode(NSInteger statusCode) {
     }
 }
 
-/**
- * 检查请求路径是否匹配黑名单模式
- * @param requestPath 请求的URL路径
- * @param pattern 黑名单模式
- * @return 匹配返回YES
- */
-static BOOL emas_pathMatchesPattern(NSString *requestPath, NSString *pattern) {
-    if (!requestPath || !pattern) {
-        return NO;
-    }
+// 基于已有响应头构造指定区间的206响应，Content-Range/Content-Length按新区间重写
+static NSHTTPURLResponse *EMASPartialContentResponse(NSHTTPURLResponse *response,
+                                                     NSURL *URL,
+                                                     NSString *httpVersion,
+                                                     NSRange range,
+                                                     unsigned long long totalLength) {
+    NSMutableDictionary<NSString *, NSString *> *headers = [NSMutableDictionary dictionary];
+    [response.allHeaderFields enumerateKeysAndObjectsUsingBlock:^(id key, id obj, BOOL *stop) {
+        if ([key caseInsensitiveCompare:EMASHTTPHeaderContentRange] == NSOrderedSame ||
+            [key caseInsensitiveCompare:@"Content-Length"] == NSOrderedSame) {
+            return;
+        }
+        headers[key] = obj;
+    }];
+    headers[EMASHTTPHeaderContentRange] = [NSString stringWithFormat:@"bytes %lu-%lu/%llu",
+                                           (unsigned long)range.location,
+                                           (unsigned long)(NSMaxRange(range) - 1),
+                                           totalLength];
+    headers[@"Content-Length"] = [NSString stringWithFormat:@"%lu", (unsigned long)range.length];
+    return [[NSHTTPURLResponse alloc] initWithURL:URL
+                                       statusCode:206
+                                      HTTPVersion:httpVersion ?: @"HTTP/1.1"
+                                     headerFields:headers];
+}
+
+// 续传得到的206响应对客户端呈现为完整资源的200响应，Content-Length为完整长度
+static NSHTTPURLResponse *EMASResumedFullContentResponse(NSHTTPURLResponse *response,
+                                                         NSString *httpVersion,
+                                                         unsigned long long totalLength) {
+    NSMutableDictionary<NSString *, NSString *> *headers = [NSMutableDictionary dictionary];
+    [response.allHeaderFields enumerateKeysAndObjectsUsingBlock:^(id key, id obj, BOOL *stop) {
+        if ([key caseInsensitiveCompare:EMASHTTPHeaderContentRange] == NSOrderedSame ||
+            [key caseInsensitiveCompare:@"Content-Length"] == NSOrderedSame) {
+            return;
+        }
+        headers[key] = obj;
+    }];
+    headers[@"Content-Length"] = [NSString stringWithFormat:@"%llu", totalLength];
+    return [[NSHTTPURLResponse alloc] initWithURL:response.URL
+                                       statusCode:200
+                                      HTTPVersion:httpVersion ?: @"HTTP/1.1"
+                                     headerFields:headers];
+}
 
-    // 多级通配符: "/sample/**"
-    if ([pattern hasSuffix:@"/**"]) {
-        NSString *prefix = [pattern substringToIndex:pattern.length - 3];
-        // 匹配前缀本身或前缀加任意后续路径
-        return [requestPath isEqualToString:prefix] ||
-               [requestPath hasPrefix:[prefix stringByAppendingString:@"/"]];
+// 可用于If-Range的校验器：强ETag优先，否则Last-Modified；弱ETag不能用于If-Range
+static NSString *EMASStrongValidatorFromHeaders(const EMASHeaderParser *parser) {
+    const EMASHeaderField *etagField = EMASHeaderParserFindKnown(parser, EMASKnownHeaderETag);
+    NSString *etag = etagField ? EMASHeaderParserCopyFieldValue(parser, etagField) : nil;
+    if (etag.length > 0 && ![etag hasPrefix:@"W/"]) {
+        return etag;
     }
+    const EMASHeaderField *lastModifiedField = EMASHeaderParserFindKnown(parser, EMASKnownHeaderLastModified);
+    NSString *lastModified = lastModifiedField ? EMASHeaderParserCopyFieldValue(parser, lastModifiedField) : nil;
+    return lastModified.length > 0 ? lastModified : nil;
+}
 
-    // 单级通配符: "/sample/*"
-    if ([pattern hasSuffix:@"/*"]) {
-        NSString *prefix = [pattern substringToIndex:pattern.length - 2];
-        // 匹配前缀本身（无尾斜杠）
-        if ([requestPath isEqualToString:prefix]) {
-            return YES;
-        }
-        // 匹配 prefix/ 开头，且之后不能再有 /
-        if ([requestPath hasPrefix:[prefix stringByAppendingString:@"/"]]) {
-            NSString *remaining = [requestPath substringFromIndex:prefix.length + 1];
-            return ![remaining containsString:@"/"];
-        }
-        return NO;
+// 综合性能指标中的各时间点
+typedef NS_ENUM(NSInteger, EMASCurlTimestamp) {
+    EMASCurlTimestampFetchStart = 0,
+    EMASCurlTimestampDomainLookupStart,
+    EMASCurlTimestampDomainLookupEnd,
+    EMASCurlTimestampConnectStart,
+    EMASCurlTimestampConnectEnd,
+    EMASCurlTimestampSecureConnectionStart,
+    EMASCurlTimestampSecureConnectionEnd,
+    EMASCurlTimestampRequestStart,
+    EMASCurlTimestampRequestEnd,
+    EMASCurlTimestampResponseStart,
+    EMASCurlTimestampResponseEnd,
+    EMASCurlTimestampCount
+};
+
+// 各时间点相对请求起点的单调时钟偏移（纳秒），-1表示没有该阶段；起点的墙上时间只在换算NSDate时使用
+typedef struct {
+    NSTimeInterval startTimeIntervalSince1970;
+    int64_t offsetsNs[EMASCurlTimestampCount];
+} EMASCurlTimestamps;
+
+// 只有fetchStart的时间点集合
+static EMASCurlTimestamps EMASCurlTimestampsMake(NSTimeInterval startTimeIntervalSince1970) {
+    EMASCurlTimestamps timestamps;
+    timestamps.startTimeIntervalSince1970 = startTimeIntervalSince1970;
+    for (NSInteger i = 0; i < EMASCurlTimestampCount; i++) {
+        timestamps.offsetsNs[i] = -1;
     }
+    timestamps.offsetsNs[EMASCurlTimestampFetchStart] = 0;
+    return timestamps;
+}
+
+// libcurl阶段时间（微秒，从加入multi起算）换算为相对请求起点的偏移
+static inline int64_t EMASCurlPhaseOffsetNs(int64_t transferOffsetNs, curl_off_t us) {
+    return transferOffsetNs + (int64_t)MAX(us, 0) * (int64_t)NSEC_PER_USEC;
+}
 
-    // 完全匹配
-    return [requestPath isEqualToString:pattern];
+@interface EMASCurlTransactionMetrics () {
+    EMASCurlTimestamps _timestamps;
 }
 
+- (void)setTimestamps:(const EMASCurlTimestamps *)timestamps;
+
+@end
+
 // EMASCurlTransactionMetrics实现
+// 时间戳在读取时才换算为NSDate，观察者不读取则不产生对象；显式赋值的优先
 @implementation EMASCurlTransactionMetrics
+
+- (instancetype)init {
+    self = [super init];
+    if (self) {
+        for (NSInteger i = 0; i < EMASCurlTimestampCount; i++) {
+            _timestamps.offsetsNs[i] = -1;
+        }
+    }
+    return self;
+}
+
+- (void)setTimestamps:(const EMASCurlTimestamps *)timestamps {
+    _timestamps = *timestamps;
+}
+
+- (nullable NSDate *)dateForTimestamp:(EMASCurlTimestamp)timestamp {
+    int64_t offsetNs = _timestamps.offsetsNs[timestamp];
+    if (offsetNs < 0) {
+        return nil;
+    }
+    return [NSDate dateWithTimeIntervalSince1970:_timestamps.startTimeIntervalSince1970 + (double)offsetNs / NSEC_PER_SEC];
+}
+
+- (NSDate *)fetchStartDate {
+    return _fetchStartDate ?: [self dateForTimestamp:EMASCurlTimestampFetchStart];
+}
+
+- (NSDate *)domainLookupStartDate {
+    return _domainLookupStartDate ?: [self dateForTimestamp:EMASCurlTimestampDomainLookupStart];
+}
+
+- (NSDate *)domainLookupEndDate {
+    return _domainLookupEndDate ?: [self dateForTimestamp:EMASCurlTimestampDomainLookupEnd];
+}
+
+- (NSDate *)connectStartDate {
+    return _connectStartDate ?: [self dateForTimestamp:EMASCurlTimestampConnectStart];
+}
+
+- (NSDate *)connectEndDate {
+    return _connectEndDate ?: [self dateForTimestamp:EMASCurlTimestampConnectEnd];
+}
+
+- (NSDate *)secureConnectionStartDate {
+    return _secureConnectionStartDate ?: [self dateForTimestamp:EMASCurlTimestampSecureConnectionStart];
+}
+
+- (NSDate *)secureConnectionEndDate {
+    return _secureConnectionEndDate ?: [self dateForTimestamp:EMASCurlTimestampSecureConnectionEnd];
+}
+
+- (NSDate *)requestStartDate {
+    return _requestStartDate ?: [self dateForTimestamp:EMASCurlTimestampRequestStart];
+}
+
+- (NSDate *)requestEndDate {
+    return _requestEndDate ?: [self dateForTimestamp:EMASCurlTimestampRequestEnd];
+}
+
+- (NSDate *)responseStartDate {
+    return _responseStartDate ?: [self dateForTimestamp:EMASCurlTimestampResponseStart];
+}
+
+- (NSDate *)responseEndDate {
+    return _responseEndDate ?: [self dateForTimestamp:EMASCurlTimestampResponseEnd];
+}
+
+@end
+
+@implementation EMASCurlCacheCompressionStatistics
+
+- (double)compressionRatio {
+    if (self.compressedBytes == 0) {
+        return 0;
+    }
+    return (double)self.originalBytes / (double)self.compressedBytes;
+}
+
+@end
+
+@implementation EMASCurlCacheStatistics
+
+- (double)hitRatio {
+    NSUInteger total = self.hitCount + self.missCount;
+    if (total == 0) {
+        return 0;
+    }
+    return (double)self.hitCount / (double)total;
+}
+
 @end
 
 @interface CurlHTTPResponse : NSObject
@@ -116,6 +301,12 @@ static BOOL emas_pathMatchesPattern(NSString *requestPath, NSString *pattern) {
 
 @property (nonatomic, assign) BOOL isFinalResponse;
 
+// 逐行解析响应头，头部结束时才生成上面的字符串与字典；每个新头部从状态行开始，解析器随之重置
+@property (nonatomic, assign, nullable) EMASHeaderParser *headerParser;
+
+// 已处理过Set-Cookie的字段数，避免trailer结束时重复设置
+@property (nonatomic, assign) size_t processedCookieFieldCount;
+
 @end
 
 @implementation CurlHTTPResponse
@@ -123,17 +314,23 @@ static BOOL emas_pathMatchesPattern(NSString *requestPath, NSString *pattern) {
 - (instancetype)init {
     self = [super init];
     if (self) {
+        _headerParser = EMASHeaderParserCreate();
         [self reset];
     }
     return self;
 }
 
+- (void)dealloc {
+    EMASHeaderParserDestroy(_headerParser);
+}
+
 - (void)reset {
     _statusCode = 0;
     _httpVersion = nil;
     _reasonPhrase = nil;
     _headers = [NSMutableDictionary new];
     _isFinalResponse = NO;
+    _processedCookieFieldCount = 0;
 }
 
 @end
@@ -142,7 +339,14 @@ static BOOL emas_pathMatchesPattern(NSString *requestPath, NSString *pattern) {
 
 @property (nonatomic, assign) CURL *easyHandle;
 
-@property (nonatomic, strong) NSInputStream *inputStream;
+// 在I/O队列上读取请求体流，网络线程只从其缓冲区取数据
+@property (nonatomic, strong) EMASCurlUploadBodyPump *uploadBodyPump;
+
+// 直接交给libcurl发送的请求体，libcurl不复制该内存，需保持到协议对象释放
+@property (nonatomic, strong) NSData *uploadBodyData;
+
+// 请求体压缩时的编码器，在上传泵的I/O队列上使用，传输结束后用于统计字节数
+@property (nonatomic, strong) EMASCurlRequestBodyEncoder *requestBodyEncoder;
 
 @property (nonatomic, assign) struct curl_slist *requestHeaderFields;
 
@@ -160,13 +364,61 @@ static BOOL emas_pathMatchesPattern(NSString *requestPath, NSString *pattern) {
 
 @property (nonatomic, copy) EMASCurlUploadProgressUpdateBlock uploadProgressUpdateBlock;
 
+@property (nonatomic, copy) EMASCurlDownloadProgressUpdateBlock downloadProgressUpdateBlock;
+
+// 合并进度事件并在回调队列上交付，未设置对应回调时为nil
+@property (nonatomic, strong) EMASCurlProgressReporter *uploadProgressReporter;
+
+@property (nonatomic, strong) EMASCurlProgressReporter *downloadProgressReporter;
+
+@property (nonatomic, assign) int64_t totalBytesReceived;
+
+// 响应体直接写入的目标文件，未设置时为nil
+@property (nonatomic, copy) NSString *downloadDestinationPath;
+
+// 最终响应为2xx时创建，只在网络线程访问
+@property (nonatomic, strong) EMASCurlFileDownloadSink *downloadFileSink;
+
+// 创建目标文件失败的原因
+@property (nonatomic, strong) NSError *downloadFileError;
+
+// 下载到文件时期望的并发段数，不大于1表示不分段
+@property (nonatomic, assign) NSUInteger downloadSegmentCount;
+
+// 响应确认可分段后创建，只在网络线程访问
+@property (nonatomic, strong) EMASCurlSegmentedDownload *segmentedDownload;
+
+// 下载到文件时失败或取消后保留已下载的数据，下次续传
+@property (nonatomic, assign) BOOL downloadResumable;
+
+// 可续传下载的进度记录，响应不支持续传时置为nil
+@property (nonatomic, strong) EMASCurlDownloadResumeRecord *downloadResumeRecord;
+
+// 续传请求的Range起点，0表示从头下载
+@property (nonatomic, assign) int64_t resumeOffset;
+
+// 服务端接受续传时复用的已下载字节数
+@property (nonatomic, assign) int64_t downloadResumedBytes;
+
+// 带宽整形使用的优先级
+@property (nonatomic, assign) EMASCurlRequestPriority requestPriority;
+
+// 请求阶段追踪，开启追踪时startLoading分配，0表示不追踪
+@property (nonatomic, assign) uint64_t traceRequestId;
+@property (nonatomic, assign) uint64_t traceStartNs;
+// 传输结束、开始向客户端交付结果的时刻
+@property (nonatomic, assign) uint64_t traceCallbackStartNs;
+
+@property (nonatomic, assign) int64_t totalBytesExpectedToReceive;
+
 @property (nonatomic, copy) EMASCurlMetricsObserverBlock metricsObserverBlock;
 
 @property (nonatomic, assign) double resolveDomainTimeInterval;
 
 @property (nonatomic, assign) BOOL usedCustomDNSResolverResult;
 
-@property (nonatomic, strong) NSMutableData *receivedResponseData;
+// 网络线程写入；内存压力时在网络线程置空，完成回调在其他线程读取，因此声明为atomic
+@property (atomic, strong) NSMutableData *receivedResponseData;
 
 @property (nonatomic, strong) EMASCurlConfiguration *resolvedConfiguration;
 
@@ -177,18 +429,18 @@ static BOOL emas_pathMatchesPattern(NSString *requestPath, NSString *pattern) {
 @property (nonatomic, assign) BOOL shouldBufferBodyForCache;
 @property (nonatomic, assign) NSUInteger bufferedCacheBytes;
 
-// 时间记录属性
-@property (nonatomic, strong) NSDate *fetchStartDate;
-@property (nonatomic, strong) NSDate *domainLookupStartDate;
-@property (nonatomic, strong) NSDate *domainLookupEndDate;
-@property (nonatomic, strong) NSDate *connectStartDate;
-@property (nonatomic, strong) NSDate *secureConnectionStartDate;
-@property (nonatomic, strong) NSDate *secureConnectionEndDate;
-@property (nonatomic, strong) NSDate *connectEndDate;
-@property (nonatomic, strong) NSDate *requestStartDate;
-@property (nonatomic, strong) NSDate *requestEndDate;
-@property (nonatomic, strong) NSDate *responseStartDate;
-@property (nonatomic, strong) NSDate *responseEndDate;
+// Range请求与稀疏缓存拼接：客户端请求的区间、实际向网络请求的区间，以及提供其余字节的缓存条目
+@property (nonatomic, assign) NSRange requestedByteRange;
+@property (nonatomic, assign) NSRange networkByteRange;
+@property (nonatomic, strong) EMASCurlSparseCacheEntry *sparseCacheEntry;
+@property (nonatomic, assign) BOOL splicingSparseCache;
+
+// 请求起点，startLoading时记录；各阶段按单调时钟计算，墙上时间只用于换算NSDate
+@property (nonatomic, assign) uint64_t startMonotonicNs;
+@property (nonatomic, assign) NSTimeInterval startTimeIntervalSince1970;
+// 自定义DNS解析的单调起止时刻
+@property (nonatomic, assign) uint64_t resolveDomainStartNs;
+@property (nonatomic, assign) uint64_t resolveDomainEndNs;
 
 // 客户端回调线程/RunLoop信息
 @property (nonatomic, strong) NSThread *clientThread;
@@ -207,6 +459,12 @@ static BOOL emas_pathMatchesPattern(NSString *requestPath, NSString *pattern) {
 
 - (void)invokeOnClientThread:(dispatch_block_t)block;
 
+// 总是异步投递到客户端线程，即使当前就在客户端线程
+- (void)scheduleOnClientThread:(dispatch_block_t)block;
+
+// 等已提交的进度回调执行完毕后再投递到客户端线程，期间不阻塞任何线程
+- (void)invokeOnClientThreadAfterProgressDelivered:(dispatch_block_t)block;
+
 - (BOOL)markClientNotifiedIfNeeded;
 
 - (BOOL)hasClientNotified;
@@ -221,6 +479,10 @@ static BOOL curlFeatureHttp2;
 // runtime 的libcurl xcframework是否支持HTTP3
 static BOOL curlFeatureHttp3;
 
+// runtime 的libcurl xcframework是否支持brotli与zstd内容解码
+static BOOL curlFeatureBrotli;
+static BOOL curlFeatureZstd;
+
 // 全局日志设置
 static BOOL s_enableDebugLog;
 
@@ -233,6 +495,9 @@ static EMASCurlResponseCache *s_responseCache;
 // 全局综合性能指标观察回调
 static EMASCurlTransactionMetricsObserverBlock globalTransactionMetricsObserverBlock = nil;
 
+// 正在为缓存缓冲响应体的请求，只在网络线程访问
+static NSHashTable<EMASCurlProtocol *> *s_cacheBufferingProtocols;
+
 @implementation EMASCurlProtocol
 
 #pragma mark * user API
@@ -295,6 +560,58 @@ static EMASCurlTransactionMetricsObserverBlock globalTransactionMetricsObserverB
     [NSURLProtocol setProperty:[uploadProgressUpdateBlock copy] forKey:kEMASCurlUploadProgressUpdateBlockKey inRequest:request];
 }
 
++ (void)setDownloadProgressUpdateBlockForRequest:(nonnull NSMutableURLRequest *)request downloadProgressUpdateBlock:(nonnull EMASCurlDownloadProgressUpdateBlock)downloadProgressUpdateBlock {
+    [NSURLProtocol setProperty:[downloadProgressUpdateBlock copy] forKey:kEMASCurlDownloadProgressUpdateBlockKey inRequest:request];
+}
+
++ (void)setDownloadDestinationFileURL:(nonnull NSURL *)fileURL forRequest:(nonnull NSMutableURLRequest *)request {
+    if (!fileURL.isFileURL) {
+        EMAS_LOG_ERROR(@"EC-Download", @"Download destination is not a file URL: %@", fileURL);
+        return;
+    }
+    [NSURLProtocol setProperty:fileURL.path forKey:kEMASCurlDownloadDestinationPathKey inRequest:request];
+}
+
++ (void)setDownloadSegmentCount:(NSUInteger)segmentCount forRequest:(nonnull NSMutableURLRequest *)request {
+    [NSURLProtocol setProperty:@(segmentCount) forKey:kEMASCurlDownloadSegmentCountKey inRequest:request];
+}
+
++ (void)setDownloadResumable:(BOOL)resumable forRequest:(nonnull NSMutableURLRequest *)request {
+    [NSURLProtocol setProperty:@(resumable) forKey:kEMASCurlDownloadResumableKey inRequest:request];
+}
+
++ (void)setRequestPriority:(EMASCurlRequestPriority)priority forRequest:(nonnull NSMutableURLRequest *)request {
+    [NSURLProtocol setProperty:@(priority) forKey:kEMASCurlRequestPriorityKey inRequest:request];
+}
+
++ (void)setRequestBodyEncoding:(EMASCurlRequestBodyEncoding)encoding forRequest:(nonnull NSMutableURLRequest *)request {
+    [NSURLProtocol setProperty:@(encoding) forKey:kEMASCurlRequestBodyEncodingKey inRequest:request];
+}
+
++ (void)setUploadBodyData:(nonnull NSData *)data forRequest:(nonnull NSMutableURLRequest *)request {
+    NSData *body = [data copy];
+    // 保留HTTPBody，请求未被拦截时由系统正常发送
+    request.HTTPBody = body;
+    [NSURLProtocol removePropertyForKey:kEMASCurlUploadBodyFilePathKey inRequest:request];
+    [NSURLProtocol setProperty:body forKey:kEMASCurlUploadBodyDataKey inRequest:request];
+}
+
++ (void)setUploadBodyFileURL:(nonnull NSURL *)fileURL forRequest:(nonnull NSMutableURLRequest *)request {
+    if (!fileURL.isFileURL) {
+        EMAS_LOG_ERROR(@"EC-Upload", @"Upload body URL is not a file URL: %@", fileURL);
+        return;
+    }
+
+    // 保留等价的HTTPBodyStream，请求未被拦截时由系统正常发送
+    request.HTTPBodyStream = [NSInputStream inputStreamWithURL:fileURL];
+    NSNumber *fileSize = [[NSFileManager defaultManager] attributesOfItemAtPath:fileURL.path error:nil][NSFileSize];
+    if (fileSize) {
+        [request setValue:fileSize.stringValue forHTTPHeaderField:@"Content-Length"];
+    }
+    [NSURLProtocol removePropertyForKey:kEMASCurlUploadBodyDataKey inRequest:request];
+    [NSURLProtocol setProperty:fileURL.path forKey:kEMASCurlUploadBodyFilePathKey inRequest:request];
+}
+
 + (void)setGlobalTransactionMetricsObserverBlock:(nullable EMASCurlTransactionMetricsObserverBlock)transactionMetricsObserverBlock {
     @synchronized (self) {
         globalTransactionMetricsObserverBlock = [transactionMetricsObserverBlock copy];
@@ -307,6 +624,50 @@ static EMASCurlTransactionMetricsObserverBlock globalTransactionMetricsObserverB
     }
 }
 
++ (nonnull EMASCurlCacheCompressionStatistics *)cacheCompressionStatistics {
+    return [s_responseCache compressionStatistics];
+}
+
++ (nonnull EMASCurlCacheStatistics *)cacheStatistics {
+    return [s_responseCache cacheStatistics];
+}
+
++ (void)removeAllCachedResponses {
+    [s_responseCache removeAllCachedResponses];
+}
+
++ (nonnull NSArray<EMASCurlHostLatencySnapshot *> *)hostLatencySnapshotsResetting:(BOOL)reset {
+    return [[EMASCurlLatencyHistograms sharedInstance] snapshotsResetting:reset];
+}
+
++ (BOOL)addCacheSeedPackAtPath:(nonnull NSString *)path {
+    return [s_responseCache addSeedPackAtPath:path];
+}
+
++ (BOOL)writeCacheSeedPackWithEntries:(nonnull NSArray<EMASCurlCacheSeedEntry *> *)entries toPath:(nonnull NSString *)path {
+    return [EMASCurlCacheSeedPack writePackWithEntries:entries toPath:path];
+}
+
++ (void)setMemoryPressureObserverBlock:(nullable EMASCurlMemoryPressureObserverBlock)memoryPressureObserverBlock {
+    [EMASCurlMemoryPressureManager sharedManager].observer = memoryPressureObserverBlock;
+}
+
+// 停止所有传输的缓存缓冲并释放已缓冲的数据，这些响应不会再写入缓存
++ (NSUInteger)releaseCacheBuffersOnNetworkThread {
+    NSUInteger releasedBytes = 0;
+    for (EMASCurlProtocol *protocol in s_cacheBufferingProtocols) {
+        if (!protocol.shouldBufferBodyForCache && !protocol.receivedResponseData) {
+            continue;
+        }
+        releasedBytes += protocol.receivedResponseData.length;
+        protocol.shouldBufferBodyForCache = NO;
+        protocol.receivedResponseData = nil;
+        protocol.bufferedCacheBytes = 0;
+    }
+    [s_cacheBufferingProtocols removeAllObjects];
+    return releasedBytes;
+}
+
 + (void)setMetricsObserverBlockForRequest:(nonnull NSMutableURLRequest *)request metricsObserverBlock:(nonnull EMASCurlMetricsObserverBlock)metricsObserverBlock {
     [NSURLProtocol setProperty:[metricsObserverBlock copy] forKey:kEMASCurlMetricsObserverBlockKey inRequest:request];
 }
@@ -376,6 +737,30 @@ static EMASCurlTransactionMetricsObserverBlock globalTransactionMetricsObserverB
     [[EMASCurlManager sharedInstance] setMaxConcurrentStreamsPerConnection:maxStreams];
 }
 
++ (EMASCurlNetworkQualityEstimate *)currentNetworkQuality {
+    return [[EMASCurlNetworkQualityEstimator sharedInstance] currentEstimate];
+}
+
++ (NSArray<EMASCurlConnectionInfo *> *)connectionPoolSnapshot {
+    return [[EMASCurlManager sharedInstance] connectionPoolSnapshot];
+}
+
++ (void)setBandwidthShapingEnabled:(BOOL)enabled {
+    [[EMASCurlManager sharedInstance] setBandwidthShapingEnabled:enabled];
+}
+
++ (void)setRequestTracingEnabled:(BOOL)enabled {
+    [EMASCurlTraceRecorder setEnabled:enabled];
+}
+
++ (nonnull NSData *)exportRequestTraceJSON {
+    return [EMASCurlTraceRecorder exportChromeTraceJSON];
+}
+
++ (void)clearRequestTrace {
+    [EMASCurlTraceRecorder clear];
+}
+
 + (void)setRequestInterceptEnabled:(BOOL)requestInterceptEnabled {
     @synchronized (self) {
         s_requestInterceptEnabled = requestInterceptEnabled;
@@ -407,11 +792,25 @@ static EMASCurlTransactionMetricsObserverBlock globalTransactionMetricsObserverB
     curl_version_info_data *version_info = curl_version_info(CURLVERSION_NOW);
     curlFeatureHttp2 = (version_info->features & CURL_VERSION_HTTP2) ? YES : NO;
     curlFeatureHttp3 = (version_info->features & CURL_VERSION_HTTP3) ? YES : NO;
+    curlFeatureBrotli = (version_info->features & CURL_VERSION_BROTLI) ? YES : NO;
+    curlFeatureZstd = (version_info->features & CURL_VERSION_ZSTD) ? YES : NO;
 
     s_enableDebugLog = NO;
 
     s_responseCache = [EMASCurlResponseCache new];
 
+    // 内存压力时释放传输中为缓存缓冲的响应体；缓冲只在网络线程读写，释放也在网络线程执行
+    s_cacheBufferingProtocols = [NSHashTable weakObjectsHashTable];
+    [[EMASCurlMemoryPressureManager sharedManager] registerReleaseHandler:^(EMASCurlMemoryPressureLevel level, void (^completion)(NSUInteger)) {
+        if (level == EMASCurlMemoryPressureNormal) {
+            completion(0);
+            return;
+        }
+        [[EMASCurlManager sharedInstance] performBlockOnNetworkThread:^{
+            completion([EMASCurlProtocol releaseCacheBuffersOnNetworkThread]);
+        }];
+    } forComponent:EMASCurlMemoryComponentTransferBuffers];
+
     // 显式引用以触发 EMASCurlProxySetting 的 +initialize，确保尽早建立系统代理监听
     (void)[EMASCurlProxySetting class];
 }
@@ -423,17 +822,24 @@ static EMASCurlTransactionMetricsObserverBlock globalTransactionMetricsObserverB
         _cleanupSemaphore = dispatch_semaphore_create(0);
         _totalBytesSent = 0;
         _totalBytesExpected = 0;
+        _totalBytesReceived = 0;
+        _totalBytesExpectedToReceive = -1;
         _currentResponse = [CurlHTTPResponse new];
         _resolveDomainTimeInterval = -1;
         _usedCustomDNSResolverResult = NO;
-
-        // 初始化时间记录
-        _fetchStartDate = [NSDate date];
         _receivedResponseData = [NSMutableData new];
         _shouldBufferBodyForCache = NO;
         _bufferedCacheBytes = 0;
+        _requestedByteRange = NSMakeRange(NSNotFound, 0);
+        _networkByteRange = NSMakeRange(NSNotFound, 0);
+        _splicingSparseCache = NO;
 
         _uploadProgressUpdateBlock = [NSURLProtocol propertyForKey:kEMASCurlUploadProgressUpdateBlockKey inRequest:request];
+        _downloadProgressUpdateBlock = [NSURLProtocol propertyForKey:kEMASCurlDownloadProgressUpdateBlockKey inRequest:request];
+        _downloadDestinationPath = [NSURLProtocol propertyForKey:kEMASCurlDownloadDestinationPathKey inRequest:request];
+        _downloadSegmentCount = [[NSURLProtocol propertyForKey:kEMASCurlDownloadSegmentCountKey inRequest:request] unsignedIntegerValue];
+        _downloadResumable = [[NSURLProtocol propertyForKey:kEMASCurlDownloadResumableKey inRequest:request] boolValue];
+        _requestPriority = [[NSURLProtocol propertyForKey:kEMASCurlRequestPriorityKey inRequest:request] integerValue];
         _metricsObserverBlock = [NSURLProtocol propertyForKey:kEMASCurlMetricsObserverBlockKey inRequest:request];
 
         _clientNotified = NO;
@@ -492,46 +898,30 @@ static EMASCurlTransactionMetricsObserverBlock globalTransactionMetricsObserverB
         config = [[EMASCurlConfigurationManager sharedManager] defaultConfiguration];
     }
 
-    // 使用配置中的域名黑白名单
-    NSArray<NSString *> *domainBlackList = config.domainBlackList;
-    NSArray<NSString *> *domainWhiteList = config.domainWhiteList;
+    // 使用配置编译好的匹配器，名单变化后才重新编译
+    EMASCurlRequestMatcher *matcher = config.requestMatcher;
 
     // 域名黑名单检查
-    if (domainBlackList && domainBlackList.count > 0) {
-        for (NSString *blacklistDomain in domainBlackList) {
-            if ([host hasSuffix:blacklistDomain]) {
-                EMAS_LOG_DEBUG(@"EC-Request", @"Request rejected by domain blacklist: %@", host);
-                return NO;
-            }
-        }
+    if ([matcher hostMatchesDomainBlackList:host]) {
+        EMAS_LOG_DEBUG(@"EC-Request", @"Request rejected by domain blacklist: %@", host);
+        return NO;
     }
 
-    // 域名白名单检查（重构：记录结果而非直接返回，以便后续路径检查能执行）
-    if (domainWhiteList && domainWhiteList.count > 0) {
-        BOOL passedDomainWhitelist = NO;
-        for (NSString *whitelistDomain in domainWhiteList) {
-            if ([host hasSuffix:whitelistDomain]) {
-                passedDomainWhitelist = YES;
-                EMAS_LOG_DEBUG(@"EC-Request", @"Request matched domain whitelist: %@", host);
-                break;
-            }
-        }
-        if (!passedDomainWhitelist) {
+    // 域名白名单检查
+    if (matcher.hasDomainWhiteList) {
+        if (![matcher hostMatchesDomainWhiteList:host]) {
             EMAS_LOG_DEBUG(@"EC-Request", @"Request rejected: not in domain whitelist: %@", host);
             return NO;
         }
+        EMAS_LOG_DEBUG(@"EC-Request", @"Request matched domain whitelist: %@", host);
     }
 
     // URL路径黑名单检查
     NSString *urlPath = request.URL.path;
-    NSArray<NSString *> *pathBlackList = config.urlPathBlackList;
-    if (pathBlackList && pathBlackList.count > 0 && urlPath.length > 0) {
-        for (NSString *pathPattern in pathBlackList) {
-            if (emas_pathMatchesPattern(urlPath, pathPattern)) {
-                EMAS_LOG_DEBUG(@"EC-Request", @"Request rejected by path blacklist: %@ (pattern: %@)", urlPath, pathPattern);
-                return NO;
-            }
-        }
+    NSString *pathPattern = [matcher urlPathBlackListPatternMatchingPath:urlPath];
+    if (pathPattern) {
+        EMAS_LOG_DEBUG(@"EC-Request", @"Request rejected by path blacklist: %@ (pattern: %@)", urlPath, pathPattern);
+        return NO;
     }
 
     NSString *userAgent = [request valueForHTTPHeaderField:@"User-Agent"];
@@ -584,9 +974,22 @@ static EMASCurlTransactionMetricsObserverBlock globalTransactionMetricsObserverB
     return [[EMASCurlConfigurationManager sharedManager] defaultConfiguration];
 }
 
+// 缓存配额按配置ID分区，未指定配置的请求共用默认分区
+- (nullable EMASCurlCacheQuotaPolicy *)cacheQuotaPolicy {
+    NSString *configID = [NSURLProtocol propertyForKey:kEMASCurlConfigurationIDKey inRequest:self.request];
+    return [EMASCurlCacheQuotaPolicy policyWithConfiguration:self.resolvedConfiguration
+                                                   partition:configID ?: @"default"];
+}
+
 - (void)startLoading {
     // 创建请求快照，隔离外部修改
     self.frozenRequest = [self.request copy];
+    self.startMonotonicNs = EMASCurlTraceNow();
+    self.startTimeIntervalSince1970 = CFAbsoluteTimeGetCurrent() + kCFAbsoluteTimeIntervalSince1970;
+    if (EMASCurlTraceIsEnabled()) {
+        self.traceRequestId = EMASCurlTraceNextRequestId();
+        self.traceStartNs = self.startMonotonicNs;
+    }
     
     EMAS_LOG_INFO(@"EC-Protocol", @"Starting request for URL: %@", self.frozenRequest.URL.absoluteString);
 
@@ -596,12 +999,29 @@ static EMASCurlTransactionMetricsObserverBlock globalTransactionMetricsObserverB
 
     // 解析此请求应使用的配置
     self.resolvedConfiguration = [self resolveConfiguration];
+    if (self.downloadDestinationPath && self.resolvedConfiguration.cacheEnabled) {
+        // 响应体直接写入文件，不经过缓存读写
+        EMASCurlConfiguration *configuration = [self.resolvedConfiguration copy];
+        configuration.cacheEnabled = NO;
+        self.resolvedConfiguration = configuration;
+    }
+    if (self.downloadDestinationPath && self.downloadResumable) {
+        [self loadDownloadResumeRecord];
+    }
 
     // 检查是否启用缓存以及是否是可缓存的请求
     BOOL useCache = NO;
     NSCachedURLResponse *hitCachedResponse = nil;
+    uint64_t cacheLookupStartNs = self.traceRequestId ? EMASCurlTraceNow() : 0;
 
     if (self.resolvedConfiguration.cacheEnabled &&
+        [[self.frozenRequest.HTTPMethod uppercaseString] isEqualToString:@"GET"] &&
+        [self.frozenRequest valueForHTTPHeaderField:EMASHTTPHeaderRange]) {
+
+        // Range请求走稀疏缓存，完整响应缓存不能直接应答
+        hitCachedResponse = [self prepareRangeRequestWithSparseCache];
+        useCache = hitCachedResponse != nil;
+    } else if (self.resolvedConfiguration.cacheEnabled &&
         [[self.frozenRequest.HTTPMethod uppercaseString] isEqualToString:@"GET"]) {
 
         // 从我们的缓存逻辑获取响应
@@ -625,17 +1045,37 @@ static EMASCurlTransactionMetricsObserverBlock globalTransactionMetricsObserverB
         }
     }
 
+    // 命中前先确认响应体可读（文件存储的响应体可能已被系统清理），不可读时按未命中走网络
+    EMASCurlCacheBodyReader *hitBodyReader = nil;
+    if (useCache) {
+        hitBodyReader = [s_responseCache bodyReaderForCachedResponse:hitCachedResponse];
+        if (!hitBodyReader) {
+            EMAS_LOG_INFO(@"EC-Cache", @"Cached body unreadable, falling back to network for: %@", self.frozenRequest.URL.absoluteString);
+            useCache = NO;
+            hitCachedResponse = nil;
+        }
+    }
+
+    if (self.resolvedConfiguration.cacheEnabled &&
+        [[self.frozenRequest.HTTPMethod uppercaseString] isEqualToString:@"GET"]) {
+        [s_responseCache recordLookupForRequest:self.frozenRequest hit:useCache];
+        if (self.traceRequestId) {
+            EMASCurlTraceRecordSpan(self.traceRequestId, EMASCurlTracePhaseCacheLookup, cacheLookupStartNs, EMASCurlTraceNow(), NULL);
+        }
+    }
+
     // 如果使用了缓存，则直接返回
     if (useCache) {
         [self reportCacheHitMetricsWithCachedResponse:hitCachedResponse];
+        if (self.traceRequestId) {
+            self.traceCallbackStartNs = EMASCurlTraceNow();
+        }
         [self invokeOnClientThread:^{
             if (![self markClientNotifiedIfNeeded]) {
                 return;
             }
             [self.client URLProtocol:self didReceiveResponse:hitCachedResponse.response cacheStoragePolicy:NSURLCacheStorageNotAllowed];
-            [self.client URLProtocol:self didLoadData:hitCachedResponse.data];
-            [self.client URLProtocolDidFinishLoading:self];
-            [self cleanupIfNeeded];
+            [self deliverNextCachedBodyChunkFromReader:hitBodyReader];
         }];
         return;
     }
@@ -659,6 +1099,7 @@ static EMASCurlTransactionMetricsObserverBlock globalTransactionMetricsObserverB
 
     EMAS_LOG_DEBUG(@"EC-Protocol", @"Easy handle created successfully for URL: %@", self.frozenRequest.URL.absoluteString);
 
+    [self setupProgressReporters];
     [self populateRequestHeader:easyHandle];
     [self populateRequestBody:easyHandle];
 
@@ -680,12 +1121,57 @@ static EMASCurlTransactionMetricsObserverBlock globalTransactionMetricsObserverB
         return;
     }
 
-    [[EMASCurlManager sharedInstance] enqueueNewEasyHandle:easyHandle completion:^(BOOL succeed, NSError *error, EMASCurlMetricsData *metrics) {
+    if (self.traceRequestId) {
+        // Manager据此把libcurl各阶段记录到同一条轨道
+        curl_easy_setopt(easyHandle, CURLOPT_PRIVATE, (void *)(uintptr_t)self.traceRequestId);
+    }
+
+    EMASCurlAdaptiveAdmission admission = EMASCurlAdaptiveAdmissionNone;
+    if (self.resolvedConfiguration.adaptiveHostConcurrencyEnabled) {
+        admission |= EMASCurlAdaptiveAdmissionHostConcurrency;
+    }
+    if (self.resolvedConfiguration.adaptivePrefetchGatingEnabled) {
+        admission |= EMASCurlAdaptiveAdmissionPrefetchGating;
+    }
+    [[EMASCurlManager sharedInstance] enqueueNewEasyHandle:easyHandle
+                                                  priority:self.requestPriority
+                                                      host:self.frozenRequest.URL.host
+                                         adaptiveAdmission:admission
+                                                   timeout:self.frozenRequest.timeoutInterval
+                                         cancellationCheck:^BOOL{
+        return self.shouldCancel;
+    }
+                                                completion:^(BOOL succeed, NSError *error, EMASCurlMetricsData *metrics) {
+        if (self.traceRequestId) {
+            self.traceCallbackStartNs = EMASCurlTraceNow();
+        }
+        // 分段下载中primary写到段尾后被主动中止，不算失败
+        if (self.segmentedDownload.primaryRangeComplete) {
+            succeed = YES;
+            error = nil;
+        }
         [self reportNetworkMetricWithData:metrics success:succeed error:error];
 
+        // 节流中尚未交付的进度在完成前补发
+        [self.uploadProgressReporter flush];
+        [self.downloadProgressReporter flush];
+
+        if (self.segmentedDownload) {
+            // 其余各段结束后由segmentedDownload的completionHandler完成下载
+            [self.segmentedDownload primaryDidFinishWithSuccess:succeed error:error];
+            return;
+        }
+        if (self.downloadFileSink || self.downloadFileError) {
+            [self finishDownloadToFileWithSuccess:succeed error:error];
+            return;
+        }
+
         // 从 metrics 获取重定向信息（在 Manager 中 curl_easy_cleanup 之前已提取）
         long redirectCount = metrics.redirectCount;
 
+        // 内存压力可能随时在网络线程释放缓冲，这里只读取一次
+        NSData *bufferedBody = self.receivedResponseData;
+
         // 如果发生重定向，获取最终URL
         NSURL *effectiveURL = self.frozenRequest.URL;
         if (redirectCount > 0 && metrics.effectiveURL) {
@@ -695,12 +1181,42 @@ static EMASCurlTransactionMetricsObserverBlock globalTransactionMetricsObserverB
             }
         }
 
-        // 如果请求成功且状态码可缓存，则尝试缓存响应（仅在内存中曾经缓冲成功时）
-        if (succeed &&
+        // 区间拼接时，网络区间之后的部分由缓存补齐
+        NSData *sparseTailData = nil;
+        if (succeed && self.splicingSparseCache) {
+            NSUInteger tailStart = NSMaxRange(self.networkByteRange);
+            NSUInteger tailEnd = NSMaxRange(self.requestedByteRange);
+            if (tailEnd > tailStart) {
+                sparseTailData = [self.sparseCacheEntry dataForRange:NSMakeRange(tailStart, tailEnd - tailStart)];
+            }
+        }
+
+        // 206响应合并进稀疏缓存条目，不能作为完整响应缓存
+        if (self.currentResponse.statusCode == 206) {
+            NSHTTPURLResponse *partialResponse = nil;
+            if (succeed &&
+                self.resolvedConfiguration.cacheEnabled &&
+                [[self.frozenRequest.HTTPMethod uppercaseString] isEqualToString:@"GET"] &&
+                bufferedBody != nil &&
+                redirectCount == 0) {
+                partialResponse = [[NSHTTPURLResponse alloc] initWithURL:effectiveURL
+                                                              statusCode:self.currentResponse.statusCode
+                                                             HTTPVersion:self.currentResponse.httpVersion
+                                                            headerFields:self.currentResponse.headers];
+            }
+            if (partialResponse) {
+                [s_responseCache storePartialResponse:partialResponse
+                                                 data:bufferedBody
+                                           forRequest:self.frozenRequest
+                                      withHTTPVersion:self.currentResponse.httpVersion
+                                             maxBytes:self.resolvedConfiguration.maximumCacheableBodyBytes
+                                          quotaPolicy:[self cacheQuotaPolicy]];
+            }
+        } else if (succeed &&
             isPotentiallyCacheableStatusCode(self.currentResponse.statusCode) &&
             self.resolvedConfiguration.cacheEnabled &&
             [[self.frozenRequest.HTTPMethod uppercaseString] isEqualToString:@"GET"] &&
-            self.receivedResponseData != nil) {
+            bufferedBody != nil) {
 
             NSHTTPURLResponse *httpResponse = [[NSHTTPURLResponse alloc] initWithURL:effectiveURL
                                                                           statusCode:self.currentResponse.statusCode
@@ -718,14 +1234,20 @@ static EMASCurlTransactionMetricsObserverBlock globalTransactionMetricsObserverB
                 } else {
                     EMAS_LOG_INFO(@"EC-Cache", @"Response cached for URL: %@", self.frozenRequest.URL.absoluteString);
                 }
+                EMASCurlCacheCompressionAlgorithm compression =
+                    [EMASCurlCacheCompressor algorithmForContentType:httpResponse.allHeaderFields[@"Content-Type"]
+                                                             inTable:self.resolvedConfiguration.cacheCompressionAlgorithms];
                 [s_responseCache cacheResponse:httpResponse
-                                          data:self.receivedResponseData
+                                          data:bufferedBody
                                     forRequest:cacheKeyRequest
-                               withHTTPVersion:self.currentResponse.httpVersion];
+                               withHTTPVersion:self.currentResponse.httpVersion
+                                   compression:compression
+                                   quotaPolicy:[self cacheQuotaPolicy]];
             }
         }
 
-        [self invokeOnClientThread:^{
+        // 保证进度回调先于完成回调到达调用方
+        [self invokeOnClientThreadAfterProgressDelivered:^{
             // 仅在尚未通知客户端时发送回调，但无论如何都要执行资源清理
             if ([self markClientNotifiedIfNeeded]) {
                 if (self.cancelled) {
@@ -734,6 +1256,9 @@ static EMASCurlTransactionMetricsObserverBlock globalTransactionMetricsObserverB
                     [self.client URLProtocol:self didFailWithError:cancelErr];
                 } else if (succeed) {
                     EMAS_LOG_DEBUG(@"EC-Protocol", @"Request processing completed with status: %ld", (long)self.currentResponse.statusCode);
+                    if (sparseTailData.length > 0) {
+                        [self.client URLProtocol:self didLoadData:sparseTailData];
+                    }
                     [self.client URLProtocolDidFinishLoading:self];
                 } else {
                     EMAS_LOG_ERROR(@"EC-Protocol", @"Request failed: %@ (NSURLError=%ld, CURLcode=%@)",
@@ -749,10 +1274,154 @@ static EMASCurlTransactionMetricsObserverBlock globalTransactionMetricsObserverB
     }];
 }
 
+// 直接写文件的下载：文件落盘并替换到位后再通知客户端
+- (void)finishDownloadToFileWithSuccess:(BOOL)succeed error:(NSError *)error {
+    void (^notifyClient)(NSError *) = ^(NSError *fileError) {
+        [self invokeOnClientThreadAfterProgressDelivered:^{
+            if ([self markClientNotifiedIfNeeded]) {
+                if (self.cancelled) {
+                    NSError *cancelErr = [NSError errorWithDomain:NSURLErrorDomain code:NSURLErrorCancelled userInfo:nil];
+                    [self.client URLProtocol:self didFailWithError:cancelErr];
+                } else if (succeed && !fileError) {
+                    EMAS_LOG_DEBUG(@"EC-Download", @"Response body written to %@", self.downloadDestinationPath);
+                    [self.client URLProtocolDidFinishLoading:self];
+                } else {
+                    // 写文件失败时libcurl只报告CURLE_WRITE_ERROR，优先返回文件错误
+                    NSError *finalError = fileError ?: error;
+                    EMAS_LOG_ERROR(@"EC-Download", @"Download to file failed: %@", finalError.localizedDescription);
+                    [self.client URLProtocol:self didFailWithError:finalError];
+                }
+            }
+            [self cleanupIfNeeded];
+        }];
+    };
+
+    if (!self.downloadFileSink) {
+        notifyClient(self.downloadFileError);
+        return;
+    }
+    [self.downloadFileSink finishWithSuccess:(succeed && !self.cancelled) completion:notifyClient];
+}
+
+// 在客户端线程执行：每次只交付一个数据块，然后让出RunLoop，
+// 大响应体不会长时间阻塞客户端线程，取消也能在块之间及时生效
+- (void)deliverNextCachedBodyChunkFromReader:(EMASCurlCacheBodyReader *)reader {
+    if (self.cancelled) {
+        [self cleanupIfNeeded];
+        return;
+    }
+
+    NSData *chunk = [reader nextChunk];
+    if (chunk) {
+        [self.client URLProtocol:self didLoadData:chunk];
+        [self scheduleOnClientThread:^{
+            [self deliverNextCachedBodyChunkFromReader:reader];
+        }];
+        return;
+    }
+
+    if (reader.finished) {
+        [self.client URLProtocolDidFinishLoading:self];
+    } else {
+        [s_responseCache removeCachedResponseForRequest:self.frozenRequest];
+        NSError *decodeError = [NSError errorWithDomain:NSURLErrorDomain code:NSURLErrorCannotDecodeContentData userInfo:nil];
+        [self.client URLProtocol:self didFailWithError:decodeError];
+    }
+    [self cleanupIfNeeded];
+}
+
+// Range请求：区间已被新鲜的稀疏缓存完整覆盖时返回可直接应答的206缓存响应；
+// 否则在有If-Range验证器的前提下记录只需从网络获取的最小区间，其余字节在响应时由缓存补齐
+- (nullable NSCachedURLResponse *)prepareRangeRequestWithSparseCache {
+    // 调用方自带If-Range时无法与缓存验证器合并，直接透传
+    if ([self.frozenRequest valueForHTTPHeaderField:EMASHTTPHeaderIfRange]) {
+        return nil;
+    }
+
+    EMASCurlSparseCacheEntry *entry = [s_responseCache sparseEntryForRequest:self.frozenRequest];
+    if (!entry) {
+        return nil;
+    }
+
+    NSRange requestedRange = EMASParseSingleByteRange([self.frozenRequest valueForHTTPHeaderField:EMASHTTPHeaderRange], entry.totalLength);
+    if (requestedRange.location == NSNotFound) {
+        return nil;
+    }
+
+    BOOL isFresh = [entry.cachedResponse emas_isResponseStillFreshForRequest:self.frozenRequest] &&
+                   ![entry.cachedResponse emas_requiresRevalidation];
+    if (isFresh && [entry containsRange:requestedRange]) {
+        NSHTTPURLResponse *cachedHTTPResponse = (NSHTTPURLResponse *)entry.cachedResponse.response;
+        NSString *httpVersion = entry.cachedResponse.userInfo[EMASUserInfoKeyOriginalHTTPVersion];
+        NSHTTPURLResponse *partialResponse = EMASPartialContentResponse(cachedHTTPResponse,
+                                                                        self.frozenRequest.URL,
+                                                                        [httpVersion isKindOfClass:[NSString class]] ? httpVersion : nil,
+                                                                        requestedRange,
+                                                                        entry.totalLength);
+        NSData *rangeData = [entry dataForRange:requestedRange];
+        if (partialResponse && rangeData) {
+            EMAS_LOG_INFO(@"EC-Cache", @"Sparse cache hit for range %lu+%lu of URL: %@",
+                          (unsigned long)requestedRange.location, (unsigned long)requestedRange.length,
+                          self.frozenRequest.URL.absoluteString);
+            return [[NSCachedURLResponse alloc] initWithResponse:partialResponse
+                                                            data:rangeData
+                                                        userInfo:nil
+                                                   storagePolicy:NSURLCacheStorageNotAllowed];
+        }
+    }
+
+    // 没有强验证器就无法确认已缓存字节与服务端当前表示一致，不做拼接
+    if (![entry ifRangeValidator]) {
+        return nil;
+    }
+
+    // 过期条目需要整段重新校验：If-Range匹配时服务端返回206，不匹配时返回完整的200
+    NSRange missingRange = isFresh ? [entry missingSpanInRange:requestedRange] : requestedRange;
+    if (missingRange.location == NSNotFound) {
+        missingRange = requestedRange;
+    }
+
+    self.requestedByteRange = requestedRange;
+    self.networkByteRange = missingRange;
+    self.sparseCacheEntry = entry;
+    EMAS_LOG_DEBUG(@"EC-Cache", @"Range %lu+%lu partially cached, fetching %lu+%lu from network",
+                   (unsigned long)requestedRange.location, (unsigned long)requestedRange.length,
+                   (unsigned long)missingRange.location, (unsigned long)missingRange.length);
+    return nil;
+}
+
+// 网络返回与计划区间一致的206时，改写为客户端请求区间的响应；否则放弃拼接并原样透传
+- (NSHTTPURLResponse *)responseBySplicingSparseCacheIntoResponse:(NSHTTPURLResponse *)response {
+    NSRange contentRange = NSMakeRange(NSNotFound, 0);
+    unsigned long long totalLength = 0;
+    if (response.statusCode == 206 &&
+        EMASParseContentRange(response.allHeaderFields[EMASHTTPHeaderContentRange], &contentRange, &totalLength) &&
+        NSEqualRanges(contentRange, self.networkByteRange) &&
+        totalLength == self.sparseCacheEntry.totalLength) {
+        self.splicingSparseCache = YES;
+        return EMASPartialContentResponse(response, response.URL, self.currentResponse.httpVersion,
+                                          self.requestedByteRange, totalLength) ?: response;
+    }
+
+    // If-Range不匹配时服务端返回完整200，说明资源已变化，缓存区间全部作废
+    if (response.statusCode == 200) {
+        EMAS_LOG_INFO(@"EC-Cache", @"If-Range mismatch, dropping sparse entry for URL: %@", self.frozenRequest.URL.absoluteString);
+        [s_responseCache removeSparseEntryForRequest:self.frozenRequest];
+    }
+    self.sparseCacheEntry = nil;
+    return response;
+}
+
 - (void)stopLoading {
     self.shouldCancel = YES;
     self.cancelled = YES;
-    // 提醒网络线程尽快从 curl_multi_wait 唤醒，进入 progress 回调并中止
+    if (self.downloadSegmentCount > 1) {
+        // primary可能已结束，其余各段需单独中止
+        [[EMASCurlManager sharedInstance] performBlockOnNetworkThread:^{
+            [self.segmentedDownload cancel];
+        }];
+    }
+    // 提醒网络线程尽快从 curl_multi_wait 唤醒，进入 progress 回调并中止；尚在自适应准入中排队的请求由Manager直接结束
     [[EMASCurlManager sharedInstance] wakeup];
 
     // 非阻塞：立即返回。客户端取消通知切回调度线程且保证只发一次
@@ -778,7 +1447,8 @@ static EMASCurlTransactionMetricsObserverBlock globalTransactionMetricsObserverB
     // 创建空的 metrics 对象，fetchStartDate 复用请求开始时间
     EMASCurlTransactionMetrics *emptyMetrics = [[EMASCurlTransactionMetrics alloc] init];
     emptyMetrics.request = self.frozenRequest;
-    emptyMetrics.fetchStartDate = self.fetchStartDate ?: [NSDate date];
+    EMASCurlTimestamps timestamps = EMASCurlTimestampsMake(self.startTimeIntervalSince1970);
+    [emptyMetrics setTimestamps:&timestamps];
 
     if (globalCallback) {
         globalCallback(self.frozenRequest, NO, error, emptyMetrics);
@@ -803,8 +1473,9 @@ static EMASCurlTransactionMetricsObserverBlock globalTransactionMetricsObserverB
     EMASCurlTransactionMetrics *cacheMetrics = [[EMASCurlTransactionMetrics alloc] init];
     cacheMetrics.request = self.frozenRequest;
     cacheMetrics.response = cachedResponse.response;
-    cacheMetrics.fetchStartDate = self.fetchStartDate ?: [NSDate date];
-    cacheMetrics.responseEndDate = [NSDate date];
+    EMASCurlTimestamps timestamps = EMASCurlTimestampsMake(self.startTimeIntervalSince1970);
+    timestamps.offsetsNs[EMASCurlTimestampResponseEnd] = (int64_t)(EMASCurlTraceNow() - self.startMonotonicNs);
+    [cacheMetrics setTimestamps:&timestamps];
     // 所有网络时间保持nil/0，表示无网络活动
 
     if (globalCallback) {
@@ -862,8 +1533,7 @@ static EMASCurlTransactionMetricsObserverBlock globalTransactionMetricsObserverB
 
     if (globalTransactionCallback || instanceTransactionCallback) {
         // 创建综合性能指标对象
-        EMASCurlTransactionMetrics *transactionMetrics = [self createTransactionMetricsWithData:metricsData
-                                                                                 nameLookupTime:nameLookupTime];
+        EMASCurlTransactionMetrics *transactionMetrics = [self createTransactionMetricsWithData:metricsData];
 
         if (globalTransactionCallback) {
             globalTransactionCallback(self.frozenRequest, success, error, transactionMetrics);
@@ -948,11 +1618,32 @@ static EMASCurlTransactionMetricsObserverBlock globalTransactionMetricsObserverB
                    metricsData.downloadBytes,
                    requestTimeout,
                    self.usedCustomDNSResolverResult ? @"YES" : @"NO");
+
+    // 附上该host在连接缓存中剩余的连接，便于判断是否复用了已失效的连接
+    [[EMASCurlManager sharedInstance] connectionPoolSnapshotWithCompletion:^(NSArray<EMASCurlConnectionInfo *> *connections) {
+        for (EMASCurlConnectionInfo *connection in connections) {
+            if (![connection.host isEqualToString:host]) {
+                continue;
+            }
+            EMAS_LOG_ERROR(@"EC-Performance",
+                           @"Pooled connection: host=%@ remote=%@:%ld local=%ld protocol=%@ age=%.1fs idle=%.1fs activeStreams=%lu reuses=%lu sent=%lld received=%lld",
+                           connection.host,
+                           connection.remoteAddress,
+                           (long)connection.remotePort,
+                           (long)connection.localPort,
+                           connection.protocolName ?: @"unknown",
+                           connection.age,
+                           connection.idleTime,
+                           (unsigned long)connection.activeStreams,
+                           (unsigned long)connection.reuseCount,
+                           connection.bytesSent,
+                           connection.bytesReceived);
+        }
+    }];
 }
 
 // 使用 Manager 传入的 metrics 数据创建 TransactionMetrics，避免访问已释放的 easyHandle
-- (EMASCurlTransactionMetrics *)createTransactionMetricsWithData:(EMASCurlMetricsData *)metricsData
-                                                  nameLookupTime:(double)nameLookupTime {
+- (EMASCurlTransactionMetrics *)createTransactionMetricsWithData:(EMASCurlMetricsData *)metricsData {
     EMASCurlTransactionMetrics *metrics = [[EMASCurlTransactionMetrics alloc] init];
 
     metrics.request = self.frozenRequest;
@@ -970,45 +1661,50 @@ static EMASCurlTransactionMetricsObserverBlock globalTransactionMetricsObserverB
         }
     }
 
-    double connectTime = metricsData.connectTime;
-    double appConnectTime = metricsData.appConnectTime;
-    double preTransferTime = metricsData.preTransferTime;
-    double startTransferTime = metricsData.startTransferTime;
-    double totalTime = metricsData.totalTime;
-
-    // 计算时间戳（基于fetchStartDate）
-    NSTimeInterval baseTime = self.fetchStartDate.timeIntervalSince1970;
+    // libcurl各阶段以加入multi的时刻为起点，先换算出该时刻相对请求起点的偏移
+    EMASCurlPhaseTimings timings = metricsData.timings;
+    int64_t transferOffsetNs = 0;
+    if (timings.transferStartNs > self.startMonotonicNs) {
+        transferOffsetNs = (int64_t)(timings.transferStartNs - self.startMonotonicNs);
+    }
 
-    metrics.fetchStartDate = self.fetchStartDate;
+    EMASCurlTimestamps timestamps = EMASCurlTimestampsMake(self.startTimeIntervalSince1970);
+    int64_t *offsets = timestamps.offsetsNs;
 
-    if (nameLookupTime > 0) {
-        metrics.domainLookupStartDate = self.fetchStartDate;
-        metrics.domainLookupEndDate = [NSDate dateWithTimeIntervalSince1970:baseTime + nameLookupTime];
+    if (self.usedCustomDNSResolverResult) {
+        offsets[EMASCurlTimestampDomainLookupStart] = (int64_t)(self.resolveDomainStartNs - self.startMonotonicNs);
+        offsets[EMASCurlTimestampDomainLookupEnd] = (int64_t)(self.resolveDomainEndNs - self.startMonotonicNs);
+    } else if (timings.nameLookup > 0) {
+        offsets[EMASCurlTimestampDomainLookupStart] = EMASCurlPhaseOffsetNs(transferOffsetNs, timings.queue);
+        offsets[EMASCurlTimestampDomainLookupEnd] = EMASCurlPhaseOffsetNs(transferOffsetNs, timings.nameLookup);
     }
 
-    if (connectTime > 0) {
-        metrics.connectStartDate = [NSDate dateWithTimeIntervalSince1970:baseTime + nameLookupTime];
-        metrics.connectEndDate = [NSDate dateWithTimeIntervalSince1970:baseTime + connectTime];
+    if (timings.connect > 0) {
+        offsets[EMASCurlTimestampConnectStart] = EMASCurlPhaseOffsetNs(transferOffsetNs, timings.nameLookup);
+        offsets[EMASCurlTimestampConnectEnd] = EMASCurlPhaseOffsetNs(transferOffsetNs, timings.connect);
     }
 
-    if (appConnectTime > 0) {
-        metrics.secureConnectionStartDate = [NSDate dateWithTimeIntervalSince1970:baseTime + connectTime];
-        metrics.secureConnectionEndDate = [NSDate dateWithTimeIntervalSince1970:baseTime + appConnectTime];
+    if (timings.appConnect > 0) {
+        offsets[EMASCurlTimestampSecureConnectionStart] = EMASCurlPhaseOffsetNs(transferOffsetNs, timings.connect);
+        offsets[EMASCurlTimestampSecureConnectionEnd] = EMASCurlPhaseOffsetNs(transferOffsetNs, timings.appConnect);
     }
 
-    if (preTransferTime > 0) {
-        metrics.requestStartDate = [NSDate dateWithTimeIntervalSince1970:baseTime + appConnectTime];
-        metrics.requestEndDate = [NSDate dateWithTimeIntervalSince1970:baseTime + preTransferTime];
+    // 请求发送阶段：pretransfer开始写请求，posttransfer写完请求
+    if (timings.preTransfer > 0) {
+        offsets[EMASCurlTimestampRequestStart] = EMASCurlPhaseOffsetNs(transferOffsetNs, timings.preTransfer);
+        offsets[EMASCurlTimestampRequestEnd] = EMASCurlPhaseOffsetNs(transferOffsetNs, MAX(timings.postTransfer, timings.preTransfer));
     }
 
-    if (startTransferTime > 0) {
-        metrics.responseStartDate = [NSDate dateWithTimeIntervalSince1970:baseTime + startTransferTime];
+    if (timings.startTransfer > 0) {
+        offsets[EMASCurlTimestampResponseStart] = EMASCurlPhaseOffsetNs(transferOffsetNs, timings.startTransfer);
     }
 
-    if (totalTime > 0) {
-        metrics.responseEndDate = [NSDate dateWithTimeIntervalSince1970:baseTime + totalTime];
+    if (timings.total > 0) {
+        offsets[EMASCurlTimestampResponseEnd] = EMASCurlPhaseOffsetNs(transferOffsetNs, timings.total);
     }
 
+    [metrics setTimestamps:&timestamps];
+
     // 从传入的字典中填充额外信息
     [self populateTransactionMetricsFromData:metricsData metrics:metrics];
 
@@ -1049,7 +1745,9 @@ static EMASCurlTransactionMetricsObserverBlock globalTransactionMetricsObserverB
 
     // 获取实际传输的字节数
     metrics.requestBodyBytesSent = metricsData.uploadBytes;
+    metrics.requestBodyBytesBeforeEncoding = self.requestBodyEncoder ? (NSInteger)self.requestBodyEncoder.rawBytes : metricsData.uploadBytes;
     metrics.responseBodyBytesReceived = metricsData.downloadBytes;
+    metrics.resumedResponseBodyBytes = (NSInteger)self.downloadResumedBytes;
 
     // 获取网络地址信息
     if (metricsData.localIP.length > 0) {
@@ -1065,6 +1763,154 @@ static EMASCurlTransactionMetricsObserverBlock globalTransactionMetricsObserverB
 
 #pragma mark * curl option setup
 
+// 仅GET且未指定Range的下载可续传；有完整校验信息且已下载部分前缀时从断点处请求
+- (void)loadDownloadResumeRecord {
+    if (![[self.frozenRequest.HTTPMethod uppercaseString] isEqualToString:@"GET"] ||
+        [self.frozenRequest valueForHTTPHeaderField:EMASHTTPHeaderRange]) {
+        return;
+    }
+    NSURL *destinationURL = [NSURL fileURLWithPath:self.downloadDestinationPath];
+    EMASCurlDownloadResumeRecord *record = [EMASCurlDownloadResumeRecord recordForDestinationURL:destinationURL
+                                                                                      URLString:self.frozenRequest.URL.absoluteString];
+    int64_t resumableLength = record.resumableLength;
+    if (record.validator.length > 0 && resumableLength > 0 && resumableLength < record.totalLength) {
+        self.resumeOffset = resumableLength;
+        EMAS_LOG_INFO(@"EC-Download", @"Resuming download of %@ from byte %lld", self.frozenRequest.URL.absoluteString, resumableLength);
+    }
+    self.downloadResumeRecord = record;
+}
+
+- (void)discardDownloadResumeRecord {
+    [self.downloadResumeRecord remove];
+    unlink(self.downloadResumeRecord.partialFilePath.fileSystemRepresentation);
+    self.downloadResumeRecord = nil;
+}
+
+// 可续传下载的2xx最终响应：206且衔接已下载的前缀时对客户端呈现完整的200响应；
+// 其他响应说明资源已变化或服务端不支持续传，丢弃旧数据从头下载，响应可续传时记录新的校验器
+- (NSHTTPURLResponse *)responseByResumingDownloadWithResponse:(NSHTTPURLResponse *)response parser:(const EMASHeaderParser *)parser {
+    EMASCurlDownloadResumeRecord *record = self.downloadResumeRecord;
+    if (self.resumeOffset > 0 && response.statusCode == 206) {
+        const EMASHeaderField *contentRangeField = EMASHeaderParserFindKnown(parser, EMASKnownHeaderContentRange);
+        NSString *contentRange = contentRangeField ? EMASHeaderParserCopyFieldValue(parser, contentRangeField) : nil;
+        NSRange range = NSMakeRange(NSNotFound, 0);
+        unsigned long long totalLength = 0;
+        if (EMASParseContentRange(contentRange, &range, &totalLength) &&
+            (int64_t)range.location == self.resumeOffset &&
+            (int64_t)totalLength == record.totalLength &&
+            NSMaxRange(range) == totalLength) {
+            record.receivedRanges = [NSIndexSet indexSetWithIndexesInRange:NSMakeRange(0, (NSUInteger)self.resumeOffset)];
+            self.downloadResumedBytes = self.resumeOffset;
+            self.totalBytesReceived = self.resumeOffset;
+            EMAS_LOG_INFO(@"EC-Download", @"Server accepted resume at byte %lld of %llu", self.resumeOffset, totalLength);
+            return EMASResumedFullContentResponse(response, self.currentResponse.httpVersion, totalLength);
+        }
+        EMAS_LOG_ERROR(@"EC-Download", @"Resumed response %@ does not continue from byte %lld", contentRange, self.resumeOffset);
+        self.downloadFileError = [NSError errorWithDomain:NSURLErrorDomain
+                                                     code:NSURLErrorBadServerResponse
+                                                 userInfo:@{NSLocalizedDescriptionKey: @"Resumed response does not match the partial download"}];
+        [self discardDownloadResumeRecord];
+        return response;
+    }
+
+    // 从头下载，旧的partial数据作废；带Content-Encoding时字节偏移无法对应，不可续传
+    NSString *validator = response.statusCode == 200 ? EMASStrongValidatorFromHeaders(parser) : nil;
+    int64_t totalLength = EMASHeaderParserFindKnown(parser, EMASKnownHeaderContentEncoding) ? -1 : response.expectedContentLength;
+    if (validator.length == 0 || totalLength <= 0) {
+        [self discardDownloadResumeRecord];
+        return response;
+    }
+    record.validator = validator;
+    record.totalLength = totalLength;
+    // 记录随写入进度由下载文件落盘，旧记录在首次落盘前被If-Range校验器保护
+    record.receivedRanges = [NSIndexSet indexSet];
+    return response;
+}
+
+// 在网络线程创建目标文件，失败时记录错误，write_cb据此中止传输
+- (void)openDownloadFileSink {
+    if (self.downloadFileError) {
+        return;
+    }
+    NSError *error = nil;
+    NSURL *destinationURL = [NSURL fileURLWithPath:self.downloadDestinationPath];
+    // HEAD响应没有响应体，不按Content-Length校验文件长度
+    BOOL isHead = [[self.frozenRequest.HTTPMethod uppercaseString] isEqualToString:HTTP_METHOD_HEAD];
+    self.downloadFileSink = [[EMASCurlFileDownloadSink alloc] initWithDestinationURL:destinationURL
+                                                                      expectedLength:isHead ? -1 : self.totalBytesExpectedToReceive
+                                                                        resumeRecord:self.downloadResumeRecord
+                                                                               error:&error];
+    if (!self.downloadFileSink) {
+        self.downloadFileError = error;
+        return;
+    }
+    CURL *easyHandle = self.easyHandle;
+    self.downloadFileSink.drainedHandler = ^{
+        [[EMASCurlManager sharedInstance] resumeEasyHandle:easyHandle];
+    };
+}
+
+// 首个200响应即作为探测：确认支持bytes范围请求、长度已知且有强校验器后才分段
+- (void)startSegmentedDownloadIfPossible:(const EMASHeaderParser *)parser {
+    int64_t totalLength = self.totalBytesExpectedToReceive;
+    if (![[self.frozenRequest.HTTPMethod uppercaseString] isEqualToString:@"GET"] ||
+        [self.frozenRequest valueForHTTPHeaderField:EMASHTTPHeaderRange] ||
+        totalLength <= 0 ||
+        !EMASHeaderParserKnownHeaderContains(parser, EMASKnownHeaderAcceptRanges, "bytes")) {
+        return;
+    }
+
+    NSString *validator = EMASStrongValidatorFromHeaders(parser);
+    if (validator.length == 0) {
+        return;
+    }
+
+    char *effectiveURL = NULL;
+    curl_easy_getinfo(self.easyHandle, CURLINFO_EFFECTIVE_URL, &effectiveURL);
+    EMASCurlSegmentedDownload *segmentedDownload =
+        [[EMASCurlSegmentedDownload alloc] initWithPrimaryHandle:self.easyHandle
+                                                    effectiveURL:effectiveURL ? @(effectiveURL) : self.frozenRequest.URL.absoluteString
+                                                    headerFields:self.requestHeaderFields
+                                                       validator:validator
+                                                     totalLength:totalLength
+                                                    segmentCount:self.downloadSegmentCount
+                                                            sink:self.downloadFileSink];
+    if (!segmentedDownload) {
+        return;
+    }
+    segmentedDownload.priority = self.requestPriority;
+    segmentedDownload.bytesReceivedHandler = ^(int64_t bytes, int64_t totalBytes) {
+        self.totalBytesReceived = totalBytes;
+        [self.downloadProgressReporter reportBytes:bytes totalBytes:totalBytes expectedBytes:totalLength];
+    };
+    // 完成后handler被置空，不会长期持有self
+    segmentedDownload.completionHandler = ^(BOOL succeeded, NSError *error) {
+        [self.downloadProgressReporter flush];
+        [self finishDownloadToFileWithSuccess:succeeded error:error];
+    };
+    self.segmentedDownload = segmentedDownload;
+    [segmentedDownload start];
+}
+
+- (void)setupProgressReporters {
+    EMASCurlConfiguration *config = self.resolvedConfiguration;
+    int64_t byteDelta = (int64_t)MIN(config.progressReportByteDelta, (NSUInteger)INT64_MAX);
+    if (self.uploadProgressUpdateBlock) {
+        self.uploadProgressReporter = [[EMASCurlProgressReporter alloc] initWithRequest:self.frozenRequest
+                                                                                handler:self.uploadProgressUpdateBlock
+                                                                               interval:config.progressReportInterval
+                                                                              byteDelta:byteDelta
+                                                                                  queue:config.progressCallbackQueue];
+    }
+    if (self.downloadProgressUpdateBlock) {
+        self.downloadProgressReporter = [[EMASCurlProgressReporter alloc] initWithRequest:self.frozenRequest
+                                                                                  handler:self.downloadProgressUpdateBlock
+                                                                                 interval:config.progressReportInterval
+                                                                                byteDelta:byteDelta
+                                                                                    queue:config.progressCallbackQueue];
+    }
+}
+
 - (void)populateRequestHeader:(CURL *)easyHandle {
     NSURLRequest *request = self.frozenRequest;
 
@@ -1139,12 +1985,35 @@ static EMASCurlTransactionMetricsObserverBlock globalTransactionMetricsObserverB
         }
     } else if (self.resolvedConfiguration.enableBuiltInGzip) {
         // 用户没有手动设置Accept-Encoding头部，使用内置gzip设置
+        // 空字符串让libcurl声明它编译进来的全部编码，包含br与zstd
         curl_easy_setopt(easyHandle, CURLOPT_ACCEPT_ENCODING, "");
-        EMAS_LOG_DEBUG(@"EC-Headers", @"Using built-in gzip encoding");
+        EMAS_LOG_DEBUG(@"EC-Headers", @"Using built-in content encoding (br: %d, zstd: %d)", curlFeatureBrotli, curlFeatureZstd);
+    }
+
+    // Range请求只需获取缓存未覆盖的区间，并用If-Range保证与缓存区间属于同一版本
+    if (self.sparseCacheEntry && self.networkByteRange.location != NSNotFound) {
+        NSString *rangeHeader = [NSString stringWithFormat:@"Range: bytes=%lu-%lu",
+                                 (unsigned long)self.networkByteRange.location,
+                                 (unsigned long)(NSMaxRange(self.networkByteRange) - 1)];
+        NSString *ifRangeHeader = [NSString stringWithFormat:@"If-Range: %@", [self.sparseCacheEntry ifRangeValidator]];
+        self.requestHeaderFields = curl_slist_append(self.requestHeaderFields, [rangeHeader UTF8String]);
+        self.requestHeaderFields = curl_slist_append(self.requestHeaderFields, [ifRangeHeader UTF8String]);
     }
 
-    // 只对GET请求添加缓存相关条件头
-    if (self.resolvedConfiguration.cacheEnabled && [[self.frozenRequest.HTTPMethod uppercaseString] isEqualToString:@"GET"]) {
+    // 续传按原始字节偏移拼接，不请求压缩编码
+    if (self.downloadResumeRecord) {
+        curl_easy_setopt(easyHandle, CURLOPT_ACCEPT_ENCODING, NULL);
+    }
+    if (self.resumeOffset > 0) {
+        NSString *rangeHeader = [NSString stringWithFormat:@"Range: bytes=%lld-", self.resumeOffset];
+        NSString *ifRangeHeader = [NSString stringWithFormat:@"If-Range: %@", self.downloadResumeRecord.validator];
+        self.requestHeaderFields = curl_slist_append(self.requestHeaderFields, [rangeHeader UTF8String]);
+        self.requestHeaderFields = curl_slist_append(self.requestHeaderFields, [ifRangeHeader UTF8String]);
+    }
+
+    // 只对GET请求添加缓存相关条件头，Range请求的校验由If-Range完成
+    if (self.resolvedConfiguration.cacheEnabled && [[self.frozenRequest.HTTPMethod uppercaseString] isEqualToString:@"GET"] &&
+        ![self.frozenRequest valueForHTTPHeaderField:EMASHTTPHeaderRange]) {
         // 再次从缓存获取，看是否有可用于条件GET的项
         // 注意：这里的 request 应该是用于网络请求的 NSMutableURLRequest
         // 而 s_responseCache.cachedResponseForRequest 需要 frozenRequest 作为键
@@ -1179,10 +2048,114 @@ static EMASCurlTransactionMetricsObserverBlock globalTransactionMetricsObserverB
     curl_easy_setopt(easyHandle, CURLOPT_HTTPHEADER, self.requestHeaderFields);
 }
 
+// 可直接交给libcurl的请求体：显式设置的数据，其次是请求自带的HTTPBody
+- (NSData *)directUploadBodyData {
+    NSURLRequest *request = self.frozenRequest;
+
+    NSData *data = [NSURLProtocol propertyForKey:kEMASCurlUploadBodyDataKey inRequest:request];
+    if (data) {
+        return data;
+    }
+
+    return request.HTTPBody;
+}
+
+// 以文件作为请求体时，每次传输新建文件流并取当前文件大小
+// 不使用内存映射：上传期间文件被截断时，访问映射页会触发SIGBUS，而流读取只会提前读到结尾，由libcurl以上传不完整结束
+- (NSInputStream *)uploadBodyFileStreamWithLength:(int64_t *)length {
+    NSString *filePath = [NSURLProtocol propertyForKey:kEMASCurlUploadBodyFilePathKey inRequest:self.frozenRequest];
+    if (!filePath) {
+        return nil;
+    }
+
+    NSError *error = nil;
+    NSNumber *fileSize = [[NSFileManager defaultManager] attributesOfItemAtPath:filePath error:&error][NSFileSize];
+    NSInputStream *fileStream = fileSize ? [NSInputStream inputStreamWithFileAtPath:filePath] : nil;
+    if (!fileStream) {
+        EMAS_LOG_ERROR(@"EC-Upload", @"Failed to open upload file %@: %@, fall back to body stream", filePath, error);
+        return nil;
+    }
+
+    *length = fileSize.longLongValue;
+    return fileStream;
+}
+
+- (void)populateRequestBody:(CURL *)easyHandle withData:(NSData *)bodyData {
+    NSURLRequest *request = self.frozenRequest;
+
+    // CURLOPT_POSTFIELDS不复制数据，由uploadBodyData保证整个传输期间有效
+    self.uploadBodyData = bodyData;
+    self.totalBytesExpected = (int64_t)bodyData.length;
+
+    if (![HTTP_METHOD_POST isEqualToString:request.HTTPMethod]) {
+        // CURLOPT_UPLOAD会让libcurl改走read_cb，这里统一按POST发送数据并保留原始方法
+        curl_easy_setopt(easyHandle, CURLOPT_UPLOAD, 0L);
+        curl_easy_setopt(easyHandle, CURLOPT_CUSTOMREQUEST, [request.HTTPMethod UTF8String]);
+        if (![request valueForHTTPHeaderField:@"Content-Type"]) {
+            // 避免libcurl补充表单类型的Content-Type，与走read_cb时的行为保持一致
+            self.requestHeaderFields = curl_slist_append(self.requestHeaderFields, "Content-Type:");
+            curl_easy_setopt(easyHandle, CURLOPT_HTTPHEADER, self.requestHeaderFields);
+        }
+    }
+
+    curl_easy_setopt(easyHandle, CURLOPT_POSTFIELDSIZE_LARGE, (curl_off_t)bodyData.length);
+    // 传NULL会让libcurl退回read_cb，空数据时传空串
+    curl_easy_setopt(easyHandle, CURLOPT_POSTFIELDS, bodyData.length > 0 ? bodyData.bytes : "");
+}
+
+// 单个请求的设置优先，其次按host配置；已编码、过小或被host拒绝的请求体不压缩
+- (EMASCurlRequestBodyEncoder *)requestBodyEncoderIfNeeded {
+    NSURLRequest *request = self.frozenRequest;
+
+    NSNumber *encoding = [NSURLProtocol propertyForKey:kEMASCurlRequestBodyEncodingKey inRequest:request];
+    if (!encoding) {
+        NSString *host = request.URL.host.lowercaseString;
+        encoding = host ? self.resolvedConfiguration.requestBodyEncodingByHost[host] : nil;
+    }
+    if (encoding.integerValue == EMASCurlRequestBodyEncodingNone) {
+        return nil;
+    }
+
+    if ([request valueForHTTPHeaderField:@"Content-Encoding"]) {
+        return nil;
+    }
+    NSString *contentLength = [request valueForHTTPHeaderField:@"Content-Length"];
+    if (contentLength && [contentLength longLongValue] < kEMASRequestBodyEncodingMinimumBytes) {
+        return nil;
+    }
+    if ([EMASCurlRequestBodyEncoder hostRejectsEncodedBody:request.URL.host]) {
+        EMAS_LOG_DEBUG(@"EC-Upload", @"Host %@ rejected encoded body before, sending uncompressed", request.URL.host);
+        return nil;
+    }
+
+    return [EMASCurlRequestBodyEncoder encoderWithEncoding:encoding.integerValue];
+}
+
 - (void)populateRequestBody:(CURL *)easyHandle {
     NSURLRequest *request = self.frozenRequest;
+    BOOL methodHasBody = ![HTTP_METHOD_GET isEqualToString:request.HTTPMethod]
+        && ![HTTP_METHOD_HEAD isEqualToString:request.HTTPMethod];
+
+    EMASCurlRequestBodyEncoder *encoder = methodHasBody ? [self requestBodyEncoderIfNeeded] : nil;
+    NSInputStream *bodyStream = request.HTTPBodyStream;
+
+    int64_t fileLength = -1;
+    NSInputStream *fileStream = methodHasBody ? [self uploadBodyFileStreamWithLength:&fileLength] : nil;
+    if (fileStream) {
+        bodyStream = fileStream;
+    } else if (methodHasBody && !encoder) {
+        NSData *bodyData = [self directUploadBodyData];
+        if (bodyData) {
+            [self populateRequestBody:easyHandle withData:bodyData];
+            return;
+        }
+    } else if (encoder && !bodyStream) {
+        // 压缩需要经过上传泵，内存数据转为流
+        NSData *bodyData = [self directUploadBodyData];
+        bodyStream = bodyData ? [NSInputStream inputStreamWithData:bodyData] : nil;
+    }
 
-    if (!request.HTTPBodyStream) {
+    if (!bodyStream) {
         if ([HTTP_METHOD_PUT isEqualToString:request.HTTPMethod]) {
             curl_easy_setopt(easyHandle, CURLOPT_INFILESIZE_LARGE, 0L);
         } else if ([HTTP_METHOD_POST isEqualToString:request.HTTPMethod]) {
@@ -1194,8 +2167,16 @@ static EMASCurlTransactionMetricsObserverBlock globalTransactionMetricsObserverB
         return;
     }
 
-    // NSURLSession内部会把HTTPBody统一转换到HTTPBodyStream，因此不用单独处理HTTPBody字段
-    self.inputStream = request.HTTPBodyStream;
+    // NSURLSession内部会把HTTPBody统一转换到HTTPBodyStream，需零拷贝时通过setUploadBodyData:forRequest:显式指定
+    // 流的打开与读取都在I/O队列上进行，缓冲区为空时read_cb暂停传输，数据到达后再恢复
+    self.uploadBodyPump = [[EMASCurlUploadBodyPump alloc] initWithInputStream:bodyStream
+                                                                      capacity:kEMASUploadBodyPumpCapacity];
+    self.uploadBodyPump.encoder = encoder;
+    self.requestBodyEncoder = encoder;
+    self.uploadBodyPump.dataAvailableHandler = ^{
+        [[EMASCurlManager sharedInstance] resumeEasyHandle:easyHandle];
+    };
+    [self.uploadBodyPump start];
 
     // 用read_cb回调函数来读取需要传输的数据
     curl_easy_setopt(easyHandle, CURLOPT_READFUNCTION, read_cb);
@@ -1207,8 +2188,18 @@ static EMASCurlTransactionMetricsObserverBlock globalTransactionMetricsObserverB
         curl_easy_setopt(easyHandle, CURLOPT_UPLOAD, 1);
     }
 
+    if (encoder) {
+        // 压缩后的长度无法预知，不设置Content-Length，按chunked发送
+        NSString *contentEncodingHeader = [NSString stringWithFormat:@"Content-Encoding: %@", encoder.contentEncoding];
+        self.requestHeaderFields = curl_slist_append(self.requestHeaderFields, contentEncodingHeader.UTF8String);
+        self.requestHeaderFields = curl_slist_append(self.requestHeaderFields, "Expect:");
+        curl_easy_setopt(easyHandle, CURLOPT_HTTPHEADER, self.requestHeaderFields);
+        self.totalBytesExpected = -1;
+        return;
+    }
+
     NSString *contentLength = [request valueForHTTPHeaderField:@"Content-Length"];
-    if (!contentLength) {
+    if (!fileStream && !contentLength) {
         // chunked模式不发送Expect，保持和NSURLSession的行为一致
         self.requestHeaderFields = curl_slist_append(self.requestHeaderFields, "Expect:");
         // 未设置Content-Length的情况，即使是使用Transfer-Encoding: chunked，也把totalBytesExpected设置为-1
@@ -1216,7 +2207,8 @@ static EMASCurlTransactionMetricsObserverBlock globalTransactionMetricsObserverB
         return;
     }
 
-    int64_t length = [contentLength longLongValue];
+    // 文件请求体以当前文件大小为准，设置接口记录的Content-Length可能已过时
+    int64_t length = fileStream ? fileLength : [contentLength longLongValue];
     self.totalBytesExpected = length;
 
     if ([HTTP_METHOD_PUT isEqualToString:request.HTTPMethod]) {
@@ -1289,9 +2281,8 @@ static EMASCurlTransactionMetricsObserverBlock globalTransactionMetricsObserverB
     // 无代理时才需要提前解析域名
     BOOL shouldRequestDirectly = (proxyServer.length == 0);
     if (self.resolvedConfiguration.dnsResolver && shouldRequestDirectly) {
-        NSTimeInterval startTime = [[NSDate date] timeIntervalSince1970];
         if ([self preResolveDomain:easyHandle]) {
-            self.resolveDomainTimeInterval = [[NSDate date] timeIntervalSince1970] - startTime;
+            self.resolveDomainTimeInterval = (double)(self.resolveDomainEndNs - self.resolveDomainStartNs) / NSEC_PER_SEC;
             self.usedCustomDNSResolverResult = YES;
         }
     }
@@ -1346,6 +2337,10 @@ static EMASCurlTransactionMetricsObserverBlock globalTransactionMetricsObserverB
     } else {
         // 使用配置中的连接超时设置
         connectTimeout = self.resolvedConfiguration.connectTimeoutInterval;
+        if (self.resolvedConfiguration.adaptiveConnectTimeoutEnabled) {
+            connectTimeout = [[EMASCurlNetworkQualityEstimator sharedInstance] connectTimeoutForBaseTimeout:connectTimeout];
+            EMAS_LOG_DEBUG(@"EC-Timeout", @"Using adaptive connect timeout: %.1f seconds", connectTimeout);
+        }
     }
     curl_easy_setopt(easyHandle, CURLOPT_CONNECTTIMEOUT_MS, (long)(connectTimeout * 1000));
 
@@ -1393,12 +2388,11 @@ static EMASCurlTransactionMetricsObserverBlock globalTransactionMetricsObserverB
 
     EMAS_LOG_INFO(@"EC-DNS", @"Using custom DNS resolver for domain: %@", host);
 
-    CFAbsoluteTime startTime = CFAbsoluteTimeGetCurrent();
+    self.resolveDomainStartNs = EMASCurlTraceNow();
     NSString *address = [self.resolvedConfiguration.dnsResolver resolveDomain:host];
-    CFAbsoluteTime endTime = CFAbsoluteTimeGetCurrent();
+    self.resolveDomainEndNs = EMASCurlTraceNow();
 
-    double resolutionTime = (endTime - startTime) * 1000; // 转换为毫秒
-    self.resolveDomainTimeInterval = resolutionTime;
+    double resolutionTime = (double)(self.resolveDomainEndNs - self.resolveDomainStartNs) / NSEC_PER_MSEC; // 转换为毫秒
 
     if (!address) {
         EMAS_LOG_ERROR(@"EC-DNS", @"Custom DNS resolver returned nil for domain: %@", host);
@@ -1422,14 +2416,20 @@ static EMASCurlTransactionMetricsObserverBlock globalTransactionMetricsObserverB
     return NO;
 }
 
-// 过滤Accept-Encoding头部，只保留libcurl支持的编码方法（gzip和deflate）
+// 过滤Accept-Encoding头部，只保留libcurl支持的编码方法（gzip、deflate，以及运行时可用的br和zstd）
 - (NSString *)filterSupportedEncodings:(NSString *)acceptEncoding {
     if (!acceptEncoding || acceptEncoding.length == 0) {
         return nil;
     }
 
     // libcurl支持的编码方法
-    NSSet *supportedEncodings = [NSSet setWithObjects:@"gzip", @"deflate", @"identity", nil];
+    NSMutableSet *supportedEncodings = [NSMutableSet setWithObjects:@"gzip", @"deflate", @"identity", nil];
+    if (curlFeatureBrotli) {
+        [supportedEncodings addObject:@"br"];
+    }
+    if (curlFeatureZstd) {
+        [supportedEncodings addObject:@"zstd"];
+    }
 
     // 解析Accept-Encoding头部值
     NSArray *encodings = [acceptEncoding componentsSeparatedByString:@","];
@@ -1479,6 +2479,10 @@ static EMASCurlTransactionMetricsObserverBlock globalTransactionMetricsObserverB
         if ([key caseInsensitiveCompare:kEMASCurlConfigurationHeaderKey] == NSOrderedSame) {
             continue;
         }
+        // 需要与稀疏缓存拼接时，Range已在populateRequestHeader中改写为缺失区间
+        if (self.sparseCacheEntry && [key caseInsensitiveCompare:EMASHTTPHeaderRange] == NSOrderedSame) {
+            continue;
+        }
         // 检查是否已提供User-Agent
         if ([key caseInsensitiveCompare:@"User-Agent"] == NSOrderedSame) {
             userAgentPresent = YES;
@@ -1514,65 +2518,46 @@ size_t header_cb(char *buffer, size_t size, size_t nitems, void *userdata) {
     EMASCurlProtocol *protocol = (__bridge EMASCurlProtocol *)userdata;
 
     size_t totalSize = size * nitems;
-    NSData *data = [NSData dataWithBytes:buffer length:size * nitems];
-
-    NSString *headerLine = [[NSString alloc] initWithData:data encoding:NSUTF8StringEncoding];
-    if (!headerLine) {
+    CurlHTTPResponse *currentResponse = protocol.currentResponse;
+    EMASHeaderParser *parser = currentResponse.headerParser;
+    if (!parser) {
         return totalSize;
     }
 
-    headerLine = [headerLine stringByTrimmingCharactersInSet:[NSCharacterSet whitespaceAndNewlineCharacterSet]];
-
-    if ([headerLine hasPrefix:@"HTTP/"]) {
+    // 逐行直接解析libcurl缓冲区，不创建对象；头部结束时一次性生成头部字典
+    EMASHeaderLineType lineType = EMASHeaderParserFeedLine(parser, buffer, totalSize);
+    if (lineType == EMASHeaderLineStatus) {
         // 头部首行，标识新的头部开始
-        [protocol.currentResponse reset];
-
-        NSArray<NSString *> *components = [headerLine componentsSeparatedByString:@" "];
-        if (components.count >= 3) {
-            protocol.currentResponse.httpVersion = components[0];
-            protocol.currentResponse.statusCode = [components[1] integerValue];
-            protocol.currentResponse.reasonPhrase = [[components subarrayWithRange:NSMakeRange(2, components.count - 2)] componentsJoinedByString:@" "];
-        } else if (components.count == 2) {
-            protocol.currentResponse.httpVersion = components[0];
-            protocol.currentResponse.statusCode = [components[1] integerValue];
-            protocol.currentResponse.reasonPhrase = @"";
-        }
-
-        EMAS_LOG_INFO(@"EC-Response", @"Received response: %ld %@", (long)protocol.currentResponse.statusCode, protocol.currentResponse.reasonPhrase);
-        EMAS_LOG_DEBUG(@"EC-Response", @"Processing %@ response", protocol.currentResponse.httpVersion);
-    } else {
-        NSRange delimiterRange = [headerLine rangeOfString:@": "];
-        if (delimiterRange.location != NSNotFound) {
-            NSString *key = [headerLine substringToIndex:delimiterRange.location];
-            NSString *value = [headerLine substringFromIndex:delimiterRange.location + delimiterRange.length];
+        [currentResponse reset];
+        currentResponse.statusCode = EMASHeaderParserStatusCode(parser);
+        return totalSize;
+    }
 
-            if (!key) {
-                // key不能为空，否则无法处理
-                return totalSize;
-            }
-            if (!value) {
-                value = @"";
+    if (lineType == EMASHeaderLineEnd) {
+        // 尾行，标识当前头部读取结束
+        currentResponse.statusCode = EMASHeaderParserStatusCode(parser);
+        currentResponse.httpVersion = EMASHeaderParserCopyHTTPVersion(parser);
+        currentResponse.reasonPhrase = EMASHeaderParserCopyReasonPhrase(parser);
+        currentResponse.headers = EMASHeaderParserCopyHeaderDictionary(parser);
+
+        EMAS_LOG_INFO(@"EC-Response", @"Received response: %ld %@", (long)currentResponse.statusCode, currentResponse.reasonPhrase);
+        EMAS_LOG_DEBUG(@"EC-Response", @"Processing %@ response", currentResponse.httpVersion);
+
+        // 设置cookie
+        size_t fieldCount = EMASHeaderParserFieldCount(parser);
+        for (size_t i = currentResponse.processedCookieFieldCount; i < fieldCount; i++) {
+            const EMASHeaderField *field = EMASHeaderParserFieldAtIndex(parser, i);
+            if (field->known != EMASKnownHeaderSetCookie) {
+                continue;
             }
-
-            // 设置cookie
-            if ([key caseInsensitiveCompare:@"set-cookie"] == NSOrderedSame) {
-                EMASCurlCookieStorage *cookieStorage = [EMASCurlCookieStorage sharedStorage];
-                [cookieStorage setCookieWithString:value forURL:protocol.frozenRequest.URL];
+            NSString *value = EMASHeaderParserCopyFieldValue(parser, field);
+            if (value) {
+                [[EMASCurlCookieStorage sharedStorage] setCookieWithString:value forURL:protocol.frozenRequest.URL];
                 EMAS_LOG_DEBUG(@"EC-Response", @"Cookie set: %@", value);
             }
-
-            if (protocol.currentResponse.headers[key]) {
-                NSString *existingValue = protocol.currentResponse.headers[key];
-                NSString *combinedValue = [existingValue stringByAppendingFormat:@", %@", value];
-                protocol.currentResponse.headers[key] = combinedValue;
-            } else {
-                protocol.currentResponse.headers[key] = value;
-            }
         }
-    }
+        currentResponse.processedCookieFieldCount = fieldCount;
 
-    if ([headerLine length] == 0) {
-        // 尾行，标识当前头部读取结束
         NSInteger statusCode = protocol.currentResponse.statusCode;
         NSString *reasonPhrase = protocol.currentResponse.reasonPhrase;
 
@@ -1598,11 +2583,26 @@ size_t header_cb(char *buffer, size_t size, size_t nitems, void *userdata) {
             // 更新缓存并获取更新后的响应
             NSCachedURLResponse *updatedResponse = [s_responseCache updateCachedResponseWithHeaders:protocol.currentResponse.headers
                                                                                          forRequest:protocol.frozenRequest];
-            if (updatedResponse) {
+            // 网络线程上只打开响应体读取器，解压放到客户端线程；响应体文件缺失时丢弃缓存条目并将304原样交给客户端
+            EMASCurlCacheBodyReader *updatedBodyReader = updatedResponse ? [s_responseCache bodyReaderForCachedResponse:updatedResponse] : nil;
+            if (updatedResponse && !updatedBodyReader) {
+                [s_responseCache removeCachedResponseForRequest:protocol.frozenRequest];
+            }
+            if (updatedBodyReader) {
                 [protocol invokeOnClientThread:^{
-                    if (![protocol hasClientNotified]) {
-                        [protocol.client URLProtocol:protocol didReceiveResponse:updatedResponse.response cacheStoragePolicy:NSURLCacheStorageNotAllowed];
-                        [protocol.client URLProtocol:protocol didLoadData:updatedResponse.data];
+                    if ([protocol hasClientNotified]) {
+                        return;
+                    }
+                    [protocol.client URLProtocol:protocol didReceiveResponse:updatedResponse.response cacheStoragePolicy:NSURLCacheStorageNotAllowed];
+                    // 须在传输的完成回调之前交付完毕，这里逐块读完，不持有完整的解压数据
+                    NSData *chunk = nil;
+                    while ((chunk = [updatedBodyReader nextChunk])) {
+                        [protocol.client URLProtocol:protocol didLoadData:chunk];
+                    }
+                    if (!updatedBodyReader.finished && [protocol markClientNotifiedIfNeeded]) {
+                        [s_responseCache removeCachedResponseForRequest:protocol.frozenRequest];
+                        NSError *decodeError = [NSError errorWithDomain:NSURLErrorDomain code:NSURLErrorCannotDecodeContentData userInfo:nil];
+                        [protocol.client URLProtocol:protocol didFailWithError:decodeError];
                     }
                 }];
                 return totalSize;
@@ -1612,13 +2612,8 @@ size_t header_cb(char *buffer, size_t size, size_t nitems, void *userdata) {
         if (isRedirectionStatusCode(statusCode)) {
             if (!protocol.resolvedConfiguration.enableBuiltInRedirection) {
                 // 关闭了重定向支持，则把重定向信息往外传递
-                __block NSString *location = nil;
-                [protocol.currentResponse.headers enumerateKeysAndObjectsUsingBlock:^(NSString * _Nonnull key, NSString * _Nonnull obj, BOOL * _Nonnull stop) {
-                    if ([key caseInsensitiveCompare:@"Location"] == NSOrderedSame) {
-                        location = obj;
-                        *stop = YES;
-                    }
-                }];
+                const EMASHeaderField *locationField = EMASHeaderParserFindKnown(parser, EMASKnownHeaderLocation);
+                NSString *location = locationField ? EMASHeaderParserCopyFieldValue(parser, locationField) : nil;
                 if (location) {
                     EMAS_LOG_DEBUG(@"EC-Response", @"Handling redirect to: %@", location);
                     NSURL *locationURL = [NSURL URLWithString:location relativeToURL:protocol.frozenRequest.URL];
@@ -1634,32 +2629,69 @@ size_t header_cb(char *buffer, size_t size, size_t nitems, void *userdata) {
             }
             [protocol.currentResponse reset];
         } else {
+            NSHTTPURLResponse *clientResponse = httpResponse;
+            if (protocol.downloadResumeRecord && statusCode >= 200 && statusCode < 300) {
+                clientResponse = [protocol responseByResumingDownloadWithResponse:httpResponse parser:parser];
+            }
+            NSData *sparseHeadData = nil;
+            if (protocol.sparseCacheEntry) {
+                clientResponse = [protocol responseBySplicingSparseCacheIntoResponse:httpResponse];
+                if (protocol.splicingSparseCache && protocol.networkByteRange.location > protocol.requestedByteRange.location) {
+                    NSRange headRange = NSMakeRange(protocol.requestedByteRange.location,
+                                                    protocol.networkByteRange.location - protocol.requestedByteRange.location);
+                    sparseHeadData = [protocol.sparseCacheEntry dataForRange:headRange];
+                }
+            }
             [protocol invokeOnClientThread:^{
                 if (![protocol hasClientNotified]) {
-                    [protocol.client URLProtocol:protocol didReceiveResponse:httpResponse cacheStoragePolicy:NSURLCacheStorageNotAllowed];
+                    [protocol.client URLProtocol:protocol didReceiveResponse:clientResponse cacheStoragePolicy:NSURLCacheStorageNotAllowed];
+                    // 网络区间之前的部分先由缓存交付，后续网络数据按序追加
+                    if (sparseHeadData.length > 0) {
+                        [protocol.client URLProtocol:protocol didLoadData:sparseHeadData];
+                    }
                 }
             }];
             protocol.currentResponse.isFinalResponse = YES;
 
+            // 响应体经libcurl解码后交付，带Content-Encoding时Content-Length不代表交付的字节数
+            if (!EMASHeaderParserFindKnown(parser, EMASKnownHeaderContentEncoding)) {
+                // 续传时期望长度为完整资源长度
+                protocol.totalBytesExpectedToReceive = protocol.downloadResumedBytes > 0 ? clientResponse.expectedContentLength
+                                                                                         : httpResponse.expectedContentLength;
+            }
+
+            // 只有成功响应的响应体写入目标文件，错误响应照常交付给客户端
+            if (protocol.downloadDestinationPath && statusCode >= 200 && statusCode < 300) {
+                [protocol openDownloadFileSink];
+                if (protocol.downloadFileSink && protocol.downloadSegmentCount > 1 && statusCode == 200) {
+                    [protocol startSegmentedDownloadIfPossible:parser];
+                }
+            }
+
+            if (statusCode == 415 && protocol.requestBodyEncoder) {
+                [EMASCurlRequestBodyEncoder markHostRejectingEncodedBody:protocol.frozenRequest.URL.host];
+            }
+
             // 仅在最终响应首包前决定是否在内存中缓冲以用于缓存。
             // 复杂原因：若无上限，巨大GET响应会导致NSMutableData反复扩容，引发NSMallocException。
             if (protocol.resolvedConfiguration.cacheEnabled &&
                 [[protocol.frozenRequest.HTTPMethod uppercaseString] isEqualToString:@"GET"] &&
                 isPotentiallyCacheableStatusCode(statusCode)) {
                 // 检查Cache-Control: no-store，遇到则不缓冲
-                NSString *cacheCtl = protocol.currentResponse.headers[@"Cache-Control"] ?: protocol.currentResponse.headers[@"cache-control"];
-                BOOL hasNoStore = NO;
-                if (cacheCtl.length > 0) {
-                    NSString *lc = [cacheCtl lowercaseString];
-                    hasNoStore = [lc containsString:@"no-store"];
-                }
-
-                if (!hasNoStore) {
+                BOOL hasNoStore = EMASHeaderParserKnownHeaderContains(parser, EMASKnownHeaderCacheControl, "no-store");
+
+                if (!hasNoStore && [EMASCurlMemoryPressureManager sharedManager].currentLevel == EMASCurlMemoryPressureCritical) {
+                    // 严重内存压力期间不再缓冲新的响应体，本次响应不写入缓存
+                    protocol.shouldBufferBodyForCache = NO;
+                    protocol.receivedResponseData = nil;
+                    protocol.bufferedCacheBytes = 0;
+                } else if (!hasNoStore) {
                     protocol.shouldBufferBodyForCache = YES;
+                    [s_cacheBufferingProtocols addObject:protocol];
 
                     // 依据Content-Length和阈值预判是否值得在内存中缓冲
-                    NSString *clStr = protocol.currentResponse.headers[@"Content-Length"] ?: protocol.currentResponse.headers[@"content-length"];
-                    unsigned long long contentLen = (unsigned long long) [clStr longLongValue];
+                    long long contentLength = EMASHeaderParserKnownHeaderInteger(parser, EMASKnownHeaderContentLength);
+                    unsigned long long contentLen = contentLength > 0 ? (unsigned long long)contentLength : 0;
                     NSUInteger cap = (NSUInteger)MIN(contentLen > 0 ? contentLen : 0, protocol.resolvedConfiguration.maximumCacheableBodyBytes);
 
                     if (contentLen > 0 && contentLen > protocol.resolvedConfiguration.maximumCacheableBodyBytes) {
@@ -1712,6 +2744,35 @@ static size_t write_cb(void *contents, size_t size, size_t nmemb, void *userp) {
     EMASCurlProtocol *protocol = (__bridge EMASCurlProtocol *)userp;
 
     size_t totalSize = size * nmemb;
+
+    // 直接写文件的下载不经过NSData与客户端线程
+    if (protocol.currentResponse.isFinalResponse && protocol.segmentedDownload) {
+        // 分段下载的进度由segmentedDownload统一上报
+        NSInteger accepted = [protocol.segmentedDownload writePrimaryBytes:contents length:totalSize];
+        if (accepted == EMASCurlSegmentWriteWouldBlock) {
+            return CURL_WRITEFUNC_PAUSE;
+        }
+        // 写到primary的段尾时返回0中止传输，其余部分由各段获取
+        return accepted < 0 ? 0 : (size_t)accepted;
+    }
+    if (protocol.currentResponse.isFinalResponse && (protocol.downloadFileSink || protocol.downloadFileError)) {
+        NSInteger accepted = protocol.downloadFileSink ? [protocol.downloadFileSink appendBytes:contents length:totalSize]
+                                                       : EMASCurlFileSinkAppendFailed;
+        if (accepted == EMASCurlFileSinkAppendWouldBlock) {
+            return CURL_WRITEFUNC_PAUSE;
+        }
+        if (accepted < 0) {
+            return 0;
+        }
+        if (protocol.downloadProgressReporter) {
+            protocol.totalBytesReceived += (int64_t)totalSize;
+            [protocol.downloadProgressReporter reportBytes:(int64_t)totalSize
+                                                totalBytes:protocol.totalBytesReceived
+                                             expectedBytes:protocol.totalBytesExpectedToReceive];
+        }
+        return totalSize;
+    }
+
     NSData *data = [[NSData alloc] initWithBytes:contents length:totalSize];
 
     // 收集响应数据用于缓存（带内存上限保护）
@@ -1731,6 +2792,13 @@ static size_t write_cb(void *contents, size_t size, size_t nmemb, void *userp) {
 
     // 只有确认获得已经读取了最后一个响应，接受的数据才视为有效数据
     if (protocol.currentResponse.isFinalResponse) {
+        if (protocol.downloadProgressReporter) {
+            protocol.totalBytesReceived += (int64_t)totalSize;
+            [protocol.downloadProgressReporter reportBytes:(int64_t)totalSize
+                                                totalBytes:protocol.totalBytesReceived
+                                             expectedBytes:protocol.totalBytesExpectedToReceive];
+        }
+
         // 将客户端回调切回协议调度线程
         [protocol invokeOnClientThread:^{
             if (![protocol hasClientNotified]) {
@@ -1746,7 +2814,7 @@ static size_t write_cb(void *contents, size_t size, size_t nmemb, void *userp) {
 static size_t read_cb(char *buffer, size_t size, size_t nitems, void *userp) {
     EMASCurlProtocol *protocol = (__bridge EMASCurlProtocol *)userp;
 
-    if (!protocol || !protocol.inputStream) {
+    if (!protocol || !protocol.uploadBodyPump) {
         return CURL_READFUNC_ABORT;
     }
 
@@ -1754,33 +2822,38 @@ static size_t read_cb(char *buffer, size_t size, size_t nitems, void *userp) {
         return CURL_READFUNC_ABORT;
     }
 
-    if ([protocol.inputStream streamStatus] == NSStreamStatusNotOpen) {
-        [protocol.inputStream open];
+    NSInteger bytesRead = [protocol.uploadBodyPump readIntoBuffer:(uint8_t *)buffer maxLength:size * nitems];
+    if (bytesRead == EMASCurlUploadPumpReadWouldBlock) {
+        return CURL_READFUNC_PAUSE;
     }
-
-    NSInteger bytesRead = [protocol.inputStream read:(uint8_t *)buffer maxLength:size * nitems];
     if (bytesRead < 0) {
         return CURL_READFUNC_ABORT;
     }
 
     protocol.totalBytesSent += bytesRead;
 
-    if (protocol.uploadProgressUpdateBlock) {
-        protocol.uploadProgressUpdateBlock(protocol.frozenRequest,
-                                           bytesRead,
-                                           protocol.totalBytesSent,
-                                           protocol.totalBytesExpected);
-    }
+    [protocol.uploadProgressReporter reportBytes:bytesRead
+                                      totalBytes:protocol.totalBytesSent
+                                   expectedBytes:protocol.totalBytesExpected];
 
     return bytesRead;
 }
 
 static int progress_callback(void *clientp, curl_off_t dltotal, curl_off_t dlnow, curl_off_t ultotal, curl_off_t ulnow) {
     EMASCurlProtocol *protocol = (__bridge EMASCurlProtocol *)clientp;
-    // 检查是否取消传输
-    if (protocol.shouldCancel) {
+    // 检查是否取消传输，分段下载失败时primary一并中止
+    if (protocol.shouldCancel || protocol.segmentedDownload.aborted) {
         return 1;
     }
+
+    // 直接发送的请求体不经过read_cb，上传进度在这里根据已发送字节数上报
+    if (protocol.uploadBodyData && protocol.uploadProgressReporter && ulnow > protocol.totalBytesSent) {
+        int64_t bytesSent = ulnow - protocol.totalBytesSent;
+        protocol.totalBytesSent = ulnow;
+        [protocol.uploadProgressReporter reportBytes:bytesSent
+                                          totalBytes:protocol.totalBytesSent
+                                       expectedBytes:protocol.totalBytesExpected];
+    }
     return 0;
 }
 
@@ -1847,6 +2920,16 @@ static int debug_cb(CURL *handle, curl_infotype type, char *data, size_t size, v
     [EMASCurlLogger setLogHandler:handler];
 }
 
++ (void)setLogFileDirectory:(nullable NSString *)directory
+                maxFileSize:(unsigned long long)maxFileSize
+               maxFileCount:(NSUInteger)maxFileCount {
+    [EMASCurlLogger setLogFileDirectory:directory maxFileSize:maxFileSize maxFileCount:maxFileCount];
+}
+
++ (void)flushLogs {
+    [EMASCurlLogger flush];
+}
+
 @end
 
 #pragma mark - 调度线程封装与清理
@@ -1867,6 +2950,35 @@ static int debug_cb(CURL *handle, curl_infotype type, char *data, size_t size, v
         block();
         return;
     }
+    [self scheduleOnClientThread:block];
+}
+
+- (void)invokeOnClientThreadAfterProgressDelivered:(dispatch_block_t)block {
+    // 依次排在上传、下载进度回调之后，再回到客户端线程执行
+    dispatch_block_t deliver = ^{
+        [self invokeOnClientThread:block];
+    };
+    EMASCurlProgressReporter *downloadReporter = self.downloadProgressReporter;
+    if (downloadReporter) {
+        dispatch_block_t next = deliver;
+        deliver = ^{
+            [downloadReporter performAfterDelivered:next];
+        };
+    }
+    EMASCurlProgressReporter *uploadReporter = self.uploadProgressReporter;
+    if (uploadReporter) {
+        dispatch_block_t next = deliver;
+        deliver = ^{
+            [uploadReporter performAfterDelivered:next];
+        };
+    }
+    deliver();
+}
+
+- (void)scheduleOnClientThread:(dispatch_block_t)block {
+    if (!block) {
+        return;
+    }
     // 必须在协议调度线程/RunLoop模式下执行所有 client 回调，避免CFNetwork内部状态被跨线程访问导致竞态
     [self performSelector:@selector(_invokeBlockOnClientThread:)
                  onThread:self.clientThread
@@ -1898,12 +3010,13 @@ static int debug_cb(CURL *handle, curl_infotype type, char *data, size_t size, v
         }
         self.cleanedUp = YES;
     }
+    if (self.traceRequestId) {
+        [self recordTraceCompletion];
+    }
     // easy 句柄的销毁必须在被从 multi handle 移除后再执行；改为由 Manager 统一 cleanup，避免并发销毁
-    if (self.inputStream) {
-        if ([self.inputStream streamStatus] == NSStreamStatusOpen) {
-            [self.inputStream close];
-        }
-        self.inputStream = nil;
+    if (self.uploadBodyPump) {
+        [self.uploadBodyPump cancel];
+        self.uploadBodyPump = nil;
     }
     if (self.requestHeaderFields) {
         curl_slist_free_all(self.requestHeaderFields);
@@ -1917,6 +3030,16 @@ static int debug_cb(CURL *handle, curl_infotype type, char *data, size_t size, v
     self.easyHandle = nil;
 }
 
+// 客户端已收到结果（或请求被取消），记录交付阶段与整个请求
+- (void)recordTraceCompletion {
+    uint64_t now = EMASCurlTraceNow();
+    if (self.traceCallbackStartNs) {
+        EMASCurlTraceRecordSpan(self.traceRequestId, EMASCurlTracePhaseCallbackDelivery, self.traceCallbackStartNs, now, NULL);
+    }
+    NSString *label = [NSString stringWithFormat:@"%@ %@", self.frozenRequest.HTTPMethod ?: @"GET", self.frozenRequest.URL.absoluteString];
+    EMASCurlTraceRecordSpan(self.traceRequestId, EMASCurlTracePhaseRequest, self.traceStartNs, now, label.UTF8String);
+}
+
 @end
 
 #pragma mark - 多实例配置支持
@@ -14,7 +14,13 @@
 + (void)setManualProxyServer:(nullable NSString *)proxyServerURL;
 
 /// 基于缓存的系统代理为目标 URL 计算代理串
+/// 决策按 (scheme, host, port) 缓存，读取只在极短的临界区内取快照引用，系统网络配置变化时失效；
+/// 系统配置了PAC时异步求值，完成前沿用其余代理条目的结果
 /// 返回格式：scheme://host:port；无可用代理时返回 nil
 + (nullable NSString *)proxyServerForURL:(nullable NSURL *)url;
 
+/// 以给定的代理设置（CFNetworkCopySystemProxySettings的格式）替代系统代理设置，并同步使决策缓存失效；
+/// 传nil恢复读取系统设置。用于测试
++ (void)overrideSystemProxySettings:(nullable NSDictionary *)settings;
+
 @end
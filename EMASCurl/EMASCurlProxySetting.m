@@ -9,6 +9,22 @@
 #import "EMASCurlLogger.h"
 #import <CFNetwork/CFNetwork.h>
 #import <notify.h>
+#import <os/lock.h>
+
+// 进行中的PAC求值，回调在主线程RunLoop上触发
+@interface EMASProxyAutoConfigurationContext : NSObject
+@property (nonatomic, copy) NSString *key;
+@property (nonatomic, assign) uint64_t generation;
+@property (nonatomic, strong) id fallbackDecision;
+@property (nonatomic, assign) CFRunLoopSourceRef runLoopSource;
+@end
+
+@implementation EMASProxyAutoConfigurationContext
+@end
+
+@interface EMASCurlProxySetting ()
++ (void)finishProxyAutoConfigurationForKey:(NSString *)key decision:(id)decision generation:(uint64_t)generation;
+@end
 
 @implementation EMASCurlProxySetting
 
@@ -20,6 +36,21 @@ static int s_proxyNotifyToken;
 static dispatch_block_t s_pendingUpdateBlock;
 static const double kProxyUpdateDebounceIntervalSec = 0.8;
 
+// 按(scheme, host, port)缓存的代理决策，value为代理串或NSNull（直连）。
+// 快照不可变，替换只在s_proxyQueue上进行；读取方在s_decisionCacheLock内取得快照的强引用，
+// 临界区只有一次指针赋值，之后在锁外查找
+static NSDictionary *s_decisionCache;
+static os_unfair_lock s_decisionCacheLock = OS_UNFAIR_LOCK_INIT;
+// 非nil时替代系统代理设置
+static NSDictionary *s_overrideProxySettings;
+// 代理设置变化时递增，丢弃基于旧设置计算的结果
+static uint64_t s_decisionGeneration;
+static NSMutableSet<NSString *> *s_pacInFlightKeys;
+static const NSUInteger kProxyDecisionCacheMaxEntries = 256;
+
+static NSString *EMASProxyDecisionKey(NSURL *url);
+static NSString *EMASProxyStringFromProxies(NSArray *proxies, NSDictionary **autoConfiguration);
+
 // 类初始化时完成一次性初始化与监听启动
 + (void)initialize {
     if (self != [EMASCurlProxySetting class]) {
@@ -30,6 +61,7 @@ static const double kProxyUpdateDebounceIntervalSec = 0.8;
     s_cachedProxySettings = nil;
     s_proxyNotifyToken = 0;
     s_pendingUpdateBlock = NULL;
+    s_pacInFlightKeys = [NSMutableSet new];
 
     [self startProxyObservation];
     [self updateProxySettingsAsyncInQueue];
@@ -39,6 +71,7 @@ static const double kProxyUpdateDebounceIntervalSec = 0.8;
     BOOL manualEnabled = (proxyServerURL != nil && proxyServerURL.length > 0);
     dispatch_sync(s_proxyQueue, ^{
         s_manualProxyEnabled = manualEnabled;
+        [self invalidateDecisionCacheLocked];
         if (manualEnabled) {
             s_cachedProxySettings = nil;
             // 主动取消未执行的去抖更新，避免在切到手动代理后仍触发系统代理更新
@@ -64,26 +97,72 @@ static const double kProxyUpdateDebounceIntervalSec = 0.8;
         return nil;
     }
 
+    // 快路径：读取决策缓存快照
+    NSString *key = EMASProxyDecisionKey(url);
+    if (key) {
+        id decision = [self currentDecisionCache][key];
+        if (decision) {
+            return [decision isKindOfClass:[NSString class]] ? decision : nil;
+        }
+    }
+
     __block NSDictionary *proxySettings = nil;
+    __block uint64_t generation = 0;
     dispatch_sync(s_proxyQueue, ^{
         proxySettings = s_cachedProxySettings;
+        generation = s_decisionGeneration;
     });
-    if (!proxySettings) {
-        return nil;
+
+    id decision = [NSNull null];
+    if (proxySettings) {
+        CFArrayRef proxiesRef = CFNetworkCopyProxiesForURL((__bridge CFURLRef)url, (__bridge CFDictionaryRef)proxySettings);
+        if (proxiesRef) {
+            NSArray *proxies = CFBridgingRelease(proxiesRef);
+            NSDictionary *autoConfiguration = nil;
+            decision = EMASProxyStringFromProxies(proxies, &autoConfiguration) ?: [NSNull null];
+            // PAC异步求值，完成前沿用列表中其余条目的结果，不阻塞请求发起
+            if (autoConfiguration && key) {
+                [self evaluateProxyAutoConfiguration:autoConfiguration forURL:url key:key fallbackDecision:decision generation:generation];
+            }
+        }
+    }
+
+    if (key) {
+        [self storeDecision:decision forKey:key generation:generation overwrite:NO];
     }
+    return [decision isKindOfClass:[NSString class]] ? decision : nil;
+}
 
-    CFArrayRef proxiesRef = CFNetworkCopyProxiesForURL((__bridge CFURLRef)url, (__bridge CFDictionaryRef)proxySettings);
-    if (!proxiesRef) {
+#pragma mark - Decision Cache
+
+// 代理决策只取决于scheme、host与端口，路径不同的请求共享同一决策
+static NSString *EMASProxyDecisionKey(NSURL *url) {
+    NSString *scheme = url.scheme.lowercaseString;
+    NSString *host = url.host.lowercaseString;
+    if (scheme.length == 0 || host.length == 0) {
         return nil;
     }
+    NSInteger port = url.port ? url.port.integerValue : ([scheme isEqualToString:@"https"] ? 443 : 80);
+    return [NSString stringWithFormat:@"%@://%@:%ld", scheme, host, (long)port];
+}
 
-    NSArray *proxies = CFBridgingRelease(proxiesRef);
+/**
+ * 从CFNetwork返回的代理列表中选出第一个可用的HTTP/HTTPS/SOCKS代理，返回scheme://host:port。
+ * 在此之前出现的PAC条目通过autoConfiguration返回，由调用方异步求值
+ */
+static NSString *EMASProxyStringFromProxies(NSArray *proxies, NSDictionary **autoConfiguration) {
     NSDictionary *proxyInfo = nil;
     for (NSDictionary *candidate in proxies) {
         NSString *candidateType = candidate[(NSString *)kCFProxyTypeKey];
         if ([candidateType isEqualToString:(NSString *)kCFProxyTypeNone]) {
             continue;
         }
+        if (autoConfiguration && *autoConfiguration == nil &&
+            ([candidateType isEqualToString:(NSString *)kCFProxyTypeAutoConfigurationURL] ||
+             [candidateType isEqualToString:(NSString *)kCFProxyTypeAutoConfigurationJavaScript])) {
+            *autoConfiguration = candidate;
+            continue;
+        }
         if ([candidateType isEqualToString:(NSString *)kCFProxyTypeHTTP] ||
             [candidateType isEqualToString:(NSString *)kCFProxyTypeHTTPS] ||
             [candidateType isEqualToString:(NSString *)kCFProxyTypeSOCKS]) {
@@ -120,6 +199,121 @@ static const double kProxyUpdateDebounceIntervalSec = 0.8;
     return [NSString stringWithFormat:@"%@://%@:%@", scheme, host, port];
 }
 
+// overwrite为NO时不覆盖已有决策，避免并发未命中的临时结果覆盖PAC求值结果
++ (void)storeDecision:(id)decision forKey:(NSString *)key generation:(uint64_t)generation overwrite:(BOOL)overwrite {
+    dispatch_async(s_proxyQueue, ^{
+        if (generation != s_decisionGeneration) {
+            return;
+        }
+        NSDictionary *current = [self currentDecisionCache];
+        if (!overwrite && current[key]) {
+            return;
+        }
+        NSMutableDictionary *next = (current && current.count < kProxyDecisionCacheMaxEntries) ? [current mutableCopy] : [NSMutableDictionary new];
+        next[key] = decision;
+        [self publishDecisionCacheLocked:[next copy]];
+    });
+}
+
++ (nullable NSDictionary *)currentDecisionCache {
+    os_unfair_lock_lock(&s_decisionCacheLock);
+    NSDictionary *cache = s_decisionCache;
+    os_unfair_lock_unlock(&s_decisionCacheLock);
+    return cache;
+}
+
+// 要求在 s_proxyQueue 上调用；旧快照离开作用域时在锁外释放，读取方已持有的强引用不受影响
++ (void)publishDecisionCacheLocked:(nullable NSDictionary *)cache {
+    os_unfair_lock_lock(&s_decisionCacheLock);
+    NSDictionary *previous = s_decisionCache;
+    s_decisionCache = cache;
+    os_unfair_lock_unlock(&s_decisionCacheLock);
+    (void)previous;
+}
+
+// 要求在 s_proxyQueue 上调用；进行中的PAC结果因代际不匹配被丢弃
++ (void)invalidateDecisionCacheLocked {
+    s_decisionGeneration++;
+    [s_pacInFlightKeys removeAllObjects];
+    [self publishDecisionCacheLocked:nil];
+}
+
+#pragma mark - Proxy Auto Configuration
+
+static void EMASProxyAutoConfigurationCallback(void *client, CFArrayRef proxyList, CFErrorRef error) {
+    EMASProxyAutoConfigurationContext *context = CFBridgingRelease(client);
+    if (context.runLoopSource) {
+        CFRunLoopSourceInvalidate(context.runLoopSource);
+        CFRelease(context.runLoopSource);
+        context.runLoopSource = NULL;
+    }
+
+    id decision = context.fallbackDecision;
+    if (error) {
+        EMAS_LOG_INFO(@"EC-Proxy", @"PAC evaluation failed for %@: %@", context.key, (__bridge NSError *)error);
+    } else if (proxyList) {
+        decision = EMASProxyStringFromProxies((__bridge NSArray *)proxyList, NULL) ?: [NSNull null];
+    }
+    [EMASCurlProxySetting finishProxyAutoConfigurationForKey:context.key decision:decision generation:context.generation];
+}
+
++ (void)evaluateProxyAutoConfiguration:(NSDictionary *)autoConfiguration
+                                forURL:(NSURL *)url
+                                   key:(NSString *)key
+                      fallbackDecision:(id)fallbackDecision
+                            generation:(uint64_t)generation {
+    dispatch_async(s_proxyQueue, ^{
+        if (generation != s_decisionGeneration || [s_pacInFlightKeys containsObject:key]) {
+            return;
+        }
+        [s_pacInFlightKeys addObject:key];
+
+        // PAC的下载与脚本执行由CFNetwork在RunLoop上驱动
+        dispatch_async(dispatch_get_main_queue(), ^{
+            EMASProxyAutoConfigurationContext *context = [EMASProxyAutoConfigurationContext new];
+            context.key = key;
+            context.generation = generation;
+            context.fallbackDecision = fallbackDecision;
+
+            CFStreamClientContext clientContext = {0, (void *)CFBridgingRetain(context), NULL, NULL, NULL};
+            CFRunLoopSourceRef source = NULL;
+            NSString *type = autoConfiguration[(NSString *)kCFProxyTypeKey];
+            if ([type isEqualToString:(NSString *)kCFProxyTypeAutoConfigurationURL]) {
+                NSURL *scriptURL = autoConfiguration[(NSString *)kCFProxyAutoConfigurationURLKey];
+                if (scriptURL) {
+                    source = CFNetworkExecuteProxyAutoConfigurationURL((__bridge CFURLRef)scriptURL, (__bridge CFURLRef)url,
+                                                                       EMASProxyAutoConfigurationCallback, &clientContext);
+                }
+            } else {
+                NSString *script = autoConfiguration[(NSString *)kCFProxyAutoConfigurationJavaScriptKey];
+                if (script) {
+                    source = CFNetworkExecuteProxyAutoConfigurationScript((__bridge CFStringRef)script, (__bridge CFURLRef)url,
+                                                                          EMASProxyAutoConfigurationCallback, &clientContext);
+                }
+            }
+
+            if (!source) {
+                CFBridgingRelease(clientContext.info);
+                [self finishProxyAutoConfigurationForKey:key decision:fallbackDecision generation:generation];
+                return;
+            }
+            context.runLoopSource = source;
+            CFRunLoopAddSource(CFRunLoopGetMain(), source, kCFRunLoopCommonModes);
+        });
+    });
+}
+
++ (void)finishProxyAutoConfigurationForKey:(NSString *)key decision:(id)decision generation:(uint64_t)generation {
+    dispatch_async(s_proxyQueue, ^{
+        if (generation != s_decisionGeneration) {
+            return;
+        }
+        [s_pacInFlightKeys removeObject:key];
+        EMAS_LOG_DEBUG(@"EC-Proxy", @"PAC decision for %@: %@", key, decision);
+    });
+    [self storeDecision:decision forKey:key generation:generation overwrite:YES];
+}
+
 #pragma mark - Internal
 
 // 使用 Darwin 通知监听系统网络配置变化，避免轮询
@@ -197,6 +391,13 @@ static const double kProxyUpdateDebounceIntervalSec = 0.8;
     });
 }
 
++ (void)overrideSystemProxySettings:(NSDictionary *)settings {
+    dispatch_sync(s_proxyQueue, ^{
+        s_overrideProxySettings = [settings copy];
+        [self _updateProxySettingsLocked];
+    });
+}
+
 + (void)updateProxySettingsAsyncInQueue {
     dispatch_async(s_proxyQueue, ^{
         [self _updateProxySettingsLocked];
@@ -211,13 +412,18 @@ static const double kProxyUpdateDebounceIntervalSec = 0.8;
 
     EMAS_LOG_INFO(@"EC-Proxy", @"Try to update proxy config.");
 
-    CFDictionaryRef proxySettings = CFNetworkCopySystemProxySettings();
-    if (!proxySettings) {
-        s_cachedProxySettings = nil;
-        return;
-    }
+    // 去抖后的网络变化同时使决策缓存失效
+    [self invalidateDecisionCacheLocked];
 
-    NSDictionary *proxyDict = CFBridgingRelease(proxySettings);
+    NSDictionary *proxyDict = s_overrideProxySettings;
+    if (!proxyDict) {
+        CFDictionaryRef proxySettings = CFNetworkCopySystemProxySettings();
+        if (!proxySettings) {
+            s_cachedProxySettings = nil;
+            return;
+        }
+        proxyDict = CFBridgingRelease(proxySettings);
+    }
     if (proxyDict.count == 0) {
         s_cachedProxySettings = nil;
         return;
@@ -0,0 +1,58 @@
+//
+//  EMASCurlRequestBodyEncoder.h
+//  EMASCurl
+//
+//  Created by xuyecan on 2026/10/18.
+//
+
+#import <Foundation/Foundation.h>
+#import "EMASCurlConfiguration.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ * 流式压缩请求体，由上传泵在I/O队列上驱动：needsInput时提供原始数据，
+ * 再反复调用encodeIntoBuffer:maxLength:取出压缩结果，直到finished。
+ * 非线程安全，只应在同一个串行队列上使用。
+ */
+@interface EMASCurlRequestBodyEncoder : NSObject
+
+// 不支持的编码返回nil
++ (nullable instancetype)encoderWithEncoding:(EMASCurlRequestBodyEncoding)encoding;
+
+- (instancetype)init NS_UNAVAILABLE;
+
+// Content-Encoding头的值
+@property (nonatomic, copy, readonly) NSString *contentEncoding;
+
+// 上次提供的数据已全部消费且尚未结束输入
+@property (nonatomic, assign, readonly) BOOL needsInput;
+
+// 所有输出均已取出
+@property (nonatomic, assign, readonly) BOOL finished;
+
+@property (nonatomic, assign, readonly) uint64_t rawBytes;
+
+@property (nonatomic, assign, readonly) uint64_t encodedBytes;
+
+/**
+ * 提供下一段原始数据，数据在下次needsInput为YES之前必须保持有效。
+ * length为0表示输入结束
+ */
+- (void)provideInput:(const uint8_t *)bytes length:(NSUInteger)length;
+
+/**
+ * 取出最多length字节的压缩数据，返回实际字节数（可能为0），出错返回-1
+ */
+- (NSInteger)encodeIntoBuffer:(uint8_t *)buffer maxLength:(NSUInteger)length;
+
+#pragma mark - 拒绝压缩请求体的host
+
+// 服务端对压缩的请求体返回415后记录该host，之后发往该host的请求不再压缩
++ (void)markHostRejectingEncodedBody:(NSString *)host;
+
++ (BOOL)hostRejectsEncodedBody:(NSString *)host;
+
+@end
+
+NS_ASSUME_NONNULL_END
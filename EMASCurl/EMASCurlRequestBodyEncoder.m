@@ -0,0 +1,121 @@
+//
+//  EMASCurlRequestBodyEncoder.m
+//  EMASCurl
+//
+//  Created by xuyecan on 2026/10/18.
+//
+
+#import "EMASCurlRequestBodyEncoder.h"
+#import "EMASCurlLogger.h"
+#import <os/lock.h>
+#import <zlib.h>
+
+// deflate的windowBits加16时输出gzip格式
+static const int kEMASGzipWindowBits = MAX_WBITS + 16;
+
+@interface EMASCurlRequestBodyEncoder () {
+    z_stream _stream;
+    BOOL _inputEnded;
+}
+
+@property (nonatomic, copy, readwrite) NSString *contentEncoding;
+@property (nonatomic, assign, readwrite) BOOL finished;
+@property (nonatomic, assign, readwrite) uint64_t rawBytes;
+
+@end
+
+@implementation EMASCurlRequestBodyEncoder
+
++ (instancetype)encoderWithEncoding:(EMASCurlRequestBodyEncoding)encoding {
+    if (encoding != EMASCurlRequestBodyEncodingGzip) {
+        return nil;
+    }
+    return [[self alloc] initGzipEncoder];
+}
+
+- (instancetype)initGzipEncoder {
+    self = [super init];
+    if (self) {
+        memset(&_stream, 0, sizeof(_stream));
+        if (deflateInit2(&_stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, kEMASGzipWindowBits, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+            EMAS_LOG_ERROR(@"EC-Upload", @"Failed to initialize gzip encoder");
+            return nil;
+        }
+        _contentEncoding = @"gzip";
+    }
+    return self;
+}
+
+- (void)dealloc {
+    deflateEnd(&_stream);
+}
+
+- (BOOL)needsInput {
+    return !_inputEnded && _stream.avail_in == 0;
+}
+
+- (uint64_t)encodedBytes {
+    return _stream.total_out;
+}
+
+- (void)provideInput:(const uint8_t *)bytes length:(NSUInteger)length {
+    if (length == 0) {
+        _inputEnded = YES;
+        return;
+    }
+    _stream.next_in = (Bytef *)bytes;
+    _stream.avail_in = (uInt)length;
+    self.rawBytes += length;
+}
+
+- (NSInteger)encodeIntoBuffer:(uint8_t *)buffer maxLength:(NSUInteger)length {
+    if (self.finished || length == 0) {
+        return 0;
+    }
+
+    _stream.next_out = buffer;
+    _stream.avail_out = (uInt)MIN(length, (NSUInteger)UINT_MAX);
+    uInt availableBefore = _stream.avail_out;
+
+    int status = deflate(&_stream, _inputEnded ? Z_FINISH : Z_NO_FLUSH);
+    if (status == Z_STREAM_ERROR) {
+        EMAS_LOG_ERROR(@"EC-Upload", @"Gzip encoder failed: %d", status);
+        return -1;
+    }
+    if (status == Z_STREAM_END) {
+        self.finished = YES;
+    }
+    return (NSInteger)(availableBefore - _stream.avail_out);
+}
+
+#pragma mark - 拒绝压缩请求体的host
+
+static os_unfair_lock s_rejectingHostsLock = OS_UNFAIR_LOCK_INIT;
+static NSMutableSet<NSString *> *s_rejectingHosts;
+
++ (void)markHostRejectingEncodedBody:(NSString *)host {
+    NSString *key = host.lowercaseString;
+    if (key.length == 0) {
+        return;
+    }
+    os_unfair_lock_lock(&s_rejectingHostsLock);
+    if (!s_rejectingHosts) {
+        s_rejectingHosts = [NSMutableSet set];
+    }
+    [s_rejectingHosts addObject:key];
+    os_unfair_lock_unlock(&s_rejectingHostsLock);
+    EMAS_LOG_INFO(@"EC-Upload", @"Host %@ rejected encoded request body, sending uncompressed from now on", key);
+}
+
++ (BOOL)hostRejectsEncodedBody:(NSString *)host {
+    NSString *key = host.lowercaseString;
+    if (key.length == 0) {
+        return NO;
+    }
+    os_unfair_lock_lock(&s_rejectingHostsLock);
+    BOOL rejects = [s_rejectingHosts containsObject:key];
+    os_unfair_lock_unlock(&s_rejectingHostsLock);
+    return rejects;
+}
+
+@end
@@ -0,0 +1,45 @@
+//
+//  EMASCurlRequestMatcher.h
+//  EMASCurl
+//
+//  Created by xuyecan on 2026/10/18.
+//
+
+#import <Foundation/Foundation.h>
+#import "EMASCurlConfiguration.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ * 由配置中的域名黑白名单与URL路径黑名单编译而成的匹配器，创建后不可变，可跨线程使用。
+ * 域名规则按字符逆序存入前缀树，匹配语义与逐条hasSuffix:一致；
+ * 路径规则按"/"分段存入前缀树，支持完全匹配、"/\*"与"/\*\*"三种模式。
+ * 匹配只遍历一次输入，不产生分配。
+ */
+@interface EMASCurlRequestMatcher : NSObject
+
+- (instancetype)initWithDomainBlackList:(nullable NSArray<NSString *> *)domainBlackList
+                        domainWhiteList:(nullable NSArray<NSString *> *)domainWhiteList
+                        urlPathBlackList:(nullable NSArray<NSString *> *)urlPathBlackList NS_DESIGNATED_INITIALIZER;
+
+- (instancetype)init NS_UNAVAILABLE;
+
+// 白名单非空时，只有匹配白名单的域名才会被拦截
+@property (nonatomic, assign, readonly) BOOL hasDomainWhiteList;
+
+- (BOOL)hostMatchesDomainBlackList:(NSString *)host;
+- (BOOL)hostMatchesDomainWhiteList:(NSString *)host;
+
+// 返回命中的路径模式，未命中返回nil
+- (nullable NSString *)urlPathBlackListPatternMatchingPath:(NSString *)path;
+
+@end
+
+@interface EMASCurlConfiguration (EMASRequestMatcher)
+
+// 惰性编译并缓存，任一名单变化后重新编译
+@property (nonatomic, strong, readonly) EMASCurlRequestMatcher *requestMatcher;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,369 @@
+//
+//  EMASCurlRequestMatcher.m
+//  EMASCurl
+//
+//  Created by xuyecan on 2026/10/18.
+//
+
+#import "EMASCurlRequestMatcher.h"
+
+// 域名与路径通常很短，栈上缓冲区可覆盖绝大多数请求
+#define EMAS_MATCHER_STACK_BUFFER_SIZE 1024
+
+// 域名前缀树节点：按字节逆序，子节点连续存放且按字节升序
+typedef struct {
+    uint32_t firstChild;
+    uint32_t childCount;
+    uint8_t byte;
+    bool terminal;     // 某条规则在此结束，即host以该规则结尾
+} EMASHostTrieNode;
+
+// 路径前缀树节点：每个节点对应一个路径段，子节点连续存放且按段内容升序
+typedef struct {
+    uint32_t firstChild;
+    uint32_t childCount;
+    uint32_t segmentOffset;
+    uint32_t segmentLength;
+    int32_t exactPattern;   // 以下为urlPathBlackList中的下标，-1表示无
+    int32_t singlePattern;  // "prefix/*"
+    int32_t anyPattern;     // "prefix/**"
+} EMASPathTrieNode;
+
+#pragma mark - 构建
+
+// 编译期使用的临时节点，编译完成后按广度优先顺序展开为C数组
+@interface EMASTrieBuilderNode : NSObject
+@property (nonatomic, strong) NSMutableDictionary<id, EMASTrieBuilderNode *> *children;
+@property (nonatomic, strong, nullable) id key;
+@property (nonatomic, assign) NSUInteger firstChild;
+@property (nonatomic, assign) BOOL terminal;
+@property (nonatomic, assign) int32_t exactPattern;
+@property (nonatomic, assign) int32_t singlePattern;
+@property (nonatomic, assign) int32_t anyPattern;
+@end
+
+@implementation EMASTrieBuilderNode
+
+- (instancetype)init {
+    self = [super init];
+    if (self) {
+        _children = [NSMutableDictionary new];
+        _exactPattern = -1;
+        _singlePattern = -1;
+        _anyPattern = -1;
+    }
+    return self;
+}
+
+- (EMASTrieBuilderNode *)childForKey:(id)key {
+    EMASTrieBuilderNode *child = self.children[key];
+    if (!child) {
+        child = [EMASTrieBuilderNode new];
+        child.key = key;
+        self.children[key] = child;
+    }
+    return child;
+}
+
+@end
+
+static int EMASCompareSegments(const void *a, size_t aLength, const void *b, size_t bLength) {
+    size_t commonLength = MIN(aLength, bLength);
+    int result = commonLength > 0 ? memcmp(a, b, commonLength) : 0;
+    if (result != 0) {
+        return result;
+    }
+    return aLength < bLength ? -1 : (aLength > bLength ? 1 : 0);
+}
+
+// 广度优先展开，同一节点的子节点按comparator排序后连续排列
+static NSArray<EMASTrieBuilderNode *> *EMASTrieFlatten(EMASTrieBuilderNode *root, NSComparator comparator) {
+    NSMutableArray<EMASTrieBuilderNode *> *order = [NSMutableArray arrayWithObject:root];
+    for (NSUInteger i = 0; i < order.count; i++) {
+        EMASTrieBuilderNode *node = order[i];
+        node.firstChild = order.count;
+        NSArray *keys = [node.children.allKeys sortedArrayUsingComparator:comparator];
+        for (id key in keys) {
+            [order addObject:node.children[key]];
+        }
+    }
+    return order;
+}
+
+static EMASHostTrieNode *EMASHostTrieCreate(NSArray<NSString *> *domains) {
+    EMASTrieBuilderNode *root = [EMASTrieBuilderNode new];
+    BOOL hasRule = NO;
+    for (NSString *domain in domains) {
+        if (![domain isKindOfClass:[NSString class]]) {
+            continue;
+        }
+        NSData *bytes = [domain dataUsingEncoding:NSUTF8StringEncoding];
+        // hasSuffix:@""恒为NO，空规则不参与匹配
+        if (bytes.length == 0) {
+            continue;
+        }
+        const uint8_t *buffer = bytes.bytes;
+        EMASTrieBuilderNode *node = root;
+        for (NSUInteger i = bytes.length; i > 0; i--) {
+            node = [node childForKey:@(buffer[i - 1])];
+        }
+        node.terminal = YES;
+        hasRule = YES;
+    }
+    if (!hasRule) {
+        return NULL;
+    }
+
+    NSArray<EMASTrieBuilderNode *> *order = EMASTrieFlatten(root, ^NSComparisonResult(NSNumber *a, NSNumber *b) {
+        return [a compare:b];
+    });
+    EMASHostTrieNode *nodes = calloc(order.count, sizeof(EMASHostTrieNode));
+    if (!nodes) {
+        return NULL;
+    }
+    [order enumerateObjectsUsingBlock:^(EMASTrieBuilderNode *node, NSUInteger idx, BOOL *stop) {
+        nodes[idx].firstChild = (uint32_t)node.firstChild;
+        nodes[idx].childCount = (uint32_t)node.children.count;
+        nodes[idx].byte = (uint8_t)[node.key unsignedCharValue];
+        nodes[idx].terminal = node.terminal;
+    }];
+    return nodes;
+}
+
+static EMASPathTrieNode *EMASPathTrieCreate(NSArray<NSString *> *patterns, NSMutableData *segmentPool) {
+    EMASTrieBuilderNode *root = [EMASTrieBuilderNode new];
+    BOOL hasRule = NO;
+    for (NSUInteger index = 0; index < patterns.count && index <= INT32_MAX; index++) {
+        NSString *pattern = patterns[index];
+        if (![pattern isKindOfClass:[NSString class]]) {
+            continue;
+        }
+
+        NSUInteger wildcardLength = 0;
+        if ([pattern hasSuffix:@"/**"]) {
+            wildcardLength = 3;
+        } else if ([pattern hasSuffix:@"/*"]) {
+            wildcardLength = 2;
+        }
+        NSString *prefix = [pattern substringToIndex:pattern.length - wildcardLength];
+
+        // 与匹配时按"/"逐段切分的方式一致，"/api"切分为""与"api"两段
+        EMASTrieBuilderNode *node = root;
+        for (NSString *segment in [prefix componentsSeparatedByString:@"/"]) {
+            node = [node childForKey:[segment dataUsingEncoding:NSUTF8StringEncoding] ?: [NSData data]];
+        }
+
+        // 同一节点上保留名单中靠前的模式，与逐条匹配时命中的模式一致
+        int32_t patternIndex = (int32_t)index;
+        if (wildcardLength == 3) {
+            if (node.anyPattern < 0) node.anyPattern = patternIndex;
+        } else if (wildcardLength == 2) {
+            if (node.singlePattern < 0) node.singlePattern = patternIndex;
+        } else {
+            if (node.exactPattern < 0) node.exactPattern = patternIndex;
+        }
+        hasRule = YES;
+    }
+    if (!hasRule) {
+        return NULL;
+    }
+
+    NSArray<EMASTrieBuilderNode *> *order = EMASTrieFlatten(root, ^NSComparisonResult(NSData *a, NSData *b) {
+        int result = EMASCompareSegments(a.bytes, a.length, b.bytes, b.length);
+        return result < 0 ? NSOrderedAscending : (result > 0 ? NSOrderedDescending : NSOrderedSame);
+    });
+    EMASPathTrieNode *nodes = calloc(order.count, sizeof(EMASPathTrieNode));
+    if (!nodes) {
+        return NULL;
+    }
+    [order enumerateObjectsUsingBlock:^(EMASTrieBuilderNode *node, NSUInteger idx, BOOL *stop) {
+        NSData *segment = node.key;
+        nodes[idx].firstChild = (uint32_t)node.firstChild;
+        nodes[idx].childCount = (uint32_t)node.children.count;
+        nodes[idx].segmentOffset = (uint32_t)segmentPool.length;
+        nodes[idx].segmentLength = (uint32_t)segment.length;
+        nodes[idx].exactPattern = node.exactPattern;
+        nodes[idx].singlePattern = node.singlePattern;
+        nodes[idx].anyPattern = node.anyPattern;
+        if (segment.length > 0) {
+            [segmentPool appendData:segment];
+        }
+    }];
+    return nodes;
+}
+
+#pragma mark - 匹配
+
+/**
+ * 获取字符串的UTF-8字节。ASCII字符串直接使用其内部缓冲区，其余情况复制到调用方的栈上缓冲区；
+ * 超出缓冲区时才退回UTF8String。失败返回NULL。
+ */
+static const char *EMASMatcherUTF8Bytes(NSString *string, char *buffer, NSUInteger capacity, NSUInteger *length) {
+    CFStringRef cfString = (__bridge CFStringRef)string;
+    const char *bytes = CFStringGetCStringPtr(cfString, kCFStringEncodingUTF8);
+    if (bytes) {
+        *length = (NSUInteger)CFStringGetLength(cfString);
+        return bytes;
+    }
+
+    NSRange remaining = NSMakeRange(0, 0);
+    if ([string getBytes:buffer maxLength:capacity usedLength:length encoding:NSUTF8StringEncoding
+                 options:0 range:NSMakeRange(0, string.length) remainingRange:&remaining] && remaining.length == 0) {
+        return buffer;
+    }
+
+    bytes = string.UTF8String;
+    if (!bytes) {
+        return NULL;
+    }
+    *length = strlen(bytes);
+    return bytes;
+}
+
+static BOOL EMASHostTrieMatchesSuffix(const EMASHostTrieNode *nodes, const char *host, size_t length) {
+    uint32_t node = 0;
+    for (size_t i = length; i > 0; i--) {
+        uint8_t byte = (uint8_t)host[i - 1];
+        uint32_t low = nodes[node].firstChild;
+        uint32_t high = low + nodes[node].childCount;
+        uint32_t end = high;
+        while (low < high) {
+            uint32_t mid = low + (high - low) / 2;
+            if (nodes[mid].byte < byte) {
+                low = mid + 1;
+            } else {
+                high = mid;
+            }
+        }
+        if (low == end || nodes[low].byte != byte) {
+            return NO;
+        }
+        node = low;
+        if (nodes[node].terminal) {
+            return YES;
+        }
+    }
+    return NO;
+}
+
+static int32_t EMASPathTrieFindChild(const EMASPathTrieNode *nodes, const char *segmentPool, uint32_t parent,
+                                     const char *segment, size_t segmentLength) {
+    uint32_t low = nodes[parent].firstChild;
+    uint32_t high = low + nodes[parent].childCount;
+    while (low < high) {
+        uint32_t mid = low + (high - low) / 2;
+        int result = EMASCompareSegments(segmentPool + nodes[mid].segmentOffset, nodes[mid].segmentLength,
+                                         segment, segmentLength);
+        if (result == 0) {
+            return (int32_t)mid;
+        }
+        if (result < 0) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    return -1;
+}
+
+// 逐段下行，返回命中的模式下标，未命中返回-1
+static int32_t EMASPathTrieMatch(const EMASPathTrieNode *nodes, const char *segmentPool, const char *path, size_t length) {
+    uint32_t node = 0;
+    size_t start = 0;
+    while (true) {
+        const char *slash = start < length ? memchr(path + start, '/', length - start) : NULL;
+        size_t end = slash ? (size_t)(slash - path) : length;
+        int32_t child = EMASPathTrieFindChild(nodes, segmentPool, node, path + start, end - start);
+        if (child < 0) {
+            return -1;
+        }
+        node = (uint32_t)child;
+        const EMASPathTrieNode *current = &nodes[node];
+
+        // 路径在此结束：完全匹配，或与通配模式的前缀本身相等
+        if (end == length) {
+            if (current->exactPattern >= 0) return current->exactPattern;
+            if (current->singlePattern >= 0) return current->singlePattern;
+            return current->anyPattern;
+        }
+
+        // 之后还有"/"：多级通配直接命中，单级通配要求剩余部分不再包含"/"
+        if (current->anyPattern >= 0) {
+            return current->anyPattern;
+        }
+        if (current->singlePattern >= 0) {
+            size_t remainingStart = end + 1;
+            if (remainingStart == length || !memchr(path + remainingStart, '/', length - remainingStart)) {
+                return current->singlePattern;
+            }
+        }
+        start = end + 1;
+    }
+}
+
+#pragma mark - EMASCurlRequestMatcher
+
+@implementation EMASCurlRequestMatcher {
+    EMASHostTrieNode *_blackListNodes;
+    EMASHostTrieNode *_whiteListNodes;
+    EMASPathTrieNode *_pathNodes;
+    NSData *_segmentPool;
+    NSArray<NSString *> *_urlPathBlackList;
+}
+
+- (instancetype)initWithDomainBlackList:(NSArray<NSString *> *)domainBlackList
+                        domainWhiteList:(NSArray<NSString *> *)domainWhiteList
+                        urlPathBlackList:(NSArray<NSString *> *)urlPathBlackList {
+    self = [super init];
+    if (self) {
+        _hasDomainWhiteList = domainWhiteList.count > 0;
+        _blackListNodes = EMASHostTrieCreate(domainBlackList);
+        _whiteListNodes = EMASHostTrieCreate(domainWhiteList);
+
+        NSMutableData *segmentPool = [NSMutableData new];
+        _pathNodes = EMASPathTrieCreate(urlPathBlackList, segmentPool);
+        _segmentPool = [segmentPool copy];
+        _urlPathBlackList = [urlPathBlackList copy];
+    }
+    return self;
+}
+
+- (void)dealloc {
+    free(_blackListNodes);
+    free(_whiteListNodes);
+    free(_pathNodes);
+}
+
+- (BOOL)host:(NSString *)host matchesTrie:(const EMASHostTrieNode *)nodes {
+    if (!nodes || host.length == 0) {
+        return NO;
+    }
+    char buffer[EMAS_MATCHER_STACK_BUFFER_SIZE];
+    NSUInteger length = 0;
+    const char *bytes = EMASMatcherUTF8Bytes(host, buffer, sizeof(buffer), &length);
+    return bytes && EMASHostTrieMatchesSuffix(nodes, bytes, length);
+}
+
+- (BOOL)hostMatchesDomainBlackList:(NSString *)host {
+    return [self host:host matchesTrie:_blackListNodes];
+}
+
+- (BOOL)hostMatchesDomainWhiteList:(NSString *)host {
+    return [self host:host matchesTrie:_whiteListNodes];
+}
+
+- (NSString *)urlPathBlackListPatternMatchingPath:(NSString *)path {
+    if (!_pathNodes || path.length == 0) {
+        return nil;
+    }
+    char buffer[EMAS_MATCHER_STACK_BUFFER_SIZE];
+    NSUInteger length = 0;
+    const char *bytes = EMASMatcherUTF8Bytes(path, buffer, sizeof(buffer), &length);
+    if (!bytes) {
+        return nil;
+    }
+    int32_t index = EMASPathTrieMatch(_pathNodes, _segmentPool.bytes, bytes, length);
+    return index >= 0 ? _urlPathBlackList[index] : nil;
+}
+
+@end
@@ -6,9 +6,30 @@
 //
 
 #import <Foundation/Foundation.h>
+#import "EMASCurlConfiguration.h"
+
+@class EMASCurlSparseCacheEntry;
+@class EMASCurlCacheQuotaPolicy;
 
 NS_ASSUME_NONNULL_BEGIN
 
+/**
+ * 按需读取缓存响应体，每次返回一个不超过64KB的数据块。
+ * 未压缩的响应体直接引用存储数据（大响应体为只读文件映射），不复制；压缩的响应体逐块解压。
+ * 非线程安全，同一时刻只能在一个线程中使用。
+ */
+@interface EMASCurlCacheBodyReader : NSObject
+
+// 读取完毕且数据完整
+@property (nonatomic, assign, readonly) BOOL finished;
+// 响应体损坏，已返回的数据不完整
+@property (nonatomic, assign, readonly) BOOL failed;
+
+// 返回下一个数据块，读取完毕或失败时返回nil
+- (nullable NSData *)nextChunk;
+
+@end
+
 @interface EMASCurlResponseCache : NSObject
 
 /**
@@ -25,6 +46,83 @@ NS_ASSUME_NONNULL_BEGIN
            forRequest:(NSURLRequest *)request
       withHTTPVersion:(NSString *)httpVersion; // 添加 httpVersion 参数
 
+/**
+ * 缓存HTTP响应，并按指定算法压缩响应体后存储。
+ * 响应体过小或压缩无收益时按原样存储。
+ *
+ * @param compression 响应体压缩算法，EMASCurlCacheCompressionNone表示不压缩
+ */
+- (void)cacheResponse:(NSHTTPURLResponse *)response
+                 data:(NSData *)data
+           forRequest:(NSURLRequest *)request
+      withHTTPVersion:(NSString *)httpVersion
+          compression:(EMASCurlCacheCompressionAlgorithm)compression;
+
+/**
+ * 缓存HTTP响应，并登记到淘汰索引。写入后若超过quotaPolicy的配额，按其策略移除条目（可能包括刚写入的条目）。
+ *
+ * @param quotaPolicy 淘汰策略与配额，nil表示该条目不受淘汰策略管理
+ */
+- (void)cacheResponse:(NSHTTPURLResponse *)response
+                 data:(NSData *)data
+           forRequest:(NSURLRequest *)request
+      withHTTPVersion:(NSString *)httpVersion
+          compression:(EMASCurlCacheCompressionAlgorithm)compression
+          quotaPolicy:(nullable EMASCurlCacheQuotaPolicy *)quotaPolicy;
+
+/**
+ * 记录一次缓存查询结果，用于命中率统计以及淘汰策略的访问时间与频率
+ */
+- (void)recordLookupForRequest:(NSURLRequest *)request hit:(BOOL)hit;
+
+/**
+ * 命中率与淘汰统计的快照
+ */
+- (EMASCurlCacheStatistics *)cacheStatistics;
+
+/**
+ * 创建缓存响应体的读取器，响应体文件丢失或无法解压时返回nil
+ */
+- (nullable EMASCurlCacheBodyReader *)bodyReaderForCachedResponse:(NSCachedURLResponse *)cachedResponse;
+
+/**
+ * 分块交付缓存响应体。压缩存储的响应体会被流式解压，不会一次性持有完整的解压数据。
+ *
+ * @param cachedResponse 由本类返回的缓存响应
+ * @param block 每个数据块的回调，在调用线程同步执行
+ * @return 响应体损坏无法解压时返回NO，此前已回调的数据不完整
+ */
+- (BOOL)enumerateBodyOfCachedResponse:(NSCachedURLResponse *)cachedResponse
+                           usingBlock:(void (^)(NSData *chunk))block;
+
+/**
+ * 获取完整的（解压后的）缓存响应体，损坏时返回nil
+ */
+- (nullable NSData *)bodyOfCachedResponse:(NSCachedURLResponse *)cachedResponse;
+
+/**
+ * 添加只读的预置缓存包作为下层缓存：NSURLCache未命中时按添加顺序倒序查找。
+ * 同一路径重复添加时替换旧的包。
+ *
+ * @return 文件不存在或文件头/索引无效时返回NO
+ */
+- (BOOL)addSeedPackAtPath:(NSString *)path;
+
+/**
+ * 移除请求对应的完整响应缓存，用于丢弃响应体已损坏的条目
+ */
+- (void)removeCachedResponseForRequest:(NSURLRequest *)request;
+
+/**
+ * 清空NSURLCache中的全部条目、独立存放的响应体文件与淘汰索引
+ */
+- (void)removeAllCachedResponses;
+
+/**
+ * 响应体压缩统计的快照
+ */
+- (EMASCurlCacheCompressionStatistics *)compressionStatistics;
+
 /**
  * 获取请求对应的缓存响应。
  * 此方法会返回一个缓存响应，如果它存在且:
@@ -47,6 +145,47 @@ NS_ASSUME_NONNULL_BEGIN
 - (nullable NSCachedURLResponse *)updateCachedResponseWithHeaders:(NSDictionary *)newResponseHeaders
                                                        forRequest:(NSURLRequest *)request;
 
+/**
+ * 获取Range请求可用的稀疏缓存条目。
+ * 优先使用该URL独立存储的稀疏条目，不存在时把同一URL的完整200缓存视作覆盖全部字节的条目。
+ * Vary不匹配时返回nil；已过期且没有可用于If-Range的验证器的稀疏条目会被移除。
+ *
+ * @param request 带Range头的原始请求
+ * @return 稀疏缓存条目，或nil。
+ */
+- (nullable EMASCurlSparseCacheEntry *)sparseEntryForRequest:(NSURLRequest *)request;
+
+/**
+ * 将206响应的数据合并进该URL的稀疏缓存条目。
+ * 已有条目的验证器或资源总长度与新响应不一致时，已有条目被替换。
+ *
+ * @param response 206响应，必须带有可解析的Content-Range
+ * @param data 响应体数据，长度必须与Content-Range一致
+ * @param request 原始请求
+ * @param httpVersion 原始响应的HTTP版本
+ * @param maxBytes 合并后条目允许的最大字节数，超过时保留原条目不变
+ */
+- (void)storePartialResponse:(NSHTTPURLResponse *)response
+                        data:(NSData *)data
+                  forRequest:(NSURLRequest *)request
+             withHTTPVersion:(NSString *)httpVersion
+                    maxBytes:(NSUInteger)maxBytes;
+
+/**
+ * 同上，合并后的条目登记到淘汰索引并按quotaPolicy执行配额
+ */
+- (void)storePartialResponse:(NSHTTPURLResponse *)response
+                        data:(NSData *)data
+                  forRequest:(NSURLRequest *)request
+             withHTTPVersion:(NSString *)httpVersion
+                    maxBytes:(NSUInteger)maxBytes
+                 quotaPolicy:(nullable EMASCurlCacheQuotaPolicy *)quotaPolicy;
+
+/**
+ * 移除该URL的稀疏缓存条目，不影响完整响应的缓存
+ */
+- (void)removeSparseEntryForRequest:(NSURLRequest *)request;
+
 @end
 
 NS_ASSUME_NONNULL_END
@@ -7,12 +7,127 @@
 
 #import "EMASCurlResponseCache.h"
 #import "NSCachedURLResponse+EMASCurl.h"
+#import "EMASCurlSparseCacheEntry.h"
+#import "EMASCurlCacheCompressor.h"
+#import "EMASCurlCacheIndex.h"
+#import "EMASCurlCacheSeedPack.h"
+#import "EMASCurlMemoryPressureManager.h"
 #import "EMASCurlLogger.h"
+#import <CommonCrypto/CommonDigest.h>
+#import <sys/stat.h>
+#import <sys/time.h>
+#import <time.h>
+#import <unistd.h>
+
+// 稀疏条目与完整响应共用NSURLCache，通过附加查询参数派生独立的存储键，避免互相覆盖
+static NSString * const kEMASSparseCacheQueryItemName = @"emascurl-sparse";
+
+// 压缩存储或响应体存放在独立文件中的完整响应同样使用派生的存储键：直接读取NSURLCache的调用方
+// （如未安装EMASCurl的NSURLSession）查不到这些条目，不会把压缩数据或空响应体当作原始响应
+static NSString * const kEMASEncodedCacheQueryItemName = @"emascurl-encoded";
+
+// 小于该大小的响应体压缩收益有限，按原样存储
+static const NSUInteger kEMASCacheCompressionMinimumBytes = 1024;
+
+// 命中时解压交付的分块大小
+static const NSUInteger kEMASCacheBodyChunkSize = 64 * 1024;
+
+// 不小于该大小的响应体写入独立文件，命中时只读映射，NSURLCache中只保留元数据
+static const NSUInteger kEMASCacheMappedBodyMinimumBytes = 256 * 1024;
+
+// 超过该时长仍未改名的临时响应体文件是异常退出的遗留，清理时删除
+static const NSTimeInterval kEMASCacheTemporaryBodyMaxAge = 60;
+
+// 淘汰索引变化后延迟写入文件的时间，期间的多次变化合并为一次写入
+static const NSTimeInterval kEMASCacheIndexPersistDelay = 2;
+
+#pragma mark - EMASCurlCacheBodyReader
+
+static NSTimeInterval EMASCurrentThreadCPUTime(void) {
+    struct timespec ts;
+    if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts) != 0) {
+        return 0;
+    }
+    return (NSTimeInterval)ts.tv_sec + (NSTimeInterval)ts.tv_nsec / 1e9;
+}
+
+@interface EMASCurlCacheBodyReader ()
+
+@property (nonatomic, assign, readwrite) BOOL finished;
+@property (nonatomic, assign, readwrite) BOOL failed;
+@property (nonatomic, strong) NSData *storedBody;
+@property (nonatomic, assign) NSUInteger offset;
+@property (nonatomic, strong, nullable) EMASCurlCacheDecoder *decoder;
+// 解压后应有的长度，NSNotFound表示未知
+@property (nonatomic, assign) NSUInteger expectedLength;
+@property (nonatomic, assign) NSUInteger producedLength;
+@property (nonatomic, assign) NSTimeInterval decodeCPUTime;
+@property (nonatomic, copy, nullable) void (^decodeCompletion)(NSTimeInterval decodeCPUTime);
+
+@end
+
+@implementation EMASCurlCacheBodyReader
+
+- (nullable NSData *)nextChunk {
+    if (self.finished || self.failed) {
+        return nil;
+    }
+
+    if (!self.decoder) {
+        NSUInteger remaining = self.storedBody.length - self.offset;
+        if (remaining == 0) {
+            self.finished = YES;
+            return nil;
+        }
+        // 直接引用存储数据（可能是文件映射）的一段，不复制；块对象持有存储数据，保证映射在块释放前有效
+        NSData *storedBody = self.storedBody;
+        NSUInteger length = MIN(remaining, kEMASCacheBodyChunkSize);
+        const uint8_t *bytes = (const uint8_t *)storedBody.bytes + self.offset;
+        self.offset += length;
+        return [[NSData alloc] initWithBytesNoCopy:(void *)bytes length:length deallocator:^(void *chunkBytes, NSUInteger chunkLength) {
+            (void)storedBody;
+        }];
+    }
+
+    // 解压CPU时间只统计解压本身，不包括调用方处理数据块的耗时
+    NSTimeInterval startCPUTime = EMASCurrentThreadCPUTime();
+    NSData *chunk = [self.decoder nextChunk];
+    self.decodeCPUTime += MAX(0, EMASCurrentThreadCPUTime() - startCPUTime);
+    if (chunk) {
+        self.producedLength += chunk.length;
+        return chunk;
+    }
+
+    if (self.decoder.finished && (self.expectedLength == NSNotFound || self.expectedLength == self.producedLength)) {
+        self.finished = YES;
+        if (self.decodeCompletion) {
+            self.decodeCompletion(self.decodeCPUTime);
+        }
+    } else {
+        self.failed = YES;
+    }
+    return nil;
+}
+
+@end
 
 @interface EMASCurlResponseCache ()
 
 @property (nonatomic, strong) NSURLCache *urlCache;
 @property (nonatomic, strong) dispatch_queue_t cacheQueue;
+@property (nonatomic, strong) EMASCurlCacheCompressionStatistics *statistics;
+// 淘汰索引，只在cacheQueue中访问
+@property (nonatomic, strong) EMASCurlCacheIndex *index;
+// 大响应体文件所在目录
+@property (nonatomic, copy) NSString *bodyDirectory;
+// 已安排清理响应体文件；只在cacheQueue中访问
+@property (nonatomic, assign) BOOL bodyTrimScheduled;
+// 淘汰索引的持久化文件
+@property (nonatomic, copy) NSString *indexFilePath;
+// 已安排写入淘汰索引；只在cacheQueue中访问
+@property (nonatomic, assign) BOOL indexPersistScheduled;
+// 只读的预置缓存包，后添加的在前；只在cacheQueue中访问
+@property (nonatomic, copy) NSArray<EMASCurlCacheSeedPack *> *seedPacks;
 
 @end
 
@@ -52,44 +167,577 @@ static NSData *EMASCacheImmutableData(NSData *data) {
     return [data isKindOfClass:[NSMutableData class]] ? [data copy] : data;
 }
 
+// 响应体文件名：缓存键的SHA-256，同一URL的新响应覆盖旧文件
+static NSString *EMASCacheBodyFileName(NSString *key) {
+    NSData *keyData = [key dataUsingEncoding:NSUTF8StringEncoding];
+    unsigned char digest[CC_SHA256_DIGEST_LENGTH];
+    CC_SHA256(keyData.bytes, (CC_LONG)keyData.length, digest);
+    NSMutableString *name = [NSMutableString stringWithCapacity:CC_SHA256_DIGEST_LENGTH * 2];
+    for (int i = 0; i < CC_SHA256_DIGEST_LENGTH; i++) {
+        [name appendFormat:@"%02x", digest[i]];
+    }
+    return name;
+}
+
+static NSURLRequest *EMASDerivedStorageRequest(NSURLRequest *request, NSString *queryItemName) {
+    NSURLComponents *components = [NSURLComponents componentsWithURL:request.URL resolvingAgainstBaseURL:NO];
+    if (!components) {
+        return nil;
+    }
+    NSMutableArray<NSURLQueryItem *> *queryItems = [components.queryItems mutableCopy] ?: [NSMutableArray array];
+    [queryItems addObject:[NSURLQueryItem queryItemWithName:queryItemName value:@"1"]];
+    components.queryItems = queryItems;
+    if (!components.URL) {
+        return nil;
+    }
+
+    NSMutableURLRequest *storageRequest = [request mutableCopy];
+    storageRequest.URL = components.URL;
+    return storageRequest;
+}
+
+static NSURLRequest *EMASSparseStorageRequest(NSURLRequest *request) {
+    return EMASDerivedStorageRequest(request, kEMASSparseCacheQueryItemName);
+}
+
+static NSURLRequest *EMASEncodedStorageRequest(NSURLRequest *request) {
+    return EMASDerivedStorageRequest(request, kEMASEncodedCacheQueryItemName);
+}
+
+static BOOL EMASCachedResponseIsEncoded(NSCachedURLResponse *cachedResponse) {
+    return cachedResponse.userInfo[EMASUserInfoKeyBodyCompression] != nil || cachedResponse.userInfo[EMASUserInfoKeyBodyFile] != nil;
+}
+
 - (instancetype)init {
     if (self = [super init]) {
         _urlCache = [NSURLCache sharedURLCache];
         _cacheQueue = dispatch_queue_create("com.alicloud.emascurl.cacheQueue", DISPATCH_QUEUE_SERIAL);
+        _statistics = [EMASCurlCacheCompressionStatistics new];
+        _index = [EMASCurlCacheIndex new];
+        _seedPacks = @[];
+        NSString *cachesDirectory = NSSearchPathForDirectoriesInDomains(NSCachesDirectory, NSUserDomainMask, YES).firstObject ?: NSTemporaryDirectory();
+        _bodyDirectory = [cachesDirectory stringByAppendingPathComponent:@"com.alicloud.emascurl/CacheBodies"];
+        _indexFilePath = [cachesDirectory stringByAppendingPathComponent:@"com.alicloud.emascurl/CacheIndex.json"];
+        [[NSFileManager defaultManager] createDirectoryAtPath:_bodyDirectory withIntermediateDirectories:YES attributes:nil error:nil];
+        [self registerMemoryPressureHandler];
+        // 恢复上次运行的淘汰索引，之前存入的条目继续受配额与淘汰策略管理；读文件不阻塞初始化，之后的访问都排在其后
+        dispatch_async(_cacheQueue, ^{
+            self.index = [EMASCurlCacheIndex indexWithContentsOfFile:self.indexFilePath];
+        });
+        // 上次运行遗留的响应体文件（NSURLCache已淘汰其条目、或被外部清空）在启动后清理
+        [self scheduleBodyTrim];
     }
     return self;
 }
 
+// 内存压力时只释放SDK自己持有的内存。urlCache是应用共享的NSURLCache，宿主的URLSession与WebView也在使用，不调整其容量
+- (void)registerMemoryPressureHandler {
+    __weak typeof(self) weakSelf = self;
+    [[EMASCurlMemoryPressureManager sharedManager] registerReleaseHandler:^(EMASCurlMemoryPressureLevel level, void (^completion)(NSUInteger)) {
+        __strong typeof(weakSelf) strongSelf = weakSelf;
+        if (!strongSelf || level == EMASCurlMemoryPressureNormal) {
+            completion(0);
+            return;
+        }
+        dispatch_async(strongSelf.cacheQueue, ^{
+            completion([strongSelf releaseMemoryForPressure]);
+        });
+    } forComponent:EMASCurlMemoryComponentResponseCache];
+}
+
+// 丢弃预置缓存包中已解析的条目元数据，映射的文件页由系统按需回收
+- (NSUInteger)releaseMemoryForPressure {
+    NSUInteger releasedBytes = 0;
+    for (EMASCurlCacheSeedPack *pack in self.seedPacks) {
+        releasedBytes += [pack purgeValidatedMetadata];
+    }
+    return releasedBytes;
+}
+
 - (void)cacheResponse:(NSHTTPURLResponse *)response
                  data:(NSData *)data
            forRequest:(NSURLRequest *)request
       withHTTPVersion:(NSString *)httpVersion {
+    [self cacheResponse:response
+                   data:data
+             forRequest:request
+        withHTTPVersion:httpVersion
+            compression:EMASCurlCacheCompressionNone
+            quotaPolicy:nil];
+}
+
+- (void)cacheResponse:(NSHTTPURLResponse *)response
+                 data:(NSData *)data
+           forRequest:(NSURLRequest *)request
+      withHTTPVersion:(NSString *)httpVersion
+          compression:(EMASCurlCacheCompressionAlgorithm)compression {
+    [self cacheResponse:response
+                   data:data
+             forRequest:request
+        withHTTPVersion:httpVersion
+            compression:compression
+            quotaPolicy:nil];
+}
+
+- (void)cacheResponse:(NSHTTPURLResponse *)response
+                 data:(NSData *)data
+           forRequest:(NSURLRequest *)request
+      withHTTPVersion:(NSString *)httpVersion
+          compression:(EMASCurlCacheCompressionAlgorithm)compression
+          quotaPolicy:(nullable EMASCurlCacheQuotaPolicy *)quotaPolicy {
     if (!request || !response || !data) {
         EMAS_LOG_ERROR(@"EC-Cache", @"Failed to cache response: nil request, response, or data");
         return;
     }
 
+    // 可缓存性判断与压缩都不依赖共享状态，放在串行队列外执行，避免阻塞其他请求的缓存查询
+    // request.URL 用于NSCachedURLResponse初始化，因为response.URL可能因重定向而与原始请求URL不同
+    NSCachedURLResponse *emasCachedResponse = [NSCachedURLResponse emas_cachedResponseWithHTTPURLResponse:response
+                                                                                                    data:data
+                                                                                              requestURL:request.URL
+                                                                                             httpVersion:httpVersion
+                                                                                         originalRequest:request];
+    if (!emasCachedResponse) {
+        EMAS_LOG_DEBUG(@"EC-Cache", @"Response not cacheable for URL: %@", request.URL.absoluteString);
+        return;
+    }
+
+    emasCachedResponse = [self compressedResponse:emasCachedResponse algorithm:compression request:request];
+    NSUInteger storedLength = emasCachedResponse.data.length;
+
+    // 大响应体先写入临时文件（不占用串行队列），入队后再原子替换为正式文件；
+    // 响应体文件与NSURLCache共用其磁盘容量，容量不足以容纳时按原样交给NSURLCache决定是否存储
+    NSString *temporaryBodyPath = nil;
+    if (storedLength >= kEMASCacheMappedBodyMinimumBytes && storedLength < self.urlCache.diskCapacity) {
+        temporaryBodyPath = [self writeTemporaryBodyFile:emasCachedResponse.data];
+        if (temporaryBodyPath) {
+            NSMutableDictionary *userInfo = [emasCachedResponse.userInfo mutableCopy] ?: [NSMutableDictionary dictionary];
+            userInfo[EMASUserInfoKeyBodyFile] = EMASCacheBodyFileName(request.URL.absoluteString);
+            userInfo[EMASUserInfoKeyBodyStoredLength] = @(storedLength);
+            emasCachedResponse = [[NSCachedURLResponse alloc] initWithResponse:emasCachedResponse.response
+                                                                          data:[NSData data]
+                                                                      userInfo:userInfo
+                                                                 storagePolicy:emasCachedResponse.storagePolicy];
+        }
+    }
+
+    emasCachedResponse = [self sanitizedResponseForStorage:emasCachedResponse
+                                                     stage:@"cacheResponse.beforeStore"
+                                                   request:request];
+
     dispatch_sync(self.cacheQueue, ^{
-        // 使用类别方法创建并检查是否可缓存
-        // request.URL 用于NSCachedURLResponse初始化，因为response.URL可能因重定向而与原始请求URL不同
-        NSCachedURLResponse *emasCachedResponse = [NSCachedURLResponse emas_cachedResponseWithHTTPURLResponse:response
-                                                                                                        data:data
-                                                                                                  requestURL:request.URL
-                                                                                                 httpVersion:httpVersion
-                                                                                             originalRequest:request];
-
-        if (emasCachedResponse) {
-            emasCachedResponse = [self sanitizedResponseForStorage:emasCachedResponse
-                                                             stage:@"cacheResponse.beforeStore"
-                                                           request:request];
-            EMAS_LOG_DEBUG(@"EC-Cache", @"Storing response in cache for URL: %@", request.URL.absoluteString);
-            [self.urlCache storeCachedResponse:emasCachedResponse forRequest:request];
+        NSString *bodyPath = [self bodyFilePathForKey:request.URL.absoluteString];
+        if (temporaryBodyPath) {
+            if (rename(temporaryBodyPath.fileSystemRepresentation, bodyPath.fileSystemRepresentation) != 0) {
+                EMAS_LOG_ERROR(@"EC-Cache", @"Failed to move cached body file for URL: %@ (errno %d)", request.URL.absoluteString, errno);
+                unlink(temporaryBodyPath.fileSystemRepresentation);
+                return;
+            }
         } else {
-            EMAS_LOG_DEBUG(@"EC-Cache", @"Response not cacheable for URL: %@", request.URL.absoluteString);
+            // 同一URL之前的响应体可能存放在文件中
+            unlink(bodyPath.fileSystemRepresentation);
+        }
+
+        EMAS_LOG_DEBUG(@"EC-Cache", @"Storing response in cache for URL: %@", request.URL.absoluteString);
+        [self storeCompleteResponse:emasCachedResponse forRequest:request];
+        [self recordStoreForRequest:request
+                              bytes:storedLength
+                        quotaPolicy:quotaPolicy];
+        if (temporaryBodyPath) {
+            [self scheduleBodyTrim];
+        }
+    });
+}
+
+- (NSString *)bodyFilePathForKey:(NSString *)key {
+    return [self.bodyDirectory stringByAppendingPathComponent:EMASCacheBodyFileName(key ?: @"")];
+}
+
+- (nullable NSString *)writeTemporaryBodyFile:(NSData *)data {
+    NSString *path = [self.bodyDirectory stringByAppendingPathComponent:[NSString stringWithFormat:@"%@.tmp", [NSUUID UUID].UUIDString]];
+    NSError *error = nil;
+    if (![data writeToFile:path options:0 error:&error]) {
+        EMAS_LOG_ERROR(@"EC-Cache", @"Failed to write cached body file: %@", error.localizedDescription);
+        unlink(path.fileSystemRepresentation);
+        return nil;
+    }
+    return path;
+}
+
+// 在cacheQueue中调用：完整响应按原始、编码两种存储键依次查找
+- (nullable NSCachedURLResponse *)storedCompleteResponseForRequest:(NSURLRequest *)request {
+    NSCachedURLResponse *cachedResponse = [self.urlCache cachedResponseForRequest:request];
+    if (cachedResponse) {
+        return cachedResponse;
+    }
+    NSURLRequest *encodedRequest = EMASEncodedStorageRequest(request);
+    return encodedRequest ? [self.urlCache cachedResponseForRequest:encodedRequest] : nil;
+}
+
+// 在cacheQueue中调用：按响应体是否编码选择存储键，并移除另一种形式的旧条目
+- (void)storeCompleteResponse:(NSCachedURLResponse *)cachedResponse forRequest:(NSURLRequest *)request {
+    NSURLRequest *encodedRequest = EMASEncodedStorageRequest(request);
+    if (!EMASCachedResponseIsEncoded(cachedResponse)) {
+        if (encodedRequest) {
+            [self.urlCache removeCachedResponseForRequest:encodedRequest];
+        }
+        [self.urlCache storeCachedResponse:cachedResponse forRequest:request];
+        return;
+    }
+
+    [self.urlCache removeCachedResponseForRequest:request];
+    if (!encodedRequest) {
+        // 无法派生存储键时不存储，编码后的响应体不能以原始URL存储
+        EMAS_LOG_INFO(@"EC-Cache", @"Cannot derive encoded storage key for URL: %@", request.URL.absoluteString);
+        return;
+    }
+    [self.urlCache storeCachedResponse:cachedResponse forRequest:encodedRequest];
+}
+
+// 在cacheQueue中调用：移除缓存条目及其响应体文件，并停止跟踪
+- (void)removeStoredResponseForRequest:(NSURLRequest *)request {
+    [self.urlCache removeCachedResponseForRequest:request];
+    NSURLRequest *encodedRequest = EMASEncodedStorageRequest(request);
+    if (encodedRequest) {
+        [self.urlCache removeCachedResponseForRequest:encodedRequest];
+    }
+    [self.index removeKey:request.URL.absoluteString];
+    [self scheduleIndexPersist];
+    unlink([self bodyFilePathForKey:request.URL.absoluteString].fileSystemRepresentation);
+}
+
+// 在cacheQueue中调用：合并一段时间内的索引变化后写入文件
+- (void)scheduleIndexPersist {
+    if (self.indexPersistScheduled) {
+        return;
+    }
+    self.indexPersistScheduled = YES;
+    dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t)(kEMASCacheIndexPersistDelay * NSEC_PER_SEC)), self.cacheQueue, ^{
+        self.indexPersistScheduled = NO;
+        [self.index writeToFile:self.indexFilePath];
+    });
+}
+
+// 合并短时间内的多次写入，清理不阻塞写入方
+- (void)scheduleBodyTrim {
+    dispatch_async(self.cacheQueue, ^{
+        if (self.bodyTrimScheduled) {
+            return;
         }
+        self.bodyTrimScheduled = YES;
+        dispatch_async(self.cacheQueue, ^{
+            self.bodyTrimScheduled = NO;
+            [self trimBodyDirectory];
+        });
     });
 }
 
+// 在cacheQueue中调用：先移除索引中已被NSURLCache自行淘汰的条目及其响应体文件；
+// 之后响应体文件与NSURLCache的磁盘占用合计仍超过diskCapacity时，按最近访问时间从旧到新删除响应体文件。
+// 被删除文件对应的条目在下次查找时发现响应体缺失而移除；不受索引跟踪的条目遗留的文件不再被访问，会先被删除
+- (void)trimBodyDirectory {
+    NSUInteger orphanCount = 0;
+    for (NSString *key in [self.index allKeys]) {
+        NSURL *url = [NSURL URLWithString:key];
+        if (url && [self storedCompleteResponseForRequest:[NSURLRequest requestWithURL:url]]) {
+            continue;
+        }
+        [self.index removeKey:key];
+        unlink([self bodyFilePathForKey:key].fileSystemRepresentation);
+        orphanCount++;
+    }
+    if (orphanCount > 0) {
+        EMAS_LOG_DEBUG(@"EC-Cache", @"Dropped %lu index entries evicted by NSURLCache", (unsigned long)orphanCount);
+        [self scheduleIndexPersist];
+    }
+
+    NSUInteger diskCapacity = self.urlCache.diskCapacity;
+    NSUInteger indexUsage = self.urlCache.currentDiskUsage;
+    unsigned long long budget = diskCapacity > indexUsage ? diskCapacity - indexUsage : 0;
+
+    NSArray<NSURLResourceKey> *keys = @[NSURLContentModificationDateKey, NSURLFileSizeKey];
+    NSArray<NSURL *> *fileURLs = [[NSFileManager defaultManager] contentsOfDirectoryAtURL:[NSURL fileURLWithPath:self.bodyDirectory]
+                                                               includingPropertiesForKeys:keys
+                                                                                  options:NSDirectoryEnumerationSkipsHiddenFiles
+                                                                                    error:nil];
+    NSMutableArray<NSDictionary<NSURLResourceKey, id> *> *bodyFiles = [NSMutableArray arrayWithCapacity:fileURLs.count];
+    unsigned long long totalBytes = 0;
+    for (NSURL *fileURL in fileURLs) {
+        NSDictionary<NSURLResourceKey, id> *values = [fileURL resourceValuesForKeys:keys error:nil];
+        NSDate *modified = values[NSURLContentModificationDateKey];
+        if ([fileURL.pathExtension isEqualToString:@"tmp"]) {
+            // 正在写入的临时文件由写入方改名或删除
+            if (modified && -modified.timeIntervalSinceNow > kEMASCacheTemporaryBodyMaxAge) {
+                unlink(fileURL.fileSystemRepresentation);
+            }
+            continue;
+        }
+        if (!modified) {
+            continue;
+        }
+        totalBytes += [values[NSURLFileSizeKey] unsignedLongLongValue];
+        [bodyFiles addObject:@{NSURLPathKey: fileURL.path, NSURLContentModificationDateKey: modified, NSURLFileSizeKey: values[NSURLFileSizeKey] ?: @0}];
+    }
+    if (totalBytes <= budget) {
+        return;
+    }
+
+    [bodyFiles sortUsingComparator:^NSComparisonResult(NSDictionary *a, NSDictionary *b) {
+        return [a[NSURLContentModificationDateKey] compare:b[NSURLContentModificationDateKey]];
+    }];
+    NSUInteger removedCount = 0;
+    for (NSDictionary<NSURLResourceKey, id> *bodyFile in bodyFiles) {
+        if (totalBytes <= budget) {
+            break;
+        }
+        NSString *path = bodyFile[NSURLPathKey];
+        if (unlink(path.fileSystemRepresentation) == 0) {
+            totalBytes -= [bodyFile[NSURLFileSizeKey] unsignedLongLongValue];
+            removedCount++;
+        }
+    }
+    EMAS_LOG_DEBUG(@"EC-Cache", @"Trimmed %lu cached body files, %llu bytes remain", (unsigned long)removedCount, totalBytes);
+}
+
+// 文件存储的响应体是否仍然完整可用
+- (BOOL)bodyFileIsIntactForCachedResponse:(NSCachedURLResponse *)cachedResponse {
+    NSString *fileName = cachedResponse.userInfo[EMASUserInfoKeyBodyFile];
+    if (!fileName) {
+        return YES;
+    }
+    NSNumber *storedLength = cachedResponse.userInfo[EMASUserInfoKeyBodyStoredLength];
+    if (![fileName isKindOfClass:[NSString class]] || ![storedLength isKindOfClass:[NSNumber class]]) {
+        return NO;
+    }
+    struct stat st;
+    NSString *path = [self.bodyDirectory stringByAppendingPathComponent:fileName.lastPathComponent];
+    return stat(path.fileSystemRepresentation, &st) == 0 && (unsigned long long)st.st_size == storedLength.unsignedLongLongValue;
+}
+
+// 在cacheQueue中调用：登记刚写入的条目，并移除为满足配额被淘汰的条目
+- (void)recordStoreForRequest:(NSURLRequest *)request
+                        bytes:(NSUInteger)bytes
+                  quotaPolicy:(nullable EMASCurlCacheQuotaPolicy *)quotaPolicy {
+    NSString *key = request.URL.absoluteString;
+    if (!key) {
+        return;
+    }
+    if (!quotaPolicy) {
+        // 不受淘汰策略管理的写入覆盖了同一条目，停止跟踪旧记录
+        if ([self.index containsKey:key]) {
+            [self.index removeKey:key];
+            [self scheduleIndexPersist];
+        }
+        return;
+    }
+
+    NSArray<NSString *> *evictedKeys = [self.index recordStoreForKey:key
+                                                                host:request.URL.host ?: @""
+                                                               bytes:bytes
+                                                         quotaPolicy:quotaPolicy];
+    [self scheduleIndexPersist];
+    for (NSString *evictedKey in evictedKeys) {
+        NSURL *evictedURL = [NSURL URLWithString:evictedKey];
+        if (!evictedURL) {
+            continue;
+        }
+        EMAS_LOG_DEBUG(@"EC-Cache", @"Evicting cached response for URL: %@", evictedKey);
+        [self removeStoredResponseForRequest:[NSURLRequest requestWithURL:evictedURL]];
+    }
+}
+
+- (void)recordLookupForRequest:(NSURLRequest *)request hit:(BOOL)hit {
+    NSString *key = request.URL.absoluteString;
+    if (!key) {
+        return;
+    }
+    // 统计不影响本次请求的处理，异步记录，不阻塞调用方
+    NSString *sparseKey = EMASSparseStorageRequest(request).URL.absoluteString;
+    dispatch_async(self.cacheQueue, ^{
+        [self.index recordLookupForKey:key hit:hit];
+        if (sparseKey && [self.index containsKey:sparseKey]) {
+            [self.index recordLookupForKey:sparseKey hit:hit];
+        }
+        // 访问顺序与频率决定淘汰对象，同样需要持久化
+        if ([self.index containsKey:key] || (sparseKey && [self.index containsKey:sparseKey])) {
+            [self scheduleIndexPersist];
+        }
+    });
+}
+
+- (EMASCurlCacheStatistics *)cacheStatistics {
+    __block EMASCurlCacheStatistics *statistics = nil;
+    dispatch_sync(self.cacheQueue, ^{
+        statistics = [self.index statistics];
+    });
+    return statistics;
+}
+
+- (NSCachedURLResponse *)compressedResponse:(NSCachedURLResponse *)cachedResponse
+                                  algorithm:(EMASCurlCacheCompressionAlgorithm)algorithm
+                                    request:(NSURLRequest *)request {
+    NSString *algorithmName = [EMASCurlCacheCompressor nameForAlgorithm:algorithm];
+    NSData *data = cachedResponse.data;
+    if (!algorithmName || data.length < kEMASCacheCompressionMinimumBytes) {
+        return cachedResponse;
+    }
+
+    NSData *compressed = [EMASCurlCacheCompressor compressData:data algorithm:algorithm];
+    // 节省不足1/8时，命中时的解压开销不划算
+    if (!compressed || compressed.length > data.length - data.length / 8) {
+        @synchronized (self.statistics) {
+            self.statistics.incompressibleEntryCount += 1;
+        }
+        return cachedResponse;
+    }
+
+    @synchronized (self.statistics) {
+        self.statistics.compressedEntryCount += 1;
+        self.statistics.originalBytes += data.length;
+        self.statistics.compressedBytes += compressed.length;
+    }
+    EMAS_LOG_DEBUG(@"EC-Cache", @"Compressed cached body %lu -> %lu bytes (%@) for URL: %@",
+                   (unsigned long)data.length, (unsigned long)compressed.length, algorithmName, request.URL.absoluteString);
+
+    NSMutableDictionary *userInfo = [cachedResponse.userInfo mutableCopy] ?: [NSMutableDictionary dictionary];
+    userInfo[EMASUserInfoKeyBodyCompression] = algorithmName;
+    userInfo[EMASUserInfoKeyBodyOriginalLength] = @(data.length);
+    return [[NSCachedURLResponse alloc] initWithResponse:cachedResponse.response
+                                                    data:compressed
+                                                userInfo:userInfo
+                                           storagePolicy:cachedResponse.storagePolicy];
+}
+
+- (nullable EMASCurlCacheBodyReader *)bodyReaderForCachedResponse:(NSCachedURLResponse *)cachedResponse {
+    NSData *storedBody = cachedResponse.data ?: [NSData data];
+    NSString *fileName = cachedResponse.userInfo[EMASUserInfoKeyBodyFile];
+    if (fileName) {
+        if (![self bodyFileIsIntactForCachedResponse:cachedResponse]) {
+            EMAS_LOG_INFO(@"EC-Cache", @"Cached body file missing or truncated for URL: %@", cachedResponse.response.URL.absoluteString);
+            return nil;
+        }
+        // 只读映射：由内核按需换页，不会把整个响应体读入内存
+        NSError *error = nil;
+        NSString *path = [self.bodyDirectory stringByAppendingPathComponent:fileName.lastPathComponent];
+        storedBody = [NSData dataWithContentsOfFile:path options:NSDataReadingMappedAlways error:&error];
+        // 以修改时间记录最近访问，清理时最久未命中的文件先被删除
+        utimes(path.fileSystemRepresentation, NULL);
+        if (!storedBody) {
+            EMAS_LOG_ERROR(@"EC-Cache", @"Failed to map cached body file: %@", error.localizedDescription);
+            return nil;
+        }
+    }
+
+    EMASCurlCacheBodyReader *reader = [EMASCurlCacheBodyReader new];
+    reader.storedBody = storedBody;
+    reader.expectedLength = NSNotFound;
+
+    EMASCurlCacheCompressionAlgorithm algorithm = [EMASCurlCacheCompressor algorithmForName:cachedResponse.userInfo[EMASUserInfoKeyBodyCompression]];
+    if (algorithm != EMASCurlCacheCompressionNone) {
+        reader.decoder = [[EMASCurlCacheDecoder alloc] initWithData:storedBody algorithm:algorithm chunkSize:kEMASCacheBodyChunkSize];
+        if (!reader.decoder) {
+            return nil;
+        }
+        NSNumber *originalLength = cachedResponse.userInfo[EMASUserInfoKeyBodyOriginalLength];
+        if ([originalLength isKindOfClass:[NSNumber class]]) {
+            reader.expectedLength = originalLength.unsignedIntegerValue;
+        }
+        __weak typeof(self) weakSelf = self;
+        reader.decodeCompletion = ^(NSTimeInterval decodeCPUTime) {
+            __strong typeof(weakSelf) strongSelf = weakSelf;
+            @synchronized (strongSelf.statistics) {
+                strongSelf.statistics.decodedEntryCount += 1;
+                strongSelf.statistics.decodeCPUTime += decodeCPUTime;
+            }
+        };
+    }
+    return reader;
+}
+
+- (BOOL)enumerateBodyOfCachedResponse:(NSCachedURLResponse *)cachedResponse
+                           usingBlock:(void (^)(NSData *chunk))block {
+    EMASCurlCacheBodyReader *reader = [self bodyReaderForCachedResponse:cachedResponse];
+    if (!reader) {
+        return NO;
+    }
+
+    NSData *chunk = nil;
+    while ((chunk = [reader nextChunk])) {
+        block(chunk);
+    }
+    if (!reader.finished) {
+        EMAS_LOG_ERROR(@"EC-Cache", @"Failed to decode cached body for URL: %@", cachedResponse.response.URL.absoluteString);
+        return NO;
+    }
+    return YES;
+}
+
+- (nullable NSData *)bodyOfCachedResponse:(NSCachedURLResponse *)cachedResponse {
+    if (!cachedResponse.userInfo[EMASUserInfoKeyBodyCompression] && !cachedResponse.userInfo[EMASUserInfoKeyBodyFile]) {
+        return cachedResponse.data;
+    }
+
+    NSNumber *originalLength = cachedResponse.userInfo[EMASUserInfoKeyBodyOriginalLength] ?: cachedResponse.userInfo[EMASUserInfoKeyBodyStoredLength];
+    NSMutableData *body = [NSMutableData dataWithCapacity:[originalLength isKindOfClass:[NSNumber class]] ? originalLength.unsignedIntegerValue : 0];
+    BOOL succeeded = [self enumerateBodyOfCachedResponse:cachedResponse usingBlock:^(NSData *chunk) {
+        [body appendData:chunk];
+    }];
+    return succeeded ? [body copy] : nil;
+}
+
+// 返回响应体已解压的副本，供需要按字节偏移访问数据的场景使用
+- (nullable NSCachedURLResponse *)decodedCachedResponse:(NSCachedURLResponse *)cachedResponse {
+    if (!cachedResponse.userInfo[EMASUserInfoKeyBodyCompression] && !cachedResponse.userInfo[EMASUserInfoKeyBodyFile]) {
+        return cachedResponse;
+    }
+    NSData *body = [self bodyOfCachedResponse:cachedResponse];
+    if (!body) {
+        return nil;
+    }
+    NSMutableDictionary *userInfo = [cachedResponse.userInfo mutableCopy];
+    [userInfo removeObjectForKey:EMASUserInfoKeyBodyCompression];
+    [userInfo removeObjectForKey:EMASUserInfoKeyBodyOriginalLength];
+    [userInfo removeObjectForKey:EMASUserInfoKeyBodyFile];
+    [userInfo removeObjectForKey:EMASUserInfoKeyBodyStoredLength];
+    return [[NSCachedURLResponse alloc] initWithResponse:cachedResponse.response
+                                                    data:body
+                                                userInfo:userInfo
+                                           storagePolicy:cachedResponse.storagePolicy];
+}
+
+- (void)removeCachedResponseForRequest:(NSURLRequest *)request {
+    if (!request) {
+        return;
+    }
+    dispatch_sync(self.cacheQueue, ^{
+        [self removeStoredResponseForRequest:request];
+    });
+}
+
+- (void)removeAllCachedResponses {
+    dispatch_sync(self.cacheQueue, ^{
+        [self.urlCache removeAllCachedResponses];
+        [self.index removeAllKeys];
+        [self scheduleIndexPersist];
+        NSFileManager *fileManager = [NSFileManager defaultManager];
+        [fileManager removeItemAtPath:self.bodyDirectory error:nil];
+        [fileManager createDirectoryAtPath:self.bodyDirectory withIntermediateDirectories:YES attributes:nil error:nil];
+    });
+}
+
+- (EMASCurlCacheCompressionStatistics *)compressionStatistics {
+    EMASCurlCacheCompressionStatistics *snapshot = [EMASCurlCacheCompressionStatistics new];
+    @synchronized (self.statistics) {
+        snapshot.compressedEntryCount = self.statistics.compressedEntryCount;
+        snapshot.incompressibleEntryCount = self.statistics.incompressibleEntryCount;
+        snapshot.originalBytes = self.statistics.originalBytes;
+        snapshot.compressedBytes = self.statistics.compressedBytes;
+        snapshot.decodedEntryCount = self.statistics.decodedEntryCount;
+        snapshot.decodeCPUTime = self.statistics.decodeCPUTime;
+    }
+    return snapshot;
+}
+
 - (nullable NSCachedURLResponse *)cachedResponseForRequest:(NSURLRequest *)request {
     if (!request) {
         return nil;
@@ -97,7 +745,13 @@ static NSData *EMASCacheImmutableData(NSData *data) {
 
     __block NSCachedURLResponse *result = nil;
     dispatch_sync(self.cacheQueue, ^{
-        NSCachedURLResponse *cachedResponse = [self.urlCache cachedResponseForRequest:request];
+        NSCachedURLResponse *cachedResponse = [self storedCompleteResponseForRequest:request];
+
+        if (!cachedResponse) {
+            // 被NSURLCache自身淘汰的条目遗留的索引记录与响应体文件由trimBodyDirectory清理，不在查询路径上处理
+            // 下层：只读的预置缓存包，之后的新鲜度与校验逻辑与上层相同
+            cachedResponse = [self seedResponseForRequest:request];
+        }
 
         if (!cachedResponse) {
             EMAS_LOG_DEBUG(@"EC-Cache", @"No cached response found for URL: %@", request.URL.absoluteString);
@@ -106,7 +760,14 @@ static NSData *EMASCacheImmutableData(NSData *data) {
 
         // 检查是否是 NSHTTPURLResponse，我们的类别方法依赖这个
         if (![cachedResponse.response isKindOfClass:[NSHTTPURLResponse class]]) {
-            [self.urlCache removeCachedResponseForRequest:request];
+            [self removeStoredResponseForRequest:request];
+            return;
+        }
+
+        // 响应体文件丢失或不完整，条目已不可用
+        if (![self bodyFileIsIntactForCachedResponse:cachedResponse]) {
+            EMAS_LOG_INFO(@"EC-Cache", @"Cached body file missing for URL: %@", request.URL.absoluteString);
+            [self removeStoredResponseForRequest:request];
             return;
         }
 
@@ -135,7 +796,7 @@ static NSData *EMASCacheImmutableData(NSData *data) {
         }
 
         // 陈旧/需要验证，但没有验证器，则此缓存无用
-        [self.urlCache removeCachedResponseForRequest:request];
+        [self removeStoredResponseForRequest:request];
     });
 
     return result;
@@ -149,7 +810,8 @@ static NSData *EMASCacheImmutableData(NSData *data) {
 
     __block NSCachedURLResponse *result = nil;
     dispatch_sync(self.cacheQueue, ^{
-        NSCachedURLResponse *oldCachedResponse = [self.urlCache cachedResponseForRequest:request];
+        // 预置缓存包的条目校验通过后写入上层缓存
+        NSCachedURLResponse *oldCachedResponse = [self storedCompleteResponseForRequest:request] ?: [self seedResponseForRequest:request];
 
         if (!oldCachedResponse) {
             return;
@@ -157,7 +819,7 @@ static NSData *EMASCacheImmutableData(NSData *data) {
 
         if (![oldCachedResponse.response isKindOfClass:[NSHTTPURLResponse class]]) {
             EMAS_LOG_INFO(@"EC-Cache", @"Invalid cached response type during 304 update for URL: %@", request.URL.absoluteString);
-            [self.urlCache removeCachedResponseForRequest:request];
+            [self removeStoredResponseForRequest:request];
             return;
         }
 
@@ -171,18 +833,210 @@ static NSData *EMASCacheImmutableData(NSData *data) {
             updatedCachedResponse = [self sanitizedResponseForStorage:updatedCachedResponse
                                                                stage:@"updateCachedResponse.beforeStore"
                                                              request:request];
-            [self.urlCache storeCachedResponse:updatedCachedResponse forRequest:request];
+            [self storeCompleteResponse:updatedCachedResponse forRequest:request];
             result = updatedCachedResponse;
         } else {
             // 理论上不应该发生，除非emas_updatedResponseWithHeadersFrom304Response实现问题
             // 保险起见，移除旧的，因为它可能已损坏或无法正确更新
-            [self.urlCache removeCachedResponseForRequest:request];
+            [self removeStoredResponseForRequest:request];
         }
     });
 
     return result;
 }
 
+- (BOOL)addSeedPackAtPath:(NSString *)path {
+    // 打开只做映射与文件头校验，不占用串行队列
+    EMASCurlCacheSeedPack *pack = [EMASCurlCacheSeedPack packWithContentsOfFile:path];
+    if (!pack) {
+        return NO;
+    }
+
+    dispatch_sync(self.cacheQueue, ^{
+        NSMutableArray<EMASCurlCacheSeedPack *> *seedPacks = [NSMutableArray arrayWithObject:pack];
+        for (EMASCurlCacheSeedPack *existing in self.seedPacks) {
+            if (![existing.path isEqualToString:pack.path]) {
+                [seedPacks addObject:existing];
+            }
+        }
+        self.seedPacks = seedPacks;
+    });
+    return YES;
+}
+
+// 在cacheQueue中调用
+- (nullable NSCachedURLResponse *)seedResponseForRequest:(NSURLRequest *)request {
+    for (EMASCurlCacheSeedPack *pack in self.seedPacks) {
+        NSCachedURLResponse *cachedResponse = [pack cachedResponseForRequest:request];
+        if (cachedResponse) {
+            EMAS_LOG_DEBUG(@"EC-Cache", @"Found seed pack entry for URL: %@", request.URL.absoluteString);
+            return cachedResponse;
+        }
+    }
+    return nil;
+}
+
+- (nullable EMASCurlSparseCacheEntry *)sparseEntryForRequest:(NSURLRequest *)request {
+    NSURLRequest *storageRequest = request ? EMASSparseStorageRequest(request) : nil;
+    if (!storageRequest) {
+        return nil;
+    }
+
+    __block EMASCurlSparseCacheEntry *result = nil;
+    dispatch_sync(self.cacheQueue, ^{
+        BOOL isSparseRecord = NO;
+        EMASCurlSparseCacheEntry *entry = nil;
+        NSCachedURLResponse *sparseResponse = [self.urlCache cachedResponseForRequest:storageRequest];
+        if (sparseResponse) {
+            entry = [EMASCurlSparseCacheEntry entryWithCachedResponse:sparseResponse];
+            if (!entry) {
+                EMAS_LOG_INFO(@"EC-Cache", @"Dropping malformed sparse cache entry for URL: %@", request.URL.absoluteString);
+                [self removeStoredResponseForRequest:storageRequest];
+            } else {
+                isSparseRecord = YES;
+            }
+        }
+        if (!entry) {
+            NSCachedURLResponse *completeResponse = [self storedCompleteResponseForRequest:request];
+            // 压缩存储的完整响应需先解压，区间偏移针对的是原始字节
+            completeResponse = completeResponse ? [self decodedCachedResponse:completeResponse] : nil;
+            if (completeResponse) {
+                entry = [EMASCurlSparseCacheEntry entryWithCompleteCachedResponse:completeResponse];
+            }
+        }
+        if (!entry) {
+            return;
+        }
+
+        if (![entry.cachedResponse emas_matchesVaryHeadersForRequest:request]) {
+            EMAS_LOG_DEBUG(@"EC-Cache", @"Vary header mismatch for sparse entry, URL: %@", request.URL.absoluteString);
+            return;
+        }
+
+        BOOL isFresh = [entry.cachedResponse emas_isResponseStillFreshForRequest:request];
+        BOOL requiresRevalidation = [entry.cachedResponse emas_requiresRevalidation];
+        if ((isFresh && !requiresRevalidation) || [entry ifRangeValidator]) {
+            result = entry;
+            return;
+        }
+
+        // 陈旧且无法用If-Range校验的稀疏条目已无用；完整响应仍可能用于条件GET，保留给cachedResponseForRequest处理
+        if (isSparseRecord) {
+            [self removeStoredResponseForRequest:storageRequest];
+        }
+    });
+
+    return result;
+}
+
+- (void)storePartialResponse:(NSHTTPURLResponse *)response
+                        data:(NSData *)data
+                  forRequest:(NSURLRequest *)request
+             withHTTPVersion:(NSString *)httpVersion
+                    maxBytes:(NSUInteger)maxBytes {
+    [self storePartialResponse:response
+                          data:data
+                    forRequest:request
+               withHTTPVersion:httpVersion
+                      maxBytes:maxBytes
+                   quotaPolicy:nil];
+}
+
+- (void)storePartialResponse:(NSHTTPURLResponse *)response
+                        data:(NSData *)data
+                  forRequest:(NSURLRequest *)request
+             withHTTPVersion:(NSString *)httpVersion
+                    maxBytes:(NSUInteger)maxBytes
+                 quotaPolicy:(nullable EMASCurlCacheQuotaPolicy *)quotaPolicy {
+    if (!request || !response || !data) {
+        EMAS_LOG_ERROR(@"EC-Cache", @"Failed to store partial response: nil request, response, or data");
+        return;
+    }
+
+    NSRange contentRange = NSMakeRange(NSNotFound, 0);
+    unsigned long long totalLength = 0;
+    if (response.statusCode != 206 ||
+        !EMASParseContentRange(response.allHeaderFields[EMASHTTPHeaderContentRange], &contentRange, &totalLength) ||
+        contentRange.length != data.length) {
+        EMAS_LOG_DEBUG(@"EC-Cache", @"Partial response not mergeable for URL: %@", request.URL.absoluteString);
+        return;
+    }
+
+    // libcurl交付的是解码后的数据，编码后的区间偏移与解码数据对不上
+    NSString *contentEncoding = response.allHeaderFields[EMASHTTPHeaderContentEncoding];
+    if (contentEncoding.length > 0 && [contentEncoding caseInsensitiveCompare:@"identity"] != NSOrderedSame) {
+        return;
+    }
+
+    NSURLRequest *storageRequest = EMASSparseStorageRequest(request);
+    if (!storageRequest) {
+        return;
+    }
+
+    dispatch_sync(self.cacheQueue, ^{
+        NSCachedURLResponse *metadataResponse = [NSCachedURLResponse emas_cachedResponseWithHTTPURLResponse:response
+                                                                                                       data:[NSData data]
+                                                                                                 requestURL:request.URL
+                                                                                                httpVersion:httpVersion
+                                                                                            originalRequest:request];
+        if (!metadataResponse) {
+            // 新响应不可缓存（如no-store），旧的区间也不应再被使用
+            [self removeStoredResponseForRequest:storageRequest];
+            return;
+        }
+
+        EMASCurlSparseCacheEntry *merged = [[EMASCurlSparseCacheEntry alloc] initWithCachedResponse:metadataResponse
+                                                                                        totalLength:totalLength];
+        NSCachedURLResponse *existingResponse = [self.urlCache cachedResponseForRequest:storageRequest];
+        EMASCurlSparseCacheEntry *existing = existingResponse ? [EMASCurlSparseCacheEntry entryWithCachedResponse:existingResponse] : nil;
+        NSString *existingValidator = [existing ifRangeValidator];
+        if (existing && existing.totalLength == totalLength &&
+            existingValidator && [existingValidator isEqualToString:[merged ifRangeValidator]]) {
+            for (NSValue *rangeValue in existing.cachedRanges) {
+                NSRange range = rangeValue.rangeValue;
+                [merged mergeData:[existing dataForRange:range] atOffset:range.location];
+            }
+        } else if (existing) {
+            EMAS_LOG_DEBUG(@"EC-Cache", @"Replacing sparse entry with mismatched validator for URL: %@", request.URL.absoluteString);
+        }
+        [merged mergeData:data atOffset:contentRange.location];
+
+        if (merged.cachedByteCount > maxBytes) {
+            EMAS_LOG_DEBUG(@"EC-Cache", @"Sparse entry exceeds %lu bytes, skip storing for URL: %@",
+                           (unsigned long)maxBytes, request.URL.absoluteString);
+            return;
+        }
+
+        NSMutableDictionary *userInfo = [metadataResponse.userInfo mutableCopy] ?: [NSMutableDictionary dictionary];
+        userInfo[EMASUserInfoKeySparseRanges] = [merged rangeListForStorage];
+        userInfo[EMASUserInfoKeySparseTotalLength] = @(totalLength);
+        NSCachedURLResponse *sparseResponse = [[NSCachedURLResponse alloc] initWithResponse:metadataResponse.response
+                                                                                      data:[merged packedData]
+                                                                                  userInfo:userInfo
+                                                                             storagePolicy:NSURLCacheStorageAllowed];
+        sparseResponse = [self sanitizedResponseForStorage:sparseResponse
+                                                     stage:@"storePartialResponse.beforeStore"
+                                                   request:request];
+        EMAS_LOG_DEBUG(@"EC-Cache", @"Storing sparse entry (%lu/%llu bytes, %lu ranges) for URL: %@",
+                       (unsigned long)merged.cachedByteCount, totalLength,
+                       (unsigned long)merged.cachedRanges.count, request.URL.absoluteString);
+        [self.urlCache storeCachedResponse:sparseResponse forRequest:storageRequest];
+        [self recordStoreForRequest:storageRequest
+                              bytes:sparseResponse.data.length
+                        quotaPolicy:quotaPolicy];
+    });
+}
+
+- (void)removeSparseEntryForRequest:(NSURLRequest *)request {
+    NSURLRequest *storageRequest = request ? EMASSparseStorageRequest(request) : nil;
+    if (!storageRequest) {
+        return;
+    }
+    dispatch_sync(self.cacheQueue, ^{
+        [self removeStoredResponseForRequest:storageRequest];
+    });
+}
+
 - (NSCachedURLResponse *)sanitizedResponseForStorage:(NSCachedURLResponse *)cachedResponse
                                                stage:(NSString *)stage
                                              request:(NSURLRequest *)request {
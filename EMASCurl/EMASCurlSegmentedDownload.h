@@ -0,0 +1,79 @@
+//
+//  EMASCurlSegmentedDownload.h
+//  EMASCurl
+//
+//  Created by xuyecan on 2026/10/18.
+//
+
+#import <Foundation/Foundation.h>
+#import <curl/curl.h>
+#import "EMASCurlFileDownloadSink.h"
+#import "EMASCurlConfiguration.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+// writePrimaryBytes:length:的返回值，非负值表示接收的字节数
+typedef NS_ENUM(NSInteger, EMASCurlSegmentWriteStatus) {
+    EMASCurlSegmentWriteWouldBlock = EMASCurlFileSinkAppendWouldBlock,  // 写盘积压，调用方应暂停传输
+    EMASCurlSegmentWriteFailed = EMASCurlFileSinkAppendFailed,          // 写文件出错或下载已中止
+    EMASCurlSegmentWriteRangeComplete = -3                              // 本段已写满，调用方应中止该传输
+};
+
+/**
+ * 分段并发下载：首个请求（primary）的200响应作为探测，确认支持范围请求后，
+ * 把剩余部分拆成若干段，由复制自primary的easy句柄带Range与If-Range并发获取，按偏移写入同一个文件。
+ * primary从0开始继续接收，写到自己的段尾即中止。某段先完成时，从剩余最多的段拆出后半段继续下载（工作窃取）。
+ * 任一段收到非206响应时退回单连接下载；单连接重新获取的响应长度或校验值与原响应不同时，以NSURLErrorBadServerResponse失败。除构造外，所有方法只应在网络线程调用。
+ */
+@interface EMASCurlSegmentedDownload : NSObject
+
+/**
+ * @param primaryHandle 正在接收响应体的primary句柄，用于复制各段句柄的选项
+ * @param headerFields primary的请求头，各段在其基础上添加If-Range，Range与If-Range头会被跳过
+ * @param validator 强ETag或Last-Modified，作为If-Range的值
+ * @param segmentCount 期望的并发段数（含primary），每段不小于1MiB
+ * @return 长度不足以拆成两段或复制句柄失败时返回nil
+ */
+- (nullable instancetype)initWithPrimaryHandle:(CURL *)primaryHandle
+                                  effectiveURL:(NSString *)effectiveURL
+                                  headerFields:(const struct curl_slist * _Nullable)headerFields
+                                     validator:(NSString *)validator
+                                   totalLength:(int64_t)totalLength
+                                  segmentCount:(NSUInteger)segmentCount
+                                          sink:(EMASCurlFileDownloadSink *)sink NS_DESIGNATED_INITIALIZER;
+
+- (instancetype)init NS_UNAVAILABLE;
+
+// 每写入一段数据调用一次，参数为本次字节数与累计字节数（不超过总长度），在网络线程执行
+@property (nonatomic, copy, nullable) void (^bytesReceivedHandler)(int64_t bytes, int64_t totalBytes);
+
+// 所有段结束后调用一次，在网络线程执行；succeeded为YES时文件内容已全部排入写队列
+@property (nonatomic, copy, nullable) void (^completionHandler)(BOOL succeeded, NSError * _Nullable error);
+
+// 各段句柄的带宽优先级，与primary一致
+@property (nonatomic, assign) EMASCurlRequestPriority priority;
+
+// 实际拆分的段数
+@property (nonatomic, assign, readonly) NSUInteger segmentCount;
+
+// 已失败或取消，primary句柄应尽快中止
+@property (nonatomic, assign, readonly) BOOL aborted;
+
+// primary已写到自己的段尾并被主动中止，其CURLE_WRITE_ERROR不代表下载失败
+@property (nonatomic, assign, readonly) BOOL primaryRangeComplete;
+
+// 启动其余各段；可在libcurl回调中调用，句柄的入队推迟到回调之外
+- (void)start;
+
+// primary句柄的响应体数据，返回接收的字节数或EMASCurlSegmentWriteStatus
+- (NSInteger)writePrimaryBytes:(const char *)bytes length:(size_t)length;
+
+// primary句柄结束，可在任意线程调用
+- (void)primaryDidFinishWithSuccess:(BOOL)succeeded error:(nullable NSError *)error;
+
+// 中止所有段，结束后以取消错误回调completionHandler
+- (void)cancel;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,538 @@
+//
+//  EMASCurlSegmentedDownload.m
+//  EMASCurl
+//
+//  Created by xuyecan on 2026/10/18.
+//
+
+#import "EMASCurlSegmentedDownload.h"
+#import "EMASCurlManager.h"
+#import "EMASCurlSparseCacheEntry.h"
+#import "EMASCurlLogger.h"
+
+// 单段至少的字节数，也是工作窃取时拆出的最小区间
+static const int64_t kEMASSegmentMinimumBytes = 1024 * 1024;
+
+// 并发段数上限
+static const NSUInteger kEMASSegmentMaxCount = 16;
+
+// 每段的写缓冲，攒满后交给文件写队列
+static const NSUInteger kEMASSegmentChunkBytes = 1024 * 1024;
+
+// 一次下载中失败段的重试总次数
+static const NSUInteger kEMASSegmentMaxRetries = 3;
+
+@class EMASCurlSegmentedDownload;
+
+@interface EMASCurlDownloadSegment : NSObject
+
+@property (nonatomic, weak) EMASCurlSegmentedDownload *download;
+// primary的句柄由EMASCurlProtocol持有，这里只用于恢复暂停
+@property (nonatomic, assign) CURL *easy;
+@property (nonatomic, assign) struct curl_slist *headerFields;
+@property (nonatomic, assign) BOOL primary;
+// NO表示不带Range的完整GET（primary或退回单连接后的请求）
+@property (nonatomic, assign) BOOL rangeRequest;
+@property (nonatomic, assign) int64_t start;
+// 下一个待接收字节的偏移
+@property (nonatomic, assign) int64_t offset;
+// 段尾（不含），被窃取时缩短
+@property (nonatomic, assign) int64_t end;
+// 请求中的段尾（不含）
+@property (nonatomic, assign) int64_t requestedEnd;
+@property (nonatomic, strong) NSMutableData *chunk;
+@property (nonatomic, assign) int64_t chunkOffset;
+@property (nonatomic, assign) BOOL validated;
+// 已写到段尾，传输被主动中止也算完成
+@property (nonatomic, assign) BOOL rangeComplete;
+// 已被放弃，传输结束后不再处理
+@property (nonatomic, assign) BOOL abandoned;
+
+@end
+
+@implementation EMASCurlDownloadSegment
+@end
+
+@interface EMASCurlSegmentedDownload ()
+
+// 复制自primary的选项模板，各段句柄由它再复制
+@property (nonatomic, assign) CURL *templateHandle;
+@property (nonatomic, copy) NSString *effectiveURL;
+@property (nonatomic, copy) NSArray<NSString *> *headerLines;
+@property (nonatomic, copy) NSString *validator;
+@property (nonatomic, assign) int64_t totalLength;
+@property (nonatomic, assign) int64_t segmentLength;
+@property (nonatomic, assign, readwrite) NSUInteger segmentCount;
+@property (nonatomic, strong) EMASCurlFileDownloadSink *sink;
+
+@property (nonatomic, strong) EMASCurlDownloadSegment *primarySegment;
+@property (nonatomic, strong) NSMutableArray<EMASCurlDownloadSegment *> *activeSegments;
+@property (nonatomic, strong) NSMutableArray<EMASCurlDownloadSegment *> *pausedSegments;
+// 已安排但尚未执行的入队
+@property (nonatomic, assign) NSUInteger pendingLaunchCount;
+@property (nonatomic, assign) NSUInteger retriesLeft;
+@property (nonatomic, assign) int64_t bytesReceived;
+@property (nonatomic, assign) BOOL primaryFinished;
+// 紧随primary的一段已确认可用，primary可以收缩到自己的段尾
+@property (nonatomic, assign) BOOL primaryRangeConfirmed;
+@property (nonatomic, assign) BOOL singleStream;
+@property (nonatomic, assign) BOOL cancelled;
+@property (nonatomic, assign) BOOL completed;
+@property (nonatomic, strong) NSError *error;
+
+- (NSInteger)writeBytes:(const char *)bytes length:(size_t)length forSegment:(EMASCurlDownloadSegment *)segment;
+
+@end
+
+static size_t segment_write_cb(char *contents, size_t size, size_t nmemb, void *userp);
+static int segment_progress_cb(void *clientp, curl_off_t dltotal, curl_off_t dlnow, curl_off_t ultotal, curl_off_t ulnow);
+
+@implementation EMASCurlSegmentedDownload
+
+- (instancetype)initWithPrimaryHandle:(CURL *)primaryHandle
+                         effectiveURL:(NSString *)effectiveURL
+                         headerFields:(const struct curl_slist *)headerFields
+                            validator:(NSString *)validator
+                          totalLength:(int64_t)totalLength
+                         segmentCount:(NSUInteger)segmentCount
+                                 sink:(EMASCurlFileDownloadSink *)sink {
+    int64_t count = (int64_t)MIN(MAX(segmentCount, (NSUInteger)1), kEMASSegmentMaxCount);
+    int64_t segmentLength = MAX((totalLength + count - 1) / count, kEMASSegmentMinimumBytes);
+    NSUInteger actualCount = totalLength > 0 ? (NSUInteger)((totalLength + segmentLength - 1) / segmentLength) : 0;
+    if (actualCount < 2) {
+        return nil;
+    }
+
+    self = [super init];
+    if (self) {
+        _templateHandle = curl_easy_duphandle(primaryHandle);
+        if (!_templateHandle) {
+            EMAS_LOG_ERROR(@"EC-Download", @"Failed to duplicate easy handle for segmented download");
+            return nil;
+        }
+        _effectiveURL = [effectiveURL copy];
+        _validator = [validator copy];
+        _totalLength = totalLength;
+        _segmentLength = segmentLength;
+        _segmentCount = actualCount;
+        _sink = sink;
+        _retriesLeft = kEMASSegmentMaxRetries;
+        _activeSegments = [NSMutableArray array];
+        _pausedSegments = [NSMutableArray array];
+
+        // 范围相关的头由各段自行设置
+        NSMutableArray<NSString *> *headerLines = [NSMutableArray array];
+        for (const struct curl_slist *item = headerFields; item; item = item->next) {
+            NSString *line = @(item->data);
+            if ([line.lowercaseString hasPrefix:@"range:"] || [line.lowercaseString hasPrefix:@"if-range:"]) {
+                continue;
+            }
+            [headerLines addObject:line];
+        }
+        _headerLines = headerLines;
+
+        // primary在第一段确认可用前保持完整长度，确认后收缩到自己的段尾
+        _primarySegment = [[EMASCurlDownloadSegment alloc] init];
+        _primarySegment.download = self;
+        _primarySegment.primary = YES;
+        _primarySegment.easy = primaryHandle;
+        _primarySegment.end = totalLength;
+        _primarySegment.requestedEnd = totalLength;
+        _primarySegment.validated = YES;
+        [_activeSegments addObject:_primarySegment];
+
+        __weak typeof(self) weakSelf = self;
+        sink.drainedHandler = ^{
+            [[EMASCurlManager sharedInstance] performBlockOnNetworkThread:^{
+                [weakSelf resumePausedSegments];
+            }];
+        };
+    }
+    return self;
+}
+
+- (void)dealloc {
+    if (_templateHandle) {
+        curl_easy_cleanup(_templateHandle);
+    }
+}
+
+- (BOOL)aborted {
+    return self.cancelled || self.error != nil;
+}
+
+- (BOOL)primaryRangeComplete {
+    return self.primarySegment.rangeComplete;
+}
+
+- (void)start {
+    EMAS_LOG_INFO(@"EC-Download", @"Segmented download of %lld bytes in %lu segments", self.totalLength, (unsigned long)self.segmentCount);
+    [self performOutsideCallback:^{
+        if (self.aborted || self.singleStream || self.primaryFinished) {
+            return;
+        }
+        for (NSUInteger i = 1; i < self.segmentCount; i++) {
+            int64_t start = (int64_t)i * self.segmentLength;
+            [self launchSegmentFrom:start to:MIN(start + self.segmentLength, self.totalLength) rangeRequest:YES];
+        }
+    }];
+}
+
+- (void)cancel {
+    self.cancelled = YES;
+    // 各段在进度回调中中止，结束后统一回调
+    [self finishIfDone];
+}
+
+#pragma mark - 句柄调度
+
+// libcurl回调运行在Manager持锁的multi_perform中，入队新句柄或恢复暂停都要推迟到回调之外
+- (void)performOutsideCallback:(dispatch_block_t)block {
+    self.pendingLaunchCount++;
+    dispatch_async(dispatch_get_global_queue(QOS_CLASS_USER_INITIATED, 0), ^{
+        [[EMASCurlManager sharedInstance] performBlockOnNetworkThread:^{
+            self.pendingLaunchCount--;
+            block();
+            [self finishIfDone];
+        }];
+    });
+}
+
+- (void)launchSegmentFrom:(int64_t)start to:(int64_t)end rangeRequest:(BOOL)rangeRequest {
+    CURL *easy = curl_easy_duphandle(self.templateHandle);
+    if (!easy) {
+        EMAS_LOG_ERROR(@"EC-Download", @"Failed to duplicate easy handle for segment %lld-%lld", start, end - 1);
+        [self abortWithError:[NSError errorWithDomain:NSURLErrorDomain code:NSURLErrorUnknown userInfo:nil]];
+        return;
+    }
+
+    EMASCurlDownloadSegment *segment = [[EMASCurlDownloadSegment alloc] init];
+    segment.download = self;
+    segment.easy = easy;
+    segment.rangeRequest = rangeRequest;
+    segment.start = start;
+    segment.offset = start;
+    segment.end = end;
+    segment.requestedEnd = end;
+
+    struct curl_slist *headerFields = NULL;
+    for (NSString *line in self.headerLines) {
+        headerFields = curl_slist_append(headerFields, line.UTF8String);
+    }
+    if (rangeRequest) {
+        // 资源已变化时服务端返回200而非206，据此退回单连接
+        NSString *ifRange = [NSString stringWithFormat:@"If-Range: %@", self.validator];
+        headerFields = curl_slist_append(headerFields, ifRange.UTF8String);
+        NSString *range = [NSString stringWithFormat:@"%lld-%lld", start, end - 1];
+        curl_easy_setopt(easy, CURLOPT_RANGE, range.UTF8String);
+    }
+    segment.headerFields = headerFields;
+
+    curl_easy_setopt(easy, CURLOPT_URL, self.effectiveURL.UTF8String);
+    curl_easy_setopt(easy, CURLOPT_HTTPGET, 1L);
+    curl_easy_setopt(easy, CURLOPT_HTTPHEADER, headerFields);
+    // 各段按原始字节拼接，不协商压缩
+    curl_easy_setopt(easy, CURLOPT_ACCEPT_ENCODING, NULL);
+    curl_easy_setopt(easy, CURLOPT_FOLLOWLOCATION, 0L);
+    curl_easy_setopt(easy, CURLOPT_HEADERFUNCTION, NULL);
+    curl_easy_setopt(easy, CURLOPT_HEADERDATA, NULL);
+    curl_easy_setopt(easy, CURLOPT_WRITEFUNCTION, segment_write_cb);
+    curl_easy_setopt(easy, CURLOPT_WRITEDATA, (__bridge void *)segment);
+    curl_easy_setopt(easy, CURLOPT_NOPROGRESS, 0L);
+    curl_easy_setopt(easy, CURLOPT_XFERINFOFUNCTION, segment_progress_cb);
+    curl_easy_setopt(easy, CURLOPT_XFERINFODATA, (__bridge void *)segment);
+
+    [self.activeSegments addObject:segment];
+    EMAS_LOG_DEBUG(@"EC-Download", @"Launching segment %lld-%lld", start, end - 1);
+
+    EMASCurlManager *manager = [EMASCurlManager sharedInstance];
+    [manager enqueueNewEasyHandle:easy priority:self.priority completion:^(BOOL succeeded, NSError *error, EMASCurlMetricsData *metrics) {
+        [manager performBlockOnNetworkThread:^{
+            [self segment:segment didFinishWithSuccess:succeeded error:error];
+        }];
+    }];
+}
+
+- (void)resumePausedSegments {
+    NSArray<EMASCurlDownloadSegment *> *pausedSegments = [self.pausedSegments copy];
+    [self.pausedSegments removeAllObjects];
+    for (EMASCurlDownloadSegment *segment in pausedSegments) {
+        // Manager会忽略已结束的句柄
+        [[EMASCurlManager sharedInstance] resumeEasyHandle:segment.easy];
+    }
+}
+
+#pragma mark - 数据写入
+
+- (NSInteger)writePrimaryBytes:(const char *)bytes length:(size_t)length {
+    return [self writeBytes:bytes length:length forSegment:self.primarySegment];
+}
+
+- (NSInteger)writeBytes:(const char *)bytes length:(size_t)length forSegment:(EMASCurlDownloadSegment *)segment {
+    if (self.aborted || segment.abandoned) {
+        return EMASCurlSegmentWriteFailed;
+    }
+    if (!segment.validated && ![self validateSegment:segment]) {
+        return EMASCurlSegmentWriteFailed;
+    }
+    if (segment.offset >= segment.end) {
+        [self completeRangeOfSegment:segment];
+        return EMASCurlSegmentWriteRangeComplete;
+    }
+
+    NSInteger status = [self.sink checkWritable];
+    if (status == EMASCurlFileSinkAppendWouldBlock) {
+        if (![self.pausedSegments containsObject:segment]) {
+            [self.pausedSegments addObject:segment];
+        }
+        return EMASCurlSegmentWriteWouldBlock;
+    }
+    if (status < 0) {
+        return EMASCurlSegmentWriteFailed;
+    }
+
+    int64_t accepted = MIN((int64_t)length, segment.end - segment.offset);
+    if (!segment.chunk) {
+        segment.chunk = [NSMutableData dataWithCapacity:kEMASSegmentChunkBytes];
+        segment.chunkOffset = segment.offset;
+    }
+    [segment.chunk appendBytes:bytes length:(NSUInteger)accepted];
+    segment.offset += accepted;
+    if (segment.chunk.length >= kEMASSegmentChunkBytes) {
+        [self flushSegment:segment];
+    }
+
+    self.bytesReceived += accepted;
+    if (self.bytesReceivedHandler) {
+        self.bytesReceivedHandler(accepted, MIN(self.bytesReceived, self.totalLength));
+    }
+
+    if (segment.offset >= segment.end) {
+        [self completeRangeOfSegment:segment];
+        // 段尾被窃取或primary收缩时主动中止，否则让响应自然结束
+        if (segment.end < segment.requestedEnd || accepted < (int64_t)length) {
+            return EMASCurlSegmentWriteRangeComplete;
+        }
+    }
+    return (NSInteger)accepted;
+}
+
+// 首个数据块到达时校验响应确实是请求的区间
+- (BOOL)validateSegment:(EMASCurlDownloadSegment *)segment {
+    long statusCode = 0;
+    curl_easy_getinfo(segment.easy, CURLINFO_RESPONSE_CODE, &statusCode);
+
+    BOOL valid = NO;
+    if (segment.rangeRequest) {
+        struct curl_header *header = NULL;
+        NSRange range = NSMakeRange(NSNotFound, 0);
+        unsigned long long totalLength = 0;
+        valid = statusCode == 206 &&
+                curl_easy_header(segment.easy, "Content-Range", 0, CURLH_HEADER, -1, &header) == CURLHE_OK &&
+                EMASParseContentRange(@(header->value), &range, &totalLength) &&
+                (int64_t)range.location == segment.start && (int64_t)totalLength == self.totalLength;
+    } else {
+        // 退回单连接时资源可能已变化，响应头已按原资源交付，只接受同一版本的完整响应
+        curl_off_t contentLength = -1;
+        curl_easy_getinfo(segment.easy, CURLINFO_CONTENT_LENGTH_DOWNLOAD_T, &contentLength);
+        valid = statusCode == 200 &&
+                (int64_t)contentLength == self.totalLength &&
+                [[self validatorOfSegment:segment] isEqualToString:self.validator];
+    }
+
+    if (!valid) {
+        EMAS_LOG_INFO(@"EC-Download", @"Segment %lld-%lld got HTTP %ld, range requests unusable", segment.start, segment.requestedEnd - 1, statusCode);
+        if (self.singleStream) {
+            // 完整GET取到的是另一个版本，拼接或截断都会得到错误的文件
+            [self abortWithError:[NSError errorWithDomain:NSURLErrorDomain code:NSURLErrorBadServerResponse userInfo:nil]];
+        } else {
+            [self fallBackToSingleStream];
+        }
+        return NO;
+    }
+
+    segment.validated = YES;
+    if (segment.rangeRequest && segment.start == self.segmentLength && !self.primaryRangeConfirmed) {
+        self.primaryRangeConfirmed = YES;
+        EMASCurlDownloadSegment *primary = self.primarySegment;
+        primary.end = MAX(primary.offset, self.segmentLength);
+    }
+    return YES;
+}
+
+// 与primary相同的取法：强ETag优先，其次Last-Modified
+- (NSString *)validatorOfSegment:(EMASCurlDownloadSegment *)segment {
+    struct curl_header *header = NULL;
+    if (curl_easy_header(segment.easy, "ETag", 0, CURLH_HEADER, -1, &header) == CURLHE_OK) {
+        NSString *etag = @(header->value);
+        if (etag.length > 0 && ![etag hasPrefix:@"W/"]) {
+            return etag;
+        }
+    }
+    if (curl_easy_header(segment.easy, "Last-Modified", 0, CURLH_HEADER, -1, &header) == CURLHE_OK) {
+        return @(header->value);
+    }
+    return nil;
+}
+
+- (void)flushSegment:(EMASCurlDownloadSegment *)segment {
+    if (segment.chunk.length > 0) {
+        [self.sink writeData:segment.chunk atOffset:segment.chunkOffset];
+    }
+    segment.chunk = nil;
+}
+
+- (void)completeRangeOfSegment:(EMASCurlDownloadSegment *)segment {
+    [self flushSegment:segment];
+    segment.rangeComplete = YES;
+}
+
+#pragma mark - 段结束
+
+- (void)primaryDidFinishWithSuccess:(BOOL)succeeded error:(NSError *)error {
+    [[EMASCurlManager sharedInstance] performBlockOnNetworkThread:^{
+        self.primaryFinished = YES;
+        [self segment:self.primarySegment didFinishWithSuccess:succeeded error:error];
+    }];
+}
+
+- (void)segment:(EMASCurlDownloadSegment *)segment didFinishWithSuccess:(BOOL)succeeded error:(NSError *)error {
+    [self.activeSegments removeObject:segment];
+    [self.pausedSegments removeObject:segment];
+    if (segment.headerFields) {
+        curl_slist_free_all(segment.headerFields);
+        segment.headerFields = NULL;
+    }
+    segment.easy = NULL;
+
+    if (segment.abandoned || self.aborted) {
+        [self finishIfDone];
+        return;
+    }
+
+    // 写缓冲中的数据都已校验过，失败时也先写入，重试只需获取剩余区间
+    [self flushSegment:segment];
+    BOOL completed = segment.rangeComplete || (succeeded && segment.offset >= segment.end);
+
+    if (completed) {
+        if (!segment.rangeRequest && segment.end == self.totalLength) {
+            // 完整GET已取完全部数据，其余各段不再需要
+            [self abandonSegmentsExcept:nil];
+        } else {
+            [self stealWork];
+        }
+    } else if (!self.singleStream && self.retriesLeft > 0 && segment.offset < segment.end) {
+        self.retriesLeft--;
+        EMAS_LOG_INFO(@"EC-Download", @"Retrying segment from %lld to %lld: %@", segment.offset, segment.end - 1, error.localizedDescription);
+        [self launchSegmentFrom:segment.offset to:segment.end rangeRequest:YES];
+    } else {
+        [self abortWithError:error ?: [NSError errorWithDomain:NSURLErrorDomain code:NSURLErrorNetworkConnectionLost userInfo:nil]];
+    }
+    [self finishIfDone];
+}
+
+// 从剩余最多的段拆出后半段，保持并发数
+- (void)stealWork {
+    if (self.singleStream) {
+        return;
+    }
+    EMASCurlDownloadSegment *victim = nil;
+    int64_t largestRemaining = 0;
+    for (EMASCurlDownloadSegment *segment in self.activeSegments) {
+        if (!segment.validated || segment.abandoned || segment.rangeComplete) {
+            continue;
+        }
+        if (segment.primary && !self.primaryRangeConfirmed) {
+            continue;
+        }
+        int64_t remaining = segment.end - segment.offset;
+        if (remaining > largestRemaining) {
+            largestRemaining = remaining;
+            victim = segment;
+        }
+    }
+    if (!victim || largestRemaining < 2 * kEMASSegmentMinimumBytes) {
+        return;
+    }
+
+    int64_t split = victim.offset + largestRemaining / 2;
+    int64_t end = victim.end;
+    victim.end = split;
+    EMAS_LOG_DEBUG(@"EC-Download", @"Stealing %lld-%lld from segment starting at %lld", split, end - 1, victim.start);
+    [self launchSegmentFrom:split to:end rangeRequest:YES];
+}
+
+// 服务端不支持范围请求或资源已变化：只保留一个完整GET
+- (void)fallBackToSingleStream {
+    self.singleStream = YES;
+    EMASCurlDownloadSegment *primary = self.primarySegment;
+    if (!self.primaryFinished && !primary.rangeComplete) {
+        // primary仍在接收，恢复到完整长度即可
+        primary.end = self.totalLength;
+        [self abandonSegmentsExcept:primary];
+        return;
+    }
+    [self abandonSegmentsExcept:nil];
+    [self performOutsideCallback:^{
+        if (!self.aborted) {
+            [self launchSegmentFrom:0 to:self.totalLength rangeRequest:NO];
+        }
+    }];
+}
+
+- (void)abandonSegmentsExcept:(EMASCurlDownloadSegment *)keptSegment {
+    for (EMASCurlDownloadSegment *segment in self.activeSegments) {
+        if (segment != keptSegment && !segment.primary) {
+            segment.abandoned = YES;
+            segment.chunk = nil;
+        }
+    }
+}
+
+- (void)abortWithError:(NSError *)error {
+    if (!self.error) {
+        self.error = error;
+    }
+    [self abandonSegmentsExcept:nil];
+}
+
+- (void)finishIfDone {
+    if (self.completed || !self.primaryFinished || self.activeSegments.count > 0 || self.pendingLaunchCount > 0) {
+        return;
+    }
+    self.completed = YES;
+    curl_easy_cleanup(self.templateHandle);
+    self.templateHandle = NULL;
+
+    NSError *error = self.error;
+    if (self.cancelled) {
+        error = [NSError errorWithDomain:NSURLErrorDomain code:NSURLErrorCancelled userInfo:nil];
+    }
+    void (^completionHandler)(BOOL, NSError *) = self.completionHandler;
+    self.completionHandler = nil;
+    self.bytesReceivedHandler = nil;
+    self.sink.drainedHandler = nil;
+    if (completionHandler) {
+        completionHandler(error == nil, error);
+    }
+}
+
+@end
+
+#pragma mark - libcurl回调
+
+static size_t segment_write_cb(char *contents, size_t size, size_t nmemb, void *userp) {
+    EMASCurlDownloadSegment *segment = (__bridge EMASCurlDownloadSegment *)userp;
+    size_t totalSize = size * nmemb;
+    NSInteger accepted = [segment.download writeBytes:contents length:totalSize forSegment:segment];
+    if (accepted == EMASCurlSegmentWriteWouldBlock) {
+        return CURL_WRITEFUNC_PAUSE;
+    }
+    // 返回少于totalSize的值会让libcurl以CURLE_WRITE_ERROR中止该段
+    return accepted < 0 ? 0 : (size_t)accepted;
+}
+
+static int segment_progress_cb(void *clientp, curl_off_t dltotal, curl_off_t dlnow, curl_off_t ultotal, curl_off_t ulnow) {
+    EMASCurlDownloadSegment *segment = (__bridge EMASCurlDownloadSegment *)clientp;
+    return (segment.abandoned || segment.download.aborted) ? 1 : 0;
+}
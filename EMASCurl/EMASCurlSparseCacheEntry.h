@@ -0,0 +1,100 @@
+//
+//  EMASCurlSparseCacheEntry.h
+//  EMASCurl
+//
+//  Created by xuyecan on 2026/10/18.
+//
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ * 解析请求中的Range头，仅支持单个字节区间（bytes=a-b、bytes=a-、bytes=-n）。
+ * 多区间、非bytes单位或无法满足的区间返回location为NSNotFound的NSRange。
+ *
+ * @param rangeHeader Range头的值
+ * @param totalLength 资源总长度；为0表示未知，此时无法解析开放区间和后缀区间
+ */
+NSRange EMASParseSingleByteRange(NSString * _Nullable rangeHeader, unsigned long long totalLength);
+
+/**
+ * 解析响应中的Content-Range头（bytes a-b/total）。
+ * total为"*"时视为无法解析，因为稀疏条目必须知道资源总长度。
+ */
+BOOL EMASParseContentRange(NSString * _Nullable contentRange, NSRange * _Nonnull outRange, unsigned long long * _Nonnull outTotalLength);
+
+/**
+ * 稀疏缓存条目：记录同一资源已缓存的若干字节区间。
+ * 用于206 Partial Content响应的合并存储，以及用缓存数据应答Range请求。
+ * 该对象不是线程安全的，由EMASCurlResponseCache在自己的队列中创建和合并。
+ */
+@interface EMASCurlSparseCacheEntry : NSObject
+
+// 底层存储的缓存响应，用于新鲜度与Vary校验
+@property (nonatomic, strong, readonly) NSCachedURLResponse *cachedResponse;
+
+// 资源完整长度（来自Content-Range的total部分）
+@property (nonatomic, assign, readonly) unsigned long long totalLength;
+
+// 已缓存的字节区间（NSRange），按起始位置升序且互不重叠
+@property (nonatomic, copy, readonly) NSArray<NSValue *> *cachedRanges;
+
+// 已缓存的字节总数
+@property (nonatomic, assign, readonly) NSUInteger cachedByteCount;
+
+/**
+ * 从稀疏缓存记录还原条目，userInfo中缺少区间信息时返回nil
+ */
++ (nullable instancetype)entryWithCachedResponse:(NSCachedURLResponse *)cachedResponse;
+
+/**
+ * 将完整的200缓存响应视作覆盖[0, length)的稀疏条目，使Range请求也能命中完整缓存
+ */
++ (nullable instancetype)entryWithCompleteCachedResponse:(NSCachedURLResponse *)cachedResponse;
+
+/**
+ * 创建一个只包含元数据、尚无数据区间的新条目
+ */
+- (instancetype)initWithCachedResponse:(NSCachedURLResponse *)cachedResponse totalLength:(unsigned long long)totalLength;
+
+/**
+ * 指定区间是否已被完整缓存
+ */
+- (BOOL)containsRange:(NSRange)range;
+
+/**
+ * 读取已完整缓存的区间数据，区间未被完整覆盖时返回nil
+ */
+- (nullable NSData *)dataForRange:(NSRange)range;
+
+/**
+ * 计算请求区间内需要从网络获取的最小连续区间。
+ * 从首个缺失字节到最后一个缺失字节，中间已缓存的字节也会被重新获取，以保证只发起一次网络请求。
+ * 区间已完整缓存时返回location为NSNotFound的NSRange。
+ */
+- (NSRange)missingSpanInRange:(NSRange)range;
+
+/**
+ * 合并一段数据到条目中，与已有区间重叠或相邻时会合并为一个区间，重叠部分以新数据为准
+ */
+- (void)mergeData:(NSData *)data atOffset:(NSUInteger)offset;
+
+/**
+ * 所有区间按顺序拼接后的数据，用于持久化
+ */
+- (NSData *)packedData;
+
+/**
+ * 区间列表的属性列表表示 [[offset, length], ...]，用于持久化到userInfo
+ */
+- (NSArray<NSArray<NSNumber *> *> *)rangeListForStorage;
+
+/**
+ * 可用于If-Range的验证器：优先使用强ETag，其次使用Last-Modified；弱ETag不能用于If-Range
+ */
+- (nullable NSString *)ifRangeValidator;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,371 @@
+//
+//  EMASCurlSparseCacheEntry.m
+//  EMASCurl
+//
+//  Created by xuyecan on 2026/10/18.
+//
+
+#import "EMASCurlSparseCacheEntry.h"
+#import "EMASCurlCacheConstants.h"
+
+static BOOL EMASIsDecimalString(NSString *str) {
+    if (str.length == 0) {
+        return NO;
+    }
+    return [str rangeOfCharacterFromSet:[[NSCharacterSet decimalDigitCharacterSet] invertedSet]].location == NSNotFound;
+}
+
+static NSString *EMASTrimmed(NSString *str) {
+    return [str stringByTrimmingCharactersInSet:[NSCharacterSet whitespaceCharacterSet]];
+}
+
+NSRange EMASParseSingleByteRange(NSString *rangeHeader, unsigned long long totalLength) {
+    NSRange notFound = NSMakeRange(NSNotFound, 0);
+    NSString *value = EMASTrimmed(rangeHeader ?: @"");
+    if (![[value lowercaseString] hasPrefix:@"bytes="]) {
+        return notFound;
+    }
+
+    NSString *spec = EMASTrimmed([value substringFromIndex:6]);
+    // 多区间请求的响应是multipart/byteranges，不参与稀疏缓存
+    if ([spec containsString:@","]) {
+        return notFound;
+    }
+
+    NSRange dashRange = [spec rangeOfString:@"-"];
+    if (dashRange.location == NSNotFound) {
+        return notFound;
+    }
+    NSString *startStr = EMASTrimmed([spec substringToIndex:dashRange.location]);
+    NSString *endStr = EMASTrimmed([spec substringFromIndex:dashRange.location + 1]);
+
+    if (startStr.length == 0) {
+        // 后缀区间 bytes=-n，需要知道总长度才能换算
+        if (!EMASIsDecimalString(endStr) || totalLength == 0) {
+            return notFound;
+        }
+        unsigned long long suffixLength = strtoull(endStr.UTF8String, NULL, 10);
+        if (suffixLength == 0) {
+            return notFound;
+        }
+        unsigned long long start = suffixLength >= totalLength ? 0 : totalLength - suffixLength;
+        return NSMakeRange((NSUInteger)start, (NSUInteger)(totalLength - start));
+    }
+
+    if (!EMASIsDecimalString(startStr)) {
+        return notFound;
+    }
+    unsigned long long start = strtoull(startStr.UTF8String, NULL, 10);
+    unsigned long long end = 0;
+    if (endStr.length == 0) {
+        // 开放区间 bytes=a-
+        if (totalLength == 0) {
+            return notFound;
+        }
+        end = totalLength - 1;
+    } else {
+        if (!EMASIsDecimalString(endStr)) {
+            return notFound;
+        }
+        end = strtoull(endStr.UTF8String, NULL, 10);
+        if (end < start) {
+            return notFound;
+        }
+        if (totalLength > 0 && end >= totalLength) {
+            end = totalLength - 1;
+        }
+    }
+
+    if (totalLength > 0 && start >= totalLength) {
+        return notFound;
+    }
+    return NSMakeRange((NSUInteger)start, (NSUInteger)(end - start + 1));
+}
+
+BOOL EMASParseContentRange(NSString *contentRange, NSRange *outRange, unsigned long long *outTotalLength) {
+    NSString *value = EMASTrimmed(contentRange ?: @"");
+    if (![[value lowercaseString] hasPrefix:@"bytes "]) {
+        return NO;
+    }
+
+    NSString *spec = EMASTrimmed([value substringFromIndex:6]);
+    NSRange slashRange = [spec rangeOfString:@"/"];
+    if (slashRange.location == NSNotFound) {
+        return NO;
+    }
+    NSString *rangePart = EMASTrimmed([spec substringToIndex:slashRange.location]);
+    NSString *totalPart = EMASTrimmed([spec substringFromIndex:slashRange.location + 1]);
+    if (!EMASIsDecimalString(totalPart)) {
+        return NO;
+    }
+
+    NSRange dashRange = [rangePart rangeOfString:@"-"];
+    if (dashRange.location == NSNotFound) {
+        return NO;
+    }
+    NSString *startStr = [rangePart substringToIndex:dashRange.location];
+    NSString *endStr = [rangePart substringFromIndex:dashRange.location + 1];
+    if (!EMASIsDecimalString(startStr) || !EMASIsDecimalString(endStr)) {
+        return NO;
+    }
+
+    unsigned long long start = strtoull(startStr.UTF8String, NULL, 10);
+    unsigned long long end = strtoull(endStr.UTF8String, NULL, 10);
+    unsigned long long total = strtoull(totalPart.UTF8String, NULL, 10);
+    if (end < start || total == 0 || end >= total) {
+        return NO;
+    }
+
+    *outRange = NSMakeRange((NSUInteger)start, (NSUInteger)(end - start + 1));
+    *outTotalLength = total;
+    return YES;
+}
+
+#pragma mark - EMASCurlSparseSegment
+
+@interface EMASCurlSparseSegment : NSObject
+
+@property (nonatomic, assign) NSUInteger offset;
+@property (nonatomic, strong) NSData *data;
+
+@end
+
+@implementation EMASCurlSparseSegment
+
+- (NSUInteger)end {
+    return self.offset + self.data.length;
+}
+
+@end
+
+#pragma mark - EMASCurlSparseCacheEntry
+
+@interface EMASCurlSparseCacheEntry ()
+
+@property (nonatomic, strong, readwrite) NSCachedURLResponse *cachedResponse;
+@property (nonatomic, assign, readwrite) unsigned long long totalLength;
+@property (nonatomic, strong) NSMutableArray<EMASCurlSparseSegment *> *segments;
+
+@end
+
+@implementation EMASCurlSparseCacheEntry
+
+- (instancetype)initWithCachedResponse:(NSCachedURLResponse *)cachedResponse totalLength:(unsigned long long)totalLength {
+    self = [super init];
+    if (self) {
+        _cachedResponse = cachedResponse;
+        _totalLength = totalLength;
+        _segments = [NSMutableArray array];
+    }
+    return self;
+}
+
++ (nullable instancetype)entryWithCachedResponse:(NSCachedURLResponse *)cachedResponse {
+    NSArray *rangeList = cachedResponse.userInfo[EMASUserInfoKeySparseRanges];
+    NSNumber *totalLength = cachedResponse.userInfo[EMASUserInfoKeySparseTotalLength];
+    if (![rangeList isKindOfClass:[NSArray class]] || ![totalLength isKindOfClass:[NSNumber class]]) {
+        return nil;
+    }
+
+    EMASCurlSparseCacheEntry *entry = [[self alloc] initWithCachedResponse:cachedResponse
+                                                               totalLength:totalLength.unsignedLongLongValue];
+    NSData *packedData = cachedResponse.data;
+    NSUInteger cursor = 0;
+    for (NSArray *pair in rangeList) {
+        if (![pair isKindOfClass:[NSArray class]] || pair.count != 2) {
+            return nil;
+        }
+        NSUInteger offset = [pair[0] unsignedIntegerValue];
+        NSUInteger length = [pair[1] unsignedIntegerValue];
+        // 记录与数据不一致时视为损坏，交由调用方移除
+        if (length == 0 || cursor + length > packedData.length || offset + length > entry.totalLength) {
+            return nil;
+        }
+        EMASCurlSparseSegment *segment = [EMASCurlSparseSegment new];
+        segment.offset = offset;
+        segment.data = [packedData subdataWithRange:NSMakeRange(cursor, length)];
+        [entry.segments addObject:segment];
+        cursor += length;
+    }
+    if (cursor != packedData.length) {
+        return nil;
+    }
+    return entry;
+}
+
++ (nullable instancetype)entryWithCompleteCachedResponse:(NSCachedURLResponse *)cachedResponse {
+    if (![cachedResponse.response isKindOfClass:[NSHTTPURLResponse class]]) {
+        return nil;
+    }
+    NSHTTPURLResponse *httpResponse = (NSHTTPURLResponse *)cachedResponse.response;
+    if (httpResponse.statusCode != 200 || cachedResponse.data.length == 0) {
+        return nil;
+    }
+    // 缓存中保存的是libcurl解码后的数据，带内容编码时字节偏移与服务端表示不一致，不能按区间切分
+    NSString *contentEncoding = httpResponse.allHeaderFields[EMASHTTPHeaderContentEncoding];
+    if (contentEncoding.length > 0 && [contentEncoding caseInsensitiveCompare:@"identity"] != NSOrderedSame) {
+        return nil;
+    }
+
+    EMASCurlSparseCacheEntry *entry = [[self alloc] initWithCachedResponse:cachedResponse
+                                                               totalLength:cachedResponse.data.length];
+    EMASCurlSparseSegment *segment = [EMASCurlSparseSegment new];
+    segment.offset = 0;
+    segment.data = cachedResponse.data;
+    [entry.segments addObject:segment];
+    return entry;
+}
+
+- (NSArray<NSValue *> *)cachedRanges {
+    NSMutableArray<NSValue *> *ranges = [NSMutableArray arrayWithCapacity:self.segments.count];
+    for (EMASCurlSparseSegment *segment in self.segments) {
+        [ranges addObject:[NSValue valueWithRange:NSMakeRange(segment.offset, segment.data.length)]];
+    }
+    return [ranges copy];
+}
+
+- (NSUInteger)cachedByteCount {
+    NSUInteger count = 0;
+    for (EMASCurlSparseSegment *segment in self.segments) {
+        count += segment.data.length;
+    }
+    return count;
+}
+
+- (EMASCurlSparseSegment *)segmentContainingOffset:(NSUInteger)offset {
+    for (EMASCurlSparseSegment *segment in self.segments) {
+        if (segment.offset <= offset && offset < segment.end) {
+            return segment;
+        }
+    }
+    return nil;
+}
+
+- (BOOL)containsRange:(NSRange)range {
+    if (range.location == NSNotFound || range.length == 0) {
+        return NO;
+    }
+    // 相邻区间在合并时已连成一段，完整覆盖的区间必然落在同一段内
+    EMASCurlSparseSegment *segment = [self segmentContainingOffset:range.location];
+    return segment != nil && NSMaxRange(range) <= segment.end;
+}
+
+- (nullable NSData *)dataForRange:(NSRange)range {
+    if (![self containsRange:range]) {
+        return nil;
+    }
+    EMASCurlSparseSegment *segment = [self segmentContainingOffset:range.location];
+    return [segment.data subdataWithRange:NSMakeRange(range.location - segment.offset, range.length)];
+}
+
+- (NSRange)missingSpanInRange:(NSRange)range {
+    if (range.location == NSNotFound || range.length == 0) {
+        return NSMakeRange(NSNotFound, 0);
+    }
+
+    NSUInteger firstMissing = range.location;
+    EMASCurlSparseSegment *head = [self segmentContainingOffset:firstMissing];
+    if (head) {
+        firstMissing = head.end;
+    }
+    if (firstMissing >= NSMaxRange(range)) {
+        return NSMakeRange(NSNotFound, 0);
+    }
+
+    NSUInteger missingEnd = NSMaxRange(range);
+    EMASCurlSparseSegment *tail = [self segmentContainingOffset:missingEnd - 1];
+    if (tail) {
+        missingEnd = tail.offset;
+    }
+    return NSMakeRange(firstMissing, missingEnd - firstMissing);
+}
+
+- (void)mergeData:(NSData *)data atOffset:(NSUInteger)offset {
+    if (data.length == 0) {
+        return;
+    }
+    if (self.totalLength > 0) {
+        if (offset >= self.totalLength) {
+            return;
+        }
+        if (offset + data.length > self.totalLength) {
+            data = [data subdataWithRange:NSMakeRange(0, (NSUInteger)(self.totalLength - offset))];
+        }
+    }
+
+    NSUInteger newEnd = offset + data.length;
+    NSUInteger mergedStart = offset;
+    NSUInteger mergedEnd = newEnd;
+    NSMutableArray<EMASCurlSparseSegment *> *kept = [NSMutableArray array];
+    NSMutableArray<EMASCurlSparseSegment *> *touching = [NSMutableArray array];
+    for (EMASCurlSparseSegment *segment in self.segments) {
+        if (segment.end < offset || segment.offset > newEnd) {
+            [kept addObject:segment];
+        } else {
+            [touching addObject:segment];
+            mergedStart = MIN(mergedStart, segment.offset);
+            mergedEnd = MAX(mergedEnd, segment.end);
+        }
+    }
+
+    NSData *mergedData = data;
+    if (touching.count > 0) {
+        NSMutableData *buffer = [NSMutableData dataWithLength:mergedEnd - mergedStart];
+        for (EMASCurlSparseSegment *segment in touching) {
+            [buffer replaceBytesInRange:NSMakeRange(segment.offset - mergedStart, segment.data.length)
+                              withBytes:segment.data.bytes];
+        }
+        // 重叠部分以新数据为准
+        [buffer replaceBytesInRange:NSMakeRange(offset - mergedStart, data.length) withBytes:data.bytes];
+        mergedData = buffer;
+    }
+
+    EMASCurlSparseSegment *merged = [EMASCurlSparseSegment new];
+    merged.offset = mergedStart;
+    merged.data = [mergedData copy];
+    [kept addObject:merged];
+    [kept sortUsingComparator:^NSComparisonResult(EMASCurlSparseSegment *a, EMASCurlSparseSegment *b) {
+        if (a.offset == b.offset) {
+            return NSOrderedSame;
+        }
+        return a.offset < b.offset ? NSOrderedAscending : NSOrderedDescending;
+    }];
+    self.segments = kept;
+}
+
+- (NSData *)packedData {
+    if (self.segments.count == 1) {
+        return self.segments.firstObject.data;
+    }
+    NSMutableData *packed = [NSMutableData dataWithCapacity:self.cachedByteCount];
+    for (EMASCurlSparseSegment *segment in self.segments) {
+        [packed appendData:segment.data];
+    }
+    return [packed copy];
+}
+
+- (NSArray<NSArray<NSNumber *> *> *)rangeListForStorage {
+    NSMutableArray<NSArray<NSNumber *> *> *list = [NSMutableArray arrayWithCapacity:self.segments.count];
+    for (EMASCurlSparseSegment *segment in self.segments) {
+        [list addObject:@[@(segment.offset), @(segment.data.length)]];
+    }
+    return [list copy];
+}
+
+- (nullable NSString *)ifRangeValidator {
+    if (![self.cachedResponse.response isKindOfClass:[NSHTTPURLResponse class]]) {
+        return nil;
+    }
+    NSDictionary *headers = ((NSHTTPURLResponse *)self.cachedResponse.response).allHeaderFields;
+    NSString *etag = headers[EMASHTTPHeaderETag];
+    if (etag.length > 0 && ![etag hasPrefix:@"W/"]) {
+        return etag;
+    }
+    NSString *lastModified = headers[EMASHTTPHeaderLastModified];
+    if (lastModified.length > 0) {
+        return lastModified;
+    }
+    return nil;
+}
+
+@end
@@ -0,0 +1,60 @@
+//
+//  EMASCurlTraceRecorder.h
+//  EMASCurl
+//
+//  Created by xuyecan on 2026/10/18.
+//
+
+#import <Foundation/Foundation.h>
+#import <stdatomic.h>
+#include <stdint.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+// 请求阶段名，事件只保存指针，必须是静态字符串
+extern const char * const EMASCurlTracePhaseRequest;
+extern const char * const EMASCurlTracePhaseCacheLookup;
+extern const char * const EMASCurlTracePhaseQueue;
+extern const char * const EMASCurlTracePhaseNameLookup;
+extern const char * const EMASCurlTracePhaseConnect;
+extern const char * const EMASCurlTracePhaseSecureConnection;
+extern const char * const EMASCurlTracePhaseRequestSend;
+extern const char * const EMASCurlTracePhaseTimeToFirstByte;
+extern const char * const EMASCurlTracePhaseBodyDownload;
+extern const char * const EMASCurlTracePhaseCallbackDelivery;
+
+// 追踪开关，只由+[EMASCurlTraceRecorder setEnabled:]修改
+extern atomic_bool EMASCurlTraceEnabledFlag;
+
+// 关闭时调用方只付出这一次分支判断
+static inline BOOL EMASCurlTraceIsEnabled(void) {
+    return __builtin_expect(atomic_load_explicit(&EMASCurlTraceEnabledFlag, memory_order_relaxed), 0);
+}
+
+// 单调时钟，单位纳秒
+uint64_t EMASCurlTraceNow(void);
+
+// 分配一个请求的追踪ID，作为导出时的tid，不为0
+uint64_t EMASCurlTraceNextRequestId(void);
+
+// 记录一个阶段的起止时间；detail为UTF-8字符串，会在字符边界处截断到不超过63字节，仅用于标注请求（如URL）
+void EMASCurlTraceRecordSpan(uint64_t requestId, const char *phase, uint64_t startNs, uint64_t endNs, const char * _Nullable detail);
+
+/**
+ * 请求阶段追踪。事件写入固定容量的环形缓冲区，多线程并发写入只做原子操作、不加锁，写满后覆盖最旧的事件；
+ * 每个槽位用序号做seqlock，导出时跳过正在写入或已被覆盖的槽位。
+ */
+@interface EMASCurlTraceRecorder : NSObject
+
+// 首次开启时分配缓冲区，之后常驻，关闭只停止记录
++ (void)setEnabled:(BOOL)enabled;
+
+// 以Chrome Trace Event格式导出缓冲区中的事件，每个请求一条轨道
++ (NSData *)exportChromeTraceJSON;
+
+// 丢弃已记录的事件
++ (void)clear;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,157 @@
+//
+//  EMASCurlTraceRecorder.m
+//  EMASCurl
+//
+//  Created by xuyecan on 2026/10/18.
+//
+
+#import "EMASCurlTraceRecorder.h"
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+const char * const EMASCurlTracePhaseRequest = "request";
+const char * const EMASCurlTracePhaseCacheLookup = "cache_lookup";
+const char * const EMASCurlTracePhaseQueue = "queue";
+const char * const EMASCurlTracePhaseNameLookup = "dns";
+const char * const EMASCurlTracePhaseConnect = "connect";
+const char * const EMASCurlTracePhaseSecureConnection = "tls";
+const char * const EMASCurlTracePhaseRequestSend = "request_send";
+const char * const EMASCurlTracePhaseTimeToFirstByte = "ttfb";
+const char * const EMASCurlTracePhaseBodyDownload = "body_download";
+const char * const EMASCurlTracePhaseCallbackDelivery = "callback_delivery";
+
+atomic_bool EMASCurlTraceEnabledFlag = false;
+
+// 容量须为2的幂，每个请求约10个事件
+#define EMAS_TRACE_CAPACITY 8192
+#define EMAS_TRACE_DETAIL_WORDS 8
+
+typedef struct {
+    // 0表示从未写入；写入中为2*ticket+1，写完为2*ticket+2
+    _Atomic uint64_t sequence;
+    _Atomic uint64_t phase;
+    _Atomic uint64_t requestId;
+    _Atomic uint64_t startNs;
+    _Atomic uint64_t endNs;
+    _Atomic uint64_t detail[EMAS_TRACE_DETAIL_WORDS];
+} EMASTraceEvent;
+
+static _Atomic(EMASTraceEvent *) s_traceEvents = NULL;
+static _Atomic uint64_t s_traceHead = 0;
+// clear时的head，导出只包含此后写入的事件
+static _Atomic uint64_t s_traceClearedTicket = 0;
+static _Atomic uint64_t s_traceRequestId = 0;
+
+uint64_t EMASCurlTraceNow(void) {
+    return clock_gettime_nsec_np(CLOCK_UPTIME_RAW);
+}
+
+uint64_t EMASCurlTraceNextRequestId(void) {
+    return atomic_fetch_add_explicit(&s_traceRequestId, 1, memory_order_relaxed) + 1;
+}
+
+void EMASCurlTraceRecordSpan(uint64_t requestId, const char *phase, uint64_t startNs, uint64_t endNs, const char *detail) {
+    EMASTraceEvent *events = atomic_load_explicit(&s_traceEvents, memory_order_acquire);
+    if (!events || endNs < startNs) {
+        return;
+    }
+
+    uint64_t ticket = atomic_fetch_add_explicit(&s_traceHead, 1, memory_order_relaxed);
+    EMASTraceEvent *event = &events[ticket & (EMAS_TRACE_CAPACITY - 1)];
+
+    uint64_t words[EMAS_TRACE_DETAIL_WORDS] = {0};
+    if (detail) {
+        size_t length = strnlen(detail, sizeof(words));
+        if (length > sizeof(words) - 1) {
+            // 截断点落在多字节字符中间时回退到该字符的首字节，保证保存的是完整的UTF-8
+            length = sizeof(words) - 1;
+            while (length > 0 && ((uint8_t)detail[length] & 0xC0) == 0x80) {
+                length--;
+            }
+        }
+        memcpy(words, detail, length);
+    }
+
+    atomic_store_explicit(&event->sequence, 2 * ticket + 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+    atomic_store_explicit(&event->phase, (uint64_t)(uintptr_t)phase, memory_order_relaxed);
+    atomic_store_explicit(&event->requestId, requestId, memory_order_relaxed);
+    atomic_store_explicit(&event->startNs, startNs, memory_order_relaxed);
+    atomic_store_explicit(&event->endNs, endNs, memory_order_relaxed);
+    for (int i = 0; i < EMAS_TRACE_DETAIL_WORDS; i++) {
+        atomic_store_explicit(&event->detail[i], words[i], memory_order_relaxed);
+    }
+    atomic_store_explicit(&event->sequence, 2 * ticket + 2, memory_order_release);
+}
+
+@implementation EMASCurlTraceRecorder
+
++ (void)setEnabled:(BOOL)enabled {
+    if (enabled && !atomic_load_explicit(&s_traceEvents, memory_order_acquire)) {
+        EMASTraceEvent *events = calloc(EMAS_TRACE_CAPACITY, sizeof(EMASTraceEvent));
+        EMASTraceEvent *expected = NULL;
+        if (!atomic_compare_exchange_strong_explicit(&s_traceEvents, &expected, events, memory_order_acq_rel, memory_order_acquire)) {
+            free(events);
+        }
+    }
+    atomic_store_explicit(&EMASCurlTraceEnabledFlag, enabled, memory_order_relaxed);
+}
+
++ (void)clear {
+    atomic_store_explicit(&s_traceClearedTicket,
+                          atomic_load_explicit(&s_traceHead, memory_order_relaxed),
+                          memory_order_relaxed);
+}
+
++ (NSData *)exportChromeTraceJSON {
+    NSNumber *pid = @(getpid());
+    NSMutableArray<NSDictionary *> *traceEvents = [NSMutableArray array];
+    [traceEvents addObject:@{@"name": @"process_name", @"ph": @"M", @"pid": pid, @"tid": @0,
+                             @"args": @{@"name": @"EMASCurl"}}];
+
+    EMASTraceEvent *events = atomic_load_explicit(&s_traceEvents, memory_order_acquire);
+    uint64_t head = atomic_load_explicit(&s_traceHead, memory_order_acquire);
+    uint64_t first = head > EMAS_TRACE_CAPACITY ? head - EMAS_TRACE_CAPACITY : 0;
+    first = MAX(first, atomic_load_explicit(&s_traceClearedTicket, memory_order_relaxed));
+
+    for (uint64_t ticket = first; events && ticket < head; ticket++) {
+        EMASTraceEvent *event = &events[ticket & (EMAS_TRACE_CAPACITY - 1)];
+        uint64_t sequence = atomic_load_explicit(&event->sequence, memory_order_acquire);
+        if (sequence != 2 * ticket + 2) {
+            // 尚未写完或已被更新的事件覆盖
+            continue;
+        }
+        const char *phase = (const char *)(uintptr_t)atomic_load_explicit(&event->phase, memory_order_relaxed);
+        uint64_t requestId = atomic_load_explicit(&event->requestId, memory_order_relaxed);
+        uint64_t startNs = atomic_load_explicit(&event->startNs, memory_order_relaxed);
+        uint64_t endNs = atomic_load_explicit(&event->endNs, memory_order_relaxed);
+        uint64_t words[EMAS_TRACE_DETAIL_WORDS];
+        for (int i = 0; i < EMAS_TRACE_DETAIL_WORDS; i++) {
+            words[i] = atomic_load_explicit(&event->detail[i], memory_order_relaxed);
+        }
+        atomic_thread_fence(memory_order_acquire);
+        if (atomic_load_explicit(&event->sequence, memory_order_relaxed) != sequence) {
+            continue;
+        }
+
+        // Chrome Trace Event的时间单位为微秒
+        [traceEvents addObject:@{@"name": @(phase), @"cat": @"emascurl", @"ph": @"X",
+                                 @"ts": @(startNs / 1000.0), @"dur": @((endNs - startNs) / 1000.0),
+                                 @"pid": pid, @"tid": @(requestId)}];
+        // detail按UTF-8解码，非ASCII的URL不会乱码
+        size_t detailLength = strnlen((const char *)words, sizeof(words));
+        NSString *detail = detailLength > 0 ? [[NSString alloc] initWithBytes:words length:detailLength encoding:NSUTF8StringEncoding] : nil;
+        if (detail) {
+            NSString *label = [NSString stringWithFormat:@"#%llu %@", requestId, detail];
+            [traceEvents addObject:@{@"name": @"thread_name", @"ph": @"M", @"pid": pid, @"tid": @(requestId),
+                                     @"args": @{@"name": label}}];
+        }
+    }
+
+    NSDictionary *trace = @{@"traceEvents": traceEvents, @"displayTimeUnit": @"ms"};
+    return [NSJSONSerialization dataWithJSONObject:trace options:0 error:nil] ?: [NSData data];
+}
+
+@end
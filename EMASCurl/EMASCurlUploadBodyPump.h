@@ -0,0 +1,56 @@
+//
+//  EMASCurlUploadBodyPump.h
+//  EMASCurl
+//
+//  Created by xuyecan on 2026/10/18.
+//
+
+#import <Foundation/Foundation.h>
+
+@class EMASCurlRequestBodyEncoder;
+
+NS_ASSUME_NONNULL_BEGIN
+
+// 消费端读取结果，非负值表示读到的字节数（0为读完）
+typedef NS_ENUM(NSInteger, EMASCurlUploadPumpReadStatus) {
+    EMASCurlUploadPumpReadWouldBlock = -1,  // 暂无数据，数据到达后触发dataAvailableHandler
+    EMASCurlUploadPumpReadFailed = -2       // 读取请求体流出错
+};
+
+/**
+ * 上传请求体的生产者：在独立的I/O队列上打开并读取NSInputStream，写入有界环形缓冲区。
+ * 网络线程只从缓冲区取数据，慢速或阻塞的请求体流不会拖慢同一线程上的其他传输。
+ * 单生产者单消费者，消费端只应在一个线程上调用。
+ */
+@interface EMASCurlUploadBodyPump : NSObject
+
+- (instancetype)initWithInputStream:(NSInputStream *)inputStream capacity:(NSUInteger)capacity NS_DESIGNATED_INITIALIZER;
+
+- (instancetype)init NS_UNAVAILABLE;
+
+/**
+ * 消费端返回WouldBlock后，有新数据、读完或出错时调用一次，在I/O队列上执行。
+ * 需在start之前设置
+ */
+@property (nonatomic, copy, nullable) dispatch_block_t dataAvailableHandler;
+
+/**
+ * 请求体编码器，设置后读出的数据先在I/O队列上压缩再写入缓冲区。
+ * 需在start之前设置，传输结束后可读取其字节统计
+ */
+@property (nonatomic, strong, nullable) EMASCurlRequestBodyEncoder *encoder;
+
+// 开始在I/O队列上预读
+- (void)start;
+
+/**
+ * 取出最多length字节，返回字节数或EMASCurlUploadPumpReadStatus
+ */
+- (NSInteger)readIntoBuffer:(uint8_t *)buffer maxLength:(NSUInteger)length;
+
+// 停止读取并在I/O队列上关闭流
+- (void)cancel;
+
+@end
+
+NS_ASSUME_NONNULL_END
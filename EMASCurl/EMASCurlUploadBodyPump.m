@@ -0,0 +1,221 @@
+//
+//  EMASCurlUploadBodyPump.m
+//  EMASCurl
+//
+//  Created by xuyecan on 2026/10/18.
+//
+
+#import "EMASCurlUploadBodyPump.h"
+#import "EMASCurlRequestBodyEncoder.h"
+#import "EMASCurlLogger.h"
+#import <os/lock.h>
+
+// 单次read:的上限，与libcurl默认的上传缓冲区大小一致
+static const NSUInteger kEMASUploadPumpReadChunkBytes = 64 * 1024;
+
+@interface EMASCurlUploadBodyPump () {
+    os_unfair_lock _lock;
+    uint8_t *_buffer;
+    // 压缩时的原始数据暂存区，只在I/O队列上访问
+    uint8_t *_rawBuffer;
+    NSUInteger _capacity;
+    // 以下由_lock保护；[head, head + count)为已写入待消费的数据
+    NSUInteger _head;
+    NSUInteger _count;
+    BOOL _finished;
+    BOOL _failed;
+    BOOL _cancelled;
+    BOOL _consumerWaiting;
+    BOOL _producerWaiting;
+}
+
+@property (nonatomic, strong) NSInputStream *inputStream;
+@property (nonatomic, strong) dispatch_queue_t ioQueue;
+@property (nonatomic, assign) BOOL streamOpened;
+
+@end
+
+@implementation EMASCurlUploadBodyPump
+
++ (dispatch_queue_t)sharedTargetQueue {
+    static dispatch_queue_t queue;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        dispatch_queue_attr_t attr = dispatch_queue_attr_make_with_qos_class(DISPATCH_QUEUE_CONCURRENT, QOS_CLASS_UTILITY, 0);
+        queue = dispatch_queue_create("com.alicloud.emascurl.uploadPump", attr);
+    });
+    return queue;
+}
+
+- (instancetype)initWithInputStream:(NSInputStream *)inputStream capacity:(NSUInteger)capacity {
+    self = [super init];
+    if (self) {
+        _lock = OS_UNFAIR_LOCK_INIT;
+        _capacity = MAX(capacity, (NSUInteger)1024);
+        _buffer = malloc(_capacity);
+        _inputStream = inputStream;
+        // 每个上传一个串行队列，阻塞的流只占用自己的队列
+        _ioQueue = dispatch_queue_create_with_target("com.alicloud.emascurl.uploadPump.stream", DISPATCH_QUEUE_SERIAL,
+                                                     [EMASCurlUploadBodyPump sharedTargetQueue]);
+        if (!_buffer) {
+            _failed = YES;
+            _finished = YES;
+        }
+    }
+    return self;
+}
+
+- (void)dealloc {
+    free(_buffer);
+    free(_rawBuffer);
+}
+
+- (void)start {
+    dispatch_async(self.ioQueue, ^{
+        [self produce];
+    });
+}
+
+- (void)cancel {
+    os_unfair_lock_lock(&_lock);
+    _cancelled = YES;
+    os_unfair_lock_unlock(&_lock);
+
+    dispatch_async(self.ioQueue, ^{
+        [self closeStream];
+    });
+}
+
+#pragma mark - Producer
+
+// 在ioQueue上执行，缓冲区写满时退出，消费端腾出空间后重新调度
+- (void)produce {
+    if (!self.streamOpened) {
+        self.streamOpened = YES;
+        [self.inputStream open];
+    }
+
+    while (YES) {
+        os_unfair_lock_lock(&_lock);
+        if (_cancelled || _finished) {
+            os_unfair_lock_unlock(&_lock);
+            return;
+        }
+        NSUInteger free = _capacity - _count;
+        if (free == 0) {
+            _producerWaiting = YES;
+            os_unfair_lock_unlock(&_lock);
+            return;
+        }
+        NSUInteger writeIndex = (_head + _count) % _capacity;
+        NSUInteger contiguous = MIN(free, _capacity - writeIndex);
+        os_unfair_lock_unlock(&_lock);
+
+        // 空闲区域只由生产者写入，读取期间不需要持锁
+        NSInteger bytesRead;
+        BOOL streamEnded;
+        if (self.encoder) {
+            bytesRead = [self encodeIntoBuffer:_buffer + writeIndex maxLength:MIN(contiguous, kEMASUploadPumpReadChunkBytes)];
+            streamEnded = bytesRead < 0 || self.encoder.finished;
+        } else {
+            bytesRead = [self.inputStream read:_buffer + writeIndex maxLength:MIN(contiguous, kEMASUploadPumpReadChunkBytes)];
+            streamEnded = bytesRead <= 0;
+        }
+
+        os_unfair_lock_lock(&_lock);
+        if (bytesRead > 0) {
+            _count += (NSUInteger)bytesRead;
+        }
+        if (streamEnded) {
+            _finished = YES;
+            _failed = (bytesRead < 0);
+        }
+        // 编码器可能只消费输入而暂无输出，此时不唤醒消费端
+        BOOL notify = _consumerWaiting && (bytesRead != 0 || streamEnded);
+        if (notify) {
+            _consumerWaiting = NO;
+        }
+        os_unfair_lock_unlock(&_lock);
+
+        if (bytesRead < 0) {
+            EMAS_LOG_ERROR(@"EC-Upload", @"Failed to read request body stream: %@", self.inputStream.streamError);
+        }
+        if (notify && self.dataAvailableHandler) {
+            self.dataAvailableHandler();
+        }
+        if (streamEnded) {
+            [self closeStream];
+            return;
+        }
+    }
+}
+
+// 按需从流中读取原始数据交给编码器，返回写入buffer的压缩字节数（可能为0），出错返回-1
+- (NSInteger)encodeIntoBuffer:(uint8_t *)buffer maxLength:(NSUInteger)length {
+    EMASCurlRequestBodyEncoder *encoder = self.encoder;
+    if (encoder.needsInput) {
+        if (!_rawBuffer) {
+            _rawBuffer = malloc(kEMASUploadPumpReadChunkBytes);
+            if (!_rawBuffer) {
+                return -1;
+            }
+        }
+        NSInteger bytesRead = [self.inputStream read:_rawBuffer maxLength:kEMASUploadPumpReadChunkBytes];
+        if (bytesRead < 0) {
+            return -1;
+        }
+        [encoder provideInput:_rawBuffer length:(NSUInteger)bytesRead];
+    }
+    return [encoder encodeIntoBuffer:buffer maxLength:length];
+}
+
+- (void)closeStream {
+    if (self.streamOpened && self.inputStream.streamStatus != NSStreamStatusClosed) {
+        [self.inputStream close];
+    }
+}
+
+#pragma mark - Consumer
+
+- (NSInteger)readIntoBuffer:(uint8_t *)buffer maxLength:(NSUInteger)length {
+    os_unfair_lock_lock(&_lock);
+    if (_count == 0) {
+        NSInteger status = EMASCurlUploadPumpReadWouldBlock;
+        if (_failed) {
+            status = EMASCurlUploadPumpReadFailed;
+        } else if (_finished) {
+            status = 0;
+        } else {
+            _consumerWaiting = YES;
+        }
+        os_unfair_lock_unlock(&_lock);
+        return status;
+    }
+    NSUInteger head = _head;
+    NSUInteger available = _count;
+    os_unfair_lock_unlock(&_lock);
+
+    // 已写入区域只由消费者读取，复制期间不需要持锁
+    NSUInteger total = MIN(available, length);
+    NSUInteger first = MIN(total, _capacity - head);
+    memcpy(buffer, _buffer + head, first);
+    if (total > first) {
+        memcpy(buffer + first, _buffer, total - first);
+    }
+
+    os_unfair_lock_lock(&_lock);
+    _head = (head + total) % _capacity;
+    _count -= total;
+    BOOL resumeProducer = _producerWaiting;
+    _producerWaiting = NO;
+    os_unfair_lock_unlock(&_lock);
+
+    if (resumeProducer) {
+        dispatch_async(self.ioQueue, ^{
+            [self produce];
+        });
+    }
+    return (NSInteger)total;
+}
+
+@end
@@ -0,0 +1,114 @@
+//
+//  EMASCurlBandwidthShaperTest.m
+//  EMASCurlTests
+//
+//  Created by xuyecan on 2026/10/18.
+//
+
+#import <XCTest/XCTest.h>
+#import <EMASCurl/EMASCurl.h>
+#import "EMASCurlBandwidthShaper.h"
+
+@interface EMASCurlBandwidthShaper (Testing)
+- (void)setRecvCapacity:(double)recvCapacity;
+- (int64_t)limitForCapacity:(double)capacity foregroundRate:(double)foregroundRate transferCount:(NSUInteger)transferCount;
+@end
+
+@interface EMASCurlBandwidthShaperTest : XCTestCase
+@property (nonatomic, strong) EMASCurlBandwidthShaper *shaper;
+@property (nonatomic, strong) NSMutableArray<NSValue *> *easyHandles;
+@end
+
+@implementation EMASCurlBandwidthShaperTest
+
+- (void)setUp {
+    [super setUp];
+    self.shaper = [[EMASCurlBandwidthShaper alloc] init];
+    self.easyHandles = [NSMutableArray array];
+}
+
+- (void)tearDown {
+    for (NSValue *value in self.easyHandles) {
+        CURL *easy = value.pointerValue;
+        [self.shaper removeTransfer:easy];
+        curl_easy_cleanup(easy);
+    }
+    [super tearDown];
+}
+
+- (CURL *)addTransferWithPriority:(EMASCurlRequestPriority)priority {
+    CURL *easy = curl_easy_init();
+    [self.easyHandles addObject:[NSValue valueWithPointer:easy]];
+    [self.shaper addTransfer:easy priority:priority];
+    return easy;
+}
+
+- (void)removeTransfer:(CURL *)easy {
+    [self.shaper removeTransfer:easy];
+    [self.easyHandles removeObject:[NSValue valueWithPointer:easy]];
+    curl_easy_cleanup(easy);
+}
+
+// 当前设置在句柄上的下行限速
+- (int64_t)recvLimitForTransfer:(CURL *)easy {
+    NSDictionary *transfers = [self.shaper valueForKey:@"transfers"];
+    return [[transfers[@((uintptr_t)easy)] valueForKey:@"recvLimit"] longLongValue];
+}
+
+// 前台用量之上预留25%的容量，后台传输平分其余部分
+- (void)testLimitLeavesForegroundHeadroom {
+    XCTAssertEqual([self.shaper limitForCapacity:1000000 foregroundRate:500000 transferCount:1], 250000);
+    XCTAssertEqual([self.shaper limitForCapacity:1000000 foregroundRate:500000 transferCount:2], 125000);
+    XCTAssertEqual([self.shaper limitForCapacity:1000000 foregroundRate:0 transferCount:1], 750000);
+}
+
+// 前台占满链路时，后台传输合计仍保留10%的容量
+- (void)testLimitKeepsMinimumBackgroundShare {
+    XCTAssertEqual([self.shaper limitForCapacity:1000000 foregroundRate:900000 transferCount:1], 100000);
+    XCTAssertEqual([self.shaper limitForCapacity:1000000 foregroundRate:2000000 transferCount:4], 25000);
+}
+
+// 单个后台传输不低于16KiB/s
+- (void)testLimitFloorPerTransfer {
+    XCTAssertEqual([self.shaper limitForCapacity:100000 foregroundRate:100000 transferCount:10], 16 * 1024);
+}
+
+// 尚无容量估计时不限速
+- (void)testNoLimitWithoutCapacityEstimate {
+    XCTAssertEqual([self.shaper limitForCapacity:0 foregroundRate:0 transferCount:1], 0);
+}
+
+// 传输加入或结束时重新分配：只有与前台传输并存时限速，后台传输平分预算
+- (void)testRebalanceOnAddAndRemove {
+    [self.shaper setRecvCapacity:1000000];
+
+    CURL *background1 = [self addTransferWithPriority:EMASCurlRequestPriorityBackground];
+    XCTAssertEqual([self recvLimitForTransfer:background1], 0, @"没有前台传输时不限速");
+
+    CURL *foreground = [self addTransferWithPriority:EMASCurlRequestPriorityDefault];
+    XCTAssertEqual([self recvLimitForTransfer:background1], 750000);
+    XCTAssertEqual([self recvLimitForTransfer:foreground], 0, @"前台传输不限速");
+
+    CURL *background2 = [self addTransferWithPriority:EMASCurlRequestPriorityBackground];
+    XCTAssertEqual([self recvLimitForTransfer:background1], 375000);
+    XCTAssertEqual([self recvLimitForTransfer:background2], 375000);
+
+    [self removeTransfer:background2];
+    XCTAssertEqual([self recvLimitForTransfer:background1], 750000);
+
+    [self removeTransfer:foreground];
+    XCTAssertEqual([self recvLimitForTransfer:background1], 0, @"前台传输结束后解除限速");
+}
+
+// 关闭整形后解除所有限速
+- (void)testDisablingRemovesLimits {
+    [self.shaper setRecvCapacity:1000000];
+    CURL *background = [self addTransferWithPriority:EMASCurlRequestPriorityBackground];
+    [self addTransferWithPriority:EMASCurlRequestPriorityDefault];
+    XCTAssertEqual([self recvLimitForTransfer:background], 750000);
+
+    self.shaper.enabled = NO;
+    XCTAssertEqual([self recvLimitForTransfer:background], 0);
+}
+
+@end
@@ -0,0 +1,343 @@
+//
+//  EMASCurlCacheEvictionTest.m
+//  EMASCurlTests
+//
+//  Created by xuyecan on 2026/10/18.
+//
+
+#import <XCTest/XCTest.h>
+#import <EMASCurl/EMASCurl.h>
+#import "EMASCurlCacheIndex.h"
+
+static NSString * const kCDNHost = @"cdn.example.com";
+static NSString * const kAPIHost = @"api.example.com";
+
+// 回放轨迹：CDN上少量体积大的资源与API上大量体积小的响应，访问频率服从Zipf分布
+static const NSUInteger kCDNObjectCount = 200;
+static const NSUInteger kAPIObjectCount = 2000;
+static const NSUInteger kTraceLength = 20000;
+static const NSUInteger kTraceCacheQuota = 8 * 1024 * 1024;
+
+@interface EMASCurlCacheTraceRecord : NSObject
+@property (nonatomic, copy) NSString *key;
+@property (nonatomic, copy) NSString *host;
+@property (nonatomic, assign) NSUInteger bytes;
+@end
+
+@implementation EMASCurlCacheTraceRecord
+@end
+
+@interface EMASCurlCacheEvictionTest : XCTestCase
+@end
+
+@implementation EMASCurlCacheEvictionTest
+
+#pragma mark - 轨迹生成与回放
+
+static uint64_t EMASTraceNextRandom(uint64_t *state) {
+    // xorshift64*，保证每次生成的轨迹一致
+    uint64_t x = *state;
+    x ^= x >> 12;
+    x ^= x << 25;
+    x ^= x >> 27;
+    *state = x;
+    return x * 2685821657736338717ULL;
+}
+
+static double EMASTraceNextUniform(uint64_t *state) {
+    return (double)(EMASTraceNextRandom(state) >> 11) / (double)(1ULL << 53);
+}
+
+static NSArray<NSNumber *> *EMASZipfCDF(NSUInteger count, double exponent) {
+    NSMutableArray<NSNumber *> *cdf = [NSMutableArray arrayWithCapacity:count];
+    double sum = 0;
+    for (NSUInteger rank = 1; rank <= count; rank++) {
+        sum += 1.0 / pow((double)rank, exponent);
+    }
+    double accumulated = 0;
+    for (NSUInteger rank = 1; rank <= count; rank++) {
+        accumulated += 1.0 / pow((double)rank, exponent) / sum;
+        [cdf addObject:@(accumulated)];
+    }
+    return cdf;
+}
+
+static NSUInteger EMASZipfSample(NSArray<NSNumber *> *cdf, double u) {
+    NSUInteger low = 0;
+    NSUInteger high = cdf.count - 1;
+    while (low < high) {
+        NSUInteger mid = (low + high) / 2;
+        if (cdf[mid].doubleValue < u) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    return low;
+}
+
+- (NSArray<EMASCurlCacheTraceRecord *> *)generateTrace {
+    uint64_t state = 0x9E3779B97F4A7C15ULL;
+
+    NSMutableArray<EMASCurlCacheTraceRecord *> *cdnObjects = [NSMutableArray array];
+    for (NSUInteger i = 0; i < kCDNObjectCount; i++) {
+        EMASCurlCacheTraceRecord *record = [EMASCurlCacheTraceRecord new];
+        record.key = [NSString stringWithFormat:@"https://%@/assets/%lu.bin", kCDNHost, (unsigned long)i];
+        record.host = kCDNHost;
+        record.bytes = 256 * 1024 + (NSUInteger)(EMASTraceNextUniform(&state) * 1792 * 1024);
+        [cdnObjects addObject:record];
+    }
+
+    NSMutableArray<EMASCurlCacheTraceRecord *> *apiObjects = [NSMutableArray array];
+    for (NSUInteger i = 0; i < kAPIObjectCount; i++) {
+        EMASCurlCacheTraceRecord *record = [EMASCurlCacheTraceRecord new];
+        record.key = [NSString stringWithFormat:@"https://%@/v1/items/%lu", kAPIHost, (unsigned long)i];
+        record.host = kAPIHost;
+        record.bytes = 1024 + (NSUInteger)(EMASTraceNextUniform(&state) * 7 * 1024);
+        [apiObjects addObject:record];
+    }
+
+    NSArray<NSNumber *> *cdnCDF = EMASZipfCDF(kCDNObjectCount, 0.8);
+    NSArray<NSNumber *> *apiCDF = EMASZipfCDF(kAPIObjectCount, 0.9);
+
+    NSMutableArray<EMASCurlCacheTraceRecord *> *trace = [NSMutableArray arrayWithCapacity:kTraceLength];
+    for (NSUInteger i = 0; i < kTraceLength; i++) {
+        // 约1/5的请求访问CDN
+        if (EMASTraceNextUniform(&state) < 0.2) {
+            [trace addObject:cdnObjects[EMASZipfSample(cdnCDF, EMASTraceNextUniform(&state))]];
+        } else {
+            [trace addObject:apiObjects[EMASZipfSample(apiCDF, EMASTraceNextUniform(&state))]];
+        }
+    }
+    return trace;
+}
+
+// 回放轨迹：命中即查询，未命中则写入。返回 @[命中率, 字节命中率]
+- (NSArray<NSNumber *> *)replayTrace:(NSArray<EMASCurlCacheTraceRecord *> *)trace
+                           withPolicy:(EMASCurlCacheQuotaPolicy *)policy
+                           statistics:(EMASCurlCacheStatistics **)outStatistics {
+    EMASCurlCacheIndex *index = [EMASCurlCacheIndex new];
+    unsigned long long requestedBytes = 0;
+    unsigned long long hitBytes = 0;
+    NSUInteger hits = 0;
+
+    for (EMASCurlCacheTraceRecord *record in trace) {
+        BOOL hit = [index containsKey:record.key];
+        [index recordLookupForKey:record.key hit:hit];
+        requestedBytes += record.bytes;
+        if (hit) {
+            hits += 1;
+            hitBytes += record.bytes;
+        } else {
+            [index recordStoreForKey:record.key host:record.host bytes:record.bytes quotaPolicy:policy];
+        }
+    }
+
+    if (outStatistics) {
+        *outStatistics = [index statistics];
+    }
+    return @[@((double)hits / (double)trace.count), @((double)hitBytes / (double)requestedBytes)];
+}
+
+- (EMASCurlCacheQuotaPolicy *)tracePolicy:(EMASCurlCacheEvictionPolicy)evictionPolicy {
+    return [[EMASCurlCacheQuotaPolicy alloc] initWithPartition:@"trace"
+                                                evictionPolicy:evictionPolicy
+                                            partitionByteQuota:kTraceCacheQuota
+                                                 hostByteQuota:0
+                                        hostByteQuotaOverrides:nil];
+}
+
+#pragma mark - 策略行为
+
+- (void)testHostQuotaKeepsLargeAssetsFromEvictingSmallResponses {
+    EMASCurlCacheIndex *index = [EMASCurlCacheIndex new];
+    EMASCurlCacheQuotaPolicy *policy = [[EMASCurlCacheQuotaPolicy alloc] initWithPartition:@"test"
+                                                                            evictionPolicy:EMASCurlCacheEvictionPolicyLRU
+                                                                        partitionByteQuota:2 * 1024 * 1024
+                                                                             hostByteQuota:0
+                                                                    hostByteQuotaOverrides:@{kCDNHost: @(1024 * 1024)}];
+
+    for (NSUInteger i = 0; i < 20; i++) {
+        NSString *key = [NSString stringWithFormat:@"https://%@/v1/items/%lu", kAPIHost, (unsigned long)i];
+        XCTAssertEqual([index recordStoreForKey:key host:kAPIHost bytes:4 * 1024 quotaPolicy:policy].count, 0);
+    }
+    for (NSUInteger i = 0; i < 10; i++) {
+        NSString *key = [NSString stringWithFormat:@"https://%@/assets/%lu.bin", kCDNHost, (unsigned long)i];
+        [index recordStoreForKey:key host:kCDNHost bytes:256 * 1024 quotaPolicy:policy];
+    }
+
+    for (NSUInteger i = 0; i < 20; i++) {
+        NSString *key = [NSString stringWithFormat:@"https://%@/v1/items/%lu", kAPIHost, (unsigned long)i];
+        XCTAssertTrue([index containsKey:key], @"CDN大资源不应挤掉API的小响应");
+    }
+
+    EMASCurlCacheStatistics *statistics = [index statistics];
+    XCTAssertLessThanOrEqual(statistics.bytesByHost[kCDNHost].unsignedIntegerValue, 1024 * 1024);
+    XCTAssertEqual(statistics.bytesByHost[kAPIHost].unsignedIntegerValue, 20 * 4 * 1024);
+    XCTAssertEqual(statistics.evictionCountsByReason[EMASCurlCacheEvictionReasonHostQuota].unsignedIntegerValue, 6);
+    XCTAssertNil(statistics.evictionCountsByReason[EMASCurlCacheEvictionReasonConfigurationQuota]);
+}
+
+- (void)testTinyLFURejectsOneHitScan {
+    NSUInteger hotCount = 10;
+    NSArray *policies = @[@(EMASCurlCacheEvictionPolicyTinyLFU), @(EMASCurlCacheEvictionPolicyLRU)];
+    for (NSNumber *policyValue in policies) {
+        EMASCurlCacheIndex *index = [EMASCurlCacheIndex new];
+        EMASCurlCacheQuotaPolicy *policy = [[EMASCurlCacheQuotaPolicy alloc] initWithPartition:@"test"
+                                                                                evictionPolicy:policyValue.integerValue
+                                                                            partitionByteQuota:hotCount * 1024
+                                                                                 hostByteQuota:0
+                                                                        hostByteQuotaOverrides:nil];
+        for (NSUInteger i = 0; i < hotCount; i++) {
+            NSString *key = [NSString stringWithFormat:@"https://%@/hot/%lu", kAPIHost, (unsigned long)i];
+            [index recordStoreForKey:key host:kAPIHost bytes:1024 quotaPolicy:policy];
+            for (NSUInteger j = 0; j < 5; j++) {
+                [index recordLookupForKey:key hit:YES];
+            }
+        }
+
+        // 只访问一次的扫描流量
+        for (NSUInteger i = 0; i < 20; i++) {
+            NSString *key = [NSString stringWithFormat:@"https://%@/scan/%lu", kAPIHost, (unsigned long)i];
+            [index recordStoreForKey:key host:kAPIHost bytes:1024 quotaPolicy:policy];
+        }
+
+        NSUInteger retainedHot = 0;
+        for (NSUInteger i = 0; i < hotCount; i++) {
+            NSString *key = [NSString stringWithFormat:@"https://%@/hot/%lu", kAPIHost, (unsigned long)i];
+            retainedHot += [index containsKey:key] ? 1 : 0;
+        }
+
+        NSDictionary *evictions = [index statistics].evictionCountsByReason;
+        if (policyValue.integerValue == EMASCurlCacheEvictionPolicyTinyLFU) {
+            XCTAssertEqual(retainedHot, hotCount, @"TinyLFU应保留高频条目");
+            XCTAssertEqual([evictions[EMASCurlCacheEvictionReasonAdmissionRejected] unsignedIntegerValue], 20);
+        } else {
+            XCTAssertEqual(retainedHot, 0, @"LRU会被扫描流量冲掉");
+            XCTAssertNil(evictions[EMASCurlCacheEvictionReasonAdmissionRejected]);
+        }
+    }
+}
+
+- (void)testGDSFEvictsLargeColdObjectFirst {
+    EMASCurlCacheIndex *index = [EMASCurlCacheIndex new];
+    EMASCurlCacheQuotaPolicy *policy = [[EMASCurlCacheQuotaPolicy alloc] initWithPartition:@"test"
+                                                                            evictionPolicy:EMASCurlCacheEvictionPolicyGDSF
+                                                                        partitionByteQuota:100 * 1024
+                                                                             hostByteQuota:0
+                                                                    hostByteQuotaOverrides:nil];
+    NSString *largeKey = [NSString stringWithFormat:@"https://%@/assets/large.bin", kCDNHost];
+    [index recordStoreForKey:largeKey host:kCDNHost bytes:64 * 1024 quotaPolicy:policy];
+
+    NSMutableArray<NSString *> *evicted = [NSMutableArray array];
+    for (NSUInteger i = 0; i < 40; i++) {
+        NSString *key = [NSString stringWithFormat:@"https://%@/v1/items/%lu", kAPIHost, (unsigned long)i];
+        [evicted addObjectsFromArray:[index recordStoreForKey:key host:kAPIHost bytes:1024 quotaPolicy:policy]];
+    }
+
+    XCTAssertEqualObjects(evicted, @[largeKey]);
+    XCTAssertEqual([[index statistics].evictionCountsByReason[EMASCurlCacheEvictionReasonConfigurationQuota] unsignedIntegerValue], 1);
+}
+
+// 重启后恢复的索引仍计入配额，并按上次运行的访问顺序淘汰
+- (void)testIndexRestoredFromFileKeepsQuotaAndOrder {
+    EMASCurlCacheQuotaPolicy *policy = [[EMASCurlCacheQuotaPolicy alloc] initWithPartition:@"test"
+                                                                            evictionPolicy:EMASCurlCacheEvictionPolicyLRU
+                                                                        partitionByteQuota:4 * 1024
+                                                                             hostByteQuota:0
+                                                                    hostByteQuotaOverrides:nil];
+    NSString *(^keyAtIndex)(NSUInteger) = ^NSString *(NSUInteger i) {
+        return [NSString stringWithFormat:@"https://%@/v1/items/%lu", kAPIHost, (unsigned long)i];
+    };
+
+    EMASCurlCacheIndex *index = [EMASCurlCacheIndex new];
+    for (NSUInteger i = 0; i < 4; i++) {
+        [index recordStoreForKey:keyAtIndex(i) host:kAPIHost bytes:1024 quotaPolicy:policy];
+    }
+    // 访问过的第0项不再是最久未访问的条目
+    [index recordLookupForKey:keyAtIndex(0) hit:YES];
+
+    NSString *path = [NSTemporaryDirectory() stringByAppendingPathComponent:[NSUUID UUID].UUIDString];
+    XCTAssertTrue([index writeToFile:path]);
+    EMASCurlCacheIndex *restored = [EMASCurlCacheIndex indexWithContentsOfFile:path];
+    [[NSFileManager defaultManager] removeItemAtPath:path error:nil];
+
+    for (NSUInteger i = 0; i < 4; i++) {
+        XCTAssertTrue([restored containsKey:keyAtIndex(i)]);
+    }
+    XCTAssertEqual([restored statistics].bytesByHost[kAPIHost].unsignedIntegerValue, 4 * 1024);
+
+    NSArray<NSString *> *evicted = [restored recordStoreForKey:keyAtIndex(4) host:kAPIHost bytes:1024 quotaPolicy:policy];
+    XCTAssertEqualObjects(evicted, @[keyAtIndex(1)]);
+}
+
+- (void)testIndexFromMissingOrCorruptFileIsEmpty {
+    NSString *path = [NSTemporaryDirectory() stringByAppendingPathComponent:[NSUUID UUID].UUIDString];
+    XCTAssertEqual([[EMASCurlCacheIndex indexWithContentsOfFile:path] allKeys].count, 0);
+
+    [[@"not json" dataUsingEncoding:NSUTF8StringEncoding] writeToFile:path atomically:YES];
+    XCTAssertEqual([[EMASCurlCacheIndex indexWithContentsOfFile:path] allKeys].count, 0);
+    [[NSFileManager defaultManager] removeItemAtPath:path error:nil];
+}
+
+- (void)testPolicyFromConfiguration {
+    EMASCurlConfiguration *config = [EMASCurlConfiguration defaultConfiguration];
+    XCTAssertNil([EMASCurlCacheQuotaPolicy policyWithConfiguration:config partition:@"default"], @"默认不启用淘汰策略");
+
+    config.cacheEvictionPolicy = EMASCurlCacheEvictionPolicyGDSF;
+    config.cacheHostByteQuota = 1024;
+    config.cacheHostByteQuotaOverrides = @{kCDNHost: @(4096)};
+    EMASCurlCacheQuotaPolicy *policy = [EMASCurlCacheQuotaPolicy policyWithConfiguration:config partition:@"default"];
+    XCTAssertEqual(policy.evictionPolicy, EMASCurlCacheEvictionPolicyGDSF);
+    XCTAssertEqual([policy byteQuotaForHost:@"CDN.example.com"], 4096);
+    XCTAssertEqual([policy byteQuotaForHost:kAPIHost], 1024);
+}
+
+#pragma mark - 轨迹回放基准
+
+- (void)testTraceReplayHitRatios {
+    NSArray<EMASCurlCacheTraceRecord *> *trace = [self generateTrace];
+    NSDictionary<NSString *, NSNumber *> *policies = @{
+        @"LRU": @(EMASCurlCacheEvictionPolicyLRU),
+        @"TinyLFU": @(EMASCurlCacheEvictionPolicyTinyLFU),
+        @"GDSF": @(EMASCurlCacheEvictionPolicyGDSF),
+    };
+
+    for (NSString *name in @[@"LRU", @"TinyLFU", @"GDSF"]) {
+        EMASCurlCacheStatistics *statistics = nil;
+        NSArray<NSNumber *> *ratios = [self replayTrace:trace
+                                             withPolicy:[self tracePolicy:policies[name].integerValue]
+                                             statistics:&statistics];
+        NSLog(@"[%@] hit ratio: %.4f, byte hit ratio: %.4f, evictions: %@",
+              name, ratios[0].doubleValue, ratios[1].doubleValue, statistics.evictionCountsByReason);
+
+        XCTAssertGreaterThan(ratios[0].doubleValue, 0);
+        XCTAssertLessThan(ratios[0].doubleValue, 1);
+        XCTAssertEqualWithAccuracy(statistics.hitRatio, ratios[0].doubleValue, 1e-9);
+        NSUInteger totalBytes = statistics.bytesByHost[kCDNHost].unsignedIntegerValue + statistics.bytesByHost[kAPIHost].unsignedIntegerValue;
+        XCTAssertLessThanOrEqual(totalBytes, kTraceCacheQuota);
+    }
+}
+
+- (void)testTraceReplayPerformanceLRU {
+    NSArray<EMASCurlCacheTraceRecord *> *trace = [self generateTrace];
+    [self measureBlock:^{
+        [self replayTrace:trace withPolicy:[self tracePolicy:EMASCurlCacheEvictionPolicyLRU] statistics:NULL];
+    }];
+}
+
+- (void)testTraceReplayPerformanceTinyLFU {
+    NSArray<EMASCurlCacheTraceRecord *> *trace = [self generateTrace];
+    [self measureBlock:^{
+        [self replayTrace:trace withPolicy:[self tracePolicy:EMASCurlCacheEvictionPolicyTinyLFU] statistics:NULL];
+    }];
+}
+
+- (void)testTraceReplayPerformanceGDSF {
+    NSArray<EMASCurlCacheTraceRecord *> *trace = [self generateTrace];
+    [self measureBlock:^{
+        [self replayTrace:trace withPolicy:[self tracePolicy:EMASCurlCacheEvictionPolicyGDSF] statistics:NULL];
+    }];
+}
+
+@end
@@ -0,0 +1,128 @@
+//
+//  EMASCurlCacheSeedPackTest.m
+//  EMASCurlTests
+//
+//  Created by xuyecan on 2026/10/18.
+//
+
+#import <XCTest/XCTest.h>
+#import <EMASCurl/EMASCurl.h>
+#import "EMASCurlTestConstants.h"
+
+@interface EMASCurlCacheSeedPackTest : XCTestCase
+
+@property (nonatomic, strong) NSURLSession *session;
+@property (nonatomic, copy) NSString *packPath;
+
+@end
+
+@implementation EMASCurlCacheSeedPackTest
+
+- (void)setUp {
+    [super setUp];
+    [EMASCurlProtocol setLogLevel:EMASCurlLogLevelError];
+    [[NSURLCache sharedURLCache] removeAllCachedResponses];
+
+    EMASCurlConfiguration *curlConfig = [EMASCurlConfiguration defaultConfiguration];
+    curlConfig.httpVersion = HTTP1;
+
+    NSURLSessionConfiguration *config = [NSURLSessionConfiguration defaultSessionConfiguration];
+    [EMASCurlProtocol installIntoSessionConfiguration:config withConfiguration:curlConfig];
+    self.session = [NSURLSession sessionWithConfiguration:config delegate:nil delegateQueue:nil];
+
+    self.packPath = [NSTemporaryDirectory() stringByAppendingPathComponent:[NSString stringWithFormat:@"%@.pack", [NSUUID UUID].UUIDString]];
+}
+
+- (void)tearDown {
+    [EMASCurlProtocol setGlobalTransactionMetricsObserverBlock:nil];
+    [[NSFileManager defaultManager] removeItemAtPath:self.packPath error:nil];
+    [self.session invalidateAndCancel];
+    self.session = nil;
+    [super tearDown];
+}
+
+// 服务端不存在该路径，只有预置包能应答200
+- (NSURL *)seededURL {
+    return [NSURL URLWithString:[NSString stringWithFormat:@"%@/cache/seeded/%@", HTTP11_ENDPOINT, [NSUUID UUID].UUIDString]];
+}
+
+- (NSData *)seedBody {
+    NSMutableData *body = [NSMutableData dataWithLength:32 * 1024];
+    uint8_t *bytes = body.mutableBytes;
+    for (NSUInteger i = 0; i < body.length; i++) {
+        bytes[i] = (uint8_t)(i % 241);
+    }
+    return body;
+}
+
+- (NSData *)fetchURL:(NSURL *)url statusCode:(NSInteger *)statusCode servedFromNetwork:(BOOL *)servedFromNetwork {
+    __block BOOL usedNetwork = NO;
+    [EMASCurlProtocol setGlobalTransactionMetricsObserverBlock:^(NSURLRequest *request, BOOL success, NSError *error, EMASCurlTransactionMetrics *metrics) {
+        if (metrics.connectStartDate != nil || metrics.requestStartDate != nil) {
+            usedNetwork = YES;
+        }
+    }];
+
+    __block NSData *body = nil;
+    __block NSInteger code = 0;
+    XCTestExpectation *exp = [self expectationWithDescription:@"fetch"];
+    [[self.session dataTaskWithURL:url completionHandler:^(NSData *data, NSURLResponse *response, NSError *error) {
+        XCTAssertNil(error);
+        body = data;
+        code = ((NSHTTPURLResponse *)response).statusCode;
+        [exp fulfill];
+    }] resume];
+    [self waitForExpectations:@[exp] timeout:5.0];
+
+    [EMASCurlProtocol setGlobalTransactionMetricsObserverBlock:nil];
+    *statusCode = code;
+    *servedFromNetwork = usedNetwork;
+    return body;
+}
+
+- (void)testSeedPackServesEntryWithoutNetwork {
+    NSURL *url = [self seededURL];
+    NSData *seedBody = [self seedBody];
+    EMASCurlCacheSeedEntry *entry = [EMASCurlCacheSeedEntry entryWithURL:url
+                                                            headerFields:@{@"Cache-Control": @"max-age=3600",
+                                                                           @"Content-Type": @"application/octet-stream"}
+                                                                    body:seedBody];
+    XCTAssertTrue([EMASCurlProtocol writeCacheSeedPackWithEntries:@[entry] toPath:self.packPath]);
+    XCTAssertTrue([EMASCurlProtocol addCacheSeedPackAtPath:self.packPath]);
+
+    NSInteger statusCode = 0;
+    BOOL servedFromNetwork = YES;
+    NSData *body = [self fetchURL:url statusCode:&statusCode servedFromNetwork:&servedFromNetwork];
+    XCTAssertEqual(statusCode, 200);
+    XCTAssertFalse(servedFromNetwork, @"预置包中的新鲜条目应直接命中");
+    XCTAssertEqualObjects(body, seedBody);
+}
+
+// 响应体损坏的条目在首次查找时校验失败，请求回落到网络
+- (void)testCorruptedSeedEntryFallsBackToNetwork {
+    NSURL *url = [self seededURL];
+    EMASCurlCacheSeedEntry *entry = [EMASCurlCacheSeedEntry entryWithURL:url
+                                                            headerFields:@{@"Cache-Control": @"max-age=3600"}
+                                                                    body:[self seedBody]];
+    XCTAssertTrue([EMASCurlProtocol writeCacheSeedPackWithEntries:@[entry] toPath:self.packPath]);
+
+    NSFileHandle *handle = [NSFileHandle fileHandleForUpdatingAtPath:self.packPath];
+    [handle seekToFileOffset:[handle seekToEndOfFile] - 40 - 1024];
+    [handle writeData:[@"corrupted" dataUsingEncoding:NSUTF8StringEncoding]];
+    [handle closeFile];
+    XCTAssertTrue([EMASCurlProtocol addCacheSeedPackAtPath:self.packPath], @"打开时只校验文件头与索引");
+
+    NSInteger statusCode = 0;
+    BOOL servedFromNetwork = NO;
+    [self fetchURL:url statusCode:&statusCode servedFromNetwork:&servedFromNetwork];
+    XCTAssertTrue(servedFromNetwork);
+    XCTAssertEqual(statusCode, 404);
+}
+
+- (void)testInvalidPackIsRejected {
+    [[@"not a seed pack" dataUsingEncoding:NSUTF8StringEncoding] writeToFile:self.packPath atomically:YES];
+    XCTAssertFalse([EMASCurlProtocol addCacheSeedPackAtPath:self.packPath]);
+    XCTAssertFalse([EMASCurlProtocol addCacheSeedPackAtPath:[self.packPath stringByAppendingString:@".missing"]]);
+}
+
+@end
@@ -9,6 +9,28 @@
 #import <EMASCurl/EMASCurl.h>
 #import "EMASCurlTestConstants.h"
 
+// 统计数据回调次数，用于验证缓存命中时分块交付
+@interface EMASCurlCacheChunkCountingDelegate : NSObject <NSURLSessionDataDelegate>
+@property (nonatomic, strong) NSMutableData *body;
+@property (nonatomic, assign) NSUInteger chunkCount;
+@property (nonatomic, strong, nullable) NSError *error;
+@property (nonatomic, strong) XCTestExpectation *expectation;
+@end
+
+@implementation EMASCurlCacheChunkCountingDelegate
+
+- (void)URLSession:(NSURLSession *)session dataTask:(NSURLSessionDataTask *)dataTask didReceiveData:(NSData *)data {
+    [self.body appendData:data];
+    self.chunkCount += 1;
+}
+
+- (void)URLSession:(NSURLSession *)session task:(NSURLSessionTask *)task didCompleteWithError:(NSError *)error {
+    self.error = error;
+    [self.expectation fulfill];
+}
+
+@end
+
 @interface EMASCurlCacheTestBase : XCTestCase
 @property (nonatomic, strong) NSURLSession *session;
 @end
@@ -20,6 +42,70 @@
     [[NSURLCache sharedURLCache] removeAllCachedResponses];
 }
 
+- (NSData *)fetchURL:(NSURL *)url range:(NSString *)range response:(NSHTTPURLResponse **)outResponse {
+    NSMutableURLRequest *request = [NSMutableURLRequest requestWithURL:url];
+    request.HTTPMethod = @"GET";
+    [request setValue:range forHTTPHeaderField:@"Range"];
+
+    __block NSData *body = nil;
+    __block NSHTTPURLResponse *httpResponse = nil;
+    XCTestExpectation *exp = [self expectationWithDescription:[NSString stringWithFormat:@"fetch %@", range]];
+    NSURLSessionDataTask *task = [self.session dataTaskWithRequest:request completionHandler:^(NSData *data, NSURLResponse *response, NSError *error) {
+        XCTAssertNil(error);
+        body = data;
+        httpResponse = (NSHTTPURLResponse *)response;
+        [exp fulfill];
+    }];
+    [task resume];
+    [self waitForExpectations:@[exp] timeout:5.0];
+
+    if (outResponse) {
+        *outResponse = httpResponse;
+    }
+    return body;
+}
+
+- (void)assertRangeData:(NSData *)data startsAt:(NSUInteger)offset length:(NSUInteger)length {
+    XCTAssertEqual(data.length, length, @"区间数据长度不符");
+    const uint8_t *bytes = data.bytes;
+    for (NSUInteger i = 0; i < MIN(data.length, length); i++) {
+        if (bytes[i] != (uint8_t)((offset + i) % 256)) {
+            XCTFail(@"区间数据在偏移%lu处内容错误", (unsigned long)(offset + i));
+            return;
+        }
+    }
+}
+
+// 先缓存前512字节，再请求前1024字节时只应从网络获取缺失的后半段，最后落在已缓存区间内的请求应直接命中缓存
+- (void)runSparseRangeCacheTestWithEndpoint:(NSString *)endpoint {
+    NSURL *url = [NSURL URLWithString:[NSString stringWithFormat:@"%@%@", endpoint, PATH_CACHE_RANGE]];
+
+    NSHTTPURLResponse *response = nil;
+    NSData *data = [self fetchURL:url range:@"bytes=0-511" response:&response];
+    XCTAssertEqual(response.statusCode, 206);
+    [self assertRangeData:data startsAt:0 length:512];
+
+    data = [self fetchURL:url range:@"bytes=0-1023" response:&response];
+    XCTAssertEqual(response.statusCode, 206);
+    XCTAssertEqualObjects([response valueForHTTPHeaderField:@"X-Received-Range"], @"bytes=512-1023", @"应只从网络获取缓存缺失的区间");
+    XCTAssertEqualObjects([response valueForHTTPHeaderField:@"Content-Range"], @"bytes 0-1023/65536");
+    [self assertRangeData:data startsAt:0 length:1024];
+
+    __block BOOL servedFromNetwork = NO;
+    [EMASCurlProtocol setGlobalTransactionMetricsObserverBlock:^(NSURLRequest * _Nonnull req, BOOL success, NSError * _Nullable error, EMASCurlTransactionMetrics * _Nonnull metrics) {
+        if (metrics.connectStartDate != nil || metrics.requestStartDate != nil) {
+            servedFromNetwork = YES;
+        }
+    }];
+    data = [self fetchURL:url range:@"bytes=100-900" response:&response];
+    [EMASCurlProtocol setGlobalTransactionMetricsObserverBlock:nil];
+
+    XCTAssertEqual(response.statusCode, 206);
+    XCTAssertEqualObjects([response valueForHTTPHeaderField:@"Content-Range"], @"bytes 100-900/65536");
+    XCTAssertFalse(servedFromNetwork, @"已缓存区间内的Range请求应直接命中稀疏缓存");
+    [self assertRangeData:data startsAt:100 length:801];
+}
+
 @end
 
 @interface EMASCurlCacheTestHttp11 : EMASCurlCacheTestBase
@@ -185,6 +271,122 @@
     XCTAssertNotNil(cached, @"410响应应被缓存（带Cache-Control: max-age）");
 }
 
+- (void)testRangeRequestsMergeIntoSparseCache {
+    [self runSparseRangeCacheTestWithEndpoint:HTTP11_ENDPOINT];
+}
+
+// 按Content-Type压缩存储的缓存体应更小，命中时解压得到与网络响应一致的数据
+- (void)testCompressedCacheBodyDecodesOnHit {
+    EMASCurlConfiguration *curlConfig = [EMASCurlConfiguration defaultConfiguration];
+    curlConfig.httpVersion = HTTP1;
+    curlConfig.cacheCompressionAlgorithms = @{@"application/json": @(EMASCurlCacheCompressionLZ4)};
+
+    NSURLSessionConfiguration *config = [NSURLSessionConfiguration defaultSessionConfiguration];
+    [EMASCurlProtocol installIntoSessionConfiguration:config withConfiguration:curlConfig];
+    NSURLSession *session = [NSURLSession sessionWithConfiguration:config delegate:nil delegateQueue:nil];
+
+    NSURL *url = [NSURL URLWithString:[NSString stringWithFormat:@"%@%@", HTTP11_ENDPOINT, PATH_CACHE_COMPRESSIBLE]];
+    NSURLRequest *request = [NSURLRequest requestWithURL:url];
+
+    NSUInteger compressedBefore = [EMASCurlProtocol cacheCompressionStatistics].compressedEntryCount;
+
+    __block NSData *networkBody = nil;
+    XCTestExpectation *firstExp = [self expectationWithDescription:@"fetch from network"];
+    [[session dataTaskWithRequest:request completionHandler:^(NSData *data, NSURLResponse *response, NSError *error) {
+        XCTAssertNil(error);
+        XCTAssertEqual(((NSHTTPURLResponse *)response).statusCode, 200);
+        networkBody = data;
+        [firstExp fulfill];
+    }] resume];
+    [self waitForExpectations:@[firstExp] timeout:5.0];
+
+    EMASCurlCacheCompressionStatistics *stored = [EMASCurlProtocol cacheCompressionStatistics];
+    XCTAssertEqual(stored.compressedEntryCount, compressedBefore + 1, @"JSON响应体应压缩存储");
+    XCTAssertLessThan(stored.compressedBytes, stored.originalBytes, @"压缩存储的响应体应小于原始数据");
+    // 直接读取NSURLCache的调用方不应拿到压缩后的数据
+    XCTAssertNil([[NSURLCache sharedURLCache] cachedResponseForRequest:request]);
+
+    NSUInteger decodedBefore = [EMASCurlProtocol cacheCompressionStatistics].decodedEntryCount;
+
+    XCTestExpectation *secondExp = [self expectationWithDescription:@"fetch from cache"];
+    [[session dataTaskWithRequest:request completionHandler:^(NSData *data, NSURLResponse *response, NSError *error) {
+        XCTAssertNil(error);
+        XCTAssertEqualObjects(data, networkBody, @"命中时解压后的数据应与网络响应一致");
+        [secondExp fulfill];
+    }] resume];
+    [self waitForExpectations:@[secondExp] timeout:5.0];
+
+    EMASCurlCacheCompressionStatistics *statistics = [EMASCurlProtocol cacheCompressionStatistics];
+    XCTAssertEqual(statistics.decodedEntryCount, decodedBefore + 1, @"命中压缩条目时应记录一次解压");
+    XCTAssertGreaterThan(statistics.compressionRatio, 1.0);
+}
+
+// 大响应体存放在独立文件中，命中时应分多块交付且数据与网络响应一致
+- (void)testLargeCacheBodyServedFromFileInChunks {
+    EMASCurlConfiguration *curlConfig = [EMASCurlConfiguration defaultConfiguration];
+    curlConfig.httpVersion = HTTP1;
+
+    NSURLSessionConfiguration *config = [NSURLSessionConfiguration defaultSessionConfiguration];
+    [EMASCurlProtocol installIntoSessionConfiguration:config withConfiguration:curlConfig];
+    EMASCurlCacheChunkCountingDelegate *delegate = [EMASCurlCacheChunkCountingDelegate new];
+    NSURLSession *session = [NSURLSession sessionWithConfiguration:config delegate:delegate delegateQueue:nil];
+
+    NSURL *url = [NSURL URLWithString:[NSString stringWithFormat:@"%@%@", HTTP11_ENDPOINT, PATH_CACHE_LARGE]];
+    NSURLRequest *request = [NSURLRequest requestWithURL:url];
+
+    delegate.body = [NSMutableData data];
+    delegate.expectation = [self expectationWithDescription:@"fetch from network"];
+    [[session dataTaskWithRequest:request] resume];
+    [self waitForExpectations:@[delegate.expectation] timeout:10.0];
+    XCTAssertNil(delegate.error);
+    NSData *networkBody = [delegate.body copy];
+    XCTAssertEqual(networkBody.length, 2 * 1024 * 1024);
+
+    // 只有元数据写入NSURLCache，且不以原始URL存储，直接读取NSURLCache的调用方不会拿到空响应体
+    XCTAssertNil([[NSURLCache sharedURLCache] cachedResponseForRequest:request]);
+
+    delegate.body = [NSMutableData data];
+    delegate.chunkCount = 0;
+    delegate.expectation = [self expectationWithDescription:@"fetch from cache"];
+    [[session dataTaskWithRequest:request] resume];
+    [self waitForExpectations:@[delegate.expectation] timeout:10.0];
+    XCTAssertNil(delegate.error);
+    XCTAssertEqualObjects(delegate.body, networkBody, @"命中时交付的数据应与网络响应一致");
+    XCTAssertGreaterThan(delegate.chunkCount, 1, @"大响应体应分块交付");
+
+    [session invalidateAndCancel];
+}
+
+// 清空缓存时一并删除独立存放的响应体文件
+- (void)testRemoveAllCachedResponsesDeletesBodyFiles {
+    EMASCurlConfiguration *curlConfig = [EMASCurlConfiguration defaultConfiguration];
+    curlConfig.httpVersion = HTTP1;
+
+    NSURLSessionConfiguration *config = [NSURLSessionConfiguration defaultSessionConfiguration];
+    [EMASCurlProtocol installIntoSessionConfiguration:config withConfiguration:curlConfig];
+    NSURLSession *session = [NSURLSession sessionWithConfiguration:config delegate:nil delegateQueue:nil];
+
+    NSURL *url = [NSURL URLWithString:[NSString stringWithFormat:@"%@%@", HTTP11_ENDPOINT, PATH_CACHE_LARGE]];
+    NSURLRequest *request = [NSURLRequest requestWithURL:url];
+
+    XCTestExpectation *exp = [self expectationWithDescription:@"fetch from network"];
+    [[session dataTaskWithRequest:request completionHandler:^(NSData *data, NSURLResponse *response, NSError *error) {
+        XCTAssertNil(error);
+        [exp fulfill];
+    }] resume];
+    [self waitForExpectations:@[exp] timeout:10.0];
+
+    NSString *cachesDirectory = NSSearchPathForDirectoriesInDomains(NSCachesDirectory, NSUserDomainMask, YES).firstObject;
+    NSString *bodyDirectory = [cachesDirectory stringByAppendingPathComponent:@"com.alicloud.emascurl/CacheBodies"];
+    XCTAssertGreaterThan([[NSFileManager defaultManager] contentsOfDirectoryAtPath:bodyDirectory error:nil].count, 0);
+
+    [EMASCurlProtocol removeAllCachedResponses];
+    XCTAssertEqual([[NSFileManager defaultManager] contentsOfDirectoryAtPath:bodyDirectory error:nil].count, 0, @"响应体文件应被删除");
+    XCTAssertNil([[NSURLCache sharedURLCache] cachedResponseForRequest:request]);
+
+    [session invalidateAndCancel];
+}
+
 @end
 
 @interface EMASCurlCacheTestHttp2 : EMASCurlCacheTestBase
@@ -256,4 +458,8 @@
     [self waitForExpectations:@[exp] timeout:5.0];
 }
 
+- (void)testRangeRequestsMergeIntoSparseCache {
+    [self runSparseRangeCacheTestWithEndpoint:HTTP2_ENDPOINT];
+}
+
 @end
@@ -53,6 +53,16 @@
     // 验证域名过滤
     XCTAssertNil(defaultConfig.domainWhiteList, @"默认域名白名单应该为nil");
     XCTAssertNil(defaultConfig.domainBlackList, @"默认域名黑名单应该为nil");
+
+    // 验证进度回调设置
+    XCTAssertEqual(defaultConfig.progressReportInterval, 0.1, @"默认进度回调间隔应该是0.1秒");
+    XCTAssertEqual(defaultConfig.progressReportByteDelta, 0, @"默认不按字节数触发进度回调");
+    XCTAssertNil(defaultConfig.progressCallbackQueue, @"默认进度回调队列应该为nil");
+
+    // 验证网络质量自适应默认关闭
+    XCTAssertFalse(defaultConfig.adaptiveConnectTimeoutEnabled, @"默认不自适应连接超时");
+    XCTAssertFalse(defaultConfig.adaptiveHostConcurrencyEnabled, @"默认不限制host并发");
+    XCTAssertFalse(defaultConfig.adaptivePrefetchGatingEnabled, @"默认不推迟后台请求");
 }
 
 - (void)testConfigurationCopy {
@@ -0,0 +1,69 @@
+//
+//  EMASCurlConnectionPoolTest.m
+//  EMASCurlTests
+//
+//  Created by xuyecan on 2026/10/18.
+//
+
+#import <XCTest/XCTest.h>
+#import <EMASCurl/EMASCurl.h>
+#import "EMASCurlManager.h"
+#import "EMASCurlTestConstants.h"
+
+@interface EMASCurlConnectionPoolTest : XCTestCase
+@property (nonatomic, strong) NSURLSession *session;
+@end
+
+@implementation EMASCurlConnectionPoolTest
+
+- (void)setUp {
+    [super setUp];
+    NSURLSessionConfiguration *config = [NSURLSessionConfiguration defaultSessionConfiguration];
+    EMASCurlConfiguration *curlConfig = [EMASCurlConfiguration defaultConfiguration];
+    curlConfig.httpVersion = HTTP1;
+    [EMASCurlProtocol installIntoSessionConfiguration:config withConfiguration:curlConfig];
+    self.session = [NSURLSession sessionWithConfiguration:config];
+}
+
+- (void)sendEchoRequest {
+    XCTestExpectation *expectation = [self expectationWithDescription:@"request"];
+    NSURL *url = [NSURL URLWithString:[HTTP11_ENDPOINT stringByAppendingString:PATH_ECHO]];
+    [[self.session dataTaskWithURL:url completionHandler:^(NSData *data, NSURLResponse *response, NSError *error) {
+        XCTAssertNil(error);
+        [expectation fulfill];
+    }] resume];
+    [self waitForExpectations:@[expectation] timeout:10];
+}
+
+// 顺序发出的HTTP/1.1请求复用同一连接，结束后连接留在缓存中空闲
+- (void)testSequentialRequestsReuseConnection {
+    [self sendEchoRequest];
+    [self sendEchoRequest];
+
+    NSString *host = [NSURL URLWithString:HTTP11_ENDPOINT].host;
+    NSPredicate *predicate = [NSPredicate predicateWithFormat:@"host == %@ AND reuseCount > 0", host];
+    EMASCurlConnectionInfo *connection = [[[EMASCurlProtocol connectionPoolSnapshot] filteredArrayUsingPredicate:predicate] firstObject];
+    XCTAssertNotNil(connection);
+    XCTAssertEqualObjects(connection.protocolName, @"http/1.1");
+    XCTAssertEqual(connection.activeStreams, 0);
+    XCTAssertEqual(connection.remotePort, [NSURL URLWithString:HTTP11_ENDPOINT].port.integerValue);
+    XCTAssertGreaterThan(connection.localPort, 0);
+    XCTAssertGreaterThan(connection.bytesSent, 0);
+    XCTAssertGreaterThan(connection.bytesReceived, 0);
+    XCTAssertGreaterThanOrEqual(connection.age, connection.idleTime);
+}
+
+// 在网络线程上取快照不会死锁
+- (void)testSnapshotOnNetworkThread {
+    [self sendEchoRequest];
+
+    XCTestExpectation *expectation = [self expectationWithDescription:@"snapshot"];
+    [[EMASCurlManager sharedInstance] connectionPoolSnapshotWithCompletion:^(NSArray<EMASCurlConnectionInfo *> *connections) {
+        XCTAssertGreaterThan(connections.count, 0);
+        XCTAssertEqual([[EMASCurlManager sharedInstance] connectionPoolSnapshot].count, connections.count);
+        [expectation fulfill];
+    }];
+    [self waitForExpectations:@[expectation] timeout:5];
+}
+
+@end
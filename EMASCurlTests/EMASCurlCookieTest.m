@@ -8,6 +8,11 @@
 #import <XCTest/XCTest.h>
 #import <EMASCurl/EMASCurl.h>
 #import "EMASCurlTestConstants.h"
+#import "EMASCurlCookieStorage.h"
+
+@interface EMASCurlCookieStorage (Testing)
+@property (nonatomic, readonly) NSUInteger reloadCount;
+@end
 
 @interface EMASCurlCookieTest : XCTestCase
 
@@ -92,4 +97,135 @@
     XCTAssertTrue(cookieValid, @"Cookie validation failed");
 }
 
+#pragma mark - 内存索引
+
+- (NSString *)uniqueHostWithSuffix:(NSString *)suffix {
+    return [NSString stringWithFormat:@"h%@.%@", [[NSUUID UUID].UUIDString substringToIndex:8].lowercaseString, suffix];
+}
+
+// 写入后立即可读，持久化在后台批量完成
+- (void)testJarServesCookiesBeforePersistence {
+    EMASCurlCookieStorage *jar = [EMASCurlCookieStorage sharedStorage];
+    NSURL *url = [NSURL URLWithString:[NSString stringWithFormat:@"https://%@/page", [self uniqueHostWithSuffix:@"jar.test"]]];
+    [jar setCookieWithString:@"session=abc; Path=/" forURL:url];
+    XCTAssertEqualObjects([jar cookieStringForURL:url], @"session=abc");
+
+    [jar flushPendingCookies];
+    NSArray<NSHTTPCookie *> *stored = [[NSHTTPCookieStorage sharedHTTPCookieStorage] cookiesForURL:url];
+    XCTAssertEqual(stored.count, 1);
+    XCTAssertEqualObjects(stored.firstObject.value, @"abc");
+}
+
+- (void)testJarDomainPathAndSecureMatching {
+    EMASCurlCookieStorage *jar = [EMASCurlCookieStorage sharedStorage];
+    NSString *domain = [self uniqueHostWithSuffix:@"jar.test"];
+    NSURL *origin = [NSURL URLWithString:[NSString stringWithFormat:@"https://www.%@/api/v1/list", domain]];
+    [jar setCookieWithString:[NSString stringWithFormat:@"shared=1; Domain=%@; Path=/", domain] forURL:origin];
+    [jar setCookieWithString:@"api=2; Path=/api" forURL:origin];
+    [jar setCookieWithString:@"token=3; Path=/api/v1; Secure" forURL:origin];
+
+    // 路径更长的cookie在前，Secure cookie只随https发送
+    NSURL *secureURL = [NSURL URLWithString:[NSString stringWithFormat:@"https://www.%@/api/v1/detail", domain]];
+    XCTAssertEqualObjects([jar cookieStringForURL:secureURL], @"token=3; api=2; shared=1");
+    NSURL *plainURL = [NSURL URLWithString:[NSString stringWithFormat:@"http://www.%@/api/v1/detail", domain]];
+    XCTAssertEqualObjects([jar cookieStringForURL:plainURL], @"api=2; shared=1");
+
+    // 路径按段匹配，"/api"不匹配"/apis"
+    NSURL *siblingURL = [NSURL URLWithString:[NSString stringWithFormat:@"https://www.%@/apis", domain]];
+    XCTAssertEqualObjects([jar cookieStringForURL:siblingURL], @"shared=1");
+
+    // host-only的cookie不发往其他子域名
+    NSURL *otherHost = [NSURL URLWithString:[NSString stringWithFormat:@"https://img.%@/api/v1/detail", domain]];
+    XCTAssertEqualObjects([jar cookieStringForURL:otherHost], @"shared=1");
+}
+
+- (void)testJarReplacesAndExpiresCookies {
+    EMASCurlCookieStorage *jar = [EMASCurlCookieStorage sharedStorage];
+    NSURL *url = [NSURL URLWithString:[NSString stringWithFormat:@"https://%@/", [self uniqueHostWithSuffix:@"jar.test"]]];
+    [jar setCookieWithString:@"a=1; Path=/" forURL:url];
+    [jar setCookieWithString:@"b=2; Path=/" forURL:url];
+    [jar setCookieWithString:@"a=3; Path=/" forURL:url];
+    XCTAssertEqualObjects([jar cookieStringForURL:url], @"a=3; b=2");
+
+    [jar setCookieWithString:@"a=deleted; Path=/; Max-Age=0" forURL:url];
+    XCTAssertEqualObjects([jar cookieStringForURL:url], @"b=2");
+}
+
+// 外部直接删除NSHTTPCookieStorage中的cookie后，索引异步重建
+- (void)testJarReflectsExternalDeletion {
+    EMASCurlCookieStorage *jar = [EMASCurlCookieStorage sharedStorage];
+    NSURL *url = [NSURL URLWithString:[NSString stringWithFormat:@"https://%@/", [self uniqueHostWithSuffix:@"jar.test"]]];
+    [jar setCookieWithString:@"external=1; Path=/" forURL:url];
+    [jar flushPendingCookies];
+
+    NSHTTPCookieStorage *storage = [NSHTTPCookieStorage sharedHTTPCookieStorage];
+    for (NSHTTPCookie *cookie in [storage cookiesForURL:url]) {
+        [storage deleteCookie:cookie];
+    }
+
+    NSDate *deadline = [NSDate dateWithTimeIntervalSinceNow:2.0];
+    while ([jar cookieStringForURL:url] != nil && deadline.timeIntervalSinceNow > 0) {
+        [[NSRunLoop currentRunLoop] runUntilDate:[NSDate dateWithTimeIntervalSinceNow:0.05]];
+    }
+    XCTAssertNil([jar cookieStringForURL:url]);
+}
+
+// jar自身落盘引起的变更通知不触发索引重建
+- (void)testJarIgnoresOwnPersistNotifications {
+    EMASCurlCookieStorage *jar = [EMASCurlCookieStorage sharedStorage];
+    NSURL *url = [NSURL URLWithString:[NSString stringWithFormat:@"https://%@/", [self uniqueHostWithSuffix:@"jar.test"]]];
+    // 等待之前测试清理cookie引起的重建完成
+    [[NSRunLoop currentRunLoop] runUntilDate:[NSDate dateWithTimeIntervalSinceNow:0.3]];
+    NSUInteger reloadsBefore = jar.reloadCount;
+
+    for (int i = 0; i < 20; i++) {
+        [jar setCookieWithString:[NSString stringWithFormat:@"c%d=%d; Path=/", i, i] forURL:url];
+        [jar flushPendingCookies];
+    }
+    [[NSRunLoop currentRunLoop] runUntilDate:[NSDate dateWithTimeIntervalSinceNow:0.3]];
+
+    XCTAssertEqual(jar.reloadCount, reloadsBefore);
+    XCTAssertEqual([[NSHTTPCookieStorage sharedHTTPCookieStorage] cookiesForURL:url].count, 20);
+    XCTAssertTrue([[jar cookieStringForURL:url] hasPrefix:@"c0=0; c1=1"]);
+}
+
+// 与自身落盘同时发生的外部修改不会被当作自身写入忽略
+- (void)testJarReflectsExternalChangeDuringPersist {
+    EMASCurlCookieStorage *jar = [EMASCurlCookieStorage sharedStorage];
+    NSURL *url = [NSURL URLWithString:[NSString stringWithFormat:@"https://%@/", [self uniqueHostWithSuffix:@"jar.test"]]];
+    [jar setCookieWithString:@"external=1; Path=/" forURL:url];
+    [jar flushPendingCookies];
+
+    [jar setCookieWithString:@"own=1; Path=/" forURL:url];
+    NSHTTPCookieStorage *storage = [NSHTTPCookieStorage sharedHTTPCookieStorage];
+    for (NSHTTPCookie *cookie in [storage cookiesForURL:url]) {
+        [storage deleteCookie:cookie];
+    }
+    [jar flushPendingCookies];
+
+    NSDate *deadline = [NSDate dateWithTimeIntervalSinceNow:2.0];
+    while (![[jar cookieStringForURL:url] isEqualToString:@"own=1"] && deadline.timeIntervalSinceNow > 0) {
+        [[NSRunLoop currentRunLoop] runUntilDate:[NSDate dateWithTimeIntervalSinceNow:0.05]];
+    }
+    XCTAssertEqualObjects([jar cookieStringForURL:url], @"own=1");
+    XCTAssertEqual([storage cookiesForURL:url].count, 1);
+}
+
+- (void)testPerformanceJarLookup {
+    EMASCurlCookieStorage *jar = [EMASCurlCookieStorage sharedStorage];
+    NSString *domain = [self uniqueHostWithSuffix:@"jar.test"];
+    NSURL *origin = [NSURL URLWithString:[NSString stringWithFormat:@"https://www.%@/", domain]];
+    for (int i = 0; i < 20; i++) {
+        [jar setCookieWithString:[NSString stringWithFormat:@"c%d=%d; Domain=%@; Path=/p%d", i, i, domain, i % 4] forURL:origin];
+    }
+    NSURL *url = [NSURL URLWithString:[NSString stringWithFormat:@"https://www.%@/p1/detail", domain]];
+    [self measureBlock:^{
+        for (int i = 0; i < 10000; i++) {
+            @autoreleasepool {
+                (void)[jar cookieStringForURL:url];
+            }
+        }
+    }];
+}
+
 @end
@@ -140,6 +140,310 @@
     dispatch_semaphore_wait(semaphore, DISPATCH_TIME_FOREVER);
 }
 
+- (void)downloadDataWithProgressUpdateBlock:(NSString *)endpoint {
+    NSURL *url = [NSURL URLWithString:[NSString stringWithFormat:@"%@%@", endpoint, PATH_DOWNLOAD_1MB_DATA_AT_200KBPS_SPEED]];
+    NSMutableURLRequest *request = [NSMutableURLRequest requestWithURL:url];
+
+    __block int64_t sumOfBytesReceived = 0;
+    __block int64_t lastTotalBytesReceived = 0;
+    __block NSUInteger callbackCount = 0;
+    __block BOOL calledOnMainThread = NO;
+    [EMASCurlProtocol setDownloadProgressUpdateBlockForRequest:request downloadProgressUpdateBlock:^(NSURLRequest * _Nonnull request, int64_t bytesReceived, int64_t totalBytesReceived, int64_t totalBytesExpectedToReceive) {
+        sumOfBytesReceived += bytesReceived;
+        XCTAssertGreaterThanOrEqual(totalBytesReceived, lastTotalBytesReceived, @"Progress should increase monotonically");
+        lastTotalBytesReceived = totalBytesReceived;
+        // 流式响应没有Content-Length
+        XCTAssertEqual(totalBytesExpectedToReceive, -1);
+        calledOnMainThread = calledOnMainThread || [NSThread isMainThread];
+        callbackCount++;
+    }];
+
+    dispatch_semaphore_t semaphore = dispatch_semaphore_create(0);
+    [[self.session dataTaskWithRequest:request completionHandler:^(NSData *data, NSURLResponse *response, NSError *error) {
+        XCTAssertNil(error, @"Download failed with error: %@", error);
+        XCTAssertEqual([data length], 1024 * 1024, @"Expected 1MB of data");
+
+        // 默认队列上的进度回调先于完成回调交付
+        XCTAssertEqual(lastTotalBytesReceived, 1024 * 1024);
+        XCTAssertEqual(sumOfBytesReceived, 1024 * 1024);
+        XCTAssertGreaterThan(callbackCount, 0);
+        XCTAssertFalse(calledOnMainThread);
+
+        dispatch_semaphore_signal(semaphore);
+    }] resume];
+
+    XCTAssertEqual(dispatch_semaphore_wait(semaphore, dispatch_time(DISPATCH_TIME_NOW, 30 * NSEC_PER_SEC)), 0, @"Download request timed out");
+}
+
+- (NSURL *)temporaryDownloadURL {
+    NSString *fileName = [NSString stringWithFormat:@"download_test_%@.bin", [NSUUID UUID].UUIDString];
+    return [NSURL fileURLWithPath:[NSTemporaryDirectory() stringByAppendingPathComponent:fileName]];
+}
+
+- (void)downloadToFile:(NSString *)endpoint {
+    const NSUInteger size = 3 * 1024 * 1024 + 256;
+    NSURL *url = [NSURL URLWithString:[NSString stringWithFormat:@"%@%@/%lu", endpoint, PATH_DOWNLOAD_BYTES, (unsigned long)size]];
+    NSMutableURLRequest *request = [NSMutableURLRequest requestWithURL:url];
+
+    // 已存在的目标文件在下载成功后被整体替换
+    NSURL *destinationURL = [self temporaryDownloadURL];
+    [[@"stale content" dataUsingEncoding:NSUTF8StringEncoding] writeToURL:destinationURL atomically:YES];
+    [EMASCurlProtocol setDownloadDestinationFileURL:destinationURL forRequest:request];
+
+    __block int64_t lastTotalBytesReceived = 0;
+    __block int64_t expectedBytes = 0;
+    [EMASCurlProtocol setDownloadProgressUpdateBlockForRequest:request downloadProgressUpdateBlock:^(NSURLRequest * _Nonnull request, int64_t bytesReceived, int64_t totalBytesReceived, int64_t totalBytesExpectedToReceive) {
+        lastTotalBytesReceived = totalBytesReceived;
+        expectedBytes = totalBytesExpectedToReceive;
+    }];
+
+    dispatch_semaphore_t semaphore = dispatch_semaphore_create(0);
+    [[self.session dataTaskWithRequest:request completionHandler:^(NSData *data, NSURLResponse *response, NSError *error) {
+        XCTAssertNil(error, @"Download failed with error: %@", error);
+        XCTAssertEqual(((NSHTTPURLResponse *)response).statusCode, 200);
+        XCTAssertEqual(data.length, 0, @"Body should bypass the URL loading system");
+        XCTAssertEqual(lastTotalBytesReceived, (int64_t)size);
+        XCTAssertEqual(expectedBytes, (int64_t)size);
+        dispatch_semaphore_signal(semaphore);
+    }] resume];
+    XCTAssertEqual(dispatch_semaphore_wait(semaphore, dispatch_time(DISPATCH_TIME_NOW, 30 * NSEC_PER_SEC)), 0, @"Download request timed out");
+
+    [self verifyDownloadedFileAtURL:destinationURL size:size];
+    [[NSFileManager defaultManager] removeItemAtURL:destinationURL error:nil];
+}
+
+// 下载的文件内容为第i个字节等于i % 256，且替换后不残留临时文件
+- (void)verifyDownloadedFileAtURL:(NSURL *)destinationURL size:(NSUInteger)size {
+    NSData *fileData = [NSData dataWithContentsOfURL:destinationURL options:NSDataReadingMappedIfSafe error:nil];
+    XCTAssertEqual(fileData.length, size);
+    const uint8_t *bytes = fileData.bytes;
+    BOOL matches = YES;
+    for (NSUInteger i = 0; i < fileData.length && matches; i++) {
+        matches = (bytes[i] == (uint8_t)(i % 256));
+    }
+    XCTAssertTrue(matches, @"File content should match the response body");
+
+    NSArray<NSString *> *leftovers = [[[NSFileManager defaultManager] contentsOfDirectoryAtPath:NSTemporaryDirectory() error:nil]
+                                      filteredArrayUsingPredicate:[NSPredicate predicateWithFormat:@"SELF BEGINSWITH %@", [@"." stringByAppendingString:destinationURL.lastPathComponent]]];
+    XCTAssertEqual(leftovers.count, 0);
+}
+
+// 分段下载到文件，返回服务端为该次下载发出的206响应数
+- (NSInteger)segmentedDownloadToFile:(NSString *)endpoint query:(NSString *)query {
+    const NSUInteger size = 8 * 1024 * 1024 + 77;
+    NSString *tag = [NSUUID UUID].UUIDString;
+    NSURL *url = [NSURL URLWithString:[NSString stringWithFormat:@"%@%@/%lu?tag=%@%@", endpoint, PATH_DOWNLOAD_RANGED, (unsigned long)size, tag, query]];
+    NSMutableURLRequest *request = [NSMutableURLRequest requestWithURL:url];
+    NSURL *destinationURL = [self temporaryDownloadURL];
+    [EMASCurlProtocol setDownloadDestinationFileURL:destinationURL forRequest:request];
+    [EMASCurlProtocol setDownloadSegmentCount:4 forRequest:request];
+
+    __block int64_t lastTotalBytesReceived = 0;
+    [EMASCurlProtocol setDownloadProgressUpdateBlockForRequest:request downloadProgressUpdateBlock:^(NSURLRequest * _Nonnull request, int64_t bytesReceived, int64_t totalBytesReceived, int64_t totalBytesExpectedToReceive) {
+        lastTotalBytesReceived = totalBytesReceived;
+    }];
+
+    dispatch_semaphore_t semaphore = dispatch_semaphore_create(0);
+    [[self.session dataTaskWithRequest:request completionHandler:^(NSData *data, NSURLResponse *response, NSError *error) {
+        XCTAssertNil(error, @"Download failed with error: %@", error);
+        XCTAssertEqual(((NSHTTPURLResponse *)response).statusCode, 200);
+        XCTAssertEqual(data.length, 0);
+        XCTAssertEqual(lastTotalBytesReceived, (int64_t)size);
+        dispatch_semaphore_signal(semaphore);
+    }] resume];
+    XCTAssertEqual(dispatch_semaphore_wait(semaphore, dispatch_time(DISPATCH_TIME_NOW, 30 * NSEC_PER_SEC)), 0, @"Download request timed out");
+
+    [self verifyDownloadedFileAtURL:destinationURL size:size];
+    [[NSFileManager defaultManager] removeItemAtURL:destinationURL error:nil];
+    return [self partialResponsesForTag:tag endpoint:endpoint];
+}
+
+// 服务端按tag统计的206响应数
+- (NSInteger)partialResponsesForTag:(NSString *)tag endpoint:(NSString *)endpoint {
+    NSURL *statsURL = [NSURL URLWithString:[NSString stringWithFormat:@"%@%@/%@", endpoint, PATH_DOWNLOAD_RANGED_STATS, tag]];
+    dispatch_semaphore_t semaphore = dispatch_semaphore_create(0);
+    __block NSInteger partialResponses = -1;
+    [[self.session dataTaskWithURL:statsURL completionHandler:^(NSData *data, NSURLResponse *response, NSError *error) {
+        NSDictionary *stats = data ? [NSJSONSerialization JSONObjectWithData:data options:0 error:nil] : nil;
+        partialResponses = [stats[@"partial_responses"] integerValue];
+        dispatch_semaphore_signal(semaphore);
+    }] resume];
+    XCTAssertEqual(dispatch_semaphore_wait(semaphore, dispatch_time(DISPATCH_TIME_NOW, 10 * NSEC_PER_SEC)), 0, @"Stats request timed out");
+    return partialResponses;
+}
+
+- (void)segmentedDownload:(NSString *)endpoint {
+    NSInteger partialResponses = [self segmentedDownloadToFile:endpoint query:@""];
+    XCTAssertGreaterThanOrEqual(partialResponses, 3, @"Remaining segments should be fetched with range requests");
+}
+
+- (void)segmentedDownloadWithoutRangeSupport:(NSString *)endpoint {
+    NSInteger partialResponses = [self segmentedDownloadToFile:endpoint query:@"&ranges=false"];
+    XCTAssertEqual(partialResponses, 0);
+}
+
+- (void)segmentedDownloadWhenResourceChanges:(NSString *)endpoint {
+    // 每次ETag都不同，各段的If-Range校验失败，退回单连接下载
+    NSInteger partialResponses = [self segmentedDownloadToFile:endpoint query:@"&rotate_etag=true"];
+    XCTAssertEqual(partialResponses, 0);
+}
+
+// 第一次下载收到至少2MiB后取消，再次下载同一URL到同一目标；返回第二次下载服务端返回的206响应数
+- (NSInteger)resumableDownloadToFile:(NSString *)endpoint query:(NSString *)query resumedBytes:(int64_t *)resumedBytes {
+    const NSUInteger size = 6 * 1024 * 1024;
+    NSString *tag = [NSUUID UUID].UUIDString;
+    NSURL *url = [NSURL URLWithString:[NSString stringWithFormat:@"%@%@/%lu?tag=%@&chunk_delay_ms=200%@", endpoint, PATH_DOWNLOAD_RANGED, (unsigned long)size, tag, query]];
+    NSURL *destinationURL = [self temporaryDownloadURL];
+    NSString *recordPath = [destinationURL.path.stringByDeletingLastPathComponent stringByAppendingPathComponent:
+                            [NSString stringWithFormat:@".%@.emascurl-resume", destinationURL.lastPathComponent]];
+
+    NSMutableURLRequest *request = [NSMutableURLRequest requestWithURL:url];
+    [EMASCurlProtocol setDownloadDestinationFileURL:destinationURL forRequest:request];
+    [EMASCurlProtocol setDownloadResumable:YES forRequest:request];
+    dispatch_semaphore_t halfway = dispatch_semaphore_create(0);
+    __block BOOL reachedHalfway = NO;
+    [EMASCurlProtocol setDownloadProgressUpdateBlockForRequest:request downloadProgressUpdateBlock:^(NSURLRequest * _Nonnull request, int64_t bytesReceived, int64_t totalBytesReceived, int64_t totalBytesExpectedToReceive) {
+        if (!reachedHalfway && totalBytesReceived >= 2 * 1024 * 1024) {
+            reachedHalfway = YES;
+            dispatch_semaphore_signal(halfway);
+        }
+    }];
+
+    dispatch_semaphore_t semaphore = dispatch_semaphore_create(0);
+    NSURLSessionDataTask *task = [self.session dataTaskWithRequest:request completionHandler:^(NSData *data, NSURLResponse *response, NSError *error) {
+        XCTAssertEqual(error.code, NSURLErrorCancelled);
+        dispatch_semaphore_signal(semaphore);
+    }];
+    [task resume];
+    XCTAssertEqual(dispatch_semaphore_wait(halfway, dispatch_time(DISPATCH_TIME_NOW, 30 * NSEC_PER_SEC)), 0, @"Download did not make progress");
+    [task cancel];
+    XCTAssertEqual(dispatch_semaphore_wait(semaphore, dispatch_time(DISPATCH_TIME_NOW, 10 * NSEC_PER_SEC)), 0, @"Cancel timed out");
+
+    // 取消后已下载的数据落盘并写入续传记录
+    NSDate *deadline = [NSDate dateWithTimeIntervalSinceNow:5];
+    while (![[NSFileManager defaultManager] fileExistsAtPath:recordPath] && deadline.timeIntervalSinceNow > 0) {
+        [NSThread sleepForTimeInterval:0.05];
+    }
+    XCTAssertTrue([[NSFileManager defaultManager] fileExistsAtPath:recordPath], @"Resume record should be kept after cancel");
+    XCTAssertFalse([[NSFileManager defaultManager] fileExistsAtPath:destinationURL.path]);
+
+    __block int64_t observedResumedBytes = -1;
+    [EMASCurlProtocol setGlobalTransactionMetricsObserverBlock:^(NSURLRequest * _Nonnull req, BOOL success, NSError * _Nullable error, EMASCurlTransactionMetrics * _Nonnull metrics) {
+        if ([req.URL isEqual:url]) {
+            observedResumedBytes = metrics.resumedResponseBodyBytes;
+        }
+    }];
+    request = [NSMutableURLRequest requestWithURL:url];
+    [EMASCurlProtocol setDownloadDestinationFileURL:destinationURL forRequest:request];
+    [EMASCurlProtocol setDownloadResumable:YES forRequest:request];
+    [[self.session dataTaskWithRequest:request completionHandler:^(NSData *data, NSURLResponse *response, NSError *error) {
+        XCTAssertNil(error, @"Resumed download failed with error: %@", error);
+        XCTAssertEqual(((NSHTTPURLResponse *)response).statusCode, 200, @"Resumed response is presented as the full resource");
+        XCTAssertEqual(response.expectedContentLength, (long long)size);
+        dispatch_semaphore_signal(semaphore);
+    }] resume];
+    XCTAssertEqual(dispatch_semaphore_wait(semaphore, dispatch_time(DISPATCH_TIME_NOW, 30 * NSEC_PER_SEC)), 0, @"Download request timed out");
+    [EMASCurlProtocol setGlobalTransactionMetricsObserverBlock:nil];
+
+    [self verifyDownloadedFileAtURL:destinationURL size:size];
+    XCTAssertFalse([[NSFileManager defaultManager] fileExistsAtPath:recordPath], @"Resume record should be removed after success");
+    [[NSFileManager defaultManager] removeItemAtURL:destinationURL error:nil];
+    *resumedBytes = observedResumedBytes;
+    return [self partialResponsesForTag:tag endpoint:endpoint];
+}
+
+- (void)resumableDownload:(NSString *)endpoint {
+    int64_t resumedBytes = 0;
+    NSInteger partialResponses = [self resumableDownloadToFile:endpoint query:@"" resumedBytes:&resumedBytes];
+    XCTAssertEqual(partialResponses, 1, @"The second download should continue with a range request");
+    XCTAssertGreaterThanOrEqual(resumedBytes, 2 * 1024 * 1024);
+}
+
+- (void)resumableDownloadWhenResourceChanges:(NSString *)endpoint {
+    // 每次ETag都不同，If-Range校验失败，服务端返回完整的200响应，从头下载
+    int64_t resumedBytes = -1;
+    NSInteger partialResponses = [self resumableDownloadToFile:endpoint query:@"&rotate_etag=true" resumedBytes:&resumedBytes];
+    XCTAssertEqual(partialResponses, 0);
+    XCTAssertEqual(resumedBytes, 0);
+}
+
+// 后台优先级的下载与前台请求并存时按剩余带宽限速，前台请求不受影响且两者都完整完成
+- (void)backgroundPriorityDownload:(NSString *)endpoint {
+    const NSUInteger size = 8 * 1024 * 1024;
+    NSURL *url = [NSURL URLWithString:[NSString stringWithFormat:@"%@%@/%lu", endpoint, PATH_DOWNLOAD_BYTES, (unsigned long)size]];
+    NSMutableURLRequest *request = [NSMutableURLRequest requestWithURL:url];
+    NSURL *destinationURL = [self temporaryDownloadURL];
+    [EMASCurlProtocol setDownloadDestinationFileURL:destinationURL forRequest:request];
+    [EMASCurlProtocol setRequestPriority:EMASCurlRequestPriorityBackground forRequest:request];
+
+    dispatch_semaphore_t semaphore = dispatch_semaphore_create(0);
+    [[self.session dataTaskWithRequest:request completionHandler:^(NSData *data, NSURLResponse *response, NSError *error) {
+        XCTAssertNil(error, @"Background download failed with error: %@", error);
+        XCTAssertEqual(((NSHTTPURLResponse *)response).statusCode, 200);
+        dispatch_semaphore_signal(semaphore);
+    }] resume];
+
+    [self downloadData:endpoint];
+
+    XCTAssertEqual(dispatch_semaphore_wait(semaphore, dispatch_time(DISPATCH_TIME_NOW, 60 * NSEC_PER_SEC)), 0, @"Background download timed out");
+    [self verifyDownloadedFileAtURL:destinationURL size:size];
+    [[NSFileManager defaultManager] removeItemAtURL:destinationURL error:nil];
+}
+
+- (void)downloadErrorResponseToFile:(NSString *)endpoint {
+    NSURL *url = [NSURL URLWithString:[NSString stringWithFormat:@"%@%@", endpoint, PATH_CACHE_404]];
+    NSMutableURLRequest *request = [NSMutableURLRequest requestWithURL:url];
+    NSURL *destinationURL = [self temporaryDownloadURL];
+    [EMASCurlProtocol setDownloadDestinationFileURL:destinationURL forRequest:request];
+
+    dispatch_semaphore_t semaphore = dispatch_semaphore_create(0);
+    [[self.session dataTaskWithRequest:request completionHandler:^(NSData *data, NSURLResponse *response, NSError *error) {
+        XCTAssertNil(error);
+        XCTAssertEqual(((NSHTTPURLResponse *)response).statusCode, 404);
+        XCTAssertGreaterThan(data.length, 0, @"Error bodies are delivered to the client");
+        dispatch_semaphore_signal(semaphore);
+    }] resume];
+    XCTAssertEqual(dispatch_semaphore_wait(semaphore, dispatch_time(DISPATCH_TIME_NOW, 10 * NSEC_PER_SEC)), 0, @"Request timed out");
+
+    XCTAssertFalse([[NSFileManager defaultManager] fileExistsAtPath:destinationURL.path]);
+}
+
+// 1GiB回环下载：对比经URLSession下载任务落盘与libcurl直接写文件的吞吐和CPU开销
+- (void)measureLargeDownload:(NSString *)endpoint directToFile:(BOOL)directToFile {
+    const unsigned long long size = 1024ULL * 1024 * 1024;
+    NSURL *url = [NSURL URLWithString:[NSString stringWithFormat:@"%@%@/%llu", endpoint, PATH_DOWNLOAD_BYTES, size]];
+
+    XCTMeasureOptions *options = [XCTMeasureOptions defaultOptions];
+    options.iterationCount = 3;
+    [self measureWithMetrics:@[[XCTClockMetric new], [XCTCPUMetric new], [XCTMemoryMetric new]] options:options block:^{
+        NSMutableURLRequest *request = [NSMutableURLRequest requestWithURL:url];
+        NSURL *destinationURL = [self temporaryDownloadURL];
+        dispatch_semaphore_t semaphore = dispatch_semaphore_create(0);
+        NSDate *start = [NSDate date];
+
+        if (directToFile) {
+            [EMASCurlProtocol setDownloadDestinationFileURL:destinationURL forRequest:request];
+            [[self.session dataTaskWithRequest:request completionHandler:^(NSData *data, NSURLResponse *response, NSError *error) {
+                XCTAssertNil(error);
+                dispatch_semaphore_signal(semaphore);
+            }] resume];
+        } else {
+            [[self.session downloadTaskWithRequest:request completionHandler:^(NSURL *location, NSURLResponse *response, NSError *error) {
+                XCTAssertNil(error);
+                [[NSFileManager defaultManager] moveItemAtURL:location toURL:destinationURL error:nil];
+                dispatch_semaphore_signal(semaphore);
+            }] resume];
+        }
+        dispatch_semaphore_wait(semaphore, DISPATCH_TIME_FOREVER);
+
+        NSTimeInterval duration = -start.timeIntervalSinceNow;
+        NSNumber *fileSize = [[NSFileManager defaultManager] attributesOfItemAtPath:destinationURL.path error:nil][NSFileSize];
+        XCTAssertEqual(fileSize.unsignedLongLongValue, size);
+        NSLog(@"%@ download: %.1f MB/s", directToFile ? @"Direct-to-file" : @"URLSession", size / 1048576.0 / duration);
+        [[NSFileManager defaultManager] removeItemAtURL:destinationURL error:nil];
+    }];
+}
+
 #pragma mark - NSURLSessionDataDelegate
 
 - (void)URLSession:(NSURLSession *)session dataTask:(NSURLSessionDataTask *)dataTask
@@ -189,6 +493,50 @@
     [self downloadDataWithProgress:HTTP11_ENDPOINT];
 }
 
+- (void)testDownloadProgressUpdateBlock {
+    [self downloadDataWithProgressUpdateBlock:HTTP11_ENDPOINT];
+}
+
+- (void)testDownloadToFile {
+    [self downloadToFile:HTTP11_ENDPOINT];
+}
+
+- (void)testDownloadErrorResponseToFile {
+    [self downloadErrorResponseToFile:HTTP11_ENDPOINT];
+}
+
+- (void)testSegmentedDownload {
+    [self segmentedDownload:HTTP11_ENDPOINT];
+}
+
+- (void)testSegmentedDownloadWithoutRangeSupport {
+    [self segmentedDownloadWithoutRangeSupport:HTTP11_ENDPOINT];
+}
+
+- (void)testSegmentedDownloadWhenResourceChanges {
+    [self segmentedDownloadWhenResourceChanges:HTTP11_ENDPOINT];
+}
+
+- (void)testResumableDownload {
+    [self resumableDownload:HTTP11_ENDPOINT];
+}
+
+- (void)testResumableDownloadWhenResourceChanges {
+    [self resumableDownloadWhenResourceChanges:HTTP11_ENDPOINT];
+}
+
+- (void)testBackgroundPriorityDownload {
+    [self backgroundPriorityDownload:HTTP11_ENDPOINT];
+}
+
+- (void)testLargeDownloadPerformanceURLSession {
+    [self measureLargeDownload:HTTP11_ENDPOINT directToFile:NO];
+}
+
+- (void)testLargeDownloadPerformanceDirectToFile {
+    [self measureLargeDownload:HTTP11_ENDPOINT directToFile:YES];
+}
+
 - (void)testDownloadDataAndCancel {
     [self downloadDataAndCancel:HTTP11_ENDPOINT];
 }
@@ -233,6 +581,42 @@
     [self downloadDataWithProgress:HTTP2_ENDPOINT];
 }
 
+- (void)testDownloadProgressUpdateBlock {
+    [self downloadDataWithProgressUpdateBlock:HTTP2_ENDPOINT];
+}
+
+- (void)testDownloadToFile {
+    [self downloadToFile:HTTP2_ENDPOINT];
+}
+
+- (void)testDownloadErrorResponseToFile {
+    [self downloadErrorResponseToFile:HTTP2_ENDPOINT];
+}
+
+- (void)testSegmentedDownload {
+    [self segmentedDownload:HTTP2_ENDPOINT];
+}
+
+- (void)testSegmentedDownloadWithoutRangeSupport {
+    [self segmentedDownloadWithoutRangeSupport:HTTP2_ENDPOINT];
+}
+
+- (void)testSegmentedDownloadWhenResourceChanges {
+    [self segmentedDownloadWhenResourceChanges:HTTP2_ENDPOINT];
+}
+
+- (void)testResumableDownload {
+    [self resumableDownload:HTTP2_ENDPOINT];
+}
+
+- (void)testResumableDownloadWhenResourceChanges {
+    [self resumableDownloadWhenResourceChanges:HTTP2_ENDPOINT];
+}
+
+- (void)testBackgroundPriorityDownload {
+    [self backgroundPriorityDownload:HTTP2_ENDPOINT];
+}
+
 - (void)testDownloadDataAndCancel {
     [self downloadDataAndCancel:HTTP2_ENDPOINT];
 }
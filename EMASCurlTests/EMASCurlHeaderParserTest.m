@@ -0,0 +1,253 @@
+//
+//  EMASCurlHeaderParserTest.m
+//  EMASCurlTests
+//
+//  Created by xuyecan on 2026/10/18.
+//
+
+#import <XCTest/XCTest.h>
+#import "EMASCurlHeaderParser.h"
+
+// 抓取自线上请求的头部（已脱敏），覆盖HTTP/1.1静态资源、HTTP/2 API、重定向与304
+static NSArray<NSString *> *EMASHeaderCorpus(void) {
+    return @[
+        @"HTTP/1.1 200 OK\r\n"
+        @"Server: Tengine\r\n"
+        @"Content-Type: image/webp\r\n"
+        @"Content-Length: 48213\r\n"
+        @"Connection: keep-alive\r\n"
+        @"Date: Sat, 17 Oct 2026 08:12:44 GMT\r\n"
+        @"Cache-Control: max-age=31536000\r\n"
+        @"ETag: \"5F1C2B3A8D7E4F60A1B2C3D4E5F60718\"\r\n"
+        @"Last-Modified: Tue, 13 Oct 2026 02:45:10 GMT\r\n"
+        @"Accept-Ranges: bytes\r\n"
+        @"Age: 86201\r\n"
+        @"Via: cache14.l2cn3051[0,0,200-0,H], cache2.cn5524[0,0,200-0,H]\r\n"
+        @"X-Cache: HIT TCP_MEM_HIT dirn:11:388291920\r\n"
+        @"X-Swift-SaveTime: Fri, 16 Oct 2026 08:16:03 GMT\r\n"
+        @"X-Swift-CacheTime: 31449601\r\n"
+        @"Timing-Allow-Origin: *\r\n"
+        @"EagleId: 0b2a3c4d16029223642851234e\r\n"
+        @"\r\n",
+
+        @"HTTP/2 200 \r\n"
+        @"date: Sat, 17 Oct 2026 08:12:45 GMT\r\n"
+        @"content-type: application/json;charset=UTF-8\r\n"
+        @"content-length: 2874\r\n"
+        @"vary: Accept-Encoding\r\n"
+        @"vary: Origin\r\n"
+        @"set-cookie: acw_tc=2f6a1f8c16029223655384519e; path=/; HttpOnly; Max-Age=1800\r\n"
+        @"set-cookie: session=9c1e2d3f; Path=/; Secure; HttpOnly; SameSite=Lax\r\n"
+        @"cache-control: no-cache, no-store, must-revalidate\r\n"
+        @"pragma: no-cache\r\n"
+        @"expires: 0\r\n"
+        @"x-content-type-options: nosniff\r\n"
+        @"x-frame-options: SAMEORIGIN\r\n"
+        @"x-xss-protection: 1; mode=block\r\n"
+        @"strict-transport-security: max-age=31536000; includeSubDomains\r\n"
+        @"access-control-allow-origin: https://m.example.com\r\n"
+        @"access-control-allow-credentials: true\r\n"
+        @"access-control-expose-headers: x-request-id, x-trace-id\r\n"
+        @"x-request-id: 7d9c0a4e-3b1f-4c2e-9a8d-6f5e4d3c2b1a\r\n"
+        @"x-trace-id: 0b2a3c4d16029223655384519e\r\n"
+        @"x-server-time: 1792233165123\r\n"
+        @"x-ratelimit-limit: 600\r\n"
+        @"x-ratelimit-remaining: 597\r\n"
+        @"x-ratelimit-reset: 42\r\n"
+        @"server-timing: total;dur=37, db;dur=12, cache;desc=\"miss\"\r\n"
+        @"alt-svc: h3=\":443\"; ma=86400\r\n"
+        @"eagleeye-traceid: 0b2a3c4d16029223655384519e\r\n"
+        @"content-language: zh-CN\r\n"
+        @"x-api-version: 2026-09-01\r\n"
+        @"x-biz-code: 0\r\n"
+        @"x-region: cn-hangzhou\r\n"
+        @"x-cache: MISS\r\n"
+        @"\r\n",
+
+        @"HTTP/1.1 302 Found\r\n"
+        @"Server: nginx\r\n"
+        @"Date: Sat, 17 Oct 2026 08:12:46 GMT\r\n"
+        @"Content-Type: text/html\r\n"
+        @"Content-Length: 138\r\n"
+        @"Connection: keep-alive\r\n"
+        @"Location: https://cdn.example.com/assets/app.3f9a1c.js\r\n"
+        @"Cache-Control: private, max-age=0\r\n"
+        @"\r\n",
+
+        @"HTTP/2 304 \r\n"
+        @"date: Sat, 17 Oct 2026 08:12:47 GMT\r\n"
+        @"etag: W/\"a1b2c3d4\"\r\n"
+        @"cache-control: public, max-age=600\r\n"
+        @"expires: Sat, 17 Oct 2026 08:22:47 GMT\r\n"
+        @"age: 12\r\n"
+        @"x-cache: HIT\r\n"
+        @"\r\n",
+    ];
+}
+
+// 按libcurl回调的方式拆成逐行的C字符串
+static NSArray<NSData *> *EMASHeaderCorpusLines(void) {
+    NSMutableArray<NSData *> *lines = [NSMutableArray array];
+    for (NSString *block in EMASHeaderCorpus()) {
+        for (NSString *line in [block componentsSeparatedByString:@"\r\n"]) {
+            if (line.length == 0 && lines.count > 0 && [lines.lastObject length] == 2) {
+                continue;
+            }
+            [lines addObject:[[line stringByAppendingString:@"\r\n"] dataUsingEncoding:NSUTF8StringEncoding]];
+        }
+    }
+    return lines;
+}
+
+@interface EMASCurlHeaderParserTest : XCTestCase
+@property (nonatomic, assign) EMASHeaderParser *parser;
+@end
+
+@implementation EMASCurlHeaderParserTest
+
+- (void)setUp {
+    [super setUp];
+    self.parser = EMASHeaderParserCreate();
+}
+
+- (void)tearDown {
+    EMASHeaderParserDestroy(self.parser);
+    self.parser = NULL;
+    [super tearDown];
+}
+
+- (EMASHeaderLineType)feed:(NSString *)line {
+    const char *bytes = line.UTF8String;
+    return EMASHeaderParserFeedLine(self.parser, bytes, strlen(bytes));
+}
+
+- (void)testStatusLine {
+    XCTAssertEqual([self feed:@"HTTP/1.1 404 Not Found\r\n"], EMASHeaderLineStatus);
+    XCTAssertEqual(EMASHeaderParserStatusCode(self.parser), 404);
+    XCTAssertEqualObjects(EMASHeaderParserCopyHTTPVersion(self.parser), @"HTTP/1.1");
+    XCTAssertEqualObjects(EMASHeaderParserCopyReasonPhrase(self.parser), @"Not Found");
+
+    XCTAssertEqual([self feed:@"HTTP/2 200 \r\n"], EMASHeaderLineStatus);
+    XCTAssertEqual(EMASHeaderParserStatusCode(self.parser), 200);
+    XCTAssertEqualObjects(EMASHeaderParserCopyHTTPVersion(self.parser), @"HTTP/2");
+    XCTAssertEqualObjects(EMASHeaderParserCopyReasonPhrase(self.parser), @"");
+    XCTAssertEqual([self feed:@"\r\n"], EMASHeaderLineEnd);
+}
+
+- (void)testKnownHeaderLookupIsCaseInsensitive {
+    NSArray<NSString *> *names = @[@"Content-Type", @"content-length", @"CACHE-CONTROL", @"ETag", @"Set-Cookie",
+                                   @"location", @"WWW-Authenticate", @"Access-Control-Allow-Origin", @"x-cache"];
+    EMASKnownHeader expected[] = {EMASKnownHeaderContentType, EMASKnownHeaderContentLength, EMASKnownHeaderCacheControl,
+                                  EMASKnownHeaderETag, EMASKnownHeaderSetCookie, EMASKnownHeaderLocation,
+                                  EMASKnownHeaderWwwAuthenticate, EMASKnownHeaderAccessControlAllowOrigin, EMASKnownHeaderXCache};
+    for (NSUInteger i = 0; i < names.count; i++) {
+        const char *name = names[i].UTF8String;
+        XCTAssertEqual(EMASKnownHeaderLookup(name, strlen(name)), expected[i], @"%@", names[i]);
+    }
+
+    for (NSString *unknown in @[@"X-Request-Id", @"content-typo", @"Dates", @"ag", @"x-cache-status"]) {
+        const char *name = unknown.UTF8String;
+        XCTAssertEqual(EMASKnownHeaderLookup(name, strlen(name)), EMASKnownHeaderNone, @"%@", unknown);
+    }
+}
+
+- (void)testHeaderDictionaryMatchesLineByLineParsing {
+    [self feed:@"HTTP/1.1 200 OK\r\n"];
+    XCTAssertEqual([self feed:@"Content-Type: text/plain\r\n"], EMASHeaderLineField);
+    [self feed:@"Set-Cookie: a=1\r\n"];
+    [self feed:@"Set-Cookie: b=2\r\n"];
+    [self feed:@"X-Empty:\r\n"];
+    [self feed:@"X-Custom:   padded value  \r\n"];
+    XCTAssertEqual([self feed:@"not a header\r\n"], EMASHeaderLineIgnored);
+
+    NSDictionary *headers = EMASHeaderParserCopyHeaderDictionary(self.parser);
+    XCTAssertEqualObjects(headers[@"Content-Type"], @"text/plain");
+    XCTAssertEqualObjects(headers[@"Set-Cookie"], @"a=1, b=2", @"同名字段应以逗号合并");
+    XCTAssertEqualObjects(headers[@"X-Empty"], @"");
+    XCTAssertEqualObjects(headers[@"X-Custom"], @"padded value");
+    XCTAssertEqual(headers.count, 4);
+}
+
+- (void)testKnownHeaderAccessors {
+    [self feed:@"HTTP/2 200\r\n"];
+    [self feed:@"cache-control: public, No-Store\r\n"];
+    [self feed:@"content-length: 1234\r\n"];
+    [self feed:@"Location: /next\r\n"];
+
+    XCTAssertTrue(EMASHeaderParserKnownHeaderContains(self.parser, EMASKnownHeaderCacheControl, "no-store"));
+    XCTAssertFalse(EMASHeaderParserKnownHeaderContains(self.parser, EMASKnownHeaderCacheControl, "no-cache"));
+    XCTAssertEqual(EMASHeaderParserKnownHeaderInteger(self.parser, EMASKnownHeaderContentLength), 1234);
+    XCTAssertEqual(EMASHeaderParserKnownHeaderInteger(self.parser, EMASKnownHeaderAge), -1);
+    const EMASHeaderField *location = EMASHeaderParserFindKnown(self.parser, EMASKnownHeaderLocation);
+    XCTAssertEqualObjects(EMASHeaderParserCopyFieldValue(self.parser, location), @"/next");
+}
+
+// 超出初始容量后扩容，已解析的内容不受影响；新的状态行重置内容
+- (void)testArenaGrowsAndResets {
+    [self feed:@"HTTP/1.1 200 OK\r\n"];
+    NSString *longValue = [@"" stringByPaddingToLength:200 withString:@"v" startingAtIndex:0];
+    for (int i = 0; i < 200; i++) {
+        [self feed:[NSString stringWithFormat:@"X-Header-%d: %@\r\n", i, longValue]];
+    }
+    NSDictionary *headers = EMASHeaderParserCopyHeaderDictionary(self.parser);
+    XCTAssertEqual(headers.count, 200);
+    XCTAssertEqualObjects(headers[@"X-Header-0"], longValue);
+    XCTAssertEqualObjects(headers[@"X-Header-199"], longValue);
+
+    [self feed:@"HTTP/1.1 204 No Content\r\n"];
+    XCTAssertEqual(EMASHeaderParserFieldCount(self.parser), 0);
+    XCTAssertEqual(EMASHeaderParserStatusCode(self.parser), 204);
+}
+
+#pragma mark - 微基准
+
+// 逐行解析并在头部结束时构建字典
+- (void)testPerformanceHeaderParser {
+    NSArray<NSData *> *lines = EMASHeaderCorpusLines();
+    EMASHeaderParser *parser = self.parser;
+    [self measureBlock:^{
+        for (int round = 0; round < 2000; round++) {
+            @autoreleasepool {
+                for (NSData *line in lines) {
+                    if (EMASHeaderParserFeedLine(parser, line.bytes, line.length) == EMASHeaderLineEnd) {
+                        NSDictionary *headers = EMASHeaderParserCopyHeaderDictionary(parser);
+                        (void)headers;
+                    }
+                }
+            }
+        }
+    }];
+}
+
+// 原header_cb的逐行NSString处理方式，作为对照
+- (void)testPerformanceLegacyStringSplitting {
+    NSArray<NSData *> *lines = EMASHeaderCorpusLines();
+    [self measureBlock:^{
+        for (int round = 0; round < 2000; round++) {
+            @autoreleasepool {
+                NSMutableDictionary<NSString *, NSString *> *headers = [NSMutableDictionary new];
+                for (NSData *line in lines) {
+                    NSData *data = [NSData dataWithBytes:line.bytes length:line.length];
+                    NSString *headerLine = [[NSString alloc] initWithData:data encoding:NSUTF8StringEncoding];
+                    headerLine = [headerLine stringByTrimmingCharactersInSet:[NSCharacterSet whitespaceAndNewlineCharacterSet]];
+                    if ([headerLine hasPrefix:@"HTTP/"]) {
+                        headers = [NSMutableDictionary new];
+                        NSArray<NSString *> *components = [headerLine componentsSeparatedByString:@" "];
+                        (void)[components[1] integerValue];
+                        continue;
+                    }
+                    NSRange delimiterRange = [headerLine rangeOfString:@": "];
+                    if (delimiterRange.location == NSNotFound) {
+                        continue;
+                    }
+                    NSString *key = [headerLine substringToIndex:delimiterRange.location];
+                    NSString *value = [headerLine substringFromIndex:delimiterRange.location + delimiterRange.length];
+                    NSString *existingValue = headers[key];
+                    headers[key] = existingValue ? [existingValue stringByAppendingFormat:@", %@", value] : value;
+                }
+            }
+        }
+    }];
+}
+
+@end
@@ -0,0 +1,169 @@
+//
+//  EMASCurlLatencyHistogramTest.m
+//  EMASCurlTests
+//
+//  Created by xuyecan on 2026/10/18.
+//
+
+#import <XCTest/XCTest.h>
+#import <EMASCurl/EMASCurl.h>
+#import "EMASCurlLatencyHistogram.h"
+#import "EMASCurlTestConstants.h"
+
+static const NSUInteger kWriterCount = 8;
+static const NSUInteger kValuesPerWriter = 50000;
+static const NSUInteger kHostCount = 16;
+
+@interface EMASCurlLatencyHistogramTest : XCTestCase
+@end
+
+@implementation EMASCurlLatencyHistogramTest
+
+- (NSUInteger)totalCountInSnapshots:(NSArray<EMASCurlHostLatencySnapshot *> *)snapshots metric:(EMASCurlHistogramMetric)metric {
+    NSUInteger total = 0;
+    for (EMASCurlHostLatencySnapshot *snapshot in snapshots) {
+        total += [snapshot summaryForMetric:metric].count;
+    }
+    return total;
+}
+
+- (void)testPercentilesWithinBucketError {
+    EMASCurlLatencyHistograms *histograms = [EMASCurlLatencyHistograms new];
+    // 1..10000毫秒均匀分布
+    for (uint64_t ms = 1; ms <= 10000; ms++) {
+        [histograms recordValue:ms * 1000 forMetric:EMASCurlHistogramMetricTotal host:@"a.example.com" protocolName:@"http/2"];
+    }
+
+    NSArray<EMASCurlHostLatencySnapshot *> *snapshots = [histograms snapshotsResetting:NO];
+    XCTAssertEqual(snapshots.count, 1);
+    EMASCurlHistogramSummary *summary = [snapshots.firstObject summaryForMetric:EMASCurlHistogramMetricTotal];
+    XCTAssertEqual(summary.count, 10000);
+    XCTAssertEqualWithAccuracy(summary.mean, 5.0005, 1e-6);
+    XCTAssertEqualWithAccuracy(summary.min, 0.001, 0.001 / 16);
+    XCTAssertEqualWithAccuracy(summary.max, 10.0, 10.0 / 16);
+    XCTAssertEqualWithAccuracy(summary.p50, 5.0, 5.0 / 16);
+    XCTAssertEqualWithAccuracy(summary.p90, 9.0, 9.0 / 16);
+    XCTAssertEqualWithAccuracy(summary.p99, 9.9, 9.9 / 16);
+    XCTAssertNil([snapshots.firstObject summaryForMetric:EMASCurlHistogramMetricConnect], @"没有样本的指标不应出现");
+}
+
+- (void)testSeparatesHostsAndProtocols {
+    EMASCurlLatencyHistograms *histograms = [EMASCurlLatencyHistograms new];
+    [histograms recordValue:100 forMetric:EMASCurlHistogramMetricResponseBodyBytes host:@"a.example.com" protocolName:@"http/1.1"];
+    [histograms recordValue:200 forMetric:EMASCurlHistogramMetricResponseBodyBytes host:@"a.example.com" protocolName:@"http/2"];
+    [histograms recordValue:300 forMetric:EMASCurlHistogramMetricResponseBodyBytes host:@"b.example.com" protocolName:@"http/2"];
+
+    NSArray<EMASCurlHostLatencySnapshot *> *snapshots = [histograms snapshotsResetting:NO];
+    XCTAssertEqual(snapshots.count, 3);
+    NSMutableSet<NSString *> *keys = [NSMutableSet set];
+    for (EMASCurlHostLatencySnapshot *snapshot in snapshots) {
+        [keys addObject:[NSString stringWithFormat:@"%@|%@", snapshot.host, snapshot.protocolName]];
+        XCTAssertEqual([snapshot summaryForMetric:EMASCurlHistogramMetricResponseBodyBytes].count, 1);
+    }
+    NSSet *expected = [NSSet setWithArray:@[@"a.example.com|http/1.1", @"a.example.com|http/2", @"b.example.com|http/2"]];
+    XCTAssertEqualObjects(keys, expected);
+}
+
+- (void)testOverflowHostsAggregated {
+    EMASCurlLatencyHistograms *histograms = [EMASCurlLatencyHistograms new];
+    for (NSUInteger i = 0; i < 200; i++) {
+        NSString *host = [NSString stringWithFormat:@"host-%lu.example.com", (unsigned long)i];
+        [histograms recordValue:1000 forMetric:EMASCurlHistogramMetricTotal host:host protocolName:@"http/2"];
+    }
+
+    NSArray<EMASCurlHostLatencySnapshot *> *snapshots = [histograms snapshotsResetting:NO];
+    XCTAssertEqual([self totalCountInSnapshots:snapshots metric:EMASCurlHistogramMetricTotal], 200, @"表满后的样本应计入汇总项");
+    XCTAssertTrue([[snapshots valueForKey:@"host"] containsObject:@"*"]);
+}
+
+// 多线程并发记录，同时不断取快照并清零：各次快照的计数之和应等于记录总数，既不丢失也不重复
+- (void)testConcurrentRecordAndResetMergesExactly {
+    EMASCurlLatencyHistograms *histograms = [EMASCurlLatencyHistograms new];
+    __block NSUInteger snapshotTotal = 0;
+    __block BOOL writersFinished = NO;
+
+    dispatch_semaphore_t readerDone = dispatch_semaphore_create(0);
+    dispatch_async(dispatch_get_global_queue(QOS_CLASS_USER_INITIATED, 0), ^{
+        while (!__atomic_load_n(&writersFinished, __ATOMIC_ACQUIRE)) {
+            NSArray<EMASCurlHostLatencySnapshot *> *snapshots = [histograms snapshotsResetting:YES];
+            for (EMASCurlHostLatencySnapshot *snapshot in snapshots) {
+                snapshotTotal += [snapshot summaryForMetric:EMASCurlHistogramMetricResponseBodyBytes].count;
+            }
+        }
+        dispatch_semaphore_signal(readerDone);
+    });
+
+    dispatch_apply(kWriterCount, dispatch_get_global_queue(QOS_CLASS_USER_INITIATED, 0), ^(size_t writer) {
+        for (NSUInteger i = 0; i < kValuesPerWriter; i++) {
+            NSString *host = [NSString stringWithFormat:@"host-%lu.example.com", (unsigned long)(i % kHostCount)];
+            [histograms recordValue:1 forMetric:EMASCurlHistogramMetricResponseBodyBytes host:host protocolName:@"http/2"];
+        }
+    });
+    __atomic_store_n(&writersFinished, YES, __ATOMIC_RELEASE);
+    dispatch_semaphore_wait(readerDone, DISPATCH_TIME_FOREVER);
+
+    NSArray<EMASCurlHostLatencySnapshot *> *remaining = [histograms snapshotsResetting:YES];
+    snapshotTotal += [self totalCountInSnapshots:remaining metric:EMASCurlHistogramMetricResponseBodyBytes];
+    XCTAssertEqual(snapshotTotal, kWriterCount * kValuesPerWriter);
+    XCTAssertLessThanOrEqual(remaining.count, kHostCount, @"并发插入同一host不应产生重复条目");
+    XCTAssertEqual([histograms snapshotsResetting:NO].count, 0, @"清零后不应再有样本");
+}
+
+// 不清零时并发记录，最终快照等于各线程记录之和，且每个host只有一个条目
+- (void)testConcurrentRecordWithoutReset {
+    EMASCurlLatencyHistograms *histograms = [EMASCurlLatencyHistograms new];
+    dispatch_apply(kWriterCount, dispatch_get_global_queue(QOS_CLASS_USER_INITIATED, 0), ^(size_t writer) {
+        for (NSUInteger i = 0; i < kValuesPerWriter; i++) {
+            NSString *host = [NSString stringWithFormat:@"host-%lu.example.com", (unsigned long)(i % kHostCount)];
+            [histograms recordValue:(i % 1000) * 1000 forMetric:EMASCurlHistogramMetricTimeToFirstByte host:host protocolName:@"http/1.1"];
+            // 取快照不应影响记录
+            if (i % 5000 == 0) {
+                [histograms snapshotsResetting:NO];
+            }
+        }
+    });
+
+    NSArray<EMASCurlHostLatencySnapshot *> *snapshots = [histograms snapshotsResetting:NO];
+    XCTAssertEqual(snapshots.count, kHostCount);
+    XCTAssertEqual([self totalCountInSnapshots:snapshots metric:EMASCurlHistogramMetricTimeToFirstByte], kWriterCount * kValuesPerWriter);
+    for (EMASCurlHostLatencySnapshot *snapshot in snapshots) {
+        EMASCurlHistogramSummary *summary = [snapshot summaryForMetric:EMASCurlHistogramMetricTimeToFirstByte];
+        XCTAssertEqual(summary.count, kWriterCount * kValuesPerWriter / kHostCount);
+    }
+}
+
+- (void)testRequestsRecordedPerHost {
+    NSURLSessionConfiguration *config = [NSURLSessionConfiguration defaultSessionConfiguration];
+    EMASCurlConfiguration *curlConfig = [EMASCurlConfiguration defaultConfiguration];
+    curlConfig.httpVersion = HTTP1;
+    [EMASCurlProtocol installIntoSessionConfiguration:config withConfiguration:curlConfig];
+    NSURLSession *session = [NSURLSession sessionWithConfiguration:config];
+
+    [EMASCurlProtocol hostLatencySnapshotsResetting:YES];
+    NSUInteger requestCount = 5;
+    for (NSUInteger i = 0; i < requestCount; i++) {
+        XCTestExpectation *expectation = [self expectationWithDescription:@"request"];
+        NSURL *url = [NSURL URLWithString:[HTTP11_ENDPOINT stringByAppendingString:PATH_ECHO]];
+        [[session dataTaskWithURL:url completionHandler:^(NSData *data, NSURLResponse *response, NSError *error) {
+            XCTAssertNil(error);
+            [expectation fulfill];
+        }] resume];
+        [self waitForExpectations:@[expectation] timeout:10];
+    }
+
+    EMASCurlHostLatencySnapshot *hostSnapshot = nil;
+    for (EMASCurlHostLatencySnapshot *snapshot in [EMASCurlProtocol hostLatencySnapshotsResetting:NO]) {
+        if ([snapshot.host isEqualToString:@"127.0.0.1"] && [snapshot.protocolName isEqualToString:@"http/1.1"]) {
+            hostSnapshot = snapshot;
+        }
+    }
+    XCTAssertNotNil(hostSnapshot);
+    EMASCurlHistogramSummary *total = [hostSnapshot summaryForMetric:EMASCurlHistogramMetricTotal];
+    XCTAssertEqual(total.count, requestCount);
+    XCTAssertGreaterThan(total.p50, 0);
+    XCTAssertLessThanOrEqual(total.p50, total.p99);
+    XCTAssertEqual([hostSnapshot summaryForMetric:EMASCurlHistogramMetricResponseBodyBytes].count, requestCount);
+    XCTAssertNil([hostSnapshot summaryForMetric:EMASCurlHistogramMetricSecureConnection], @"明文HTTP不应有TLS握手样本");
+}
+
+@end
@@ -0,0 +1,145 @@
+//
+//  EMASCurlLoggerTest.m
+//  EMASCurlTests
+//
+//  Created by xuyecan on 2026/10/18.
+//
+
+#import <XCTest/XCTest.h>
+#import <EMASCurl/EMASCurl.h>
+#import "EMASCurlLogger.h"
+
+static NSString * const kTestComponent = @"EC-LoggerTest";
+
+@interface EMASCurlLoggerTest : XCTestCase
+@property (nonatomic, assign) EMASCurlLogLevel savedLevel;
+@property (nonatomic, strong) NSMutableArray<NSString *> *messages;
+@end
+
+@implementation EMASCurlLoggerTest
+
+- (void)setUp {
+    [super setUp];
+    self.savedLevel = [EMASCurlLogger currentLogLevel];
+    [EMASCurlLogger setLogLevel:EMASCurlLogLevelDebug];
+    [EMASCurlLogger flush];
+
+    self.messages = [NSMutableArray array];
+    NSMutableArray<NSString *> *messages = self.messages;
+    [EMASCurlLogger setLogHandler:^(EMASCurlLogLevel level, NSString *component, NSString *message) {
+        if (![component isEqualToString:kTestComponent]) {
+            return;
+        }
+        @synchronized (messages) {
+            [messages addObject:message];
+        }
+    }];
+}
+
+- (void)tearDown {
+    [EMASCurlLogger flush];
+    [EMASCurlLogger setLogHandler:nil];
+    [EMASCurlLogger setLogLevel:self.savedLevel];
+    [super tearDown];
+}
+
+- (NSArray<NSString *> *)flushedMessages {
+    [EMASCurlLogger flush];
+    @synchronized (self.messages) {
+        return [self.messages copy];
+    }
+}
+
+// 延迟格式化的结果应与同步格式化一致
+- (void)testDeferredFormattingMatchesFormatString {
+    NSURL *url = [NSURL URLWithString:@"https://example.com/path?q=1"];
+    char buffer[] = "stack buffer";
+    EMAS_LOG_INFO(kTestComponent, @"Request completed in %.0fms for URL: %@ (HTTP %ld)", 12.7, url, (long)200);
+    EMAS_LOG_DEBUG(kTestComponent, @"100%% done: %d%% %lu items %lld bytes |%-5d| %05.2f %x %c", 42, (unsigned long)7, (long long)-9, 3, 3.14159, 255, 'z');
+    EMAS_LOG_ERROR(kTestComponent, @"C string: %s, null: %s, nil: %@", buffer, (char *)NULL, nil);
+    // 修改栈上的字符串不应影响已记录的日志
+    buffer[0] = 'X';
+    // 不支持按类型保存的格式在调用线程格式化
+    EMAS_LOG_INFO(kTestComponent, @"width |%*d|", 4, 5);
+
+    NSArray<NSString *> *expected = @[
+        [NSString stringWithFormat:@"Request completed in %.0fms for URL: %@ (HTTP %ld)", 12.7, url, (long)200],
+        [NSString stringWithFormat:@"100%% done: %d%% %lu items %lld bytes |%-5d| %05.2f %x %c", 42, (unsigned long)7, (long long)-9, 3, 3.14159, 255, 'z'],
+        @"C string: stack buffer, null: (null), nil: (null)",
+        @"width |   5|",
+    ];
+    XCTAssertEqualObjects([self flushedMessages], expected);
+}
+
+- (void)testMutableStringArgumentCapturedAtLogTime {
+    NSMutableString *value = [NSMutableString stringWithString:@"before"];
+    EMAS_LOG_INFO(kTestComponent, @"value=%@", value);
+    [value setString:@"after"];
+
+    XCTAssertEqualObjects([self flushedMessages], @[@"value=before"]);
+}
+
+- (void)testLevelFilteredOnCallingThread {
+    [EMASCurlLogger setLogLevel:EMASCurlLogLevelError];
+    EMAS_LOG_DEBUG(kTestComponent, @"debug %d", 1);
+    EMAS_LOG_INFO(kTestComponent, @"info %d", 2);
+    EMAS_LOG_ERROR(kTestComponent, @"error %d", 3);
+
+    XCTAssertEqualObjects([self flushedMessages], @[@"error 3"]);
+}
+
+// 多线程并发记录，每条都输出，且同一线程内保持顺序；每个线程的记录数不超过单线程缓冲区容量
+- (void)testConcurrentThreadsKeepPerThreadOrder {
+    const NSUInteger threadCount = 8;
+    const NSUInteger messagesPerThread = 100;
+    dispatch_group_t group = dispatch_group_create();
+    for (NSUInteger thread = 0; thread < threadCount; thread++) {
+        dispatch_group_enter(group);
+        [NSThread detachNewThreadWithBlock:^{
+            for (NSUInteger i = 0; i < messagesPerThread; i++) {
+                EMAS_LOG_INFO(kTestComponent, @"%lu:%lu", (unsigned long)thread, (unsigned long)i);
+            }
+            dispatch_group_leave(group);
+        }];
+    }
+    XCTAssertEqual(dispatch_group_wait(group, dispatch_time(DISPATCH_TIME_NOW, 10 * NSEC_PER_SEC)), 0);
+
+    NSArray<NSString *> *messages = [self flushedMessages];
+    XCTAssertEqual(messages.count, threadCount * messagesPerThread);
+    NSMutableDictionary<NSString *, NSNumber *> *lastIndexByThread = [NSMutableDictionary dictionary];
+    for (NSString *message in messages) {
+        NSArray<NSString *> *parts = [message componentsSeparatedByString:@":"];
+        NSInteger index = parts[1].integerValue;
+        NSNumber *last = lastIndexByThread[parts[0]];
+        XCTAssertTrue(!last || last.integerValue < index, @"Out of order: %@", message);
+        lastIndexByThread[parts[0]] = @(index);
+    }
+    XCTAssertEqual(lastIndexByThread.count, threadCount);
+}
+
+- (void)testFileSinkRotates {
+    [EMASCurlLogger setLogHandler:nil];
+    NSString *directory = [NSTemporaryDirectory() stringByAppendingPathComponent:[NSUUID UUID].UUIDString];
+    [EMASCurlLogger setLogFileDirectory:directory maxFileSize:1024 maxFileCount:3];
+
+    for (NSUInteger i = 0; i < 100; i++) {
+        EMAS_LOG_INFO(kTestComponent, @"line %lu padding padding padding", (unsigned long)i);
+    }
+    [EMASCurlLogger flush];
+    [EMASCurlLogger setLogFileDirectory:nil maxFileSize:0 maxFileCount:0];
+
+    NSFileManager *fileManager = [NSFileManager defaultManager];
+    NSArray<NSString *> *files = [[fileManager contentsOfDirectoryAtPath:directory error:nil] sortedArrayUsingSelector:@selector(compare:)];
+    NSArray<NSString *> *expectedFiles = @[@"emascurl.1.log", @"emascurl.2.log", @"emascurl.log"];
+    XCTAssertEqualObjects(files, expectedFiles);
+    for (NSString *file in files) {
+        NSDictionary *attributes = [fileManager attributesOfItemAtPath:[directory stringByAppendingPathComponent:file] error:nil];
+        XCTAssertLessThanOrEqual([attributes fileSize], 1024);
+    }
+
+    NSString *current = [NSString stringWithContentsOfFile:[directory stringByAppendingPathComponent:@"emascurl.log"] encoding:NSUTF8StringEncoding error:nil];
+    XCTAssertTrue([current hasSuffix:@"[INFO] [EC-LoggerTest] line 99 padding padding padding\n"]);
+    [fileManager removeItemAtPath:directory error:nil];
+}
+
+@end
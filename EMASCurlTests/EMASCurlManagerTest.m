@@ -0,0 +1,182 @@
+//
+//  EMASCurlManagerTest.m
+//  EMASCurlTests
+//
+//  Created by xuyecan on 2026/10/18.
+//
+
+#import <XCTest/XCTest.h>
+#import <EMASCurl/EMASCurl.h>
+#import "EMASCurlManager.h"
+#import "EMASCurlNetworkQualityEstimator.h"
+#import "EMASCurlTestConstants.h"
+
+// 固定返回准入条件的网络质量估计
+@interface EMASCurlStubQualityEstimator : EMASCurlNetworkQualityEstimator
+@property (atomic, assign) NSUInteger hostLimit;
+@property (atomic, assign) BOOL deferBackground;
+@end
+
+@implementation EMASCurlStubQualityEstimator
+
+- (NSUInteger)maxConcurrentTransfersPerHost {
+    return self.hostLimit;
+}
+
+- (BOOL)shouldDeferBackgroundTransfers {
+    return self.deferBackground;
+}
+
+@end
+
+static size_t EMASManagerTestDiscardBody(char *ptr, size_t size, size_t nmemb, void *userdata) {
+    return size * nmemb;
+}
+
+@interface EMASCurlManagerTest : XCTestCase
+@property (nonatomic, strong) EMASCurlStubQualityEstimator *estimator;
+@property (atomic, assign) BOOL deferredCancelled;
+@end
+
+@implementation EMASCurlManagerTest
+
+- (void)setUp {
+    [super setUp];
+    self.estimator = [[EMASCurlStubQualityEstimator alloc] init];
+    [[EMASCurlManager sharedInstance] setNetworkQualityEstimator:self.estimator];
+    [self waitForNetworkThread];
+}
+
+- (void)tearDown {
+    [[EMASCurlManager sharedInstance] setNetworkQualityEstimator:nil];
+    [self waitForNetworkThread];
+    [super tearDown];
+}
+
+- (void)waitForNetworkThread {
+    XCTestExpectation *expectation = [self expectationWithDescription:@"network thread"];
+    [[EMASCurlManager sharedInstance] performBlockOnNetworkThread:^{
+        [expectation fulfill];
+    }];
+    [self waitForExpectations:@[expectation] timeout:5];
+}
+
+- (CURL *)easyHandleForPath:(NSString *)path timeoutMs:(long)timeoutMs {
+    CURL *easy = curl_easy_init();
+    curl_easy_setopt(easy, CURLOPT_URL, [HTTP11_ENDPOINT stringByAppendingString:path].UTF8String);
+    curl_easy_setopt(easy, CURLOPT_WRITEFUNCTION, EMASManagerTestDiscardBody);
+    curl_easy_setopt(easy, CURLOPT_NOSIGNAL, 1L);
+    if (timeoutMs > 0) {
+        curl_easy_setopt(easy, CURLOPT_TIMEOUT_MS, timeoutMs);
+    }
+    return easy;
+}
+
+// 慢速下载占住host，timeoutMs后由libcurl超时结束
+- (XCTestExpectation *)enqueueSlowTransferWithTimeoutMs:(long)timeoutMs admission:(EMASCurlAdaptiveAdmission)admission {
+    XCTestExpectation *expectation = [self expectationWithDescription:@"slow transfer"];
+    [[EMASCurlManager sharedInstance] enqueueNewEasyHandle:[self easyHandleForPath:PATH_DOWNLOAD_1MB_DATA_AT_200KBPS_SPEED timeoutMs:timeoutMs]
+                                                  priority:EMASCurlRequestPriorityDefault
+                                                      host:@"127.0.0.1"
+                                         adaptiveAdmission:admission
+                                                   timeout:0
+                                         cancellationCheck:nil
+                                                completion:^(BOOL succeeded, NSError *error, EMASCurlMetricsData *metrics) {
+        [expectation fulfill];
+    }];
+    return expectation;
+}
+
+// 同一host的请求数达到上限时，后到的请求等前一个结束后才开始
+- (void)testHostConcurrencyHoldsRequestsBack {
+    self.estimator.hostLimit = 1;
+
+    XCTestExpectation *slowExpectation = [self enqueueSlowTransferWithTimeoutMs:1500 admission:EMASCurlAdaptiveAdmissionHostConcurrency];
+    XCTestExpectation *heldExpectation = [self expectationWithDescription:@"held transfer"];
+    [[EMASCurlManager sharedInstance] enqueueNewEasyHandle:[self easyHandleForPath:PATH_ECHO timeoutMs:0]
+                                                  priority:EMASCurlRequestPriorityDefault
+                                                      host:@"127.0.0.1"
+                                         adaptiveAdmission:EMASCurlAdaptiveAdmissionHostConcurrency
+                                                   timeout:0
+                                         cancellationCheck:nil
+                                                completion:^(BOOL succeeded, NSError *error, EMASCurlMetricsData *metrics) {
+        XCTAssertTrue(succeeded);
+        [heldExpectation fulfill];
+    }];
+
+    [self waitForExpectations:@[slowExpectation, heldExpectation] timeout:10 enforceOrder:YES];
+}
+
+// 网络差时，后台请求等前台请求结束后才开始
+- (void)testPrefetchGatingDefersBackgroundRequests {
+    self.estimator.deferBackground = YES;
+
+    XCTestExpectation *foregroundExpectation = [self enqueueSlowTransferWithTimeoutMs:1500 admission:EMASCurlAdaptiveAdmissionNone];
+    XCTestExpectation *backgroundExpectation = [self expectationWithDescription:@"background transfer"];
+    [[EMASCurlManager sharedInstance] enqueueNewEasyHandle:[self easyHandleForPath:PATH_ECHO timeoutMs:0]
+                                                  priority:EMASCurlRequestPriorityBackground
+                                                      host:@"127.0.0.1"
+                                         adaptiveAdmission:EMASCurlAdaptiveAdmissionPrefetchGating
+                                                   timeout:0
+                                         cancellationCheck:nil
+                                                completion:^(BOOL succeeded, NSError *error, EMASCurlMetricsData *metrics) {
+        XCTAssertTrue(succeeded);
+        [backgroundExpectation fulfill];
+    }];
+
+    [self waitForExpectations:@[foregroundExpectation, backgroundExpectation] timeout:10 enforceOrder:YES];
+}
+
+// 排队中被取消的请求立即以取消错误结束，不等占住host的传输
+- (void)testCancelledDeferredRequestCompletes {
+    self.estimator.hostLimit = 1;
+    self.deferredCancelled = NO;
+
+    XCTestExpectation *slowExpectation = [self enqueueSlowTransferWithTimeoutMs:3000 admission:EMASCurlAdaptiveAdmissionHostConcurrency];
+    XCTestExpectation *cancelledExpectation = [self expectationWithDescription:@"cancelled transfer"];
+    __weak typeof(self) weakSelf = self;
+    [[EMASCurlManager sharedInstance] enqueueNewEasyHandle:[self easyHandleForPath:PATH_ECHO timeoutMs:0]
+                                                  priority:EMASCurlRequestPriorityDefault
+                                                      host:@"127.0.0.1"
+                                         adaptiveAdmission:EMASCurlAdaptiveAdmissionHostConcurrency
+                                                   timeout:0
+                                         cancellationCheck:^BOOL{
+        return weakSelf.deferredCancelled;
+    }
+                                                completion:^(BOOL succeeded, NSError *error, EMASCurlMetricsData *metrics) {
+        XCTAssertFalse(succeeded);
+        XCTAssertEqualObjects(error.domain, NSURLErrorDomain);
+        XCTAssertEqual(error.code, NSURLErrorCancelled);
+        [cancelledExpectation fulfill];
+    }];
+
+    dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t)(0.3 * NSEC_PER_SEC)), dispatch_get_main_queue(), ^{
+        self.deferredCancelled = YES;
+        [[EMASCurlManager sharedInstance] wakeup];
+    });
+
+    [self waitForExpectations:@[cancelledExpectation, slowExpectation] timeout:10 enforceOrder:YES];
+}
+
+// 排队超过请求超时的请求以超时错误结束
+- (void)testDeferredRequestTimesOut {
+    self.estimator.hostLimit = 1;
+
+    XCTestExpectation *slowExpectation = [self enqueueSlowTransferWithTimeoutMs:3000 admission:EMASCurlAdaptiveAdmissionHostConcurrency];
+    XCTestExpectation *timedOutExpectation = [self expectationWithDescription:@"timed out transfer"];
+    [[EMASCurlManager sharedInstance] enqueueNewEasyHandle:[self easyHandleForPath:PATH_ECHO timeoutMs:0]
+                                                  priority:EMASCurlRequestPriorityDefault
+                                                      host:@"127.0.0.1"
+                                         adaptiveAdmission:EMASCurlAdaptiveAdmissionHostConcurrency
+                                                   timeout:0.5
+                                         cancellationCheck:nil
+                                                completion:^(BOOL succeeded, NSError *error, EMASCurlMetricsData *metrics) {
+        XCTAssertFalse(succeeded);
+        XCTAssertEqual(error.code, NSURLErrorTimedOut);
+        [timedOutExpectation fulfill];
+    }];
+
+    [self waitForExpectations:@[timedOutExpectation, slowExpectation] timeout:10 enforceOrder:YES];
+}
+
+@end
@@ -0,0 +1,99 @@
+//
+//  EMASCurlMemoryPressureTest.m
+//  EMASCurlTests
+//
+//  Created by xuyecan on 2026/10/18.
+//
+
+#import <XCTest/XCTest.h>
+#import <EMASCurl/EMASCurl.h>
+#import "EMASCurlTestConstants.h"
+#import "EMASCurlMemoryPressureManager.h"
+
+@interface EMASCurlMemoryPressureTest : XCTestCase
+
+@property (nonatomic, strong) NSURLSession *session;
+
+@end
+
+@implementation EMASCurlMemoryPressureTest
+
+- (void)setUp {
+    [super setUp];
+    [EMASCurlProtocol setLogLevel:EMASCurlLogLevelError];
+
+    EMASCurlConfiguration *curlConfig = [EMASCurlConfiguration defaultConfiguration];
+    curlConfig.cacheEnabled = YES;
+
+    NSURLSessionConfiguration *config = [NSURLSessionConfiguration defaultSessionConfiguration];
+    [EMASCurlProtocol installIntoSessionConfiguration:config withConfiguration:curlConfig];
+    self.session = [NSURLSession sessionWithConfiguration:config delegate:nil delegateQueue:nil];
+}
+
+- (void)tearDown {
+    [EMASCurlProtocol setMemoryPressureObserverBlock:nil];
+    [[EMASCurlMemoryPressureManager sharedManager] simulateMemoryPressure:EMASCurlMemoryPressureNormal];
+    [self.session invalidateAndCancel];
+    self.session = nil;
+    [super tearDown];
+}
+
+- (void)testWarningReportsEveryComponent {
+    XCTestExpectation *expectation = [self expectationWithDescription:@"memory pressure event"];
+    [EMASCurlProtocol setMemoryPressureObserverBlock:^(EMASCurlMemoryPressureEvent *event) {
+        XCTAssertEqual(event.level, EMASCurlMemoryPressureWarning);
+        XCTAssertNotNil(event.releasedBytesByComponent[EMASCurlMemoryComponentResponseCache]);
+        XCTAssertNotNil(event.releasedBytesByComponent[EMASCurlMemoryComponentTransferBuffers]);
+        [expectation fulfill];
+    }];
+
+    [[EMASCurlMemoryPressureManager sharedManager] simulateMemoryPressure:EMASCurlMemoryPressureWarning];
+    [self waitForExpectationsWithTimeout:5 handler:nil];
+    XCTAssertEqual([EMASCurlMemoryPressureManager sharedManager].currentLevel, EMASCurlMemoryPressureWarning);
+}
+
+// 应用共享的NSURLCache也服务于宿主自己的请求，内存压力处理不应调整其容量
+- (void)testCriticalPressureKeepsSharedURLCacheCapacity {
+    NSUInteger memoryCapacity = [NSURLCache sharedURLCache].memoryCapacity;
+    XCTestExpectation *expectation = [self expectationWithDescription:@"memory pressure event"];
+    [EMASCurlProtocol setMemoryPressureObserverBlock:^(EMASCurlMemoryPressureEvent *event) {
+        [expectation fulfill];
+    }];
+
+    [[EMASCurlMemoryPressureManager sharedManager] simulateMemoryPressure:EMASCurlMemoryPressureCritical];
+    [self waitForExpectationsWithTimeout:5 handler:nil];
+    XCTAssertEqual([NSURLCache sharedURLCache].memoryCapacity, memoryCapacity);
+}
+
+- (void)testCriticalPressureReleasesInFlightCacheBuffer {
+    NSURL *url = [NSURL URLWithString:[NSString stringWithFormat:@"%@%@", HTTP11_ENDPOINT, PATH_DOWNLOAD_1MB_DATA_AT_200KBPS_SPEED]];
+    XCTestExpectation *downloadExpectation = [self expectationWithDescription:@"download completes"];
+    NSURLSessionDataTask *task = [self.session dataTaskWithURL:url completionHandler:^(NSData *data, NSURLResponse *response, NSError *error) {
+        // 释放的只是缓存缓冲，交付给客户端的数据不受影响
+        XCTAssertNil(error);
+        XCTAssertEqual(data.length, 1024 * 1024);
+        [downloadExpectation fulfill];
+    }];
+    [task resume];
+
+    // 服务端每秒发送200KB，等待缓冲累积一部分数据
+    [NSThread sleepForTimeInterval:2.5];
+
+    XCTestExpectation *eventExpectation = [self expectationWithDescription:@"memory pressure event"];
+    __block EMASCurlMemoryPressureEvent *receivedEvent = nil;
+    [EMASCurlProtocol setMemoryPressureObserverBlock:^(EMASCurlMemoryPressureEvent *event) {
+        receivedEvent = event;
+        [eventExpectation fulfill];
+    }];
+    [[EMASCurlMemoryPressureManager sharedManager] simulateMemoryPressure:EMASCurlMemoryPressureCritical];
+
+    [self waitForExpectations:@[eventExpectation] timeout:5];
+    XCTAssertEqual(receivedEvent.level, EMASCurlMemoryPressureCritical);
+    XCTAssertGreaterThan([receivedEvent.releasedBytesByComponent[EMASCurlMemoryComponentTransferBuffers] unsignedIntegerValue], 0);
+    XCTAssertGreaterThanOrEqual(receivedEvent.releasedBytes,
+                                [receivedEvent.releasedBytesByComponent[EMASCurlMemoryComponentTransferBuffers] unsignedIntegerValue]);
+
+    [self waitForExpectations:@[downloadExpectation] timeout:30];
+}
+
+@end
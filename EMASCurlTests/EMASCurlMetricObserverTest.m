@@ -183,6 +183,49 @@
     [self downloadDataWithMetrics:HTTP11_ENDPOINT];
 }
 
+// 各时间点由同一单调起点换算，应按阶段先后排列，且不晚于客户端收到完成回调
+- (void)testTimestampsOrderedByPhase {
+    NSURL *url = [NSURL URLWithString:[NSString stringWithFormat:@"%@%@", HTTP11_ENDPOINT, PATH_ECHO]];
+    dispatch_semaphore_t semaphore = dispatch_semaphore_create(0);
+    __block EMASCurlTransactionMetrics *receivedMetrics = nil;
+
+    [EMASCurlProtocol setGlobalTransactionMetricsObserverBlock:^(NSURLRequest * _Nonnull request, BOOL success, NSError * _Nullable error, EMASCurlTransactionMetrics * _Nonnull metrics) {
+        XCTAssertTrue(success);
+        receivedMetrics = metrics;
+    }];
+
+    NSDate *beforeStart = [NSDate date];
+    __block NSDate *afterCompletion = nil;
+    [[self.session dataTaskWithURL:url completionHandler:^(NSData *data, NSURLResponse *response, NSError *error) {
+        XCTAssertNil(error);
+        afterCompletion = [NSDate date];
+        dispatch_semaphore_signal(semaphore);
+    }] resume];
+    XCTAssertEqual(dispatch_semaphore_wait(semaphore, dispatch_time(DISPATCH_TIME_NOW, 10 * NSEC_PER_SEC)), 0, @"Request timed out");
+    [EMASCurlProtocol setGlobalTransactionMetricsObserverBlock:nil];
+
+    XCTAssertNotNil(receivedMetrics);
+    NSArray<NSDate *> *ordered = @[
+        receivedMetrics.fetchStartDate,
+        receivedMetrics.requestStartDate,
+        receivedMetrics.requestEndDate,
+        receivedMetrics.responseStartDate,
+        receivedMetrics.responseEndDate,
+    ];
+    for (NSUInteger i = 1; i < ordered.count; i++) {
+        XCTAssertLessThanOrEqual([ordered[i - 1] timeIntervalSince1970], [ordered[i] timeIntervalSince1970], @"Timestamp %lu out of order", (unsigned long)i);
+    }
+    if (receivedMetrics.connectEndDate) {
+        XCTAssertLessThanOrEqual([receivedMetrics.connectStartDate timeIntervalSince1970], [receivedMetrics.connectEndDate timeIntervalSince1970]);
+        XCTAssertLessThanOrEqual([receivedMetrics.connectEndDate timeIntervalSince1970], [receivedMetrics.requestStartDate timeIntervalSince1970]);
+    }
+    XCTAssertNil(receivedMetrics.secureConnectionStartDate, @"明文HTTP不应有TLS时间点");
+
+    // 墙上时间只在起点取一次，与外部测得的区间一致
+    XCTAssertGreaterThanOrEqual([receivedMetrics.fetchStartDate timeIntervalSinceDate:beforeStart], -0.001);
+    XCTAssertLessThanOrEqual([receivedMetrics.responseEndDate timeIntervalSinceDate:afterCompletion], 0.001);
+}
+
 @end
 
 @interface EMASCurlMetricsTestHttp2 : EMASCurlMetricsTestBase
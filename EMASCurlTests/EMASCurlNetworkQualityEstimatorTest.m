@@ -0,0 +1,123 @@
+//
+//  EMASCurlNetworkQualityEstimatorTest.m
+//  EMASCurlTests
+//
+//  Created by xuyecan on 2026/10/18.
+//
+
+#import <XCTest/XCTest.h>
+#import <EMASCurl/EMASCurl.h>
+#import "EMASCurlManager.h"
+#import "EMASCurlNetworkQualityEstimator.h"
+
+@interface EMASCurlNetworkQualityEstimatorTest : XCTestCase
+@property (nonatomic, strong) EMASCurlNetworkQualityEstimator *estimator;
+@end
+
+@implementation EMASCurlNetworkQualityEstimatorTest
+
+- (void)setUp {
+    [super setUp];
+    // 独立实例，不受其他用例发出的真实请求影响
+    self.estimator = [[EMASCurlNetworkQualityEstimator alloc] init];
+}
+
+// 新建连接的请求：握手耗时rttMs，在durationMs内下载bytes字节
+- (EMASCurlMetricsData *)metricsWithRTTMs:(double)rttMs bytes:(long long)bytes durationMs:(double)durationMs {
+    EMASCurlMetricsData *metrics = [[EMASCurlMetricsData alloc] init];
+    EMASCurlPhaseTimings timings = {0};
+    timings.nameLookup = 5000;
+    timings.connect = timings.nameLookup + (curl_off_t)(rttMs * 1000);
+    timings.preTransfer = timings.connect;
+    timings.startTransfer = timings.connect + (curl_off_t)(rttMs * 1000);
+    timings.total = timings.startTransfer + (curl_off_t)(durationMs * 1000);
+    metrics.timings = timings;
+    metrics.numConnects = 1;
+    metrics.httpVersion = CURL_HTTP_VERSION_1_1;
+    metrics.downloadBytes = bytes;
+    return metrics;
+}
+
+- (void)testUnknownWithoutSamples {
+    XCTAssertEqual([self.estimator currentQuality], EMASCurlNetworkQualityUnknown);
+    XCTAssertEqual([self.estimator connectTimeoutForBaseTimeout:2.5], 2.5);
+    XCTAssertEqual([self.estimator maxConcurrentTransfersPerHost], 0);
+    XCTAssertFalse([self.estimator shouldDeferBackgroundTransfers]);
+}
+
+- (void)testSlowNetworkClassifiedPoor {
+    for (int i = 0; i < 3; i++) {
+        [self.estimator recordMetrics:[self metricsWithRTTMs:1500 bytes:64 * 1024 durationMs:4000] result:CURLE_OK];
+    }
+
+    EMASCurlNetworkQualityEstimate *estimate = [self.estimator currentEstimate];
+    XCTAssertEqual(estimate.quality, EMASCurlNetworkQualityPoor);
+    XCTAssertEqualWithAccuracy(estimate.rtt, 1.5, 0.001);
+    XCTAssertEqualWithAccuracy(estimate.throughput, 16 * 1024, 1);
+    XCTAssertEqual(estimate.failureRate, 0);
+    XCTAssertEqual(estimate.sampleCount, 3);
+    XCTAssertGreaterThan(estimate.network.length, 0);
+
+    // RTT的8倍超过上限，取基准超时的4倍
+    XCTAssertEqualWithAccuracy([self.estimator connectTimeoutForBaseTimeout:2.5], 10.0, 0.001);
+    XCTAssertEqual([self.estimator maxConcurrentTransfersPerHost], 2);
+    XCTAssertTrue([self.estimator shouldDeferBackgroundTransfers]);
+}
+
+- (void)testFastNetworkClassifiedExcellent {
+    for (int i = 0; i < 3; i++) {
+        [self.estimator recordMetrics:[self metricsWithRTTMs:20 bytes:1024 * 1024 durationMs:200] result:CURLE_OK];
+    }
+
+    XCTAssertEqual([self.estimator currentQuality], EMASCurlNetworkQualityExcellent);
+    // RTT的8倍低于下限，取1秒
+    XCTAssertEqualWithAccuracy([self.estimator connectTimeoutForBaseTimeout:2.5], 1.0, 0.001);
+    XCTAssertEqual([self.estimator maxConcurrentTransfersPerHost], 0);
+    XCTAssertFalse([self.estimator shouldDeferBackgroundTransfers]);
+}
+
+- (void)testNetworkFailuresDegradeQuality {
+    for (int i = 0; i < 2; i++) {
+        [self.estimator recordMetrics:[self metricsWithRTTMs:20 bytes:0 durationMs:10] result:CURLE_OK];
+    }
+    XCTAssertEqual([self.estimator currentQuality], EMASCurlNetworkQualityExcellent);
+
+    for (int i = 0; i < 5; i++) {
+        [self.estimator recordMetrics:[[EMASCurlMetricsData alloc] init] result:CURLE_COULDNT_CONNECT];
+    }
+    EMASCurlNetworkQualityEstimate *estimate = [self.estimator currentEstimate];
+    XCTAssertEqual(estimate.quality, EMASCurlNetworkQualityPoor);
+    XCTAssertGreaterThan(estimate.failureRate, 0.3);
+}
+
+// 被限速或暂停过的传输只提供RTT与失败率样本，慢速下载不拉低质量
+- (void)testThrottledTransfersSkipThroughput {
+    for (int i = 0; i < 3; i++) {
+        [self.estimator recordMetrics:[self metricsWithRTTMs:20 bytes:64 * 1024 durationMs:4000] result:CURLE_OK sampleThroughput:NO];
+    }
+
+    EMASCurlNetworkQualityEstimate *estimate = [self.estimator currentEstimate];
+    XCTAssertEqual(estimate.quality, EMASCurlNetworkQualityExcellent);
+    XCTAssertEqualWithAccuracy(estimate.rtt, 0.02, 0.001);
+    XCTAssertEqual(estimate.throughput, 0);
+    XCTAssertFalse([self.estimator shouldDeferBackgroundTransfers]);
+}
+
+// 取消与复用连接的请求不提供样本
+- (void)testIgnoredSamples {
+    for (int i = 0; i < 10; i++) {
+        [self.estimator recordMetrics:[[EMASCurlMetricsData alloc] init] result:CURLE_ABORTED_BY_CALLBACK];
+    }
+    XCTAssertEqual([self.estimator currentEstimate].sampleCount, 0);
+
+    EMASCurlMetricsData *reused = [self metricsWithRTTMs:20 bytes:0 durationMs:10];
+    reused.numConnects = 0;
+    for (int i = 0; i < 3; i++) {
+        [self.estimator recordMetrics:reused result:CURLE_OK];
+    }
+    EMASCurlNetworkQualityEstimate *estimate = [self.estimator currentEstimate];
+    XCTAssertEqual(estimate.rtt, 0);
+    XCTAssertEqual(estimate.quality, EMASCurlNetworkQualityUnknown);
+}
+
+@end
@@ -0,0 +1,123 @@
+//
+//  EMASCurlProxySettingTest.m
+//  EMASCurlTests
+//
+//  Created by xuyecan on 2026/10/18.
+//
+
+#import <XCTest/XCTest.h>
+#import <CFNetwork/CFNetwork.h>
+#import "EMASCurlProxySetting.h"
+
+static NSDictionary *EMASTestHTTPProxySettings(NSString *host, NSInteger port) {
+    return @{
+        (NSString *)kCFNetworkProxiesHTTPEnable: @1,
+        (NSString *)kCFNetworkProxiesHTTPProxy: host,
+        (NSString *)kCFNetworkProxiesHTTPPort: @(port),
+    };
+}
+
+@interface EMASCurlProxySettingTest : XCTestCase
+@end
+
+@implementation EMASCurlProxySettingTest
+
+- (void)setUp {
+    [super setUp];
+    [EMASCurlProxySetting overrideSystemProxySettings:EMASTestHTTPProxySettings(@"10.0.0.1", 8080)];
+}
+
+- (void)tearDown {
+    [EMASCurlProxySetting setManualProxyServer:nil];
+    [EMASCurlProxySetting overrideSystemProxySettings:nil];
+    [super tearDown];
+}
+
+- (void)testInvalidURLHasNoProxy {
+    XCTAssertNil([EMASCurlProxySetting proxyServerForURL:nil]);
+    XCTAssertNil([EMASCurlProxySetting proxyServerForURL:[NSURL URLWithString:@"/relative/path"]]);
+}
+
+// 同一(scheme, host, port)下不同路径共享决策，缓存命中与未命中时结果一致
+- (void)testDecisionIsSharedAcrossPaths {
+    NSURL *first = [NSURL URLWithString:@"http://proxy-cache.example.com/a"];
+    NSURL *second = [NSURL URLWithString:@"http://PROXY-CACHE.example.com:80/b/c?x=1"];
+    for (int i = 0; i < 3; i++) {
+        XCTAssertEqualObjects([EMASCurlProxySetting proxyServerForURL:first], @"http://10.0.0.1:8080");
+        XCTAssertEqualObjects([EMASCurlProxySetting proxyServerForURL:second], @"http://10.0.0.1:8080");
+    }
+}
+
+// 代理设置变化后立即使用新的决策，不返回缓存中的旧决策
+- (void)testSettingsChangeReplacesDecisions {
+    NSURL *url = [NSURL URLWithString:@"http://proxy-change.example.com/"];
+    XCTAssertEqualObjects([EMASCurlProxySetting proxyServerForURL:url], @"http://10.0.0.1:8080");
+
+    [EMASCurlProxySetting overrideSystemProxySettings:EMASTestHTTPProxySettings(@"10.0.0.2", 3128)];
+    XCTAssertEqualObjects([EMASCurlProxySetting proxyServerForURL:url], @"http://10.0.0.2:3128");
+    XCTAssertEqualObjects([EMASCurlProxySetting proxyServerForURL:url], @"http://10.0.0.2:3128");
+
+    [EMASCurlProxySetting overrideSystemProxySettings:@{}];
+    XCTAssertNil([EMASCurlProxySetting proxyServerForURL:url]);
+}
+
+// 启用手动代理后系统代理决策失效，不再返回系统代理
+- (void)testManualProxyInvalidatesDecisions {
+    NSURL *url = [NSURL URLWithString:@"http://proxy-manual.example.com/"];
+    XCTAssertEqualObjects([EMASCurlProxySetting proxyServerForURL:url], @"http://10.0.0.1:8080");
+    [EMASCurlProxySetting setManualProxyServer:@"http://127.0.0.1:8888"];
+    XCTAssertNil([EMASCurlProxySetting proxyServerForURL:url]);
+}
+
+// 读取与替换快照并发进行，每次读到的都是某一份设置下的有效决策
+- (void)testConcurrentReadsDuringSettingsChanges {
+    NSSet<NSString *> *valid = [NSSet setWithObjects:@"http://10.0.0.1:8080", @"http://10.0.0.2:3128", nil];
+    NSURL *url = [NSURL URLWithString:@"http://proxy-race.example.com/"];
+    __block BOOL stop = NO;
+    __block NSUInteger invalidCount = 0;
+
+    dispatch_group_t group = dispatch_group_create();
+    for (int reader = 0; reader < 4; reader++) {
+        dispatch_group_async(group, dispatch_get_global_queue(QOS_CLASS_USER_INITIATED, 0), ^{
+            while (!stop) {
+                @autoreleasepool {
+                    NSString *proxy = [EMASCurlProxySetting proxyServerForURL:url];
+                    if (![valid containsObject:proxy]) {
+                        @synchronized (valid) {
+                            invalidCount++;
+                        }
+                    }
+                }
+            }
+        });
+    }
+    for (int i = 0; i < 200; i++) {
+        [EMASCurlProxySetting overrideSystemProxySettings:(i % 2) ? EMASTestHTTPProxySettings(@"10.0.0.1", 8080)
+                                                                  : EMASTestHTTPProxySettings(@"10.0.0.2", 3128)];
+    }
+    stop = YES;
+    XCTAssertEqual(dispatch_group_wait(group, dispatch_time(DISPATCH_TIME_NOW, 5 * NSEC_PER_SEC)), 0);
+    XCTAssertEqual(invalidCount, 0);
+}
+
+- (void)testPerformanceCachedDecision {
+    NSMutableArray<NSURL *> *urls = [NSMutableArray new];
+    for (int i = 0; i < 100; i++) {
+        [urls addObject:[NSURL URLWithString:[NSString stringWithFormat:@"https://host%d.example.com/path/%d", i % 10, i]]];
+    }
+    for (NSURL *url in urls) {
+        [EMASCurlProxySetting proxyServerForURL:url];
+    }
+
+    [self measureBlock:^{
+        for (int round = 0; round < 200; round++) {
+            @autoreleasepool {
+                for (NSURL *url in urls) {
+                    (void)[EMASCurlProxySetting proxyServerForURL:url];
+                }
+            }
+        }
+    }];
+}
+
+@end
@@ -0,0 +1,271 @@
+//
+//  EMASCurlRequestMatcherTest.m
+//  EMASCurlTests
+//
+//  Created by xuyecan on 2026/10/18.
+//
+
+#import <XCTest/XCTest.h>
+#import <EMASCurl/EMASCurl.h>
+#import "EMASCurlRequestMatcher.h"
+
+// 改造前canInitWithRequest中的逐条路径匹配，作为语义与性能对照
+static BOOL EMASLegacyPathMatchesPattern(NSString *requestPath, NSString *pattern) {
+    if ([pattern hasSuffix:@"/**"]) {
+        NSString *prefix = [pattern substringToIndex:pattern.length - 3];
+        return [requestPath isEqualToString:prefix] ||
+               [requestPath hasPrefix:[prefix stringByAppendingString:@"/"]];
+    }
+    if ([pattern hasSuffix:@"/*"]) {
+        NSString *prefix = [pattern substringToIndex:pattern.length - 2];
+        if ([requestPath isEqualToString:prefix]) {
+            return YES;
+        }
+        if ([requestPath hasPrefix:[prefix stringByAppendingString:@"/"]]) {
+            NSString *remaining = [requestPath substringFromIndex:prefix.length + 1];
+            return ![remaining containsString:@"/"];
+        }
+        return NO;
+    }
+    return [requestPath isEqualToString:pattern];
+}
+
+static NSArray<NSString *> *EMASBenchmarkDomainRules(void) {
+    NSMutableArray<NSString *> *rules = [NSMutableArray new];
+    NSArray<NSString *> *suffixes = @[@"com", @"cn", @"net", @"com.cn", @"org"];
+    for (int i = 0; i < 1000; i++) {
+        [rules addObject:[NSString stringWithFormat:@"service%d.vendor%d.%@", i, i % 37, suffixes[i % suffixes.count]]];
+    }
+    return rules;
+}
+
+static NSArray<NSString *> *EMASBenchmarkPathRules(void) {
+    NSMutableArray<NSString *> *rules = [NSMutableArray new];
+    for (int i = 0; i < 500; i++) {
+        switch (i % 3) {
+            case 0:
+                [rules addObject:[NSString stringWithFormat:@"/api/v%d/module%d/action.do", i % 5, i]];
+                break;
+            case 1:
+                [rules addObject:[NSString stringWithFormat:@"/static/group%d/*", i]];
+                break;
+            default:
+                [rules addObject:[NSString stringWithFormat:@"/gateway/app%d/**", i]];
+                break;
+        }
+    }
+    return rules;
+}
+
+// 大部分请求不命中任何规则，与实际被拦截的业务请求分布接近
+static NSArray<NSURL *> *EMASBenchmarkURLs(void) {
+    NSMutableArray<NSURL *> *urls = [NSMutableArray new];
+    for (int i = 0; i < 200; i++) {
+        NSString *string = nil;
+        switch (i % 4) {
+            case 0:
+                string = [NSString stringWithFormat:@"https://img%d.cdn.example.com/static/group%d/image.webp", i, i];
+                break;
+            case 1:
+                string = [NSString stringWithFormat:@"https://api.example.com/api/v2/module%d/action.do?id=%d", i, i];
+                break;
+            case 2:
+                string = [NSString stringWithFormat:@"https://service%d.vendor%d.com/gateway/app%d/a/b", i, i % 37, i];
+                break;
+            default:
+                string = [NSString stringWithFormat:@"https://m.example.org/page/%d/detail", i];
+                break;
+        }
+        [urls addObject:[NSURL URLWithString:string]];
+    }
+    return urls;
+}
+
+@interface EMASCurlRequestMatcherTest : XCTestCase
+@end
+
+@implementation EMASCurlRequestMatcherTest
+
+- (EMASCurlRequestMatcher *)matcherWithBlackList:(NSArray *)blackList whiteList:(NSArray *)whiteList paths:(NSArray *)paths {
+    return [[EMASCurlRequestMatcher alloc] initWithDomainBlackList:blackList domainWhiteList:whiteList urlPathBlackList:paths];
+}
+
+#pragma mark - 域名
+
+// 与hasSuffix:一致：按字符串后缀匹配，不要求在标签边界
+- (void)testDomainRulesKeepSuffixSemantics {
+    EMASCurlRequestMatcher *matcher = [self matcherWithBlackList:@[@"example.com", @".internal.cn", @""] whiteList:nil paths:nil];
+    XCTAssertTrue([matcher hostMatchesDomainBlackList:@"example.com"]);
+    XCTAssertTrue([matcher hostMatchesDomainBlackList:@"api.example.com"]);
+    XCTAssertTrue([matcher hostMatchesDomainBlackList:@"myexample.com"]);
+    XCTAssertTrue([matcher hostMatchesDomainBlackList:@"a.internal.cn"]);
+    XCTAssertFalse([matcher hostMatchesDomainBlackList:@"internal.cn"]);
+    XCTAssertFalse([matcher hostMatchesDomainBlackList:@"example.com.cn"]);
+    XCTAssertFalse([matcher hostMatchesDomainBlackList:@"EXAMPLE.COM"], @"与hasSuffix:一样区分大小写");
+    XCTAssertFalse([matcher hostMatchesDomainBlackList:@""]);
+    XCTAssertFalse(matcher.hasDomainWhiteList);
+    XCTAssertFalse([matcher hostMatchesDomainWhiteList:@"example.com"]);
+}
+
+- (void)testDomainRulesMatchNonASCIIHost {
+    EMASCurlRequestMatcher *matcher = [self matcherWithBlackList:nil whiteList:@[@"例子.中国"] paths:nil];
+    XCTAssertTrue(matcher.hasDomainWhiteList);
+    XCTAssertTrue([matcher hostMatchesDomainWhiteList:@"www.例子.中国"]);
+    XCTAssertFalse([matcher hostMatchesDomainWhiteList:@"www.例子.com"]);
+}
+
+// 只包含空字符串的白名单仍视为启用，与原先count > 0的判断一致
+- (void)testWhiteListWithOnlyEmptyRuleIsEnabled {
+    EMASCurlRequestMatcher *matcher = [self matcherWithBlackList:nil whiteList:@[@""] paths:nil];
+    XCTAssertTrue(matcher.hasDomainWhiteList);
+    XCTAssertFalse([matcher hostMatchesDomainWhiteList:@"example.com"]);
+}
+
+#pragma mark - 路径
+
+- (void)testPathPatterns {
+    NSArray *patterns = @[@"/exact/file.do", @"/single/*", @"/multi/**", @"/**/literal"];
+    EMASCurlRequestMatcher *matcher = [self matcherWithBlackList:nil whiteList:nil paths:patterns];
+
+    XCTAssertEqualObjects([matcher urlPathBlackListPatternMatchingPath:@"/exact/file.do"], @"/exact/file.do");
+    XCTAssertNil([matcher urlPathBlackListPatternMatchingPath:@"/exact/file.do/more"]);
+    XCTAssertNil([matcher urlPathBlackListPatternMatchingPath:@"/exact"]);
+
+    XCTAssertEqualObjects([matcher urlPathBlackListPatternMatchingPath:@"/single"], @"/single/*");
+    XCTAssertEqualObjects([matcher urlPathBlackListPatternMatchingPath:@"/single/"], @"/single/*");
+    XCTAssertEqualObjects([matcher urlPathBlackListPatternMatchingPath:@"/single/a"], @"/single/*");
+    XCTAssertNil([matcher urlPathBlackListPatternMatchingPath:@"/single/a/b"]);
+    XCTAssertNil([matcher urlPathBlackListPatternMatchingPath:@"/singles/a"]);
+
+    XCTAssertEqualObjects([matcher urlPathBlackListPatternMatchingPath:@"/multi"], @"/multi/**");
+    XCTAssertEqualObjects([matcher urlPathBlackListPatternMatchingPath:@"/multi/a/b/c"], @"/multi/**");
+    XCTAssertEqualObjects([matcher urlPathBlackListPatternMatchingPath:@"/multi//"], @"/multi/**");
+    XCTAssertNil([matcher urlPathBlackListPatternMatchingPath:@"/multiple"]);
+
+    // 通配符只在结尾生效，其余位置按字面匹配
+    XCTAssertEqualObjects([matcher urlPathBlackListPatternMatchingPath:@"/**/literal"], @"/**/literal");
+    XCTAssertNil([matcher urlPathBlackListPatternMatchingPath:@"/a/literal"]);
+
+    XCTAssertNil([matcher urlPathBlackListPatternMatchingPath:@""]);
+}
+
+- (void)testRootWildcards {
+    EMASCurlRequestMatcher *single = [self matcherWithBlackList:nil whiteList:nil paths:@[@"/*"]];
+    XCTAssertNotNil([single urlPathBlackListPatternMatchingPath:@"/"]);
+    XCTAssertNotNil([single urlPathBlackListPatternMatchingPath:@"/a"]);
+    XCTAssertNil([single urlPathBlackListPatternMatchingPath:@"/a/b"]);
+
+    EMASCurlRequestMatcher *multi = [self matcherWithBlackList:nil whiteList:nil paths:@[@"/**"]];
+    XCTAssertNotNil([multi urlPathBlackListPatternMatchingPath:@"/"]);
+    XCTAssertNotNil([multi urlPathBlackListPatternMatchingPath:@"/a/b/c"]);
+}
+
+// 随机模式与路径下，与原逐条匹配的结果保持一致
+- (void)testPathMatchingAgreesWithLegacyMatching {
+    NSArray<NSString *> *alphabet = @[@"/", @"a", @"b", @"*"];
+    srand48(20261018);
+    for (int round = 0; round < 3000; round++) {
+        NSMutableArray<NSString *> *patterns = [NSMutableArray new];
+        NSUInteger patternCount = 1 + (NSUInteger)(drand48() * 4);
+        for (NSUInteger i = 0; i < patternCount; i++) {
+            NSMutableString *pattern = [NSMutableString new];
+            NSUInteger length = (NSUInteger)(drand48() * 7);
+            for (NSUInteger j = 0; j < length; j++) {
+                [pattern appendString:alphabet[(NSUInteger)(drand48() * alphabet.count)]];
+            }
+            [patterns addObject:pattern];
+        }
+        NSMutableString *path = [NSMutableString stringWithString:@"/"];
+        NSUInteger length = (NSUInteger)(drand48() * 7);
+        for (NSUInteger j = 0; j < length; j++) {
+            [path appendString:alphabet[(NSUInteger)(drand48() * alphabet.count)]];
+        }
+
+        EMASCurlRequestMatcher *matcher = [self matcherWithBlackList:nil whiteList:nil paths:patterns];
+        NSString *matched = [matcher urlPathBlackListPatternMatchingPath:path];
+        BOOL expected = NO;
+        for (NSString *pattern in patterns) {
+            expected = expected || EMASLegacyPathMatchesPattern(path, pattern);
+        }
+        XCTAssertEqual(matched != nil, expected, @"path=%@ patterns=%@", path, patterns);
+        if (matched) {
+            XCTAssertTrue(EMASLegacyPathMatchesPattern(path, matched));
+        }
+    }
+}
+
+#pragma mark - 编译缓存
+
+- (void)testConfigurationRecompilesAfterListChange {
+    EMASCurlConfiguration *config = [EMASCurlConfiguration defaultConfiguration];
+    config.domainBlackList = @[@"blocked.com"];
+    EMASCurlRequestMatcher *first = config.requestMatcher;
+    XCTAssertTrue(first == config.requestMatcher, @"名单不变时复用已编译的匹配器");
+    XCTAssertTrue([first hostMatchesDomainBlackList:@"a.blocked.com"]);
+
+    config.urlPathBlackList = @[@"/private/**"];
+    EMASCurlRequestMatcher *second = config.requestMatcher;
+    XCTAssertTrue(first != second);
+    XCTAssertNotNil([second urlPathBlackListPatternMatchingPath:@"/private/x"]);
+    XCTAssertTrue([second hostMatchesDomainBlackList:@"a.blocked.com"]);
+
+    EMASCurlConfiguration *copy = [config copy];
+    XCTAssertTrue([copy.requestMatcher hostMatchesDomainBlackList:@"a.blocked.com"]);
+    copy.domainBlackList = nil;
+    XCTAssertFalse([copy.requestMatcher hostMatchesDomainBlackList:@"a.blocked.com"]);
+    XCTAssertTrue([config.requestMatcher hostMatchesDomainBlackList:@"a.blocked.com"], @"副本修改不影响原配置");
+}
+
+#pragma mark - 微基准
+
+// 1000条域名规则、500条路径规则，对每个URL依次做黑名单、白名单与路径检查
+- (void)testPerformanceCompiledMatcher {
+    NSArray<NSString *> *domains = EMASBenchmarkDomainRules();
+    NSArray<NSString *> *paths = EMASBenchmarkPathRules();
+    NSArray<NSURL *> *urls = EMASBenchmarkURLs();
+    NSArray<NSString *> *hosts = [urls valueForKey:@"host"];
+    NSArray<NSString *> *urlPaths = [urls valueForKey:@"path"];
+    EMASCurlRequestMatcher *matcher = [self matcherWithBlackList:domains whiteList:domains paths:paths];
+
+    [self measureBlock:^{
+        NSUInteger matched = 0;
+        for (int round = 0; round < 50; round++) {
+            for (NSUInteger i = 0; i < hosts.count; i++) {
+                if ([matcher hostMatchesDomainBlackList:hosts[i]]) matched++;
+                if ([matcher hostMatchesDomainWhiteList:hosts[i]]) matched++;
+                if ([matcher urlPathBlackListPatternMatchingPath:urlPaths[i]]) matched++;
+            }
+        }
+        XCTAssertGreaterThan(matched, 0);
+    }];
+}
+
+- (void)testPerformanceLegacyLinearScan {
+    NSArray<NSString *> *domains = EMASBenchmarkDomainRules();
+    NSArray<NSString *> *paths = EMASBenchmarkPathRules();
+    NSArray<NSURL *> *urls = EMASBenchmarkURLs();
+    NSArray<NSString *> *hosts = [urls valueForKey:@"host"];
+    NSArray<NSString *> *urlPaths = [urls valueForKey:@"path"];
+
+    [self measureBlock:^{
+        NSUInteger matched = 0;
+        for (int round = 0; round < 50; round++) {
+            @autoreleasepool {
+                for (NSUInteger i = 0; i < hosts.count; i++) {
+                    for (NSString *domain in domains) {
+                        if ([hosts[i] hasSuffix:domain]) { matched++; break; }
+                    }
+                    for (NSString *domain in domains) {
+                        if ([hosts[i] hasSuffix:domain]) { matched++; break; }
+                    }
+                    for (NSString *pattern in paths) {
+                        if (EMASLegacyPathMatchesPattern(urlPaths[i], pattern)) { matched++; break; }
+                    }
+                }
+            }
+        }
+        XCTAssertGreaterThan(matched, 0);
+    }];
+}
+
+@end
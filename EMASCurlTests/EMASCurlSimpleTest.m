@@ -279,6 +279,56 @@
     }];
 }
 
+// 不设置Accept-Encoding，由内置协商声明libcurl支持的编码；返回解码后的响应体，服务端未按该编码返回时为nil
+- (NSData *)fetchCompressedResponse:(NSString *)endpoint encoding:(NSString *)encoding {
+    NSString *path = [NSString stringWithFormat:@"%@/%@", PATH_COMPRESSION, encoding];
+    __block NSData *body = nil;
+    [self executeRequest:endpoint
+                    path:path
+                  method:@"GET"
+                    body:nil
+                 headers:nil
+         validationBlock:^(NSData *data, NSHTTPURLResponse *response) {
+        NSDictionary *responseHeaders = response.allHeaderFields;
+        NSInteger uncompressedLength = [responseHeaders[@"x-uncompressed-length"] integerValue];
+        XCTAssertEqual(data.length, uncompressedLength, @"Decoded body length mismatch for %@", encoding);
+        if ([responseHeaders[@"content-encoding"] isEqualToString:encoding]) {
+            body = data;
+        }
+    }];
+    return body;
+}
+
+- (void)getEncodedResponse:(NSString *)endpoint encoding:(NSString *)encoding {
+    NSData *body = [self fetchCompressedResponse:endpoint encoding:encoding];
+    // 使用的libcurl未编译该解码器时不会声明此编码，服务端返回未压缩内容
+    XCTSkipIf(body == nil, @"libcurl in this build does not advertise %@", encoding);
+
+    NSString *text = [[NSString alloc] initWithData:body encoding:NSUTF8StringEncoding];
+    XCTAssertTrue([text hasPrefix:@"{\"id\": 0, "], @"Unexpected decoded body prefix");
+    XCTAssertTrue([text hasSuffix:@"\"id\": 16383, \"name\": \"item-16383\", \"description\": \"content encoding throughput payload\"}\n"],
+                  @"Unexpected decoded body suffix");
+}
+
+- (void)getEncodedResponseWithManualAcceptEncoding:(NSString *)endpoint encoding:(NSString *)encoding {
+    // 手动声明的编码经过滤后仍应保留运行时支持的br/zstd
+    NSString *path = [NSString stringWithFormat:@"%@/%@", PATH_COMPRESSION, encoding];
+    NSString *acceptEncoding = [NSString stringWithFormat:@"%@, gzip;q=0.5", encoding];
+    __block NSString *contentEncoding = nil;
+    [self executeRequest:endpoint
+                    path:path
+                  method:@"GET"
+                    body:nil
+                 headers:@{@"Accept-Encoding": acceptEncoding}
+         validationBlock:^(NSData *data, NSHTTPURLResponse *response) {
+        contentEncoding = response.allHeaderFields[@"content-encoding"];
+        XCTAssertEqual(data.length, [response.allHeaderFields[@"x-uncompressed-length"] integerValue],
+                       @"Decoded body length mismatch for %@", encoding);
+    }];
+    XCTSkipIf(contentEncoding == nil, @"libcurl in this build does not advertise %@", encoding);
+    XCTAssertEqualObjects(contentEncoding, encoding);
+}
+
 @end
 
 @interface EMASCurlSimpleTestHttp11 : EMASCurlSimpleTestBase
@@ -346,6 +396,41 @@
     [self getGzipResponse:HTTP11_ENDPOINT];
 }
 
+- (void)testGetBrotliResponse {
+    [self getEncodedResponse:HTTP11_ENDPOINT encoding:@"br"];
+}
+
+- (void)testGetZstdResponse {
+    [self getEncodedResponse:HTTP11_ENDPOINT encoding:@"zstd"];
+}
+
+- (void)testManualAcceptEncodingKeepsBrotliAndZstd {
+    [self getEncodedResponseWithManualAcceptEncoding:HTTP11_ENDPOINT encoding:@"br"];
+    [self getEncodedResponseWithManualAcceptEncoding:HTTP11_ENDPOINT encoding:@"zstd"];
+}
+
+// 对比各编码的端到端解码吞吐（本地服务器，网络开销可忽略），结果输出到日志
+- (void)testContentDecodeThroughput {
+    [EMASCurlProtocol setDebugLogEnabled:NO];
+    NSInteger iterations = 10;
+    for (NSString *encoding in @[@"gzip", @"br", @"zstd"]) {
+        NSData *warmup = [self fetchCompressedResponse:HTTP11_ENDPOINT encoding:encoding];
+        if (!warmup) {
+            NSLog(@"[DecodeThroughput] %@ not advertised by libcurl, skipped", encoding);
+            continue;
+        }
+        CFAbsoluteTime start = CFAbsoluteTimeGetCurrent();
+        NSUInteger totalBytes = 0;
+        for (NSInteger i = 0; i < iterations; i++) {
+            totalBytes += [self fetchCompressedResponse:HTTP11_ENDPOINT encoding:encoding].length;
+        }
+        CFAbsoluteTime elapsed = CFAbsoluteTimeGetCurrent() - start;
+        XCTAssertEqual(totalBytes, warmup.length * iterations);
+        NSLog(@"[DecodeThroughput] %@: %.1f ms per response, %.1f MiB/s decoded",
+              encoding, elapsed * 1000 / iterations, totalBytes / elapsed / (1024 * 1024));
+    }
+}
+
 @end
 
 @interface EMASCurlSimpleTestHttp2 : EMASCurlSimpleTestBase
@@ -418,4 +503,17 @@
     [self getGzipResponse:HTTP2_ENDPOINT];
 }
 
+- (void)testGetBrotliResponse {
+    [self getEncodedResponse:HTTP2_ENDPOINT encoding:@"br"];
+}
+
+- (void)testGetZstdResponse {
+    [self getEncodedResponse:HTTP2_ENDPOINT encoding:@"zstd"];
+}
+
+- (void)testManualAcceptEncodingKeepsBrotliAndZstd {
+    [self getEncodedResponseWithManualAcceptEncoding:HTTP2_ENDPOINT encoding:@"br"];
+    [self getEncodedResponseWithManualAcceptEncoding:HTTP2_ENDPOINT encoding:@"zstd"];
+}
+
 @end
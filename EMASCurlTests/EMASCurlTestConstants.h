@@ -28,11 +28,26 @@ static NSString *PATH_REDIRECT_CHAIN = @"/redirect_chain";
 
 static NSString *PATH_DOWNLOAD_1MB_DATA_AT_200KBPS_SPEED = @"/download/1MB_data_at_200KBps_speed";
 
+// 后接字节数，如 /download/bytes/1048576
+static NSString *PATH_DOWNLOAD_BYTES = @"/download/bytes";
+
+// 后接字节数，支持Range/If-Range；查询参数ranges=false忽略Range，rotate_etag=true每次返回不同ETag
+static NSString *PATH_DOWNLOAD_RANGED = @"/download/ranged";
+
+// 后接tag，返回该tag下服务端发出的206响应数
+static NSString *PATH_DOWNLOAD_RANGED_STATS = @"/download/ranged_stats";
+
 static NSString *PATH_GZIP_RESPONSE = @"/get/gzip_response";
+
+// 后接编码名gzip/br/zstd，请求的Accept-Encoding包含该编码时返回对应编码的约1MiB文本，否则返回未压缩文本
+static NSString *PATH_COMPRESSION = @"/compression";
 static NSString *PATH_CACHE_NO_STORE = @"/cache/no_store";
 static NSString *PATH_CACHE_CACHEABLE = @"/cache/cacheable";
 static NSString *PATH_CACHE_404 = @"/cache/404";
 static NSString *PATH_CACHE_410 = @"/cache/410";
+static NSString *PATH_CACHE_RANGE = @"/cache/range";
+static NSString *PATH_CACHE_COMPRESSIBLE = @"/cache/compressible";
+static NSString *PATH_CACHE_LARGE = @"/cache/large";
 
 static NSString *PATH_UPLOAD_POST_SLOW = @"/upload/post/slow";
 
@@ -44,6 +59,12 @@ static NSString *PATH_UPLOAD_DELETE_SLOW = @"/upload/delete/slow";
 
 static NSString *PATH_UPLOAD_POST_CHUNKED = @"/upload/post/chunked";
 
+static NSString *PATH_UPLOAD_SINK = @"/upload/sink";
+
+static NSString *PATH_UPLOAD_ENCODED = @"/upload/encoded";
+
+static NSString *PATH_UPLOAD_IDENTITY_ONLY = @"/upload/identity_only";
+
 static NSString *PATH_TIMEOUT_REQUEST = @"/timeout/request";
 
 // Redirect test paths
@@ -0,0 +1,154 @@
+//
+//  EMASCurlTraceTest.m
+//  EMASCurlTests
+//
+//  Created by xuyecan on 2026/10/18.
+//
+
+#import <XCTest/XCTest.h>
+#import <EMASCurl/EMASCurl.h>
+#import "EMASCurlTraceRecorder.h"
+#import "EMASCurlTestConstants.h"
+
+@interface EMASCurlTraceTest : XCTestCase
+@end
+
+@implementation EMASCurlTraceTest
+
+- (void)setUp {
+    [super setUp];
+    [EMASCurlProtocol setRequestTracingEnabled:YES];
+    [EMASCurlProtocol clearRequestTrace];
+}
+
+- (void)tearDown {
+    [EMASCurlProtocol setRequestTracingEnabled:NO];
+    [EMASCurlProtocol clearRequestTrace];
+    [super tearDown];
+}
+
+- (NSArray<NSDictionary *> *)exportedEvents {
+    NSData *data = [EMASCurlProtocol exportRequestTraceJSON];
+    NSError *error = nil;
+    NSDictionary *trace = [NSJSONSerialization JSONObjectWithData:data options:0 error:&error];
+    XCTAssertNil(error);
+    XCTAssertTrue([trace[@"traceEvents"] isKindOfClass:[NSArray class]]);
+    return trace[@"traceEvents"];
+}
+
+- (NSArray<NSDictionary *> *)spansInEvents:(NSArray<NSDictionary *> *)events {
+    return [events filteredArrayUsingPredicate:[NSPredicate predicateWithFormat:@"ph == 'X'"]];
+}
+
+- (void)testRequestPhasesExported {
+    NSURLSessionConfiguration *config = [NSURLSessionConfiguration defaultSessionConfiguration];
+    EMASCurlConfiguration *curlConfig = [EMASCurlConfiguration defaultConfiguration];
+    curlConfig.httpVersion = HTTP1;
+    [EMASCurlProtocol installIntoSessionConfiguration:config withConfiguration:curlConfig];
+    NSURLSession *session = [NSURLSession sessionWithConfiguration:config];
+
+    XCTestExpectation *expectation = [self expectationWithDescription:@"request"];
+    NSURL *url = [NSURL URLWithString:[HTTP11_ENDPOINT stringByAppendingString:PATH_ECHO]];
+    [[session dataTaskWithURL:url completionHandler:^(NSData *data, NSURLResponse *response, NSError *error) {
+        XCTAssertNil(error);
+        [expectation fulfill];
+    }] resume];
+    [self waitForExpectations:@[expectation] timeout:10];
+
+    // 整个请求的事件在客户端收到完成回调之后才记录，稍等片刻
+    NSPredicate *threadNamePredicate = [NSPredicate predicateWithFormat:@"ph == 'M' AND name == 'thread_name' AND args.name CONTAINS %@", PATH_ECHO];
+    NSArray<NSDictionary *> *events = nil;
+    NSDictionary *threadName = nil;
+    for (int attempt = 0; attempt < 20 && !threadName; attempt++) {
+        [NSThread sleepForTimeInterval:0.05];
+        events = [self exportedEvents];
+        threadName = [[events filteredArrayUsingPredicate:threadNamePredicate] firstObject];
+    }
+    XCTAssertNotNil(threadName, @"请求轨道应以URL命名");
+
+    NSArray<NSDictionary *> *spans = [[self spansInEvents:events] filteredArrayUsingPredicate:
+                                      [NSPredicate predicateWithFormat:@"tid == %@", threadName[@"tid"]]];
+    NSDictionary<NSString *, NSDictionary *> *spansByName = [NSDictionary dictionaryWithObjects:spans forKeys:[spans valueForKey:@"name"]];
+    for (NSString *phase in @[@"request", @"cache_lookup", @"queue", @"request_send", @"ttfb", @"body_download", @"callback_delivery"]) {
+        XCTAssertNotNil(spansByName[phase], @"Missing phase %@", phase);
+    }
+    XCTAssertNil(spansByName[@"tls"], @"明文HTTP不应有TLS阶段");
+
+    // 各阶段都落在整个请求的时间范围内
+    double requestStart = [spansByName[@"request"][@"ts"] doubleValue];
+    double requestEnd = requestStart + [spansByName[@"request"][@"dur"] doubleValue];
+    for (NSDictionary *span in spans) {
+        double start = [span[@"ts"] doubleValue];
+        double end = start + [span[@"dur"] doubleValue];
+        XCTAssertGreaterThanOrEqual(start + 1, requestStart, @"%@ starts before request", span[@"name"]);
+        XCTAssertLessThanOrEqual(end, requestEnd + 1, @"%@ ends after request", span[@"name"]);
+    }
+    XCTAssertLessThanOrEqual([spansByName[@"ttfb"][@"ts"] doubleValue], [spansByName[@"body_download"][@"ts"] doubleValue]);
+}
+
+- (void)testDisabledTracingRecordsNothing {
+    [EMASCurlProtocol setRequestTracingEnabled:NO];
+
+    NSURLSessionConfiguration *config = [NSURLSessionConfiguration defaultSessionConfiguration];
+    [EMASCurlProtocol installIntoSessionConfiguration:config withConfiguration:[EMASCurlConfiguration defaultConfiguration]];
+    NSURLSession *session = [NSURLSession sessionWithConfiguration:config];
+
+    XCTestExpectation *expectation = [self expectationWithDescription:@"request"];
+    NSURL *url = [NSURL URLWithString:[HTTP11_ENDPOINT stringByAppendingString:PATH_ECHO]];
+    [[session dataTaskWithURL:url completionHandler:^(NSData *data, NSURLResponse *response, NSError *error) {
+        XCTAssertNil(error);
+        [expectation fulfill];
+    }] resume];
+    [self waitForExpectations:@[expectation] timeout:10];
+
+    XCTAssertEqual([self spansInEvents:[self exportedEvents]].count, 0);
+}
+
+// 多字节字符跨越截断点时整个字符被丢弃，导出的标注仍是有效的UTF-8
+- (void)testMultibyteDetailTruncatedOnCharacterBoundary {
+    // 前62字节为ASCII，第63字节起是一个3字节的汉字
+    NSString *prefix = [@"" stringByPaddingToLength:62 withString:@"a" startingAtIndex:0];
+    NSString *detail = [prefix stringByAppendingString:@"中文路径"];
+    uint64_t requestId = EMASCurlTraceNextRequestId();
+    uint64_t start = EMASCurlTraceNow();
+    EMASCurlTraceRecordSpan(requestId, EMASCurlTracePhaseRequest, start, start + NSEC_PER_USEC, detail.UTF8String);
+
+    NSString *shortDetail = @"https://example.com/中文";
+    uint64_t shortRequestId = EMASCurlTraceNextRequestId();
+    EMASCurlTraceRecordSpan(shortRequestId, EMASCurlTracePhaseRequest, start, start + NSEC_PER_USEC, shortDetail.UTF8String);
+
+    NSArray<NSDictionary *> *threadNames = [[self exportedEvents] filteredArrayUsingPredicate:
+                                            [NSPredicate predicateWithFormat:@"ph == 'M' AND name == 'thread_name'"]];
+    NSDictionary<NSNumber *, NSString *> *labels = [NSDictionary dictionaryWithObjects:[threadNames valueForKeyPath:@"args.name"]
+                                                                               forKeys:[threadNames valueForKey:@"tid"]];
+    XCTAssertEqualObjects(labels[@(requestId)], ([NSString stringWithFormat:@"#%llu %@", requestId, prefix]));
+    XCTAssertEqualObjects(labels[@(shortRequestId)], ([NSString stringWithFormat:@"#%llu %@", shortRequestId, shortDetail]));
+}
+
+// 多线程并发写满并覆盖环形缓冲区，导出的事件应完整有效且不超过容量
+- (void)testConcurrentWritersWrapRingBuffer {
+    const size_t writerCount = 8;
+    const uint64_t spansPerWriter = 4000;
+    dispatch_apply(writerCount, dispatch_get_global_queue(QOS_CLASS_USER_INITIATED, 0), ^(size_t writer) {
+        uint64_t requestId = EMASCurlTraceNextRequestId();
+        for (uint64_t i = 0; i < spansPerWriter; i++) {
+            uint64_t start = EMASCurlTraceNow();
+            EMASCurlTraceRecordSpan(requestId, EMASCurlTracePhaseBodyDownload, start, start + (i + 1) * NSEC_PER_USEC, NULL);
+        }
+    });
+
+    NSArray<NSDictionary *> *spans = [self spansInEvents:[self exportedEvents]];
+    XCTAssertGreaterThan(spans.count, 0);
+    XCTAssertLessThanOrEqual(spans.count, 8192);
+    for (NSDictionary *span in spans) {
+        XCTAssertEqualObjects(span[@"name"], @"body_download");
+        double duration = [span[@"dur"] doubleValue];
+        XCTAssertGreaterThanOrEqual(duration, 1);
+        XCTAssertLessThanOrEqual(duration, spansPerWriter);
+    }
+
+    [EMASCurlProtocol clearRequestTrace];
+    XCTAssertEqual([self spansInEvents:[self exportedEvents]].count, 0);
+}
+
+@end
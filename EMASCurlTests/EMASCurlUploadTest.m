@@ -9,6 +9,7 @@
 #import <XCTest/XCTest.h>
 #import <EMASCurl/EMASCurl.h>
 #import "EMASCurlTestConstants.h"
+#import "EMASCurlRequestBodyEncoder.h"
 
 // Custom NSInputStream for chunked transfer testing
 @interface EMASChunkedInputStream : NSInputStream
@@ -83,6 +84,22 @@
 
 @end
 
+// 每次读取前休眠，模拟慢速或阻塞的请求体流
+@interface EMASSlowInputStream : EMASChunkedInputStream
+
+@property (nonatomic, assign) NSTimeInterval readDelay;
+
+@end
+
+@implementation EMASSlowInputStream
+
+- (NSInteger)read:(uint8_t *)buffer maxLength:(NSUInteger)len {
+    [NSThread sleepForTimeInterval:self.readDelay];
+    return [super read:buffer maxLength:MIN(len, 1024)];
+}
+
+@end
+
 @interface EMASCurlUploadTestBase : XCTestCase
 
 @property (nonatomic, strong) NSURLSession *session;
@@ -98,6 +115,51 @@
     self.progressValues = [NSMutableArray array];
 }
 
+// 下载2MiB响应体并返回耗时，查询参数保证不命中缓存
+- (NSTimeInterval)timeLargeDownload:(NSString *)endpoint {
+    NSString *urlString = [NSString stringWithFormat:@"%@%@?nonce=%@", endpoint, PATH_CACHE_LARGE, [NSUUID UUID].UUIDString];
+    dispatch_semaphore_t semaphore = dispatch_semaphore_create(0);
+    NSDate *start = [NSDate date];
+    [[self.session dataTaskWithURL:[NSURL URLWithString:urlString] completionHandler:^(NSData *data, NSURLResponse *response, NSError *error) {
+        XCTAssertNil(error);
+        XCTAssertEqual(data.length, 2 * 1024 * 1024);
+        dispatch_semaphore_signal(semaphore);
+    }] resume];
+    XCTAssertEqual(dispatch_semaphore_wait(semaphore, dispatch_time(DISPATCH_TIME_NOW, 10 * NSEC_PER_SEC)), 0, @"Download timed out");
+    return -start.timeIntervalSinceNow;
+}
+
+// 慢速上传与下载同时进行时，下载不应被上传的流读取拖慢
+- (void)downloadWhileSlowUploadRuns:(NSString *)endpoint {
+    NSTimeInterval baseline = [self timeLargeDownload:endpoint];
+
+    NSURL *url = [NSURL URLWithString:[NSString stringWithFormat:@"%@%@", endpoint, PATH_UPLOAD_POST_CHUNKED]];
+    NSMutableURLRequest *request = [NSMutableURLRequest requestWithURL:url];
+    request.HTTPMethod = @"POST";
+    // 8KiB，每次读取1KiB并休眠0.3秒，上传至少持续2.4秒
+    EMASSlowInputStream *slowStream = [[EMASSlowInputStream alloc] initWithTotalSize:8 * 1024];
+    slowStream.readDelay = 0.3;
+    request.HTTPBodyStream = slowStream;
+
+    __block BOOL uploadFinished = NO;
+    dispatch_semaphore_t uploadSemaphore = dispatch_semaphore_create(0);
+    [[self.session dataTaskWithRequest:request completionHandler:^(NSData *data, NSURLResponse *response, NSError *error) {
+        XCTAssertNil(error, @"Slow upload failed with error: %@", error);
+        NSDictionary *responseData = data ? [NSJSONSerialization JSONObjectWithData:data options:0 error:nil] : nil;
+        XCTAssertEqual([responseData[@"actual_size"] integerValue], 8 * 1024);
+        uploadFinished = YES;
+        dispatch_semaphore_signal(uploadSemaphore);
+    }] resume];
+
+    // 等待上传开始读取请求体
+    [NSThread sleepForTimeInterval:0.5];
+    NSTimeInterval duration = [self timeLargeDownload:endpoint];
+    XCTAssertFalse(uploadFinished, @"下载应在慢速上传结束前完成");
+    XCTAssertLessThan(duration, baseline + 1.0, @"baseline: %.3fs, during slow upload: %.3fs", baseline, duration);
+
+    XCTAssertEqual(dispatch_semaphore_wait(uploadSemaphore, dispatch_time(DISPATCH_TIME_NOW, 20 * NSEC_PER_SEC)), 0, @"Slow upload timed out");
+}
+
 - (NSData *)generateTestData:(NSUInteger)size {
     NSMutableData *data = [NSMutableData dataWithCapacity:size];
     for (NSUInteger i = 0; i < size; i++) {
@@ -405,6 +467,132 @@
     dispatch_semaphore_wait(semaphore, DISPATCH_TIME_FOREVER);
 }
 
+// 以PUT上传到sink接口并校验服务端收到的字节数
+- (void)putRequest:(NSURLRequest *)request expectingSize:(int64_t)expectedSize {
+    dispatch_semaphore_t semaphore = dispatch_semaphore_create(0);
+    [[self.session dataTaskWithRequest:request completionHandler:^(NSData *data, NSURLResponse *response, NSError *error) {
+        XCTAssertNil(error, @"Upload failed with error: %@", error);
+        XCTAssertEqual(((NSHTTPURLResponse *)response).statusCode, 200);
+        NSDictionary *responseData = data ? [NSJSONSerialization JSONObjectWithData:data options:0 error:nil] : nil;
+        XCTAssertEqual([responseData[@"size"] longLongValue], expectedSize);
+        dispatch_semaphore_signal(semaphore);
+    }] resume];
+    dispatch_semaphore_wait(semaphore, DISPATCH_TIME_FOREVER);
+}
+
+- (NSMutableURLRequest *)sinkPutRequest:(NSString *)endpoint {
+    NSURL *url = [NSURL URLWithString:[NSString stringWithFormat:@"%@%@", endpoint, PATH_UPLOAD_SINK]];
+    NSMutableURLRequest *request = [NSMutableURLRequest requestWithURL:url];
+    request.HTTPMethod = @"PUT";
+    [request setValue:@"application/octet-stream" forHTTPHeaderField:@"Content-Type"];
+    return request;
+}
+
+// 创建指定大小的稀疏文件，避免基准测试准备阶段写入大量数据
+- (NSString *)createSparseFileOfSize:(unsigned long long)size {
+    NSString *filePath = [NSTemporaryDirectory() stringByAppendingPathComponent:[NSString stringWithFormat:@"upload_sparse_%@.bin", [[NSUUID UUID] UUIDString]]];
+    [[NSFileManager defaultManager] createFileAtPath:filePath contents:nil attributes:nil];
+    NSFileHandle *handle = [NSFileHandle fileHandleForWritingAtPath:filePath];
+    [handle truncateFileAtOffset:size];
+    [handle closeFile];
+    return filePath;
+}
+
+- (void)uploadBodyDataDirectly:(NSString *)endpoint {
+    NSMutableURLRequest *request = [self sinkPutRequest:endpoint];
+    NSData *testData = [self generateTestData:1024 * 1024];
+    [EMASCurlProtocol setUploadBodyData:testData forRequest:request];
+
+    __block int64_t reportedBytes = 0;
+    __block int64_t lastTotalBytesSent = 0;
+    [EMASCurlProtocol setUploadProgressUpdateBlockForRequest:request uploadProgressUpdateBlock:^(NSURLRequest * _Nonnull request, int64_t bytesSent, int64_t totalBytesSent, int64_t totalBytesExpectedToSend) {
+        reportedBytes += bytesSent;
+        lastTotalBytesSent = totalBytesSent;
+        XCTAssertEqual(totalBytesExpectedToSend, (int64_t)testData.length);
+    }];
+
+    [self putRequest:request expectingSize:testData.length];
+    XCTAssertEqual(reportedBytes, (int64_t)testData.length);
+    XCTAssertEqual(lastTotalBytesSent, (int64_t)testData.length);
+}
+
+- (void)uploadBodyFileDirectly:(NSString *)endpoint {
+    NSData *testData = [self generateTestData:3 * 1024 * 1024 + 17];
+    NSString *filePath = [self createTemporaryFileWithData:testData];
+
+    NSMutableURLRequest *request = [self sinkPutRequest:endpoint];
+    [EMASCurlProtocol setUploadBodyFileURL:[NSURL fileURLWithPath:filePath] forRequest:request];
+    XCTAssertEqualObjects([request valueForHTTPHeaderField:@"Content-Length"], @(testData.length).stringValue);
+
+    [self putRequest:request expectingSize:testData.length];
+    [[NSFileManager defaultManager] removeItemAtPath:filePath error:nil];
+}
+
+// 对比经HTTPBodyStream与直接交给libcurl两种方式上传的CPU和内存开销
+- (void)measureUploadOfFileSize:(unsigned long long)size endpoint:(NSString *)endpoint direct:(BOOL)direct {
+    NSString *filePath = [self createSparseFileOfSize:size];
+    NSURL *fileURL = [NSURL fileURLWithPath:filePath];
+
+    XCTMeasureOptions *options = [XCTMeasureOptions defaultOptions];
+    options.iterationCount = 3;
+    [self measureWithMetrics:@[[XCTCPUMetric new], [XCTMemoryMetric new], [XCTClockMetric new]] options:options block:^{
+        NSMutableURLRequest *request = [self sinkPutRequest:endpoint];
+        if (direct) {
+            [EMASCurlProtocol setUploadBodyFileURL:fileURL forRequest:request];
+        } else {
+            request.HTTPBodyStream = [NSInputStream inputStreamWithURL:fileURL];
+            [request setValue:@(size).stringValue forHTTPHeaderField:@"Content-Length"];
+        }
+        [self putRequest:request expectingSize:(int64_t)size];
+    }];
+
+    [[NSFileManager defaultManager] removeItemAtPath:filePath error:nil];
+}
+
+// 高度可压缩的JSON请求体
+- (NSData *)compressibleJSONBody {
+    NSMutableArray *events = [NSMutableArray array];
+    for (NSInteger i = 0; i < 1000; i++) {
+        [events addObject:@{@"event": @"page_view", @"page": @"/home", @"index": @(i)}];
+    }
+    return [NSJSONSerialization dataWithJSONObject:@{@"events": events} options:0 error:nil];
+}
+
+- (NSDictionary *)postBody:(NSData *)body withRequest:(NSMutableURLRequest *)request session:(NSURLSession *)session statusCode:(NSInteger *)statusCode {
+    request.HTTPMethod = @"POST";
+    request.HTTPBody = body;
+    [request setValue:@"application/json" forHTTPHeaderField:@"Content-Type"];
+
+    __block NSDictionary *result = nil;
+    __block NSInteger responseStatusCode = 0;
+    dispatch_semaphore_t semaphore = dispatch_semaphore_create(0);
+    [[session dataTaskWithRequest:request completionHandler:^(NSData *data, NSURLResponse *response, NSError *error) {
+        XCTAssertNil(error, @"Upload failed with error: %@", error);
+        responseStatusCode = ((NSHTTPURLResponse *)response).statusCode;
+        result = data ? [NSJSONSerialization JSONObjectWithData:data options:0 error:nil] : nil;
+        dispatch_semaphore_signal(semaphore);
+    }] resume];
+    XCTAssertEqual(dispatch_semaphore_wait(semaphore, dispatch_time(DISPATCH_TIME_NOW, 10 * NSEC_PER_SEC)), 0, @"Upload timed out");
+    if (statusCode) {
+        *statusCode = responseStatusCode;
+    }
+    return result;
+}
+
+- (void)uploadCompressedBody:(NSString *)endpoint {
+    NSURL *url = [NSURL URLWithString:[NSString stringWithFormat:@"%@%@", endpoint, PATH_UPLOAD_ENCODED]];
+    NSMutableURLRequest *request = [NSMutableURLRequest requestWithURL:url];
+    [EMASCurlProtocol setRequestBodyEncoding:EMASCurlRequestBodyEncodingGzip forRequest:request];
+
+    NSData *body = [self compressibleJSONBody];
+    NSDictionary *result = [self postBody:body withRequest:request session:self.session statusCode:NULL];
+
+    XCTAssertEqualObjects(result[@"content_encoding"], @"gzip");
+    XCTAssertEqual([result[@"decoded_size"] integerValue], (NSInteger)body.length);
+    XCTAssertLessThan([result[@"received_size"] integerValue], (NSInteger)body.length / 4);
+    XCTAssertEqualObjects(result[@"decoded_body"], [[NSString alloc] initWithData:body encoding:NSUTF8StringEncoding]);
+}
+
 - (void)uploadDataWithChunkedEncoding:(NSString *)endpoint {
     NSURL *url = [NSURL URLWithString:[NSString stringWithFormat:@"%@%@", endpoint, PATH_UPLOAD_POST_CHUNKED]];
     NSMutableURLRequest *request = [NSMutableURLRequest requestWithURL:url];
@@ -589,6 +777,165 @@
     [self uploadDataWithChunkedEncodingAndProgress:HTTP11_ENDPOINT];
 }
 
+- (void)testSlowUploadStreamDoesNotStallDownload {
+    [self downloadWhileSlowUploadRuns:HTTP11_ENDPOINT];
+}
+
+- (void)testGzipEncoderProducesGzipStream {
+    EMASCurlRequestBodyEncoder *encoder = [EMASCurlRequestBodyEncoder encoderWithEncoding:EMASCurlRequestBodyEncodingGzip];
+    XCTAssertNotNil(encoder);
+    XCTAssertNil([EMASCurlRequestBodyEncoder encoderWithEncoding:EMASCurlRequestBodyEncodingNone]);
+    XCTAssertEqualObjects(encoder.contentEncoding, @"gzip");
+
+    NSData *body = [self compressibleJSONBody];
+    NSMutableData *encoded = [NSMutableData data];
+    uint8_t buffer[512];
+    NSUInteger offset = 0;
+    while (!encoder.finished) {
+        if (encoder.needsInput) {
+            NSUInteger length = MIN((NSUInteger)4096, body.length - offset);
+            [encoder provideInput:(const uint8_t *)body.bytes + offset length:length];
+            offset += length;
+        }
+        NSInteger produced = [encoder encodeIntoBuffer:buffer maxLength:sizeof(buffer)];
+        XCTAssertGreaterThanOrEqual(produced, 0);
+        [encoded appendBytes:buffer length:(NSUInteger)produced];
+    }
+
+    const uint8_t *bytes = encoded.bytes;
+    XCTAssertEqual(bytes[0], 0x1f);
+    XCTAssertEqual(bytes[1], 0x8b);
+    XCTAssertEqual(encoder.rawBytes, body.length);
+    XCTAssertEqual(encoder.encodedBytes, encoded.length);
+    XCTAssertLessThan(encoded.length, body.length / 4);
+}
+
+- (void)testCompressedBody {
+    [self uploadCompressedBody:HTTP11_ENDPOINT];
+}
+
+- (void)testRequestBodyEncodingByHostReportsMetrics {
+    __block EMASCurlTransactionMetrics *reportedMetrics = nil;
+    dispatch_semaphore_t metricsSemaphore = dispatch_semaphore_create(0);
+
+    EMASCurlConfiguration *curlConfig = [EMASCurlConfiguration defaultConfiguration];
+    curlConfig.httpVersion = HTTP1;
+    curlConfig.requestBodyEncodingByHost = @{@"127.0.0.1": @(EMASCurlRequestBodyEncodingGzip)};
+    curlConfig.transactionMetricsObserver = ^(NSURLRequest * _Nonnull request, BOOL success, NSError * _Nullable error, EMASCurlTransactionMetrics * _Nonnull metrics) {
+        reportedMetrics = metrics;
+        dispatch_semaphore_signal(metricsSemaphore);
+    };
+    NSURLSessionConfiguration *config = [NSURLSessionConfiguration defaultSessionConfiguration];
+    [EMASCurlProtocol installIntoSessionConfiguration:config withConfiguration:curlConfig];
+    NSURLSession *session = [NSURLSession sessionWithConfiguration:config];
+
+    NSURL *url = [NSURL URLWithString:[NSString stringWithFormat:@"%@%@", HTTP11_ENDPOINT, PATH_UPLOAD_ENCODED]];
+    NSData *body = [self compressibleJSONBody];
+    NSDictionary *result = [self postBody:body withRequest:[NSMutableURLRequest requestWithURL:url] session:session statusCode:NULL];
+    XCTAssertEqualObjects(result[@"content_encoding"], @"gzip");
+    XCTAssertEqualObjects(result[@"transfer_encoding"], @"chunked");
+    XCTAssertEqual([result[@"decoded_size"] integerValue], (NSInteger)body.length);
+
+    XCTAssertEqual(dispatch_semaphore_wait(metricsSemaphore, dispatch_time(DISPATCH_TIME_NOW, 5 * NSEC_PER_SEC)), 0);
+    XCTAssertEqual(reportedMetrics.requestBodyBytesBeforeEncoding, (NSInteger)body.length);
+    XCTAssertEqual(reportedMetrics.requestBodyBytesSent, [result[@"received_size"] integerValue]);
+
+    // 单个请求的设置优先于按host的配置
+    NSMutableURLRequest *request = [NSMutableURLRequest requestWithURL:url];
+    [EMASCurlProtocol setRequestBodyEncoding:EMASCurlRequestBodyEncodingNone forRequest:request];
+    result = [self postBody:body withRequest:request session:session statusCode:NULL];
+    XCTAssertEqualObjects(result[@"content_encoding"], @"");
+    XCTAssertEqual([result[@"received_size"] integerValue], (NSInteger)body.length);
+}
+
+// 返回415的host被记住，之后的请求不再压缩；使用localhost避免影响其他用例的127.0.0.1
+- (void)testHostRejectingEncodedBodyFallsBackToIdentity {
+    NSURL *url = [NSURL URLWithString:[NSString stringWithFormat:@"http://localhost:9080%@", PATH_UPLOAD_IDENTITY_ONLY]];
+    NSData *body = [self compressibleJSONBody];
+
+    NSInteger statusCode = 0;
+    NSMutableURLRequest *request = [NSMutableURLRequest requestWithURL:url];
+    [EMASCurlProtocol setRequestBodyEncoding:EMASCurlRequestBodyEncodingGzip forRequest:request];
+    [self postBody:body withRequest:request session:self.session statusCode:&statusCode];
+    XCTAssertEqual(statusCode, 415);
+
+    request = [NSMutableURLRequest requestWithURL:url];
+    [EMASCurlProtocol setRequestBodyEncoding:EMASCurlRequestBodyEncodingGzip forRequest:request];
+    NSDictionary *result = [self postBody:body withRequest:request session:self.session statusCode:&statusCode];
+    XCTAssertEqual(statusCode, 200);
+    XCTAssertEqual([result[@"size"] integerValue], (NSInteger)body.length);
+}
+
+// 进度回调按时间间隔合并，并在配置的队列上执行
+- (void)testUploadProgressIsCoalescedOnCallbackQueue {
+    static void *kProgressQueueKey = &kProgressQueueKey;
+    dispatch_queue_t progressQueue = dispatch_queue_create("com.alicloud.emascurl.test.progress", DISPATCH_QUEUE_SERIAL);
+    dispatch_queue_set_specific(progressQueue, kProgressQueueKey, kProgressQueueKey, NULL);
+
+    EMASCurlConfiguration *curlConfig = [EMASCurlConfiguration defaultConfiguration];
+    curlConfig.httpVersion = HTTP1;
+    curlConfig.progressReportInterval = 0.5;
+    curlConfig.progressCallbackQueue = progressQueue;
+    NSURLSessionConfiguration *config = [NSURLSessionConfiguration defaultSessionConfiguration];
+    [EMASCurlProtocol installIntoSessionConfiguration:config withConfiguration:curlConfig];
+    NSURLSession *session = [NSURLSession sessionWithConfiguration:config];
+
+    NSURL *url = [NSURL URLWithString:[NSString stringWithFormat:@"%@%@", HTTP11_ENDPOINT, PATH_UPLOAD_POST_CHUNKED]];
+    NSMutableURLRequest *request = [NSMutableURLRequest requestWithURL:url];
+    request.HTTPMethod = @"POST";
+    // 8KiB，每次读取1KiB并休眠0.3秒，共8次读取
+    EMASSlowInputStream *slowStream = [[EMASSlowInputStream alloc] initWithTotalSize:8 * 1024];
+    slowStream.readDelay = 0.3;
+    request.HTTPBodyStream = slowStream;
+
+    __block int64_t sumOfBytesSent = 0;
+    __block NSUInteger callbackCount = 0;
+    __block BOOL calledOffQueue = NO;
+    [EMASCurlProtocol setUploadProgressUpdateBlockForRequest:request uploadProgressUpdateBlock:^(NSURLRequest * _Nonnull request, int64_t bytesSent, int64_t totalBytesSent, int64_t totalBytesExpectedToSend) {
+        calledOffQueue = calledOffQueue || dispatch_get_specific(kProgressQueueKey) != kProgressQueueKey;
+        sumOfBytesSent += bytesSent;
+        callbackCount++;
+    }];
+
+    dispatch_semaphore_t semaphore = dispatch_semaphore_create(0);
+    [[session dataTaskWithRequest:request completionHandler:^(NSData *data, NSURLResponse *response, NSError *error) {
+        XCTAssertNil(error);
+        dispatch_semaphore_signal(semaphore);
+    }] resume];
+    XCTAssertEqual(dispatch_semaphore_wait(semaphore, dispatch_time(DISPATCH_TIME_NOW, 10 * NSEC_PER_SEC)), 0, @"Upload timed out");
+
+    // 自定义队列上的回调不保证先于完成回调，这里等待队列排空
+    dispatch_sync(progressQueue, ^{});
+    XCTAssertFalse(calledOffQueue);
+    XCTAssertEqual(sumOfBytesSent, 8 * 1024);
+    XCTAssertGreaterThan(callbackCount, 0);
+    XCTAssertLessThan(callbackCount, 8, @"Reads within the report interval should be coalesced");
+}
+
+- (void)testUploadBodyDataDirectly {
+    [self uploadBodyDataDirectly:HTTP11_ENDPOINT];
+}
+
+- (void)testUploadBodyFileDirectly {
+    [self uploadBodyFileDirectly:HTTP11_ENDPOINT];
+}
+
+- (void)testUploadPerformance1MBBodyStream {
+    [self measureUploadOfFileSize:1024 * 1024 endpoint:HTTP11_ENDPOINT direct:NO];
+}
+
+- (void)testUploadPerformance1MBDirect {
+    [self measureUploadOfFileSize:1024 * 1024 endpoint:HTTP11_ENDPOINT direct:YES];
+}
+
+- (void)testUploadPerformance500MBBodyStream {
+    [self measureUploadOfFileSize:500ULL * 1024 * 1024 endpoint:HTTP11_ENDPOINT direct:NO];
+}
+
+- (void)testUploadPerformance500MBDirect {
+    [self measureUploadOfFileSize:500ULL * 1024 * 1024 endpoint:HTTP11_ENDPOINT direct:YES];
+}
+
 @end
 
 @interface EMASCurlUploadTestHttp2 : EMASCurlUploadTestBase
@@ -659,4 +1006,20 @@
     XCTSkip(@"HTTP/2 doesn't use chunked transfer encoding");
 }
 
+- (void)testSlowUploadStreamDoesNotStallDownload {
+    [self downloadWhileSlowUploadRuns:HTTP2_ENDPOINT];
+}
+
+- (void)testUploadBodyDataDirectly {
+    [self uploadBodyDataDirectly:HTTP2_ENDPOINT];
+}
+
+- (void)testUploadBodyFileDirectly {
+    [self uploadBodyFileDirectly:HTTP2_ENDPOINT];
+}
+
+- (void)testCompressedBody {
+    [self uploadCompressedBody:HTTP2_ENDPOINT];
+}
+
 @end
@@ -8,6 +8,8 @@ import os
 import asyncio
 from typing import Optional, Any
 import gzip
+import brotli
+import zstandard
 import logging
 import time
 
@@ -218,6 +220,36 @@ def create_app():
             "method": "DELETE"
         }
 
+    @app.post("/upload/encoded")
+    async def upload_encoded(request: Request):
+        """Decode a gzip request body and report raw and decoded sizes"""
+        body = await request.body()
+        content_encoding = request.headers.get("Content-Encoding", "")
+        decoded = gzip.decompress(body) if content_encoding.lower() == "gzip" else body
+        return {
+            "content_encoding": content_encoding,
+            "transfer_encoding": request.headers.get("Transfer-Encoding", ""),
+            "received_size": len(body),
+            "decoded_size": len(decoded),
+            "decoded_body": decoded.decode("utf-8", errors="replace")
+        }
+
+    @app.post("/upload/identity_only")
+    async def upload_identity_only(request: Request):
+        """Reject encoded request bodies with 415"""
+        body = await request.body()
+        if request.headers.get("Content-Encoding"):
+            return JSONResponse(status_code=415, content={"error": "encoded body not supported"})
+        return {"size": len(body)}
+
+    @app.api_route("/upload/sink", methods=["POST", "PUT"])
+    async def upload_sink(request: Request):
+        """Consume the request body without buffering it, used by upload benchmarks"""
+        total_size = 0
+        async for chunk in request.stream():
+            total_size += len(chunk)
+        return {"size": total_size}
+
     @app.post("/upload/post/chunked")
     async def upload_file_chunked(request: Request):
         """Handle chunked transfer encoding upload"""
@@ -402,6 +434,73 @@ def create_app():
             }
         )
 
+    @app.get("/download/bytes/{size}")
+    async def download_bytes(size: int):
+        """Stream the given number of bytes as fast as possible, used by download benchmarks"""
+        chunk = bytes(range(256)) * 4096
+
+        async def generate_bytes():
+            remaining = size
+            while remaining > 0:
+                current = min(len(chunk), remaining)
+                yield chunk[:current]
+                remaining -= current
+
+        return StreamingResponse(
+            generate_bytes(),
+            media_type="application/octet-stream",
+            headers={"Content-Length": str(size)}
+        )
+
+    # 分段下载测试：按tag统计服务端返回的206响应数
+    ranged_partial_counts = {}
+
+    @app.get("/download/ranged/{size}")
+    async def download_ranged(size: int, request: Request, ranges: bool = True,
+                              rotate_etag: bool = False, tag: str = "", chunk_delay_ms: int = 0):
+        """Serve deterministic bytes with Range/If-Range support for segmented download tests.
+        ranges=false ignores Range headers, rotate_etag=true changes the ETag on every request,
+        chunk_delay_ms slows the body down so that tests can cancel halfway"""
+        etag = f'"ranged-{time.time_ns()}"' if rotate_etag else f'"ranged-{size}"'
+        headers = {"ETag": etag, "Content-Type": "application/octet-stream"}
+        if ranges:
+            headers["Accept-Ranges"] = "bytes"
+
+        start, end = 0, size - 1
+        status_code = 200
+        range_header = request.headers.get("range")
+        if_range = request.headers.get("if-range")
+        if ranges and range_header and (if_range is None or if_range == etag):
+            start_str, _, end_str = range_header.strip()[len("bytes="):].partition("-")
+            start = int(start_str)
+            end = min(int(end_str), size - 1) if end_str else size - 1
+            if start >= size or end < start:
+                return Response(status_code=416, headers={"Content-Range": f"bytes */{size}"})
+            status_code = 206
+            headers["Content-Range"] = f"bytes {start}-{end}/{size}"
+            ranged_partial_counts[tag] = ranged_partial_counts.get(tag, 0) + 1
+        headers["Content-Length"] = str(end - start + 1)
+
+        chunk = bytes(range(256)) * 4096
+
+        async def generate_bytes():
+            # 与/download/bytes相同的内容：第i个字节为i % 256
+            position = start
+            while position <= end:
+                offset = position % len(chunk)
+                current = min(len(chunk) - offset, end - position + 1)
+                yield chunk[offset:offset + current]
+                position += current
+                if chunk_delay_ms > 0:
+                    await asyncio.sleep(chunk_delay_ms / 1000)
+
+        return StreamingResponse(generate_bytes(), status_code=status_code,
+                                 media_type="application/octet-stream", headers=headers)
+
+    @app.get("/download/ranged_stats/{tag}")
+    async def download_ranged_stats(tag: str):
+        return {"partial_responses": ranged_partial_counts.get(tag, 0)}
+
     @app.get("/stream")
     async def stream(body: Optional[Any] = Body(None)):
         """Stream a response in chunks with delays"""
@@ -489,6 +588,30 @@ def create_app():
             headers={"Content-Encoding": "gzip"}
         )
 
+    # 压缩测试用的文本负载，各编码结果在启动时生成，避免压缩耗时干扰客户端解码吞吐的测量
+    compression_payload = "".join(
+        f'{{"id": {i}, "name": "item-{i}", "description": "content encoding throughput payload"}}\n'
+        for i in range(16384)
+    ).encode()
+    compressed_payloads = {
+        "gzip": gzip.compress(compression_payload, compresslevel=6),
+        "br": brotli.compress(compression_payload, quality=5),
+        "zstd": zstandard.ZstdCompressor(level=3).compress(compression_payload),
+    }
+
+    @app.get("/compression/{encoding}")
+    async def compression_response(encoding: str, request: Request):
+        """Serve a ~1MiB text payload in the given content encoding when the client accepts it, identity otherwise"""
+        if encoding not in compressed_payloads:
+            raise HTTPException(status_code=404, detail="Unsupported encoding")
+        accepted = [item.split(";")[0].strip().lower()
+                    for item in request.headers.get("accept-encoding", "").split(",")]
+        headers = {"X-Uncompressed-Length": str(len(compression_payload))}
+        if encoding not in accepted:
+            return Response(content=compression_payload, media_type="text/plain", headers=headers)
+        headers["Content-Encoding"] = encoding
+        return Response(content=compressed_payloads[encoding], media_type="text/plain", headers=headers)
+
     @app.get("/cache/no_store")
     async def cache_no_store(body: Optional[Any] = Body(None)):
         """Return a small JSON with Cache-Control: no-store to test non-cacheable responses"""
@@ -525,6 +648,62 @@ def create_app():
             headers={"Cache-Control": "max-age=3600"}
         )
 
+    @app.get("/cache/compressible")
+    async def cache_compressible():
+        """Return a ~20KB repetitive JSON body with Cache-Control: max-age=3600 for cache compression tests"""
+        items = [{"id": i, "name": f"item-{i}", "description": "compressible cache payload"} for i in range(256)]
+        return JSONResponse(
+            content={"items": items},
+            headers={"Cache-Control": "max-age=3600"}
+        )
+
+    @app.get("/cache/large")
+    async def cache_large():
+        """Serve 2MiB deterministic bytes with Cache-Control: max-age=3600 for file-backed cache body tests"""
+        content = bytes(i % 251 for i in range(2 * 1024 * 1024))
+        return Response(
+            content=content,
+            headers={"Cache-Control": "max-age=3600", "Content-Type": "application/octet-stream"}
+        )
+
+    @app.get("/cache/range")
+    async def cache_range(request: Request):
+        """Serve 64KiB deterministic bytes with single byte-range support for sparse cache tests"""
+        content = bytes(i % 256 for i in range(64 * 1024))
+        total = len(content)
+        etag = '"range-v1"'
+        headers = {
+            "Cache-Control": "max-age=3600",
+            "ETag": etag,
+            "Accept-Ranges": "bytes",
+            "Content-Type": "application/octet-stream",
+        }
+        range_header = request.headers.get("range")
+        headers["X-Received-Range"] = range_header or ""
+        if_range = request.headers.get("if-range")
+        if not range_header or (if_range is not None and if_range != etag):
+            return Response(content=content, headers=headers)
+
+        spec = range_header.strip()
+        if not spec.startswith("bytes=") or "," in spec:
+            return Response(content=content, headers=headers)
+        start_str, _, end_str = spec[len("bytes="):].partition("-")
+        try:
+            if start_str == "":
+                start = max(0, total - int(end_str))
+                end = total - 1
+            else:
+                start = int(start_str)
+                end = min(int(end_str), total - 1) if end_str else total - 1
+        except ValueError:
+            return Response(content=content, headers=headers)
+        if start >= total or end < start:
+            headers["Content-Range"] = f"bytes */{total}"
+            return Response(status_code=416, headers=headers)
+
+        headers["Content-Range"] = f"bytes {start}-{end}/{total}"
+        return Response(content=content[start:end + 1], status_code=206, headers=headers)
+
     @app.get("/timeout/request")
     async def timeout_request():
         # Sleep for 2 seconds to simulate a slow response
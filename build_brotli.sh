@@ -0,0 +1,60 @@
+#!/bin/bash
+set -ex
+
+ROOT_DIR="$(cd "$(dirname "$0")"; pwd)"
+SRC_DIR="$ROOT_DIR/brotli"
+OUT_DIR="$ROOT_DIR/out/brotli"
+
+# 固定版本，源码不存在时按tag浅克隆
+BROTLI_TAG=v1.1.0
+if [ ! -d "$SRC_DIR/c" ]; then
+  rm -rf "$SRC_DIR"
+  git clone --depth 1 --branch "$BROTLI_TAG" https://github.com/google/brotli "$SRC_DIR"
+fi
+
+rm -rf "$OUT_DIR"
+mkdir -p "$OUT_DIR"
+
+DEPLOYMENT_TARGET=10.0
+
+combinations=(
+  "ARCH=arm64   SDK=iphoneos"
+  "ARCH=arm64   SDK=iphonesimulator"
+  "ARCH=x86_64  SDK=iphonesimulator"
+)
+
+for combination in "${combinations[@]}"; do
+  eval "$combination"
+
+  BUILD_DIR="$OUT_DIR/build-$SDK-$ARCH"
+  PREFIX="${OUT_DIR}/artifacts-$SDK-$ARCH"
+
+  rm -rf "$BUILD_DIR" "$PREFIX"
+  mkdir -p "$BUILD_DIR" "$PREFIX"
+
+  SDK_PATH="$(xcrun -sdk "$SDK" --show-sdk-path)"
+
+  cd "$BUILD_DIR"
+
+  # libcurl只做解码，只链接brotlicommon与brotlidec
+  cmake \
+    -G "Unix Makefiles" \
+    -DCMAKE_SYSTEM_NAME=iOS \
+    -DCMAKE_OSX_SYSROOT="$SDK_PATH" \
+    -DCMAKE_OSX_ARCHITECTURES="$ARCH" \
+    -DCMAKE_OSX_DEPLOYMENT_TARGET="$DEPLOYMENT_TARGET" \
+    -DCMAKE_INSTALL_PREFIX="$PREFIX" \
+    -DCMAKE_BUILD_TYPE=MinSizeRel \
+    -DBUILD_SHARED_LIBS=OFF \
+    -DBROTLI_DISABLE_TESTS=ON \
+    "$SRC_DIR"
+
+  cmake --build . --config MinSizeRel --target brotlicommon brotlidec -- -j8
+
+  mkdir -p "$PREFIX/lib" "$PREFIX/include"
+  cp -R "$SRC_DIR/c/include/brotli" "$PREFIX/include/"
+  cp "$(find . -name 'libbrotlicommon*.a' | head -n 1)" "$PREFIX/lib/libbrotlicommon.a"
+  cp "$(find . -name 'libbrotlidec*.a' | head -n 1)" "$PREFIX/lib/libbrotlidec.a"
+done
+
+echo "brotli built. Per-arch outputs are in: $OUT_DIR/artifacts-<SDK>-<ARCH>/lib/libbrotli{common,dec}.a"
@@ -31,6 +31,10 @@ for combination in "${combinations[@]}"; do
   # nghttp2 路径
   NGHTTP2_PREFIX="${OUT_BASE}/nghttp2/artifacts-$SDK-$ARCH"
 
+  # 内容解码依赖路径
+  BROTLI_PREFIX="${OUT_BASE}/brotli/artifacts-$SDK-$ARCH"
+  ZSTD_PREFIX="${OUT_BASE}/zstd/artifacts-$SDK-$ARCH"
+
   cd "$BUILD_DIR"
 
   cmake \
@@ -59,15 +63,27 @@ for combination in "${combinations[@]}"; do
     -DNGHTTP2_INCLUDE_DIR="$NGHTTP2_PREFIX/include" \
     -DNGHTTP2_LIBRARY="$NGHTTP2_PREFIX/lib/libnghttp2.a" \
     \
+    -DCURL_BROTLI=ON \
+    -DBROTLI_INCLUDE_DIR="$BROTLI_PREFIX/include" \
+    -DBROTLICOMMON_LIBRARY="$BROTLI_PREFIX/lib/libbrotlicommon.a" \
+    -DBROTLIDEC_LIBRARY="$BROTLI_PREFIX/lib/libbrotlidec.a" \
+    \
+    -DCURL_ZSTD=ON \
+    -DZSTD_INCLUDE_DIR="$ZSTD_PREFIX/include" \
+    -DZSTD_LIBRARY="$ZSTD_PREFIX/lib/libzstd.a" \
+    \
     "$SRC_DIR"
 
   cmake --build . --config Release -- -j8
   cmake --install . --config Release
 
-  # 对齐你原脚本：curl + nghttp2 打成一个 libcurl.a
+  # 对齐你原脚本：curl + nghttp2 + 解码库打成一个 libcurl.a
   libtool -static -o "${PREFIX}/libcurl.a" \
     "${PREFIX}/lib/libcurl.a" \
-    "${NGHTTP2_PREFIX}/lib/libnghttp2.a"
+    "${NGHTTP2_PREFIX}/lib/libnghttp2.a" \
+    "${BROTLI_PREFIX}/lib/libbrotlidec.a" \
+    "${BROTLI_PREFIX}/lib/libbrotlicommon.a" \
+    "${ZSTD_PREFIX}/lib/libzstd.a"
 done
 
 # 合并两个模拟器架构成一个 fat lib
@@ -33,6 +33,8 @@ for combination in "${combinations[@]}"; do
   NGHTTP2_PREFIX="${OUT_BASE}/nghttp2/artifacts-$SDK-$ARCH"
   NGHTTP3_PREFIX="${OUT_BASE}/nghttp3/artifacts-$SDK-$ARCH"
   NGTCP2_PREFIX="${OUT_BASE}/ngtcp2/artifacts-$SDK-$ARCH"
+  BROTLI_PREFIX="${OUT_BASE}/brotli/artifacts-$SDK-$ARCH"
+  ZSTD_PREFIX="${OUT_BASE}/zstd/artifacts-$SDK-$ARCH"
 
   cd "$BUILD_DIR"
 
@@ -67,6 +69,15 @@ for combination in "${combinations[@]}"; do
     -DNGHTTP2_INCLUDE_DIR="$NGHTTP2_PREFIX/include" \
     -DNGHTTP2_LIBRARY="$NGHTTP2_PREFIX/lib/libnghttp2.a" \
     \
+    -DCURL_BROTLI=ON \
+    -DBROTLI_INCLUDE_DIR="$BROTLI_PREFIX/include" \
+    -DBROTLICOMMON_LIBRARY="$BROTLI_PREFIX/lib/libbrotlicommon.a" \
+    -DBROTLIDEC_LIBRARY="$BROTLI_PREFIX/lib/libbrotlidec.a" \
+    \
+    -DCURL_ZSTD=ON \
+    -DZSTD_INCLUDE_DIR="$ZSTD_PREFIX/include" \
+    -DZSTD_LIBRARY="$ZSTD_PREFIX/lib/libzstd.a" \
+    \
     -DOPENSSL_ROOT_DIR="$SSL_PREFIX" \
     -DOPENSSL_INCLUDE_DIR="$SSL_PREFIX/include" \
     -DOPENSSL_CRYPTO_LIBRARY="$SSL_PREFIX/lib/libcrypto.a" \
@@ -95,7 +106,10 @@ for combination in "${combinations[@]}"; do
     "${SSL_PREFIX}/lib/libcrypto.a" \
     "${NGHTTP3_PREFIX}/lib/libnghttp3.a" \
     "${NGTCP2_PREFIX}/lib/libngtcp2.a" \
-    "${NGTCP2_PREFIX}/lib/libngtcp2_crypto_ossl.a"
+    "${NGTCP2_PREFIX}/lib/libngtcp2_crypto_ossl.a" \
+    "${BROTLI_PREFIX}/lib/libbrotlidec.a" \
+    "${BROTLI_PREFIX}/lib/libbrotlicommon.a" \
+    "${ZSTD_PREFIX}/lib/libzstd.a"
 done
 
 # 合并两个模拟器架构成一个 fat lib
@@ -12,8 +12,11 @@ mkdir "$DIR"
 
 ./build_openssl.sh
 ./build_nghttp2.sh
+./build_brotli.sh
+./build_zstd.sh
 ./build_nghttp3.sh
 ./build_ngtcp2.sh
 ./build_libcurl_http2.sh
 ./build_libcurl_http3.sh
+./measure_libcurl_size.sh
 ./create_EMASCAResource_bundle.sh
\ No newline at end of file
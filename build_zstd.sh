@@ -0,0 +1,63 @@
+#!/bin/bash
+set -ex
+
+ROOT_DIR="$(cd "$(dirname "$0")"; pwd)"
+SRC_DIR="$ROOT_DIR/zstd"
+OUT_DIR="$ROOT_DIR/out/zstd"
+
+# 固定版本，源码不存在时按tag浅克隆
+ZSTD_TAG=v1.5.6
+if [ ! -d "$SRC_DIR/lib" ]; then
+  rm -rf "$SRC_DIR"
+  git clone --depth 1 --branch "$ZSTD_TAG" https://github.com/facebook/zstd "$SRC_DIR"
+fi
+
+rm -rf "$OUT_DIR"
+mkdir -p "$OUT_DIR"
+
+DEPLOYMENT_TARGET=10.0
+
+combinations=(
+  "ARCH=arm64   SDK=iphoneos"
+  "ARCH=arm64   SDK=iphonesimulator"
+  "ARCH=x86_64  SDK=iphonesimulator"
+)
+
+for combination in "${combinations[@]}"; do
+  eval "$combination"
+
+  PREFIX="${OUT_DIR}/artifacts-$SDK-$ARCH"
+
+  rm -rf "$PREFIX"
+  mkdir -p "$PREFIX/lib" "$PREFIX/include"
+
+  SDK_PATH="$(xcrun -sdk "$SDK" --show-sdk-path)"
+  if [ "$SDK" = "iphonesimulator" ]; then
+    MIN_VERSION_FLAG="-mios-simulator-version-min=$DEPLOYMENT_TARGET"
+  else
+    MIN_VERSION_FLAG="-mios-version-min=$DEPLOYMENT_TARGET"
+  fi
+
+  cd "$SRC_DIR/lib"
+  make clean
+
+  # libcurl只做解码：用zstd自带的Makefile开关裁掉压缩、字典训练、废弃接口与旧格式支持，
+  # 并关闭x86_64汇编解码路径，保证各架构行为一致
+  make libzstd.a -j8 \
+    CC="$(xcrun -sdk "$SDK" -f clang)" \
+    AR="$(xcrun -sdk "$SDK" -f ar)" \
+    CFLAGS="-arch $ARCH -isysroot $SDK_PATH $MIN_VERSION_FLAG -Os -fvisibility=hidden" \
+    ZSTD_LIB_COMPRESSION=0 \
+    ZSTD_LIB_DICTBUILDER=0 \
+    ZSTD_LIB_DEPRECATED=0 \
+    ZSTD_LEGACY_SUPPORT=0 \
+    ZSTD_NO_ASM=1
+
+  cp libzstd.a "$PREFIX/lib/libzstd.a"
+  cp zstd.h zstd_errors.h zdict.h "$PREFIX/include/"
+done
+
+cd "$SRC_DIR/lib"
+make clean
+
+echo "zstd built. Per-arch outputs are in: $OUT_DIR/artifacts-<SDK>-<ARCH>/lib/libzstd.a"
@@ -0,0 +1,103 @@
+#!/usr/bin/env python3
+"""
+生成EMASCurl预置缓存包，运行时通过 +[EMASCurlProtocol addCacheSeedPackAtPath:] 加载。
+
+清单为JSON数组，每项描述一个条目：
+    {"url": "https://example.com/config.json", "file": "seeds/config.json",
+     "headers": {"Cache-Control": "max-age=86400", "ETag": "\"v1\""}, "status": 200}
+未指定file时从网络下载url，响应头取自下载结果（headers中的值会覆盖）。
+
+用法：
+    python3 create_cache_seed_pack.py manifest.json -o Seed.pack
+
+文件格式与 EMASCurl/EMASCurlCacheSeedPack.h 中的说明一致。
+"""
+
+import argparse
+import json
+import os
+import struct
+import sys
+import time
+import urllib.request
+import zlib
+
+MAGIC = b"EMSEEDPK"
+VERSION = 1
+HEADER_SIZE = 32
+DROPPED_HEADERS = {"content-encoding", "transfer-encoding", "connection", "content-length"}
+
+
+def fnv1a64(data):
+    h = 0xcbf29ce484222325
+    for b in data:
+        h ^= b
+        h = (h * 0x100000001b3) & 0xFFFFFFFFFFFFFFFF
+    return h
+
+
+def load_entry(item, base_dir):
+    url = item["url"]
+    headers = {}
+    status = item.get("status", 200)
+    if "file" in item:
+        with open(os.path.join(base_dir, item["file"]), "rb") as f:
+            body = f.read()
+    else:
+        # urllib不协商压缩，得到的就是未编码的响应体
+        with urllib.request.urlopen(url) as response:
+            body = response.read()
+            status = item.get("status", response.status)
+            headers.update(response.headers.items())
+    headers.update(item.get("headers", {}))
+
+    headers = {k: v for k, v in headers.items() if k.lower() not in DROPPED_HEADERS}
+    headers["Content-Length"] = str(len(body))
+    return url, status, headers, body
+
+
+def build_pack(entries, stored):
+    data = bytearray(HEADER_SIZE)
+    index = []
+    for url, status, headers, body in entries:
+        meta = json.dumps({"url": url, "status": status, "headers": headers, "stored": stored},
+                          separators=(",", ":")).encode("utf-8")
+        meta_offset = len(data)
+        data += meta
+        body_offset = len(data)
+        data += body
+        index.append((fnv1a64(url.encode("utf-8")), meta_offset, body_offset,
+                      len(meta), len(body), zlib.crc32(body) & 0xFFFFFFFF))
+
+    index.sort(key=lambda e: e[0])
+    index_offset = len(data)
+    for entry in index:
+        data += struct.pack("<QQQIIII", *entry, 0)
+
+    data[0:HEADER_SIZE] = MAGIC + struct.pack("<IIQQ", VERSION, len(index), index_offset, 0)
+    return bytes(data)
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Create an EMASCurl cache seed pack")
+    parser.add_argument("manifest", help="JSON manifest describing the entries")
+    parser.add_argument("-o", "--output", required=True, help="output pack path")
+    args = parser.parse_args()
+
+    with open(args.manifest, "r", encoding="utf-8") as f:
+        items = json.load(f)
+
+    base_dir = os.path.dirname(os.path.abspath(args.manifest))
+    entries = [load_entry(item, base_dir) for item in items]
+    for _, _, _, body in entries:
+        if len(body) > 0xFFFFFFFF:
+            sys.exit("entry body exceeds 4GiB")
+
+    pack = build_pack(entries, time.time())
+    with open(args.output, "wb") as f:
+        f.write(pack)
+    print(f"Wrote {len(entries)} entries ({len(pack)} bytes) to {args.output}")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,44 @@
+#!/bin/bash
+set -e
+
+ROOT_DIR="$(cd "$(dirname "$0")"; pwd)"
+OUT_BASE="$ROOT_DIR/out"
+REPORT="$OUT_BASE/libcurl_size_report.txt"
+
+# 统计真机arm64下各静态库的代码与数据体积（size的dec列之和），评估br/zstd解码对包体积的影响
+SDK=iphoneos
+ARCH=arm64
+
+archive_size() {
+  local archive="$1"
+  if [ ! -f "$archive" ]; then
+    echo "-"
+    return
+  fi
+  xcrun size "$archive" | awk 'NR > 1 && $5 ~ /^[0-9]+$/ { sum += $5 } END { print sum + 0 }'
+}
+
+file_size() {
+  if [ ! -f "$1" ]; then
+    echo "-"
+    return
+  fi
+  stat -f%z "$1"
+}
+
+{
+  echo "# $SDK-$ARCH static library size (bytes)"
+  printf "%-28s %14s %14s\n" "library" "segments" "archive"
+  for entry in \
+    "libbrotlicommon.a:brotli/artifacts-$SDK-$ARCH/lib/libbrotlicommon.a" \
+    "libbrotlidec.a:brotli/artifacts-$SDK-$ARCH/lib/libbrotlidec.a" \
+    "libzstd.a:zstd/artifacts-$SDK-$ARCH/lib/libzstd.a" \
+    "libcurl.a (http2):curl2/artifacts-$SDK-$ARCH-HTTP2/libcurl.a" \
+    "libcurl.a (http3):curl3/artifacts-$SDK-$ARCH-HTTP3/libcurl.a"; do
+    name="${entry%%:*}"
+    path="$OUT_BASE/${entry#*:}"
+    printf "%-28s %14s %14s\n" "$name" "$(archive_size "$path")" "$(file_size "$path")"
+  done
+} > "$REPORT"
+
+cat "$REPORT"